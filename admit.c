@@ -0,0 +1,131 @@
+// main/admit.c
+#include "admit.h"
+#include "drone_state.h"
+
+#include <stddef.h>
+#include <string.h>
+
+void admit_default_config(AdmitConfig *cfg)
+{
+    cfg->bad_after        = ADMIT_BAD_AFTER;
+    cfg->ban_ms           = ADMIT_BAN_MS;
+    cfg->fails_per_window = ADMIT_UNKNOWN_FAILS;
+    cfg->window_ms        = ADMIT_WINDOW_MS;
+    cfg->heavy_per_s      = RATE_SKETCH_HEAVY_PER_S;
+    rate_sketch_default_config(&cfg->sketch);
+    token_rate_init(&cfg->node_rate, SEC_NODE_RATE_PER_S, SEC_NODE_BURST);
+    token_rate_init(&cfg->verify_rate, SEC_VERIFY_PER_S, SEC_VERIFY_BURST);
+    cfg->verify_reserve   = SEC_VERIFY_RESERVE;
+}
+
+void admit_init(Admit *a, const AdmitConfig *cfg, uint32_t seed)
+{
+    memset(a, 0, sizeof(*a));
+    a->cfg = *cfg;
+    token_fill(&a->verify, &cfg->verify_rate, 0);
+    rate_sketch_init(&a->sketch, &cfg->sketch, seed, 0);
+}
+
+static void roll_window(Admit *a, uint32_t now_ms)
+{
+    if (now_ms - a->window_start_ms >= a->cfg.window_ms) {
+        a->window_start_ms = now_ms;
+        a->window_fails    = 0;
+    }
+}
+
+static AdmitBad *find_bad(Admit *a, const uint8_t node_id[6])
+{
+    for (int i = 0; i < ADMIT_BAD_SLOTS; ++i) {
+        AdmitBad *b = &a->bad[i];
+        if (b->in_use && memcmp(b->node_id, node_id, 6) == 0) return b;
+    }
+    return NULL;
+}
+
+// Free slot, else the one that failed longest ago (bans that ran out first)
+static AdmitBad *pick_bad(Admit *a, uint32_t now_ms)
+{
+    AdmitBad *oldest = NULL, *oldest_free = NULL;
+    for (int i = 0; i < ADMIT_BAD_SLOTS; ++i) {
+        AdmitBad *b = &a->bad[i];
+        if (!b->in_use) return b;
+        bool banned = b->banned_until_ms && (int32_t)(now_ms - b->banned_until_ms) < 0;
+        AdmitBad **best = banned ? &oldest : &oldest_free;
+        if (!*best || (int32_t)(b->last_fail_ms - (*best)->last_fail_ms) < 0) *best = b;
+    }
+    return oldest_free ? oldest_free : oldest;
+}
+
+AdmitVerdict admit_check(Admit *a, const uint8_t *frame, const SecEntry *known,
+                         uint32_t now_ms)
+{
+    a->stats.checked++;
+    AdmitVerdict v = ADMIT_PASS;
+
+    if (frame[offsetof(NeighbourState, version)] != VERSION ||
+        frame[offsetof(NeighbourState, team_id)] != TEAM_ID) {
+        v = ADMIT_HEADER;
+    } else if (known) {
+        if (token_available(&known->bucket, &a->cfg.node_rate, now_ms) == 0) {
+            v = ADMIT_RATE;
+        }
+    } else {
+        const uint8_t *node_id = frame + offsetof(NeighbourState, node_id);
+        AdmitBad *b = find_bad(a, node_id);
+        roll_window(a, now_ms);
+        if (b && b->banned_until_ms && (int32_t)(now_ms - b->banned_until_ms) < 0) {
+            v = ADMIT_BANNED;
+        } else if (a->cfg.heavy_per_s > 0 &&
+                   rate_sketch_add(&a->sketch, node_id, now_ms) >
+                       a->cfg.heavy_per_s * RATE_SKETCH_ONE) {
+            v = ADMIT_HEAVY;
+        } else if (a->cfg.fails_per_window > 0 &&
+                   a->window_fails >= a->cfg.fails_per_window) {
+            v = ADMIT_UNKNOWN;
+        }
+    }
+
+    if (v != ADMIT_PASS) a->stats.dropped[v]++;
+    return v;
+}
+
+bool admit_take_budget(Admit *a, const SecEntry *known, uint32_t now_ms)
+{
+    // The reserve is for senders well within their own rate: a flood runs
+    // its buckets dry, a neighbour's stays mostly full
+    uint32_t burst = a->cfg.node_rate.cap / TOKEN_UNIT;
+    bool quiet = known && 2 * token_available(&known->bucket, &a->cfg.node_rate, now_ms) >= burst;
+    uint32_t keep = quiet ? 0 : a->cfg.verify_reserve;
+    if (token_take(&a->verify, &a->cfg.verify_rate, keep, now_ms)) return true;
+    a->stats.dropped[ADMIT_BUDGET]++;
+    return false;
+}
+
+void admit_on_bad_mac(Admit *a, const uint8_t node_id[6], const SecEntry *known,
+                      uint32_t now_ms)
+{
+    a->stats.bad_macs++;
+    if (known) return;      // Could be forged in its name: never held against it
+
+    roll_window(a, now_ms);
+    if (a->window_fails < UINT16_MAX) a->window_fails++;
+
+    AdmitBad *b = find_bad(a, node_id);
+    if (!b) {
+        b = pick_bad(a, now_ms);
+        memset(b, 0, sizeof(*b));
+        b->in_use = true;
+        memcpy(b->node_id, node_id, 6);
+    } else if (now_ms - b->last_fail_ms >= a->cfg.ban_ms) {
+        b->fails = 0;           // Old failures, or a ban that ran out
+        b->banned_until_ms = 0;
+    }
+    b->last_fail_ms = now_ms;
+
+    if (b->fails < UINT8_MAX) b->fails++;
+    if (b->fails >= a->cfg.bad_after && !b->banned_until_ms) {
+        b->banned_until_ms = (now_ms + a->cfg.ban_ms) | 1u;   // Never 0
+        a->stats.bans++;
+    }
+}
@@ -0,0 +1,126 @@
+// main/admit.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+#include "rate_sketch.h"
+#include "sec_table.h"
+#include "token_bucket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Admission stage of the RX path, in front of the CMAC. Every frame used to
+// pay a full AES-CMAC before security_validate_packet() looked at it, so a
+// flood cost crypto per frame even when the verdict was known from the
+// header alone. admit_check() rejects those frames from a few header bytes
+// and the sender's security table entry:
+//
+//   - header:  version / team_id not ours
+//   - rate:    known sender with an empty token bucket;
+//              security_validate_packet() would drop it anyway
+//   - banned:  unknown sender that failed the CMAC bad_after times, for
+//              ban_ms
+//   - heavy:   unknown sender whose node_id sends above heavy_per_s, by a
+//              fixed-size sketch (rate_sketch.h) over all unknown senders
+//   - unknown: unknown sender while unknown senders have already failed the
+//              CMAC fails_per_window times in this window
+//
+// The RX path runs it after the relay duplicate filter: copies of a state
+// relayed by our neighbours never count against its sender.
+//
+// A heavy sender never reaches the CMAC, so it never gets a table entry
+// either: however many identities a flood cycles through, the table keeps
+// the neighbours, and it costs 2 KB rather than a slot per identity.
+//
+// admit_take_budget() then charges each CMAC actually run (after the relay
+// duplicate filter) to one global bucket, so verification work per second
+// is bounded however many identities send. The last verify_reserve tokens
+// only go to known senders with at least half of their own burst left: a
+// flood keeps its buckets empty, so neighbours still get verified.
+//
+// Only state written by authenticated frames (the table entry) or by
+// senders not in the table (the bad list) is used, so a forged frame can't
+// get a neighbour with verified history rejected: known senders are never
+// banned. The global budget is the one exception: frames forged in a known
+// sender's name still spend it, so such a flood slows verification for
+// everyone but can't push the CPU past verify_rate. Known is any sender
+// holding a table entry, looked up with sec_table_peek().
+//
+// Pure logic, no FreeRTOS: times are plain milliseconds.
+
+typedef enum {
+    ADMIT_PASS = 0,
+    ADMIT_HEADER,
+    ADMIT_RATE,
+    ADMIT_BANNED,
+    ADMIT_HEAVY,
+    ADMIT_UNKNOWN,
+    ADMIT_BUDGET,           // admit_take_budget(): global bucket empty
+    ADMIT_VERDICTS
+} AdmitVerdict;
+
+typedef struct {
+    uint8_t   bad_after;        // CMAC failures before an unknown sender is banned
+    uint32_t  ban_ms;
+    uint16_t  fails_per_window; // Unknown-sender CMAC failures before the rest wait (0: off)
+    uint32_t  window_ms;
+    uint32_t  heavy_per_s;      // Unknown-sender frame rate throttled (0: off)
+    RateSketchConfig sketch;
+    TokenRate node_rate;        // Per sender, as in security_validate_packet()
+    TokenRate verify_rate;      // All CMACs
+    uint32_t  verify_reserve;   // Tokens only known senders may take
+} AdmitConfig;
+
+typedef struct {
+    uint8_t  node_id[6];
+    uint8_t  fails;
+    bool     in_use;
+    uint32_t last_fail_ms;
+    uint32_t banned_until_ms;   // 0: not banned
+} AdmitBad;
+
+typedef struct {
+    uint32_t checked;
+    uint32_t dropped[ADMIT_VERDICTS];   // By verdict; [ADMIT_PASS] unused
+    uint32_t bans;
+    uint32_t bad_macs;          // Reported by the caller after the CMAC
+} AdmitStats;
+
+typedef struct {
+    AdmitConfig cfg;
+    AdmitBad    bad[ADMIT_BAD_SLOTS];
+    uint32_t    window_start_ms;
+    uint16_t    window_fails;
+    TokenBucket verify;
+    RateSketch  sketch;
+    AdmitStats  stats;
+} Admit;
+
+// Defaults from config.h
+void admit_default_config(AdmitConfig *cfg);
+
+// seed: random per boot, for the sketch's hash
+void admit_init(Admit *a, const AdmitConfig *cfg, uint32_t seed);
+
+// Verdict on a frame in wire order (NeighbourState first, length already
+// checked). known: the sender's table entry, or NULL.
+AdmitVerdict admit_check(Admit *a, const uint8_t *frame, const SecEntry *known,
+                         uint32_t now_ms);
+
+// TRUE if a CMAC may run now for this sender; takes a global token
+bool admit_take_budget(Admit *a, const SecEntry *known, uint32_t now_ms);
+
+// The frame admitted for this sender failed the CMAC
+void admit_on_bad_mac(Admit *a, const uint8_t node_id[6], const SecEntry *known,
+                      uint32_t now_ms);
+
+// Stats of the admission stage (security.c), for monitoring
+void security_get_admit_stats(AdmitStats *out);
+
+#ifdef __cplusplus
+}
+#endif
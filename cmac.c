@@ -0,0 +1,72 @@
+// main/cmac.c
+#include "cmac.h"
+
+#include <string.h>
+
+#define CMAC_RB  0x87   // GF(2^128) reduction for a 128-bit block
+
+static void encrypt(const CmacKey *k, const uint8_t in[CMAC_BLOCK], uint8_t out[CMAC_BLOCK])
+{
+    // mbedtls takes a non-const context but only reads the round keys
+    mbedtls_aes_crypt_ecb((mbedtls_aes_context *)&k->aes, MBEDTLS_AES_ENCRYPT, in, out);
+}
+
+// out = in << 1 in GF(2^128)
+static void dbl(const uint8_t in[CMAC_BLOCK], uint8_t out[CMAC_BLOCK])
+{
+    uint8_t carry = 0;
+    for (int i = CMAC_BLOCK - 1; i >= 0; --i) {
+        uint8_t b = in[i];
+        out[i] = (uint8_t)(b << 1) | carry;
+        carry = b >> 7;
+    }
+    out[CMAC_BLOCK - 1] ^= (uint8_t)(-carry & CMAC_RB);
+}
+
+bool cmac_key_init(CmacKey *k, const uint8_t key[16])
+{
+    memset(k, 0, sizeof(*k));
+    mbedtls_aes_init(&k->aes);
+    if (mbedtls_aes_setkey_enc(&k->aes, key, 128) != 0) {
+        mbedtls_aes_free(&k->aes);
+        return false;
+    }
+
+    // L = AES(K, 0); K1 = dbl(L); K2 = dbl(K1)
+    uint8_t l[CMAC_BLOCK] = { 0 };
+    encrypt(k, l, l);
+    dbl(l, k->k1);
+    dbl(k->k1, k->k2);
+    memset(l, 0, sizeof(l));
+
+    k->ready = true;
+    return true;
+}
+
+void cmac_key_free(CmacKey *k)
+{
+    mbedtls_aes_free(&k->aes);
+    memset(k, 0, sizeof(*k));
+}
+
+void cmac_compute(const CmacKey *k, const uint8_t *msg, size_t len,
+                  uint8_t out[CMAC_BLOCK])
+{
+    uint8_t x[CMAC_BLOCK] = { 0 };
+
+    // All blocks but the last: X = AES(K, X ^ M_i)
+    while (len > CMAC_BLOCK) {
+        for (int i = 0; i < CMAC_BLOCK; ++i) x[i] ^= msg[i];
+        encrypt(k, x, x);
+        msg += CMAC_BLOCK;
+        len -= CMAC_BLOCK;
+    }
+
+    // Last block: complete -> ^ K1, else pad 10..0 -> ^ K2
+    const uint8_t *sub = (len == CMAC_BLOCK) ? k->k1 : k->k2;
+    for (size_t i = 0; i < CMAC_BLOCK; ++i) {
+        uint8_t m = i < len ? msg[i] : (i == len ? 0x80 : 0x00);
+        x[i] ^= m ^ sub[i];
+    }
+    encrypt(k, x, out);
+}
@@ -0,0 +1,48 @@
+// main/cmac.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "mbedtls/aes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// AES-128-CMAC (RFC 4493) with the key prepared once. mbedtls_cipher_cmac()
+// sets up a cipher context, expands the AES key and derives the K1 / K2
+// subkeys on every call; for a fixed key all of that is the same each time,
+// so a CmacKey keeps the expanded key and the subkeys and a MAC costs only
+// the block encryptions (3 for a 44-byte NeighbourState).
+//
+// A CmacKey is read-only after cmac_key_init() and cmac_compute() keeps its
+// chaining state on the stack, so any number of tasks may use one key at
+// once (the ESP32 AES peripheral, when mbedtls uses it, is locked per block
+// by the port).
+//
+// Only needs the mbedtls AES block API: host builds map it onto OpenSSL
+// (host/shim/mbedtls/aes.h).
+
+#define CMAC_BLOCK  16
+
+typedef struct {
+    mbedtls_aes_context aes;
+    uint8_t k1[CMAC_BLOCK];         // Last block complete
+    uint8_t k2[CMAC_BLOCK];         // Last block padded
+    bool    ready;
+} CmacKey;
+
+// Expand key and derive subkeys. FALSE if mbedtls refused the key.
+bool cmac_key_init(CmacKey *k, const uint8_t key[16]);
+
+void cmac_key_free(CmacKey *k);
+
+// Full 16-byte tag of msg
+void cmac_compute(const CmacKey *k, const uint8_t *msg, size_t len,
+                  uint8_t out[CMAC_BLOCK]);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,11 +2,26 @@
 #include "EspHal.h"
 #include "RadioLib.h"
 #include "monitoring.h" // <--- Added
+#include "tx_policy.h"
+#include "link_adapt.h"
+#include "rx_ring.h"
+#include "neigh_ring.h"
+#include "lora_airtime.h"
+#include "tx_sched.h"
+#include "relay.h"
+#include "csma.h"
+#include "interest.h"
+#include "congestion.h"
+#include "join.h"
+#include "radio_fsm.h"
+#include "packet_view.h"
+#include "sec_stats.h"
 
 extern "C" {
 #include "config.h"
 #include "tasks.h"
 
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
@@ -35,171 +50,751 @@ static EspHal hal(PIN_SPI_SCK, PIN_SPI_MISO, PIN_SPI_MOSI);
 static SX1276 lora(new Module(&hal, PIN_LORA_CS, PIN_LORA_DIO0,
                               PIN_LORA_RST, PIN_LORA_DIO1));
 
-static SemaphoreHandle_t RX_SEM = nullptr;
 static uint16_t PACKET_SEQ = 0;
 
-static volatile bool s_transmitting = false; 
-static TickType_t last_tx_end_tick = 0; 
+// Radio state machine (radio_fsm.c), woken by DIO0 through a direct task
+// notification. radio_task only; the ISR just stamps the time.
+static RadioFsm s_radio;
+static TaskHandle_t s_radio_task = nullptr;
+static volatile int64_t s_dio0_us = 0;
 
-extern "C" void IRAM_ATTR give_rx_semaphore(void)
+static TxPolicy s_tx_policy;
+
+static LinkAdapt s_link;
+static uint8_t   s_radio_sf = LORA_SF;   // SF currently programmed into the SX1276
+static int8_t    s_radio_power_dbm = LORA_POWER_DBM;
+static SemaphoreHandle_t LINK_MUTEX = nullptr; // s_link: radio task + verifier
+
+static Relay s_relay;
+static SemaphoreHandle_t RELAY_MUTEX = nullptr; // s_relay: radio task + verifier
+
+// Channel load -> own TX interval. radio_task only; the verifier just counts
+// frames admission or the CMAC rejected, which aren't channel failures.
+static Congestion s_congestion;
+static volatile uint32_t s_rejected = 0;
+static uint32_t s_rejected_seen = 0;
+
+// Fast join: our beacons after boot, answers to other nodes' beacons.
+// radio_task only; the verifier just counts beacons heard.
+static Join s_join;
+static volatile uint32_t s_join_requests = 0;
+static uint32_t s_join_requests_seen = 0;
+static bool s_own_unscheduled = false;  // Queued own state is a join answer
+
+static InterestFilter s_interest;
+static SemaphoreHandle_t INTEREST_MUTEX = nullptr; // s_interest: radio task + verifier
+
+static TaskHandle_t s_verify_task = nullptr;
+
+// radio_task never waits for a mutex the verifier holds: a busy lock skips
+// the work and the loop comes back on the next tick.
+static bool s_lock_missed = false;      // radio_task only
+static bool s_link_retune = false;      // Own state sent, link_adapt_on_tx() owed
+static bool s_own_pos_dirty = false;    // s_own_pos not yet in s_interest
+static DroneState s_own_pos;
+
+static bool radio_try_lock(SemaphoreHandle_t m)
+{
+    if (xSemaphoreTake(m, 0) == pdTRUE) return true;
+    s_lock_missed = true;
+    return false;
+}
+
+extern "C" void IRAM_ATTR radio_dio0_isr(void)
 {
+    if (!s_radio_task) return;
+    s_dio0_us = esp_timer_get_time();
+
     BaseType_t hp = pdFALSE;
-    xSemaphoreGiveFromISR(RX_SEM, &hp);
+    vTaskNotifyGiveFromISR(s_radio_task, &hp);
     if (hp) {
         portYIELD_FROM_ISR();
     }
 }
 
+// Time since the last DIO0 interrupt
+static uint32_t radio_isr_latency_us(void)
+{
+    int64_t d = esp_timer_get_time() - s_dio0_us;
+    return d > 0 ? (uint32_t)d : 0;
+}
+
+static void radio_set_sf(uint8_t sf)
+{
+    if (sf == s_radio_sf) return;
+    if (lora.setSpreadingFactor(sf) == RADIOLIB_ERR_NONE) {
+        s_radio_sf = sf;
+    }
+}
+
+// Program the link-adapted SF / power. Only between packets, never mid-TX.
+static void radio_apply_link(void)
+{
+#if LINK_ADAPT_ENABLED
+    radio_set_sf(s_link.sf);
+    if (s_link.power_dbm != s_radio_power_dbm &&
+        lora.setOutputPower(s_link.power_dbm) == RADIOLIB_ERR_NONE) {
+        s_radio_power_dbm = s_link.power_dbm;
+    }
+#endif
+}
+
+// Time on air of a frame with the current radio settings
+static uint32_t radio_airtime_us(size_t len)
+{
+    LoraAirParams p = { s_radio_sf, LORA_BW_KHZ, LORA_CR, LORA_PREAMBLE,
+                        LORA_CRC_ON, false };
+    return lora_time_on_air_us(&p, len);
+}
+
+// Re-arm RX on the swarm SF (link adaptation may have moved it since last RX)
+static void radio_start_receive(void)
+{
+#if LINK_ADAPT_ENABLED
+    radio_set_sf(s_link.sf);
+#endif
+    lora.startReceive();
+    monitor_radio_state(MON_RADIO_RX);
+}
+
+// -----------------------------------------------------------------------------
+// RADIO FSM OPS: RadioLib side of radio_fsm.c
+// -----------------------------------------------------------------------------
+static void op_start_receive(void *ctx)
+{
+    (void)ctx;
+    radio_start_receive();
+}
+
+static bool op_start_cad(void *ctx)
+{
+    (void)ctx;
+    radio_apply_link();
+    int16_t res = lora.startChannelScan();
+    if (res != RADIOLIB_ERR_NONE) {
+        fast_log("RADIO (W): startChannelScan failed (%d)", res);
+        return false;
+    }
+    monitor_radio_state(MON_RADIO_RX);      // CAD draws about RX current
+    return true;
+}
+
+static bool op_cad_busy(void *ctx)
+{
+    (void)ctx;
+    return lora.getChannelScanResult() != RADIOLIB_CHANNEL_FREE;
+}
+
+static void op_tx_done(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+    tx_sched_on_tx_done(now_ms);
+}
+
+// RxDone: copy the raw frame into the ring, verification happens in
+// rx_verify_task. The FSM re-arms RX.
+static void op_receive(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+
+    RxFrame *slot = rx_ring_reserve();
+    if (!slot) {
+        return;     // Ring full: drop is counted
+    }
+
+    size_t len = lora.getPacketLength();
+    if (len > RX_FRAME_MAX_LEN) len = RX_FRAME_MAX_LEN;
+
+    int16_t r = lora.readData(slot->data, len);
+
+    if (r == RADIOLIB_ERR_NONE) {
+        congestion_on_rx(&s_congestion,
+                         wire::NeighbourView::fits(len)
+                             ? wire::NeighbourView(slot->data).node_id() : nullptr,
+                         radio_airtime_us(len));
+
+        slot->len      = (uint8_t)len;
+        slot->sf       = s_radio_sf;
+        slot->rssi_dbm = lora.getRSSI();
+        slot->snr_db   = lora.getSNR();
+        slot->rx_ms    = now_ms;
+        rx_ring_commit();
+        xTaskNotifyGive(s_verify_task);
+    } else if (r == RADIOLIB_ERR_CRC_MISMATCH) {
+        congestion_on_rx_error(&s_congestion, radio_airtime_us(sizeof(NeighbourState)));
+    } else {
+        fast_log("RADIO (W): readData error (%d)", r);
+    }
+}
+
+static uint32_t op_airtime_us(void *ctx, size_t len)
+{
+    (void)ctx;
+    return radio_airtime_us(len);
+}
+
+static bool op_dio0_pending(void *ctx, uint32_t *latency_us)
+{
+    (void)ctx;
+    if (ulTaskNotifyTake(pdTRUE, 0) == 0) return false;
+    *latency_us = radio_isr_latency_us();
+    return true;
+}
+
+// Send-on-delta / heartbeat: queue our own state when due. Join beacons and
+// answers go out on their own schedule. Returns the time until the next
+// check.
+static uint32_t radio_queue_own_state(DroneState *self, uint32_t now_ms)
+{
+    uint32_t defer_ms = 0;
+
+    bool own_queued = tx_sched_pending(TX_CLASS_OWN) ||
+                      radio_fsm_holds(&s_radio, TX_CLASS_OWN);
+
+    bool due;
+    bool unscheduled = false;
+    if (join_active(&s_join)) {
+        due = join_beacon_due(&s_join, now_ms);
+    } else {
+        due = tx_policy_should_send(&s_tx_policy, self, now_ms);
+        if (!due && join_answer_due(&s_join, now_ms)) {
+            due = unscheduled = true;
+        }
+    }
+
+    if (!own_queued && due) {
+#if DUTY_CYCLE_ENABLED
+        defer_ms = duty_cycle_defer_ms(radio_airtime_us(sizeof(NeighbourState)), now_ms);
+        if (defer_ms > 0) {
+            fast_log("RADIO (W): duty cycle %lu/%lu us used, TX deferred %lu ms",
+                     (unsigned long)duty_cycle_used_us(now_ms),
+                     (unsigned long)duty_cycle_budget_us(),
+                     (unsigned long)defer_ms);
+        }
+#endif
+        if (defer_ms == 0) {
+#if LINK_ADAPT_ENABLED
+            // New power is programmed by radio_apply_link() at TX start.
+            // Verifier in the link table: nothing is sent, retry next tick.
+            if (!radio_try_lock(LINK_MUTEX)) return 0;
+            link_adapt_update(&s_link, now_ms);
+            uint16_t link_cfg = link_adapt_encode(&s_link);
+            xSemaphoreGive(LINK_MUTEX);
+#endif
+            NeighbourState tx = DroneState_to_NeighbourState(self, PACKET_SEQ++);
+#if LINK_ADAPT_ENABLED
+            tx.link_cfg = link_cfg;
+#endif
+            if (join_active(&s_join)) {
+                tx.link_cfg |= LINK_CFG_JOIN;
+            }
+            join_on_own_state(&s_join, now_ms);
+            s_own_unscheduled = unscheduled;
+
+            sign_packet(&tx);
+            tx_sched_enqueue(TX_CLASS_OWN, &tx, sizeof(tx),
+                             now_ms, now_ms + TX_SCHED_OWN_DEADLINE_MS);
+        }
+    }
+
+    uint32_t wait_ms = tx_policy_next_check_ms(&s_tx_policy, now_ms);
+    if (wait_ms == 0) wait_ms = RADIO_TX_CHECK_PERIOD_MS; // Not sent yet, check again
+    uint32_t join_ms = join_wait_ms(&s_join, now_ms);
+    if (join_ms < wait_ms) wait_ms = join_ms;             // Beacon / answer
+    if (defer_ms > wait_ms) wait_ms = defer_ms;           // Out of duty cycle
+    return wait_ms;
+}
+
+// Hand a due relay to the scheduler, but only once it can go on air
+// straight away: until then later copies may still suppress it.
+static void radio_queue_relay(uint32_t now_ms)
+{
+    if (!radio_fsm_idle(&s_radio) ||
+        !tx_sched_idle_for(TX_CLASS_RELAY, now_ms)) return;
+
+    uint8_t frame[RELAY_FRAME_LEN];
+    if (!radio_try_lock(RELAY_MUTEX)) return;
+    bool due = relay_next(&s_relay, frame, now_ms);
+    xSemaphoreGive(RELAY_MUTEX);
+
+    if (due) {
+        tx_sched_enqueue(TX_CLASS_RELAY, frame, sizeof(frame),
+                         now_ms, now_ms + TX_SCHED_RELAY_DEADLINE_MS);
+    }
+}
+
+#if LINK_ADAPT_ENABLED
+// SF staged by link adaptation, once our announcement of it is on air. The
+// new SF is programmed at the next RX / TX start.
+static void radio_retune_link(void)
+{
+    if (!s_link_retune || !radio_try_lock(LINK_MUTEX)) return;
+    if (link_adapt_on_tx(&s_link)) {
+        fast_log("RADIO (I): link adapted -> SF%u @ %d dBm",
+                 (unsigned)s_link.sf, (int)s_link.power_dbm);
+    }
+    xSemaphoreGive(LINK_MUTEX);
+    s_link_retune = false;
+}
+#endif
+
+// Highest-priority frame allowed on air now
+static bool op_next_tx(void *ctx, TxItem *it, uint32_t now_ms)
+{
+    (void)ctx;
+    while (tx_sched_next(it, now_ms)) {
+        radio_apply_link();
+
+#if DUTY_CYCLE_ENABLED
+        // SF may have just moved: airtime is for what goes on air now
+        if (it->cls != TX_CLASS_OWN &&
+            duty_cycle_defer_ms(radio_airtime_us(it->len), now_ms) > 0) {
+            fast_log("RADIO (W): duty cycle exhausted, %s packet dropped",
+                     it->cls == TX_CLASS_RELAY ? "relay" : "injected");
+            continue;
+        }
+#endif
+        return true;
+    }
+    return false;
+}
+
+// Put a frame on air. The FSM only calls this with the radio idle.
+static bool op_transmit(void *ctx, const TxItem *it, uint32_t now_ms,
+                        uint32_t *airtime_us_out)
+{
+    (void)ctx;
+    radio_apply_link();
+    uint32_t airtime_us = radio_airtime_us(it->len);
+
+    int16_t res = lora.startTransmit(it->data, it->len);
+    if (res != RADIOLIB_ERR_NONE) {
+        fast_log("RADIO (E): StartTransmit failed (%d)", res);
+        return false;
+    }
+
+    *airtime_us_out = airtime_us;
+    tx_sched_on_tx_start(it, now_ms);
+    congestion_on_tx(&s_congestion, airtime_us);
+    monitor_radio_tx(airtime_us, s_radio_power_dbm);
+#if DUTY_CYCLE_ENABLED
+    duty_cycle_record(airtime_us, now_ms);
+#endif
+
+    if (it->cls == TX_CLASS_OWN) {
+        NeighbourState tx;
+        memcpy(&tx, it->data, sizeof(tx));
+        log_neighbour_state("RADIO TX ", &tx);
+        if (s_own_unscheduled) {
+            tx_policy_on_sent_unscheduled(&s_tx_policy, &tx, now_ms);
+        } else {
+            tx_policy_on_sent(&s_tx_policy, &tx, now_ms);
+        }
+#if LINK_ADAPT_ENABLED
+        // Announcement is on air: retune when TX completes
+        s_link_retune = true;
+        radio_retune_link();
+#endif
+    }
+    return true;
+}
+
+static const RadioFsmOps RADIO_OPS = {
+    op_start_receive,
+    op_start_cad,
+    op_cad_busy,
+    op_transmit,
+    op_tx_done,
+    op_receive,
+    op_next_tx,
+    op_airtime_us,
+    op_dio0_pending,
+};
+
+// Close the congestion window when due. TRUE if the own TX interval changed.
+static bool radio_update_congestion(uint32_t now_ms)
+{
+    uint32_t rejected = s_rejected;
+    congestion_on_rejected(&s_congestion, rejected - s_rejected_seen);
+    s_rejected_seen = rejected;
+
+    if (!congestion_update(&s_congestion, now_ms)) return false;
+
+#if CONGESTION_ENABLED
+    // Rate cap, and the heartbeat once the channel needs us slower than that
+    uint32_t period = congestion_period_ms(&s_congestion);
+#if RADIO_TX_ADAPTIVE
+    uint32_t heartbeat = (uint32_t)RADIO_TX_MAX_PERIOD_MS;
+    tx_policy_set_periods(&s_tx_policy, period, period > heartbeat ? period : heartbeat);
+#else
+    tx_policy_set_periods(&s_tx_policy, period, period);
+#endif
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Join beacons the verifier heard since the last pass. TRUE if that
+// scheduled an answer.
+static bool radio_update_join(uint32_t now_ms)
+{
+    uint32_t req = s_join_requests;
+    uint32_t fresh = req - s_join_requests_seen;
+    s_join_requests_seen = req;
+    if (fresh == 0) return false;
+
+    bool pending = s_join.answer_pending;
+    join_on_request(&s_join, fresh, s_congestion.stats.senders,
+                    s_congestion.stats.util,
+                    radio_airtime_us(sizeof(NeighbourState)) / 1000, now_ms);
+    return !pending && s_join.answer_pending;
+}
+
+// Own position for the verifier's interest filter; kept for the next pass
+// while the verifier holds the filter
+static void radio_set_own_position(const DroneState *self)
+{
+    if (self) {
+        s_own_pos = *self;
+        s_own_pos_dirty = true;
+    }
+    if (!s_own_pos_dirty || !radio_try_lock(INTEREST_MUTEX)) return;
+    interest_set_own(&s_interest, s_own_pos.x_mm, s_own_pos.y_mm, s_own_pos.z_mm);
+    xSemaphoreGive(INTEREST_MUTEX);
+    s_own_pos_dirty = false;
+}
+
 static void radio_task(void *arg)
 {
     (void)arg;
 
     QueueHandle_t state_q   = get_radio_state_queue();
-    QueueHandle_t neigh_q   = get_neighbour_update_queue();
     QueueHandle_t attack_q  = get_attack_queue();
 
     DroneState self{};
     xQueueReceive(state_q, &self, portMAX_DELAY);
+    radio_set_own_position(&self);
 
-    const TickType_t tx_period = pdMS_TO_TICKS(RADIO_TX_PERIOD_MS);
-    TickType_t next_tx = xTaskGetTickCount() + tx_period;
+    TxPolicyConfig policy_cfg;
+    tx_policy_default_config(&policy_cfg);
+    tx_policy_init(&s_tx_policy, &policy_cfg);
+    tx_sched_init();
 
-    lora.startReceive();
-    s_transmitting = false;
+    CongestionConfig cc_cfg;
+    congestion_default_config(&cc_cfg);
+    congestion_init(&s_congestion, &cc_cfg, pdTICKS_TO_MS(xTaskGetTickCount()));
 
-    while (true) {
-        
-        // 1. ATTACK INJECTION
-        NeighbourState attack_pkt;
-        if (xQueueReceive(attack_q, &attack_pkt, 0) == pdTRUE) {
-            int16_t res = lora.startTransmit((uint8_t*)&attack_pkt, sizeof(attack_pkt));
-            if (res == RADIOLIB_ERR_NONE) {
-                s_transmitting = true;
-                monitor_radio_state(true, 50); // Log Energy
-            }
-            while(s_transmitting) {
-                if (xSemaphoreTake(RX_SEM, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    if (s_transmitting) {
-                         s_transmitting = false;
-                         last_tx_end_tick = xTaskGetTickCount(); 
-                         lora.startReceive();
-                    }
-                }
-            }
-            continue;
-        }
+    // Join beacons instead of a single first state; draws differ per node
+    const uint8_t *mac = get_mac_address();
+    join_init(&s_join, (uint32_t)mac[1] << 24 | (uint32_t)mac[3] << 16 |
+                       (uint32_t)mac[5] << 8 | mac[2],
+              pdTICKS_TO_MS(xTaskGetTickCount()));
 
-        // 2. NORMAL RADIO LOOP
-        TickType_t now = xTaskGetTickCount();
-        TickType_t wait_ticks = (next_tx > now) ? (next_tx - now) : 0;
+    // First broadcast goes out immediately, then send-on-delta takes over
+    TickType_t next_check = xTaskGetTickCount();
+
+    radio_fsm_start(&s_radio, pdTICKS_TO_MS(xTaskGetTickCount()));
+    uint32_t wait_ticks = 0;
+
+    while (true) {
+        // Sleep until DIO0 or the next time event; nothing below blocks
+        bool dio0 = ulTaskNotifyTake(pdTRUE, wait_ticks) > 0;
 
         // --- MONITOR START ---
         monitor_task_start(MON_TASK_RADIO);
 
-        if (xSemaphoreTake(RX_SEM, wait_ticks) == pdTRUE) {
-            
-            if (s_transmitting) {
-                // TX DONE
-                s_transmitting = false;
-                last_tx_end_tick = xTaskGetTickCount(); 
-                lora.startReceive();
-                
-            } else {
-                // RX DONE
-                
-                // Anti-Echo Check
-                if (xTaskGetTickCount() - last_tx_end_tick < pdMS_TO_TICKS(50)) {
-                    lora.startReceive();
-                    monitor_task_end(MON_TASK_RADIO);
-                    continue;
-                }
-
-                NeighbourState rx{};
-                int16_t r = lora.readData((uint8_t*)&rx, sizeof(rx));
-
-                if (r == RADIOLIB_ERR_NONE) {
-                    
-                    // Ignore Own MAC
-                    if (memcmp(rx.node_id, get_mac_address(), 6) == 0) {
-                        lora.startReceive();
-                        monitor_task_end(MON_TASK_RADIO);
-                        continue;
-                    }
-
-                    // Verify Crypto
-                    if (!verify_packet(&rx)) {
-                        uint8_t spoof_mac[6] = {0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0x01};
-                        if (memcmp(rx.node_id, spoof_mac, 6) != 0) {
-                             fast_log("RADIO (W): Bad MAC/Sig from %s", format_mac(rx.node_id));
-                        }
-                        lora.startReceive();
-                        monitor_task_end(MON_TASK_RADIO);
-                        continue;
-                    }
-
-                    // Security Logic (Rate Limit / Physics)
-                    if (!security_validate_packet(&rx)) {
-                        lora.startReceive();
-                        monitor_task_end(MON_TASK_RADIO);
-                        continue;
-                    }
-
-                    // Valid
-                    log_radio_packet("RX", &rx);
-                    xQueueSend(neigh_q, &rx, 0);
-
-                } else if (r != RADIOLIB_ERR_CRC_MISMATCH) {
-                    fast_log("RADIO (W): readData error (%d)", r);
-                }
-
-                lora.startReceive();
-            }
+        uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+        s_lock_missed = false;
 
-        } else {
-            
-            // TIMEOUT -> NORMAL TX
-            xQueueReceive(state_q, &self, 0);
+        // Work a busy mutex held back last pass
+        radio_set_own_position(nullptr);
+#if LINK_ADAPT_ENABLED
+        radio_retune_link();
+#endif
 
-            NeighbourState tx = DroneState_to_NeighbourState(&self, PACKET_SEQ++);
-            sign_packet(&tx);
+        // 1. RADIO EVENT: TxDone / CadDone / RxDone
+        if (dio0) {
+            radio_fsm_on_dio0(&s_radio, now_ms, radio_isr_latency_us());
+        }
+
+        // 2. TEST INJECTION: queued behind our own state, never sent inline
+        NeighbourState attack_pkt;
+        while (xQueueReceive(attack_q, &attack_pkt, 0) == pdTRUE) {
+            tx_sched_enqueue(TX_CLASS_INJECT, &attack_pkt, sizeof(attack_pkt),
+                             now_ms, now_ms + TX_SCHED_INJECT_DEADLINE_MS);
+        }
 
-            int16_t res = lora.startTransmit((uint8_t*)&tx, sizeof(tx));
-            if (res == RADIOLIB_ERR_NONE) {
-                log_neighbour_state("RADIO TX ", &tx);
-                s_transmitting = true;
-                monitor_radio_state(true, 50); // Log Energy (approx 50ms)
-            } else {
-                fast_log("RADIO (E): StartTransmit failed (%d)", res);
-                lora.startReceive();
-                s_transmitting = false;
+        // 3. OWN STATE: checked on every pass, so RX traffic can't starve it.
+        // A new TX interval from congestion control, or a join answer, applies
+        // straight away.
+        if (radio_update_congestion(now_ms)) {
+            next_check = xTaskGetTickCount();
+        }
+        if (radio_update_join(now_ms)) {
+            next_check = xTaskGetTickCount();
+        }
+        if (xTaskGetTickCount() >= next_check) {
+            if (xQueueReceive(state_q, &self, 0) == pdTRUE) {
+                radio_set_own_position(&self);
             }
+            uint32_t wait_ms = radio_queue_own_state(&self, now_ms);
+            next_check = xTaskGetTickCount() + pdMS_TO_TICKS(wait_ms);
+        }
+
+        // 4. RELAY: due re-broadcasts of other nodes' states
+        radio_queue_relay(now_ms);
+
+        // 5. TX / timeouts: next frame when the radio is free (after a clear
+        // CAD when CSMA_ENABLED), lost TxDone / CadDone, end of a backoff
+        uint32_t guards = s_radio.stats.guard_tx + s_radio.stats.guard_cad;
+        radio_fsm_poll(&s_radio, now_ms);
+        if (s_radio.stats.guard_tx + s_radio.stats.guard_cad != guards) {
+            fast_log("RADIO (W): TxDone / CadDone missing, re-armed RX");
+        }
+
+        // 6. NEXT WAKE-UP: next own-state check, radio time event, queued
+        // TX. Capped so injected packets are picked up promptly.
+        TickType_t now = xTaskGetTickCount();
+        uint32_t wait_ms = (next_check > now) ? pdTICKS_TO_MS(next_check - now) : 0;
+
+        uint32_t fsm_ms = radio_fsm_wait_ms(&s_radio, now_ms);
+        if (fsm_ms < wait_ms) wait_ms = fsm_ms;
+
+        if (radio_fsm_idle(&s_radio)) {
+            uint32_t q_ms = tx_sched_wait_ms(now_ms);
 
-            while (next_tx <= xTaskGetTickCount()) {
-                next_tx += tx_period;
+            if (radio_try_lock(RELAY_MUTEX)) {
+                uint32_t r_ms = relay_wait_ms(&s_relay, now_ms);
+                xSemaphoreGive(RELAY_MUTEX);
+                if (r_ms < q_ms) q_ms = r_ms;
             }
+            if (q_ms < wait_ms) wait_ms = q_ms;
         }
+        if (wait_ms > RADIO_TX_CHECK_PERIOD_MS) wait_ms = RADIO_TX_CHECK_PERIOD_MS;
+        wait_ticks = pdMS_TO_TICKS(wait_ms);
+        if (s_lock_missed && wait_ticks > 1) wait_ticks = 1;   // Skipped work: next tick
 
         // --- MONITOR END ---
         monitor_task_end(MON_TASK_RADIO);
     }
 }
 
+// -----------------------------------------------------------------------------
+// RX VERIFIER: drains raw frames queued by radio_task
+// -----------------------------------------------------------------------------
+static void verify_frame(const RxFrame *f)
+{
+    int hops = relay_frame_hops(f->data, f->len);
+    if (hops < 0) {
+        return;     // Not one of ours
+    }
+
+    // Sender, duplicate and CMAC checks read the ring slot in place
+    wire::NeighbourView v(f->data);
+
+    // Ignore Own MAC (also our own state relayed back)
+    if (v.from(get_mac_address())) {
+        return;
+    }
+
+    // Relayed copies of a state we already have: skip the CMAC. Checked
+    // before admission so the sender isn't charged for our neighbours'
+    // relays of it.
+    xSemaphoreTake(RELAY_MUTEX, portMAX_DELAY);
+    bool dup = relay_is_duplicate(&s_relay, f->data, v.node_id(), v.seq_number());
+    xSemaphoreGive(RELAY_MUTEX);
+    if (dup) {
+        return;
+    }
+
+    // Foreign header, rate-limited or banned sender: drop before any crypto
+    if (!security_admit_frame(f->data)) {
+        s_rejected = s_rejected + 1;        // Single writer: this task
+        return;
+    }
+
+    // Verify Crypto, within the global verification budget
+    if (!security_verify_budget(v.node_id())) {
+        return;
+    }
+    int64_t cmac_t0 = esp_timer_get_time();
+    bool authentic = verify_packet_bytes(v.mac_region());
+    security_record_stage(SEC_STAGE_CMAC, (uint32_t)(esp_timer_get_time() - cmac_t0));
+    if (!authentic) {
+        s_rejected = s_rejected + 1;        // Single writer: this task
+        security_on_bad_mac(v.node_id());
+        uint8_t spoof_mac[6] = {0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0x01};
+        if (!v.from(spoof_mac)) {
+             fast_log("RADIO (W): Bad MAC/Sig from %s", format_mac(v.node_id()));
+        }
+        return;
+    }
+
+    xSemaphoreTake(RELAY_MUTEX, portMAX_DELAY);
+    relay_mark_seen(&s_relay, v.node_id(), v.seq_number());
+    xSemaphoreGive(RELAY_MUTEX);
+
+    // Authentic: decode once for the checks and tables that keep it
+    NeighbourState rx;
+    v.decode(&rx);
+
+    // Security Logic (Rate Limit / Physics)
+    bool newest;
+    if (!security_validate_packet(&rx, &newest)) {
+        return;
+    }
+
+    // Valid
+    xSemaphoreTake(RELAY_MUTEX, portMAX_DELAY);
+    relay_consider(&s_relay, f->data, (uint8_t)hops,
+                   f->snr_db - link_adapt_snr_floor_db(f->sf), f->rx_ms);
+    xSemaphoreGive(RELAY_MUTEX);
+
+#if LINK_ADAPT_ENABLED
+    // RSSI / SNR are of the last hop: only direct packets describe our link
+    if (hops == 0) {
+        xSemaphoreTake(LINK_MUTEX, portMAX_DELAY);
+        link_adapt_on_rx(&s_link, rx.node_id, f->rssi_dbm, f->snr_db,
+                         rx.link_cfg, f->rx_ms);
+        xSemaphoreGive(LINK_MUTEX);
+    }
+#endif
+    // A neighbour asking to be answered: radio_task schedules it
+    if (hops == 0 && (rx.link_cfg & LINK_CFG_JOIN)) {
+        s_join_requests = s_join_requests + 1;      // Single writer: this task
+    }
+
+    // Counted here, before coalescing / filtering, so neither shows as loss
+    monitor_report_packet(rx.seq_number, rx.node_id);
+
+    // Late copy of an older state: flocking only keeps the sender's newest
+    if (!newest) {
+        return;
+    }
+
+    // Too far away to matter for flocking: no ring copy, table slot or log
+    xSemaphoreTake(INTEREST_MUTEX, portMAX_DELAY);
+    bool wanted = interest_accept(&s_interest, &rx, f->rx_ms);
+    xSemaphoreGive(INTEREST_MUTEX);
+    if (!wanted) {
+        return;
+    }
+
+    log_radio_packet("RX", &rx);
+    neigh_ring_push(&rx);
+}
+
+static void rx_verify_task(void *arg)
+{
+    (void)arg;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int batch = 0;
+        RxFrame *f;
+        while ((f = rx_ring_peek()) != nullptr) {
+            int64_t t0 = esp_timer_get_time();
+            verify_frame(f);
+            security_record_stage(SEC_STAGE_FRAME, (uint32_t)(esp_timer_get_time() - t0));
+            rx_ring_release();
+
+            // Let equal-priority tasks in between batches under a flood
+            if (++batch >= RX_VERIFY_BATCH) {
+                batch = 0;
+                taskYIELD();
+            }
+        }
+    }
+}
+
+extern "C" void radio_get_relay_stats(RelayStats *out)
+{
+    xSemaphoreTake(RELAY_MUTEX, portMAX_DELAY);
+    *out = s_relay.stats;
+    xSemaphoreGive(RELAY_MUTEX);
+}
+
+extern "C" void radio_get_congestion_stats(CongestionStats *out)
+{
+    *out = s_congestion.stats;
+}
+
+extern "C" void radio_get_interest_stats(InterestStats *out)
+{
+    xSemaphoreTake(INTEREST_MUTEX, portMAX_DELAY);
+    *out = s_interest.stats;
+    xSemaphoreGive(INTEREST_MUTEX);
+}
+
+extern "C" void radio_get_join_stats(JoinStats *out)
+{
+    *out = s_join.stats;
+}
+
+extern "C" void radio_get_csma_stats(CsmaStats *out)
+{
+    *out = s_radio.csma.stats;
+}
+
+extern "C" void radio_get_fsm_stats(RadioFsmStats *out)
+{
+    *out = s_radio.stats;
+}
+
 extern "C" void init_radio(void)
 {
-    RX_SEM = xSemaphoreCreateBinary();
-    if (!RX_SEM) vTaskDelay(portMAX_DELAY);
+    LINK_MUTEX = xSemaphoreCreateMutex();
+    if (!LINK_MUTEX) vTaskDelay(portMAX_DELAY);
+
+    RELAY_MUTEX = xSemaphoreCreateMutex();
+    if (!RELAY_MUTEX) vTaskDelay(portMAX_DELAY);
+
+    INTEREST_MUTEX = xSemaphoreCreateMutex();
+    if (!INTEREST_MUTEX) vTaskDelay(portMAX_DELAY);
 
+    rx_ring_init();
+    duty_cycle_init(pdTICKS_TO_MS(xTaskGetTickCount()));
+
+    // begin(freq, bw, sf, cr, syncWord, power, preambleLength): CRC is set separately
     int16_t state = lora.begin(LORA_FREQ_MHZ, LORA_BW_KHZ, LORA_SF, LORA_CR,
-                               LORA_SYNCWORD, LORA_PREAMBLE, LORA_POWER_DBM, LORA_CRC_ON);
+                               LORA_SYNCWORD, LORA_POWER_DBM, LORA_PREAMBLE);
     
     if (state != RADIOLIB_ERR_NONE) {
         fast_log("RADIO (F): Init failed %d", state);
         vTaskDelay(portMAX_DELAY);
     }
 
-    lora.setOutputPower(LORA_POWER_DBM);
-    lora.setDio0Action(give_rx_semaphore, RISING);
+    lora.setCRC(LORA_CRC_ON);
+    lora.setDio0Action(radio_dio0_isr, RISING);
+
+    LinkAdaptConfig link_cfg;
+    link_adapt_default_config(&link_cfg, LORA_SF, LORA_POWER_DBM);
+    link_adapt_init(&s_link, &link_cfg, pdTICKS_TO_MS(xTaskGetTickCount()));
+
+    InterestConfig interest_cfg;
+    interest_default_config(&interest_cfg);
+    interest_init(&s_interest, &interest_cfg);
+
+    // Relay delays must differ between nodes: seed from our MAC
+    const uint8_t *mac = get_mac_address();
+    RelayConfig relay_cfg;
+    relay_default_config(&relay_cfg);
+    relay_init(&s_relay, &relay_cfg,
+               (uint32_t)mac[2] << 24 | (uint32_t)mac[3] << 16 |
+               (uint32_t)mac[4] << 8 | mac[5]);
+
+    // Backoff draws must differ too
+    RadioFsmConfig fsm_cfg;
+    radio_fsm_default_config(&fsm_cfg);
+    radio_fsm_init(&s_radio, &fsm_cfg, &RADIO_OPS, nullptr,
+                   (uint32_t)mac[0] << 24 | (uint32_t)mac[1] << 16 |
+                   (uint32_t)mac[4] << 8 | mac[5]);
+
+    xTaskCreate(rx_verify_task, RX_VERIFY_TASK_NAME, RX_VERIFY_MEM,
+                nullptr, RX_VERIFY_PRIORITY, &s_verify_task);
 
     xTaskCreate(radio_task, RADIO_COMBINED_TASK_NAME, RADIO_COMBINED_MEM,
-                nullptr, RADIO_COMBINED_PRIORITY, nullptr);
+                nullptr, RADIO_COMBINED_PRIORITY, &s_radio_task);
 }
\ No newline at end of file
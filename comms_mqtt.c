@@ -2,6 +2,8 @@
 
 #include "tasks.h"
 #include "config.h"
+#include "telemetry.h"
+#include "telem_ring.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -10,6 +12,15 @@
 #include <stdio.h>
 #include <string.h>
 
+#if TELEM_SAMPLE_HZ > 0
+#if TELEM_BATCH_SAMPLES < 1 || TELEM_BATCH_SAMPLES > TELEM_BATCH_MAX_SAMPLES
+#error TELEM_BATCH_PERIOD_MS must hold 1..TELEM_BATCH_MAX_SAMPLES samples
+#endif
+#if TELEM_RING_LENGTH < TELEM_BATCH_SAMPLES
+#error TELEM_RING_LENGTH must hold a whole batch
+#endif
+#endif
+
 static esp_mqtt_client_handle_t s_client = NULL;
 static bool s_connected = false;
 
@@ -60,69 +71,89 @@ static void mqtt_event_handler(void* handler_args,
 }
 
 // -----------------------------------------------------------------------------
-// JSON telemetry builder (same as before)
+// Telemetry topics
 // -----------------------------------------------------------------------------
 
+typedef struct {
+    const char   *topic;
+    TelemEncoding enc;
+} TelemTopic;
+
+static const TelemTopic s_topics[] = {
+    { MQTT_TELEM_JSON_TOPIC, TELEM_JSON },
+    { MQTT_TELEM_BIN_TOPIC,  TELEM_BINARY },
+};
+
 // -----------------------------------------------------------------------------
-// JSON telemetry builder
+// Publishing
 // -----------------------------------------------------------------------------
 
-static void make_json(DroneState *s, char *buf, size_t buf_size)
+// One message per telemetry topic: the sample p, or with batch the n
+// samples p[0..n) (already signed)
+static void publish_telemetry(const NeighbourState *p, size_t n, bool batch,
+                              uint8_t *buf, size_t size)
 {
-    static uint16_t seq = 0;
-
-    // Convert internal state to packed neighbour state
-    NeighbourState p = DroneState_to_NeighbourState(s, seq++);
-    
-    // Sign the packet to generate the HMAC (mac_tag)
-    sign_packet(&p);
-
-    // Create the hex string for the mac_tag (4 bytes -> 8 hex chars)
-    char mac_str[9];
-    snprintf(mac_str, sizeof(mac_str), "%02X%02X%02X%02X",
-             p.mac_tag[0], p.mac_tag[1], p.mac_tag[2], p.mac_tag[3]);
-
-    // Build the JSON string
-    // Note: Coordinates and velocities are cast to (int) and use %d 
-    // to correctly display negative values.
-    snprintf(buf, buf_size,
-             "{"
-             "\"version\":%u,"
-             "\"team_id\":%u,"
-             "\"node_id\":\"%02X%02X%02X%02X%02X%02X\","
-             "\"seq_number\":%u,"
-             "\"ts_s\":%lu,"
-             "\"ts_ms\":%u,"
-             "\"x_mm\":%d,"
-             "\"y_mm\":%d,"
-             "\"z_mm\":%d,"
-             "\"vx_mm_s\":%d,"
-             "\"vy_mm_s\":%d,"
-             "\"vz_mm_s\":%d,"
-             "\"yaw_cd\":%u,"
-             "\"mac_tag\":\"%s\""
-             "}",
-             p.version,
-             p.team_id,
-             p.node_id[0], p.node_id[1], p.node_id[2],
-             p.node_id[3], p.node_id[4], p.node_id[5],
-             p.seq_number,
-             (unsigned long)p.ts_s,
-             p.ts_ms,
-             (int)p.x_mm,      // Signed
-             (int)p.y_mm,      // Signed
-             (int)p.z_mm,      // Signed
-             (int)p.vx_mm_s,   // Signed
-             (int)p.vy_mm_s,   // Signed
-             (int)p.vz_mm_s,   // Signed
-             (unsigned)p.yaw_cd,
-             mac_str);
+    for (size_t t = 0; t < sizeof(s_topics) / sizeof(s_topics[0]); ++t) {
+        if (s_topics[t].topic[0] == '\0') continue;
+
+        size_t len = batch ? telem_encode_batch(s_topics[t].enc, p, n, buf, size)
+                           : telem_encode(s_topics[t].enc, p, buf, size);
+        if (len == 0) {
+            continue;       // Can't happen with these buffers; 0 would mean strlen()
+        }
+
+        int msg_id = esp_mqtt_client_publish(
+            s_client, s_topics[t].topic, (const char *)buf, (int)len, 1, 0);
+
+        if (msg_id == -1) {
+            fast_log("MQTT (E): publish to %s failed", s_topics[t].topic);
+        // } else {
+        //     fast_log("MQTT (I): published telemetry (msg_id=%d)", msg_id);
+        }
+    }
 }
 
 // -----------------------------------------------------------------------------
-// Telemetry task (publishes to MQTT_TOPIC)
+// Telemetry task (publishes to every telemetry topic)
 // -----------------------------------------------------------------------------
 
+#if TELEM_SAMPLE_HZ > 0
+
+// Static: a JSON batch is several kB, more than the task stack
+static NeighbourState s_batch[TELEM_BATCH_SAMPLES];
+static uint8_t        s_batch_buf[TELEM_BATCH_BUF_SIZE(TELEM_BATCH_SAMPLES)];
+
+static void mqtt_task(void *arg)
+{
+    (void)arg;
+
+    TickType_t period = pdMS_TO_TICKS(TELEM_BATCH_PERIOD_MS);
+    TickType_t next   = xTaskGetTickCount();
+
+    uint16_t seq = 0;
+
+    while (true) {
+        vTaskDelayUntil(&next, period);
+
+        // Everything physics captured since the last batch. More than one
+        // batch waiting (a slow publish) goes out as several messages now.
+        size_t n;
+        while ((n = telem_ring_drain(s_batch, TELEM_BATCH_SAMPLES)) > 0) {
+            if (!s_connected) {
+                continue;   // Discarded: start fresh on reconnect
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                s_batch[i].seq_number = seq++;
+                sign_packet(&s_batch[i]);
+            }
+            publish_telemetry(s_batch, n, true, s_batch_buf, sizeof(s_batch_buf));
+        }
+    }
+}
+
+#else
+
 static void mqtt_task(void *arg)
 {
     (void)arg;
@@ -133,6 +164,7 @@ static void mqtt_task(void *arg)
     TickType_t next   = xTaskGetTickCount();
 
     DroneState s;
+    uint16_t seq = 0;
 
     while (true) {
         vTaskDelayUntil(&next, period);
@@ -142,21 +174,19 @@ static void mqtt_task(void *arg)
         }
 
         if (xQueueReceive(telem_q, &s, 0) == pdTRUE) {
-            char buf[MAX_JSON_STRING_LENGTH];
-            make_json(&s, buf, sizeof(buf));
-
-            int msg_id = esp_mqtt_client_publish(
-                s_client, MQTT_TOPIC, buf, 0, 1, 0);
+            // Convert internal state to packed neighbour state, signed once
+            // for every topic (same seq_number / mac_tag in each encoding)
+            NeighbourState p = DroneState_to_NeighbourState(&s, seq++);
+            sign_packet(&p);
 
-            if (msg_id == -1) {
-                fast_log("MQTT (E): publish failed");
-            // } else {
-            //     fast_log("MQTT (I): published telemetry (msg_id=%d)", msg_id);
-            }
+            uint8_t buf[MAX_JSON_STRING_LENGTH];
+            publish_telemetry(&p, 1, false, buf, sizeof(buf));
         }
     }
 }
 
+#endif
+
 // -----------------------------------------------------------------------------
 // Init
 // -----------------------------------------------------------------------------
@@ -27,6 +27,14 @@
 #define BROKER_URI              "mqtt://broker.hivemq.com:1883"
 #define MQTT_TOPIC              "flocksim"
 
+// Telemetry topics, one encoding each (telemetry.h); "" turns one off.
+// JSON (~220 B) for dashboards, binary (49 B: the signed radio frame) for
+// ingest. Each topic on costs one QoS 1 publish per sample, so only JSON is
+// on by default. For binary only, set MQTT_TELEM_BIN_TOPIC to e.g.
+// MQTT_TOPIC "/bin" and MQTT_TELEM_JSON_TOPIC to "".
+#define MQTT_TELEM_JSON_TOPIC   MQTT_TOPIC
+#define MQTT_TELEM_BIN_TOPIC    ""
+
 // Aliases for compatibility with comms_mqtt.c
 #define MQTT_BROKER_URI         BROKER_URI
 
@@ -34,7 +42,9 @@
 //  3. SIMULATION & WORLD BOUNDS
 // =============================================================================
 
-#define VERSION                 1
+// 2: link_cfg added (48-byte frame, CMAC over 44 bytes); version 1 peers
+// are rejected by the version check instead of failing the CMAC
+#define VERSION                 2
 #define TEAM_ID                 1
 #define MAX_JSON_STRING_LENGTH  1024
 
@@ -70,7 +80,7 @@
 
 #define LOGGING_ENABLED                 1
 #define MAX_LOG_MSG_LEN                 120
-#define LOG_MESSAGE_QUEUE_LENGTH        32
+#define LOG_MESSAGE_QUEUE_LENGTH        48  // A monitoring report (35 lines) + headroom
 
 // =============================================================================
 //  6. TASK CONFIGURATION (Priorities, Stacks, Timing)
@@ -108,6 +118,144 @@
 #define RADIO_TX_FREQ_HZ          0.2
 #define RADIO_TX_PERIOD_MS        (1000 / RADIO_TX_FREQ_HZ)
 
+// Send-on-delta: transmit when neighbours' dead-reckoned estimate of us is off
+// by more than RADIO_TX_DELTA_MM. RADIO_TX_PERIOD_MS becomes the heartbeat.
+// Set to 0 to go back to the fixed RADIO_TX_PERIOD_MS schedule.
+#define RADIO_TX_ADAPTIVE         1
+#define RADIO_TX_MIN_PERIOD_MS    500                 // Rate cap (2Hz)
+#define RADIO_TX_MAX_PERIOD_MS    RADIO_TX_PERIOD_MS  // Heartbeat
+#define RADIO_TX_CHECK_PERIOD_MS  100                 // Re-evaluate every 100ms
+#define RADIO_TX_DELTA_MM         1000.0              // 1m dead-reckoning error
+#define RADIO_ECHO_GUARD_MS       50                  // RX right after our TX is our echo
+
+// Congestion control (congestion.c): every CONGESTION_WINDOW_MS each node
+// measures the channel busy fraction, the CRC failure ratio and the
+// number of senders. It then adapts its own TX interval by AIMD within
+// [CONGESTION_MIN_PERIOD_MS, CONGESTION_MAX_PERIOD_MS]. The interval becomes
+// the send-on-delta rate cap, and the heartbeat when it is longer than
+// RADIO_TX_MAX_PERIOD_MS. The upper bound keeps a few heartbeats inside
+// NEIGHBOUR_TIMEOUT_MS.
+#define CONGESTION_ENABLED        1
+#define CONGESTION_WINDOW_MS      2000
+#define CONGESTION_TARGET_UTIL    0.3f
+#define CONGESTION_MAX_FAIL_RATIO 0.2f
+#define CONGESTION_MIN_PERIOD_MS  RADIO_TX_MIN_PERIOD_MS
+#define CONGESTION_MAX_PERIOD_MS  (NEIGHBOUR_TIMEOUT_MS / 3)
+#define CONGESTION_AI_HZ          0.5f   // Per window, shared by all senders heard
+#define CONGESTION_MD_FACTOR      0.7f
+#define CONGESTION_SENDER_BITS    256    // Sender count bitmap, multiple of 32
+
+// Fast join (join.c): after boot a node sends JOIN_BEACONS own states,
+// JOIN_BEACON_GAP_MS +- JOIN_BEACON_JITTER_MS apart, flagged "please
+// announce". Neighbours that hear one answer with one own state, at most
+// once per JOIN_ANSWER_MIN_INTERVAL_MS, at a random delay within a window
+// of at least JOIN_ANSWER_WINDOW_MS, long enough that all answers together
+// keep the channel below JOIN_ANSWER_MAX_UTIL busy. Above that nobody
+// answers: the heartbeats already fill the channel.
+#define JOIN_ENABLED                1
+#define JOIN_BEACONS                3
+#define JOIN_BEACON_GAP_MS          400
+#define JOIN_BEACON_JITTER_MS       150
+#define JOIN_ANSWER_WINDOW_MS       2000
+#define JOIN_ANSWER_MAX_UTIL        CONGESTION_TARGET_UTIL
+#define JOIN_ANSWER_MIN_INTERVAL_MS RADIO_TX_PERIOD_MS
+
+// TX scheduler (tx_sched.c): own state > relayed > test injection. Items
+// past their deadline are discarded. Relayed / injected packets together get
+// at most TX_SCHED_BULK_SHARE_PCT of airtime: after each one the receiver
+// stays armed for the rest of its share (and never less than the gap).
+#define TX_SCHED_RELAY_DEPTH      8
+#define TX_SCHED_INJECT_DEPTH     8
+#define TX_SCHED_OWN_DEADLINE_MS    1000
+#define TX_SCHED_RELAY_DEADLINE_MS  2000
+#define TX_SCHED_INJECT_DEADLINE_MS 1000
+#define TX_SCHED_BULK_GAP_MS      50
+#define TX_SCHED_BULK_SHARE_PCT   25
+#define TX_SCHED_TX_GUARD_MS      500   // Re-arm if TxDone never arrives (+ airtime)
+
+// Listen before talk (csma.c): CAD before every TX; if the channel is busy,
+// back off 1..W ms with W = frame airtime doubling per busy CAD, capped at
+// CSMA_BACKOFF_MAX_MS. Own state is sent anyway after CSMA_MAX_ATTEMPTS busy
+// CADs or at its deadline; relayed / injected frames are dropped instead.
+#define CSMA_ENABLED              1
+#define CSMA_MAX_ATTEMPTS         5
+#define CSMA_BACKOFF_MAX_MS       RADIO_TX_MIN_PERIOD_MS
+#define CSMA_CAD_GUARD_MS         20    // Re-arm if CadDone never arrives (CAD ~1-10 ms)
+
+// Multi-hop relay (relay.c): verified states are re-broadcast up to
+// RELAY_MAX_HOPS hops from their origin. Only copies heard within
+// RELAY_MARGIN_MAX_DB of the SF floor (i.e. far from the sender) are relayed,
+// the weakest first, within RELAY_DELAY_MAX_MS; a relay is cancelled once
+// RELAY_SUPPRESS_COPIES copies were heard. Duplicates are dropped before CMAC
+// by a bloom filter on (node_id, seq): 2 x RELAY_DUP_FILTER_BITS bits,
+// rotated every RELAY_DUP_GEN_ENTRIES keys (<0.04% false positives).
+#define RELAY_ENABLED             1
+#define RELAY_MAX_HOPS            3
+#define RELAY_DELAY_MAX_MS        1000
+#define RELAY_SUPPRESS_COPIES     2
+#define RELAY_PROBABILITY         1.0f
+#define RELAY_MARGIN_MAX_DB       10.0f
+#define RELAY_PENDING_MAX         8
+#define RELAY_DUP_FILTER_BITS     8192  // Power of two, per generation
+#define RELAY_DUP_FILTER_HASHES   4
+#define RELAY_DUP_GEN_ENTRIES     256
+
+// Link adaptation (link_adapt.c): lowest SF/power that still reaches
+// LINK_TARGET_FRACTION of the neighbours we hear. LORA_SF / LORA_POWER_DBM
+// in comms_lora.cpp remain the boot and fallback settings.
+#define LINK_ADAPT_ENABLED        1
+#define LINK_SF_MIN               7
+#define LINK_SF_MAX               12
+#define LINK_POWER_MIN_DBM        2
+#define LINK_POWER_MAX_DBM        17
+#define LINK_TARGET_FRACTION      0.9f   // Fraction of neighbours we must reach
+#define LINK_MARGIN_DB            6.0f   // Fade margin above demod floor
+#define LINK_EMA_ALPHA            0.3f
+#define LINK_NOISE_FLOOR_DBM      -114.0f // -174 + 10log10(250kHz) + 6dB NF
+#define LINK_SNR_SATURATION_DB    5.0f
+#define LINK_PEER_TIMEOUT_MS      NEIGHBOUR_TIMEOUT_MS
+#define LINK_MAX_HOPS             8      // How far an SF need propagates
+#define LINK_SF_HOLD_MS           20000  // Agreement needed before stepping SF down
+#define LINK_ISOLATION_TIMEOUT_MS 30000  // Nothing heard -> hunt for the swarm SF
+#define LINK_HUNT_DWELL_MS        12000  // Listen this long per SF while hunting
+
+// Regulatory duty cycle (lora_airtime.c): 868.0-868.6 MHz allows 1% per hour.
+// When enabled, TX is deferred until the sliding window has room.
+#define DUTY_CYCLE_ENABLED        0
+#define DUTY_CYCLE_PERCENT        1.0
+#define DUTY_CYCLE_WINDOW_MS      3600000
+#define DUTY_CYCLE_BUCKETS        60     // 1 minute resolution
+
+// --- RX Verifier Task ---
+// Radio task only copies frames into the RX ring and re-arms; CMAC, security
+// checks and queueing run here, RX_VERIFY_BATCH frames between yields.
+#define RX_VERIFY_TASK_NAME       "rx_verify"
+#define RX_VERIFY_MEM             4096
+#define RX_VERIFY_PRIORITY        4
+#define RX_VERIFY_BATCH           4
+#define RX_RING_LENGTH            16     // Power of two
+
+// Verified neighbour updates (verifier -> flocking): latest state per node,
+// one slot per sender, so a chatty node can never push another one out.
+#define NEIGH_RING_SLOTS          64     // Power of two, >= MAX_NEIGHBOURS
+
+// Interest filter (interest.c): verified updates from nodes beyond
+// INTEREST_RADIUS_MM of our own position are not handed to flocking. The
+// radius adds what two nodes can close within the longest heartbeat (the
+// congestion-stretched one if that is longer), so a node is in the table
+// before it matters; it only counts as far again beyond
+// radius + INTEREST_HYSTERESIS_MM. INTEREST_FAR_PERIOD_MS > 0 lets one far
+// update per node through per period instead of none.
+#define INTEREST_FILTER_ENABLED   1
+#define INTEREST_HEARTBEAT_MS     ((CONGESTION_ENABLED && \
+                                    CONGESTION_MAX_PERIOD_MS > RADIO_TX_MAX_PERIOD_MS) \
+                                       ? CONGESTION_MAX_PERIOD_MS : RADIO_TX_MAX_PERIOD_MS)
+#define INTEREST_RADIUS_MM        (FLOCKING_NEIGHBOUR_RADIUS_MM + \
+                                   2.0 * MAX_SPEED_MM_S * INTEREST_HEARTBEAT_MS / 1000.0)
+#define INTEREST_HYSTERESIS_MM    10000.0
+#define INTEREST_FAR_PERIOD_MS    0
+#define INTEREST_PEERS            128    // Nodes tracked (near / far state)
+
 // --- MQTT Telemetry Task ---
 #define MQTT_TELEMETRY_TASK_NAME  "mqtt"
 #define MQTT_TELEMETRY_MEM        4096
@@ -120,12 +268,93 @@
 // Alias for comms_mqtt.c
 #define MQTT_TELEMETRY_PERIOD_MS  TELEMETRY_PERIOD_MS
 
+// Batched telemetry (telem_ring.h), optional: physics captures a sample
+// every 1/TELEM_SAMPLE_HZ into the telemetry ring, and every
+// TELEM_BATCH_PERIOD_MS mqtt_task publishes what was captured as one message
+// per topic. The topics then carry batches (a JSON array, binary schema
+// 0xB2) instead of single samples, so subscribers must expect them. Off
+// (0): one sample per MQTT_TELEMETRY_PERIOD_MS, as before.
+#define TELEM_SAMPLE_HZ           0      // Divides PHYSICS_FREQ_HZ, e.g. 25; 0 = off
+#define TELEM_BATCH_PERIOD_MS     1000
+#define TELEM_BATCH_SAMPLES       (TELEM_SAMPLE_HZ * TELEM_BATCH_PERIOD_MS / 1000)
+#define TELEM_RING_LENGTH         64     // Power of two, a couple of batches
+
 // =============================================================================
 //  7. SECURITY CONFIGURATION
 // =============================================================================
-#define DDOS_RATE_LIMIT_MS   1000
+// Rate limiting (token_bucket.c): every sender has a bucket of
+// SEC_NODE_BURST updates refilled at SEC_NODE_RATE_PER_S, a node's
+// send-on-delta cap, so short bursts pass. All senders together may start
+// at most SEC_VERIFY_PER_S CMAC verifications (burst SEC_VERIFY_BURST), which
+// bounds the verifier's CPU however many identities flood. The last
+// SEC_VERIFY_RESERVE tokens are kept for known senders with at least half
+// their own burst left, i.e. neighbours, not floods running at the cap.
+#define SEC_NODE_RATE_PER_S  (1000.0f / RADIO_TX_MIN_PERIOD_MS)
+#define SEC_NODE_BURST       3
+#define SEC_VERIFY_PER_S     40
+#define SEC_VERIFY_BURST     RX_RING_LENGTH
+#define SEC_VERIFY_RESERVE   12
 #define MAX_TRACKED_NODES    MAX_NEIGHBOURS
 
+// Replay checks: a sliding window of REPLAY_WINDOW (<= 64) sequence numbers
+// per sender (replay_win.c) accepts reordered frames once each. With both
+// clocks SNTP-synced (unix time past REPLAY_SYNCED_EPOCH_S) a timestamp must
+// be within REPLAY_FRESH_MS of ours; a frame ahead of the window may not be
+// older than the newest accepted by more than that either. A sender below
+// the window with a newer timestamp rebooted: the window restarts there.
+// Resync after a reboot needs SNTP: without synced clocks a recorded frame
+// looks just like a reboot, so frames below the window are refused and
+// counted (ReplayStats.unsynced). A sender that rebooted unsynced stays
+// refused until this node restarts too.
+#define REPLAY_WINDOW          64
+#define REPLAY_FRESH_MS        5000
+#define REPLAY_SYNCED_EPOCH_S  1704067200u   // 2024-01-01
+
+// Security table (sec_table.c): hash index over node_id, SEC_TABLE_BUCKETS
+// buckets (power of two, >= 2 x MAX_TRACKED_NODES). When full, a newcomer
+// replaces the sender seen longest ago among those with fewer than
+// SEC_TABLE_PROTECT_AFTER accepted updates; senders with that much history
+// only make room after SEC_TABLE_IDLE_MS of silence.
+#define SEC_TABLE_BUCKETS        128
+#define SEC_TABLE_PROTECT_AFTER  3
+#define SEC_TABLE_IDLE_MS        NEIGHBOUR_TIMEOUT_MS
+
+// CMAC (cmac.c) runs on a key expanded once at boot. init_security() times
+// SECURITY_CMAC_BOOT_ITERS MACs each way against mbedtls_cipher_cmac() and
+// logs the per-frame cost (0: skip the check).
+#define SECURITY_CMAC_BOOT_ITERS 64
+
+// Admission (admit.c), before the CMAC: frames with a foreign version /
+// team_id, from known senders with an empty bucket, from unknown
+// senders banned for ADMIT_BAN_MS after ADMIT_BAD_AFTER bad MACs, or from
+// unknown senders once ADMIT_UNKNOWN_FAILS of them failed the CMAC within
+// ADMIT_WINDOW_MS are dropped without crypto. ADMIT_BAD_SLOTS bad senders
+// are remembered.
+#define ADMIT_ENABLED            1
+#define ADMIT_BAD_SLOTS          16
+#define ADMIT_BAD_AFTER          3
+#define ADMIT_BAN_MS             30000
+#define ADMIT_UNKNOWN_FAILS      8
+#define ADMIT_WINDOW_MS          1000
+
+// Heavy hitters among unknown senders (rate_sketch.c): admission counts
+// their frames per claimed node_id in a RATE_SKETCH_DEPTH x
+// RATE_SKETCH_WIDTH count-min sketch of 16-bit counters (2 KB), decayed by
+// 1/8 every RATE_SKETCH_STEP_MS. Unknown senders estimated above
+// RATE_SKETCH_HEAVY_PER_S frames/s are dropped before the CMAC and never
+// get a security table entry (0: off). Keep it well above
+// SEC_NODE_RATE_PER_S plus its burst.
+#define RATE_SKETCH_DEPTH        4      // One 16-bit hash slice per row
+#define RATE_SKETCH_WIDTH        256    // Power of two
+#define RATE_SKETCH_STEP_MS      125
+#define RATE_SKETCH_HEAVY_PER_S  8
+
+// Security stats (sec_stats.c): rejections per reason, CPU time per stage
+// of the RX security path in SEC_STATS_BUCKETS log2 buckets (bucket b:
+// below 2 << b us), and the SEC_STATS_TOP node_ids rejected most.
+#define SEC_STATS_BUCKETS        16
+#define SEC_STATS_TOP            8
+
 // Physics tolerance: How much faster than MAX_SPEED can a node seemingly move 
 // before we call it fake? (Factors: latency, packet loss, small jumps)
 #define PHYSICS_SPEED_FACTOR 3.0 
@@ -148,5 +377,6 @@
 #define MONITOR_REPORT_PERIOD_MS 10000  // Print report every 10 seconds
 #define EST_CURRENT_BASE_MA      100   // ESP32 + WiFi (Active)
 #define EST_CURRENT_LORA_RX_MA   12    // SX1276 RX
+#define EST_CURRENT_LORA_IDLE_MA 2     // SX1276 standby
 
 #define EST_CURRENT_LORA_TX_MA   45    // SX1276 TX (14dBm)
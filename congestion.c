@@ -0,0 +1,131 @@
+// main/congestion.c
+#include "congestion.h"
+
+#include <math.h>
+#include <string.h>
+
+#define SEEN_BITS   CONGESTION_SENDER_BITS
+
+void congestion_default_config(CongestionConfig *cfg)
+{
+    cfg->target_util    = CONGESTION_TARGET_UTIL;
+    cfg->max_fail_ratio = CONGESTION_MAX_FAIL_RATIO;
+    cfg->window_ms      = CONGESTION_WINDOW_MS;
+    cfg->min_period_ms  = CONGESTION_MIN_PERIOD_MS;
+    cfg->max_period_ms  = CONGESTION_MAX_PERIOD_MS;
+    cfg->ai_hz          = CONGESTION_AI_HZ;
+    cfg->md_factor      = CONGESTION_MD_FACTOR;
+}
+
+static float clamp_rate(const Congestion *c, float rate_hz)
+{
+    float lo = 1000.0f / (float)c->cfg.max_period_ms;
+    float hi = 1000.0f / (float)c->cfg.min_period_ms;
+    if (rate_hz < lo) return lo;
+    if (rate_hz > hi) return hi;
+    return rate_hz;
+}
+
+static uint32_t rate_to_period(float rate_hz)
+{
+    return (uint32_t)lroundf(1000.0f / rate_hz);
+}
+
+void congestion_init(Congestion *c, const CongestionConfig *cfg, uint32_t now_ms)
+{
+    memset(c, 0, sizeof(*c));
+    c->cfg = *cfg;
+    c->rate_hz = clamp_rate(c, 1000.0f / (float)cfg->min_period_ms);
+    c->window_start_ms = now_ms;
+    c->stats.period_ms = rate_to_period(c->rate_hz);
+}
+
+void congestion_on_rx(Congestion *c, const uint8_t node_id[6], uint32_t airtime_us)
+{
+    c->busy_us += airtime_us;
+    c->rx_ok++;
+
+    if (node_id) {
+        // FNV-1a over the MAC, one bit per sender
+        uint32_t h = 2166136261u;
+        for (int i = 0; i < 6; ++i) {
+            h ^= node_id[i];
+            h *= 16777619u;
+        }
+        uint32_t bit = h % SEEN_BITS;
+        c->seen[bit / 32] |= 1u << (bit % 32);
+    }
+}
+
+void congestion_on_rx_error(Congestion *c, uint32_t airtime_us)
+{
+    c->busy_us += airtime_us;
+    c->rx_fail++;
+}
+
+void congestion_on_rejected(Congestion *c, uint32_t count)
+{
+    // Already counted as intact frames by congestion_on_rx(); their airtime
+    // stays in busy_us
+    if (count > c->rx_ok) count = c->rx_ok;
+    c->rx_ok -= count;
+}
+
+void congestion_on_tx(Congestion *c, uint32_t airtime_us)
+{
+    c->busy_us += airtime_us;
+}
+
+// Linear counting: n = -m ln(empty / m)
+static uint16_t estimate_senders(const Congestion *c)
+{
+    uint32_t set = 0;
+    for (int i = 0; i < SEEN_BITS / 32; ++i) {
+        set += (uint32_t)__builtin_popcount(c->seen[i]);
+    }
+    if (set == 0) return 0;
+    if (set >= SEEN_BITS) set = SEEN_BITS - 1;
+
+    float m = (float)SEEN_BITS;
+    return (uint16_t)lroundf(-m * logf((m - (float)set) / m));
+}
+
+bool congestion_update(Congestion *c, uint32_t now_ms)
+{
+    uint32_t elapsed = now_ms - c->window_start_ms;
+    if (elapsed < c->cfg.window_ms) return false;
+
+    float util = (float)c->busy_us / ((float)elapsed * 1000.0f);
+    uint32_t frames = c->rx_ok + c->rx_fail;
+    float fail = frames ? (float)c->rx_fail / (float)frames : 0.0f;
+    uint16_t senders = estimate_senders(c);
+
+    uint32_t old_period = rate_to_period(c->rate_hz);
+    bool congested = util > c->cfg.target_util ||
+                     (frames >= 4 && fail > c->cfg.max_fail_ratio);
+    if (congested) {
+        c->rate_hz *= c->cfg.md_factor;
+        c->stats.congested++;
+    } else {
+        c->rate_hz += c->cfg.ai_hz / (float)(senders + 1);
+    }
+    c->rate_hz = clamp_rate(c, c->rate_hz);
+
+    c->stats.windows++;
+    c->stats.util       = util;
+    c->stats.fail_ratio = fail;
+    c->stats.senders    = senders;
+    c->stats.period_ms  = rate_to_period(c->rate_hz);
+
+    c->window_start_ms = now_ms;
+    c->busy_us = 0;
+    c->rx_ok = c->rx_fail = 0;
+    memset(c->seen, 0, sizeof(c->seen));
+
+    return c->stats.period_ms != old_period;
+}
+
+uint32_t congestion_period_ms(const Congestion *c)
+{
+    return c->stats.period_ms;
+}
@@ -0,0 +1,94 @@
+// main/congestion.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Distributed congestion control for our own state broadcasts. A fixed
+// rate wastes the channel when the swarm is sparse and collapses it when it
+// is dense, so every node sets its TX interval from what it hears.
+//
+// Per window of window_ms we add up:
+//   - channel busy time: airtime of frames received, frames lost to CRC
+//     errors and our own frames
+//   - failures: CRC errors over all frames. Frames that arrived intact but
+//     were dropped by admission or the CMAC still count as busy time, but
+//     not in the ratio: a forger is not a lossy channel.
+//   - distinct senders, by linear counting on a small bitmap of node id
+//     hashes
+// At the end of the window the broadcast rate follows AIMD. If busy time
+// exceeds target_util, or failures exceed max_fail_ratio, the rate is
+// multiplied by md_factor. Otherwise it grows by ai_hz / (senders + 1), so
+// the whole neighbourhood together adds about ai_hz per window however many
+// nodes share it. The interval stays within [min_period_ms, max_period_ms].
+// Everyone in range sees roughly the same channel, so the AIMD rates
+// converge to a fair share.
+//
+// Pure logic, no FreeRTOS: times are plain milliseconds.
+
+typedef struct {
+    float    target_util;       // Busy fraction we aim below
+    float    max_fail_ratio;    // Failed / all frames above this = congested
+    uint32_t window_ms;
+    uint32_t min_period_ms;     // Fastest own broadcast
+    uint32_t max_period_ms;     // Slowest (heartbeat stretched this far)
+    float    ai_hz;             // Neighbourhood-wide additive increase per window
+    float    md_factor;         // Rate multiplier when congested
+} CongestionConfig;
+
+typedef struct {
+    uint32_t windows;
+    uint32_t congested;         // Windows that cut the rate
+    uint32_t period_ms;         // Current own TX interval
+    float    util;              // Last window: busy fraction
+    float    fail_ratio;        // Last window
+    uint16_t senders;           // Last window: distinct senders heard
+} CongestionStats;
+
+typedef struct {
+    CongestionConfig cfg;
+    float    rate_hz;
+    uint32_t window_start_ms;
+    uint64_t busy_us;
+    uint32_t rx_ok;
+    uint32_t rx_fail;
+    uint32_t seen[CONGESTION_SENDER_BITS / 32];
+    CongestionStats stats;
+} Congestion;
+
+// Defaults from config.h
+void congestion_default_config(CongestionConfig *cfg);
+
+// Starts at the rate cap (1 / min_period_ms), the rate send-on-delta runs at
+// before the first window is measured
+void congestion_init(Congestion *c, const CongestionConfig *cfg, uint32_t now_ms);
+
+// Frame received intact. node_id may be NULL for foreign traffic.
+void congestion_on_rx(Congestion *c, const uint8_t node_id[6], uint32_t airtime_us);
+
+// Frame lost to a CRC error (airtime of a typical frame)
+void congestion_on_rx_error(Congestion *c, uint32_t airtime_us);
+
+// Frames that arrived intact but were rejected by admission or the CMAC
+void congestion_on_rejected(Congestion *c, uint32_t count);
+
+void congestion_on_tx(Congestion *c, uint32_t airtime_us);
+
+// Close the window if it is over. TRUE if the TX interval changed.
+bool congestion_update(Congestion *c, uint32_t now_ms);
+
+// Current own TX interval
+uint32_t congestion_period_ms(const Congestion *c);
+
+// Stats of the radio's instance (comms_lora.cpp), for monitoring
+void radio_get_congestion_stats(CongestionStats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,53 @@
+// main/csma.c
+#include "csma.h"
+#include "config.h"
+
+#include <string.h>
+
+static uint32_t rng_next(Csma *c)
+{
+    c->rng ^= c->rng << 13;
+    c->rng ^= c->rng >> 17;
+    c->rng ^= c->rng << 5;
+    return c->rng;
+}
+
+void csma_init(Csma *c, uint32_t seed)
+{
+    memset(c, 0, sizeof(*c));
+    c->rng = seed ? seed : 0x6D2B79F5u;
+}
+
+CsmaAction csma_on_cad(Csma *c, bool busy, uint32_t frame_ms,
+                       uint32_t now_ms, uint32_t deadline_ms, bool must_send,
+                       uint32_t *backoff_ms)
+{
+    c->stats.cad++;
+
+    if (!busy) {
+        c->attempt = 0;
+        return CSMA_SEND;
+    }
+    c->stats.busy++;
+
+    // Binary exponential window, one frame airtime per slot
+    uint32_t window = (frame_ms > 0 ? frame_ms : 1) << (c->attempt < 16 ? c->attempt : 16);
+    if (window > CSMA_BACKOFF_MAX_MS) window = CSMA_BACKOFF_MAX_MS;
+    uint32_t wait = 1 + rng_next(c) % window;
+
+    bool late = (int32_t)(deadline_ms - (now_ms + wait)) < 0;
+    if (++c->attempt > CSMA_MAX_ATTEMPTS || late) {
+        c->attempt = 0;
+        if (must_send) {
+            c->stats.forced++;
+            return CSMA_SEND;
+        }
+        c->stats.dropped++;
+        return CSMA_DROP;
+    }
+
+    c->stats.backoffs++;
+    c->stats.backoff_ms += wait;
+    *backoff_ms = wait;
+    return CSMA_BACKOFF;
+}
@@ -0,0 +1,56 @@
+// main/csma.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Listen-before-talk for radio_task: before each TX the SX1276 runs channel
+// activity detection (CAD). If it sees LoRa on our SF, we re-arm RX and back
+// off for a random time, drawn from a window that doubles per busy CAD
+// (starting at one frame airtime, capped at CSMA_BACKOFF_MAX_MS), then CAD
+// again. After CSMA_MAX_ATTEMPTS busy CADs, or once the next backoff would
+// run past the frame's deadline, the frame goes out anyway (own state) or is
+// dropped (relay / injection), so backoff never holds a frame longer than
+// the TX period it belongs to.
+//
+// Pure logic, no FreeRTOS / RadioLib: times are plain milliseconds.
+
+typedef enum {
+    CSMA_SEND = 0,      // Transmit now
+    CSMA_BACKOFF,       // *backoff_ms set: wait, then CAD again
+    CSMA_DROP           // Give up on this frame
+} CsmaAction;
+
+typedef struct {
+    uint32_t cad;
+    uint32_t busy;
+    uint32_t backoffs;
+    uint32_t forced;        // Sent although the channel still looked busy
+    uint32_t dropped;
+    uint32_t backoff_ms;    // Total time spent backing off
+} CsmaStats;
+
+typedef struct {
+    uint8_t   attempt;      // Busy CADs for the current frame
+    uint32_t  rng;
+    CsmaStats stats;
+} Csma;
+
+void csma_init(Csma *c, uint32_t seed);
+
+// CAD result for the frame at hand. frame_ms is its airtime (backoff slot),
+// deadline_ms when it stops being useful; must_send for our own state.
+CsmaAction csma_on_cad(Csma *c, bool busy, uint32_t frame_ms,
+                       uint32_t now_ms, uint32_t deadline_ms, bool must_send,
+                       uint32_t *backoff_ms);
+
+// Stats of the radio's CSMA instance (comms_lora.cpp), for monitoring
+void radio_get_csma_stats(CsmaStats *out);
+
+#ifdef __cplusplus
+}
+#endif
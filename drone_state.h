@@ -50,6 +50,8 @@ typedef struct __attribute__((packed)) {
 
     uint16_t yaw_cd;
 
+    uint16_t link_cfg;      // Swarm SF need / TX power / join, see link_adapt.h
+
     uint8_t  mac_tag[4];
 } NeighbourState;
 
@@ -2,6 +2,7 @@
 #include "tasks.h"
 #include "config.h"
 #include "monitoring.h" // <--- Added
+#include "neigh_ring.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -12,6 +13,7 @@
 typedef struct {
     bool          is_valid;
     uint32_t      last_updated_s;
+    uint64_t      last_updated_ms;  // Receipt time, used for dead reckoning
     NeighbourState neighbour_state;
 } NeighbourEntry;
 
@@ -74,9 +76,6 @@ static void update_neighbour_table(const NeighbourState *n)
         return;
     }
 
-    // --- MONITORING: Report Packet ---
-    monitor_report_packet(n->seq_number, (uint8_t*)n->node_id);
-
     // --- SECURITY NOTE ---
     // Security checks are handled in Radio Task (comms_lora.cpp)
     // before the packet reaches this queue.
@@ -90,10 +89,12 @@ static void update_neighbour_table(const NeighbourState *n)
             memcmp(NEIGHBOUR_TABLE[i].neighbour_state.node_id,
                    n->node_id, sizeof(n->node_id)) == 0) {
 
-            if (n->seq_number > NEIGHBOUR_TABLE[i].neighbour_state.seq_number) {
-                NEIGHBOUR_TABLE[i].neighbour_state = *n;
-                NEIGHBOUR_TABLE[i].last_updated_s  = now_s;
-            }
+            // Only the sender's newest state gets here: security.c orders
+            // them by timestamp, and by the replay window's resync after a
+            // reboot, when seq_number and (without SNTP) the time restart
+            NEIGHBOUR_TABLE[i].neighbour_state = *n;
+            NEIGHBOUR_TABLE[i].last_updated_s  = now_s;
+            NEIGHBOUR_TABLE[i].last_updated_ms = (uint64_t)now_s * 1000ULL + now_ms;
             return;
         }
         if (!NEIGHBOUR_TABLE[i].is_valid && first_empty < 0)
@@ -103,9 +104,30 @@ static void update_neighbour_table(const NeighbourState *n)
     int idx = (first_empty >= 0) ? first_empty : 0;
     NEIGHBOUR_TABLE[idx].is_valid = true;
     NEIGHBOUR_TABLE[idx].last_updated_s = now_s;
+    NEIGHBOUR_TABLE[idx].last_updated_ms = (uint64_t)now_s * 1000ULL + now_ms;
     NEIGHBOUR_TABLE[idx].neighbour_state = *n;
 }
 
+// -----------------------------------------------------------------------------
+// Helper: Dead-reckon a neighbour forward from its last packet.
+// Senders use send-on-delta (tx_policy.c) and stay quiet while this estimate
+// is good, so we must extrapolate rather than use the raw position.
+// -----------------------------------------------------------------------------
+static void extrapolate_neighbour(const NeighbourEntry *e, uint64_t now_ms,
+                                  double *x, double *y, double *z)
+{
+    const NeighbourState *n = &e->neighbour_state;
+
+    double age_s = 0.0;
+    if (now_ms > e->last_updated_ms) {
+        age_s = (double)(now_ms - e->last_updated_ms) / 1000.0;
+    }
+
+    *x = (double)n->x_mm + n->vx_mm_s * age_s;
+    *y = (double)n->y_mm + n->vy_mm_s * age_s;
+    *z = (double)n->z_mm + n->vz_mm_s * age_s;
+}
+
 static ControlInput compute_control(const DroneState *self)
 {
     ControlInput u = {
@@ -121,13 +143,21 @@ static ControlInput compute_control(const DroneState *self)
 
     int count = 0;
 
+    uint32_t now_s; uint16_t now_ms;
+    get_current_unix_time(&now_s, &now_ms);
+    uint64_t now_total_ms = (uint64_t)now_s * 1000ULL + now_ms;
+
     for (int i = 0; i < MAX_NEIGHBOURS; ++i) {
         if (!NEIGHBOUR_TABLE[i].is_valid) continue;
         const NeighbourState *n = &NEIGHBOUR_TABLE[i].neighbour_state;
 
-        double dx = (double)n->x_mm - self->x_mm;
-        double dy = (double)n->y_mm - self->y_mm;
-        double dz = (double)n->z_mm - self->z_mm;
+        double nx_mm, ny_mm, nz_mm;
+        extrapolate_neighbour(&NEIGHBOUR_TABLE[i], now_total_ms,
+                              &nx_mm, &ny_mm, &nz_mm);
+
+        double dx = nx_mm - self->x_mm;
+        double dy = ny_mm - self->y_mm;
+        double dz = nz_mm - self->z_mm;
 
         double dist2 = dx*dx + dy*dy + dz*dz;
         if (dist2 > FLOCKING_NEIGHBOUR_RADIUS_MM * FLOCKING_NEIGHBOUR_RADIUS_MM)
@@ -156,9 +186,9 @@ static ControlInput compute_control(const DroneState *self)
         ali_vz += n->vz_mm_s;
 
         // Cohesion
-        coh_x += n->x_mm;
-        coh_y += n->y_mm;
-        coh_z += n->z_mm;
+        coh_x += nx_mm;
+        coh_y += ny_mm;
+        coh_z += nz_mm;
     }
 
     if (count > 0) {
@@ -224,7 +254,6 @@ static void flocking_task(void *arg)
 {
     (void)arg;
 
-    QueueHandle_t neigh_q  = get_neighbour_update_queue();
     QueueHandle_t state_q  = get_flocking_state_queue();
     QueueHandle_t control_q = get_control_input_queue();
 
@@ -247,7 +276,7 @@ static void flocking_task(void *arg)
 
         // 1. Ingest updates (WITHOUT individual logging)
         NeighbourState n;
-        while (xQueueReceive(neigh_q, &n, 0) == pdTRUE) {
+        while (neigh_ring_pop(&n)) {
             update_neighbour_table(&n);
         }
 
@@ -1,6 +1,8 @@
 // main/globals.c
 #include "tasks.h"
 #include "config.h"
+#include "neigh_ring.h"
+#include "telem_ring.h"
 
 #include "esp_mac.h"
 #include "freertos/FreeRTOS.h"
@@ -13,21 +15,18 @@ static char    MAC_ADDRESS_STRING[18];
 
 // Queues
 #define CONTROL_INPUT_QUEUE_LENGTH   1
-#define NEIGHBOUR_UPDATE_QUEUE_LENGTH  8
 #define FLOCKING_STATE_QUEUE_LENGTH  1
 #define RADIO_STATE_QUEUE_LENGTH     1
 #define TELEMETRY_STATE_QUEUE_LENGTH 1
 
 static QueueHandle_t ATTACK_QUEUE = NULL;
 static QueueHandle_t CONTROL_INPUT_QUEUE      = NULL;
-static QueueHandle_t NEIGHBOUR_UPDATE_QUEUE   = NULL;
 static QueueHandle_t FLOCKING_STATE_QUEUE     = NULL;
 static QueueHandle_t RADIO_STATE_QUEUE        = NULL;
 static QueueHandle_t TELEMETRY_STATE_QUEUE    = NULL;
 
 QueueHandle_t get_attack_queue(void) { return ATTACK_QUEUE; }
 QueueHandle_t get_control_input_queue(void)   { return CONTROL_INPUT_QUEUE; }
-QueueHandle_t get_neighbour_update_queue(void){ return NEIGHBOUR_UPDATE_QUEUE; }
 QueueHandle_t get_flocking_state_queue(void)  { return FLOCKING_STATE_QUEUE; }
 QueueHandle_t get_radio_state_queue(void)     { return RADIO_STATE_QUEUE; }
 QueueHandle_t get_telemetry_state_queue(void) { return TELEMETRY_STATE_QUEUE; }
@@ -58,18 +57,21 @@ void init_globals(void)
     // Queues
     CONTROL_INPUT_QUEUE = xQueueCreate(CONTROL_INPUT_QUEUE_LENGTH,
                                        sizeof(ControlInput));
-    NEIGHBOUR_UPDATE_QUEUE = xQueueCreate(NEIGHBOUR_UPDATE_QUEUE_LENGTH,
-                                          sizeof(NeighbourState));
     FLOCKING_STATE_QUEUE = xQueueCreate(FLOCKING_STATE_QUEUE_LENGTH,
                                         sizeof(DroneState));
     RADIO_STATE_QUEUE = xQueueCreate(RADIO_STATE_QUEUE_LENGTH,
                                      sizeof(DroneState));
     TELEMETRY_STATE_QUEUE = xQueueCreate(TELEMETRY_STATE_QUEUE_LENGTH,
                                          sizeof(DroneState));
+    // Neighbour updates: per-node latest-state ring, see neigh_ring.h
+    neigh_ring_init();
+    // Telemetry samples (physics -> MQTT), see telem_ring.h
+    telem_ring_init();
+
     // Create Attack Queue (Length 10 to buffer floods)
     ATTACK_QUEUE = xQueueCreate(10, sizeof(NeighbourState));
 
-    if (!CONTROL_INPUT_QUEUE || !NEIGHBOUR_UPDATE_QUEUE ||
+    if (!CONTROL_INPUT_QUEUE ||
         !FLOCKING_STATE_QUEUE || !RADIO_STATE_QUEUE ||
         !TELEMETRY_STATE_QUEUE) {
         fast_log("GLOBALS (F): failed to create queues");
@@ -0,0 +1,323 @@
+// host/admit_bench.c
+// CPU per rejected frame on the RX verifier, with and without the admission
+// stage (admit.c) in front of the CMAC.
+//
+// Each scenario is a SIM_DURATION_S trace: SIM_LEGIT neighbours sending one
+// signed frame every SIM_LEGIT_PERIOD_MS (+-10%), plus an attacker:
+//   - attacker.c:   the firmware's own attack cycle. FLOOD: 1000 signed
+//                   frames at 50 Hz from one MAC; REPLAY: 5 signed frames
+//                   10 s old, 1 s apart; SPOOF: 5 bad-MAC frames from
+//                   DE:AD:BE:EF:00:01, 1 s apart
+//   - spoof flood:  bad-MAC frames from one fake MAC, SIM_FLOOD_PER_S
+//   - fresh MACs:   bad-MAC frames, a new MAC each, SIM_FLOOD_PER_S
+//   - other team:   frames with another team_id (and key), SIM_FLOOD_PER_S
+// Frames go through the verifier steps that cost CPU:
+//   - old:  CMAC, then security_validate_packet()'s table checks (version,
+//           find / insert, token bucket, timestamp)
+//   - new:  admit_check() + sec_table_peek() first, admit_take_budget()
+//           before the CMAC, then the same
+// Each frame is timed on its own (clock pair overhead subtracted), best of
+// BENCH_RUNS per frame.
+// Reported:
+//   - rejected: frames dropped by either pipeline (same set in both)
+//   - pre-MAC:  of those, dropped by admission
+//   - ns/reject: CPU per rejected frame, old -> new
+//   - legit:    neighbour frames accepted, old / new (must match)
+
+#include "admit.h"
+#include "cmac.h"
+#include "sec_table.h"
+#include "token_bucket.h"
+#include "config.h"
+#include "drone_state.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RUNS          15
+
+#define SIM_DURATION_S      60
+#define SIM_LEGIT           20
+#define SIM_LEGIT_PERIOD_MS 1200
+#define SIM_ATTACK_START_MS 5000
+#define SIM_FLOOD_PER_S     200
+#define SIM_MAX_FRAMES      32768
+
+// security.c s_aes_key
+static const uint8_t KEY[16] = {
+    0x2B, 0x7E, 0x15, 0x16, 0x22, 0xA0, 0xD2, 0xA6,
+    0xAC, 0xF7, 0x19, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+typedef struct {
+    uint8_t  data[sizeof(NeighbourState)];
+    uint32_t rx_ms;
+    bool     legit;
+} Frame;
+
+static Frame    s_trace[SIM_MAX_FRAMES];
+static int      s_frames;
+static CmacKey  s_key;
+static uint32_t s_rng;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// -----------------------------------------------------------------------------
+// TRACE
+// -----------------------------------------------------------------------------
+enum { SCN_ATTACKER, SCN_SPOOF, SCN_FRESH, SCN_TEAM, SCN_MAX };
+static const char *const scn_names[SCN_MAX] = {
+    "attacker.c", "spoof flood", "fresh MACs", "other team"
+};
+
+static void add(const uint8_t mac[6], uint16_t seq, uint32_t rx_ms, uint32_t ts_ms,
+                uint8_t team, bool good_mac, bool legit)
+{
+    if (s_frames >= SIM_MAX_FRAMES) return;
+    NeighbourState n;
+    memset(&n, 0, sizeof(n));
+    n.version    = VERSION;
+    n.team_id    = team;
+    memcpy(n.node_id, mac, 6);
+    n.seq_number = seq;
+    n.ts_s       = 1700000000u + ts_ms / 1000;
+    n.ts_ms      = (uint16_t)(ts_ms % 1000);
+    n.x_mm = 50000; n.y_mm = 50000; n.z_mm = 1000;
+
+    uint8_t tag[CMAC_BLOCK];
+    cmac_compute(&s_key, (const uint8_t *)&n, offsetof(NeighbourState, mac_tag), tag);
+    memcpy(n.mac_tag, tag + 12, 4);
+    if (!good_mac) n.mac_tag[0] ^= 0xFF;
+
+    Frame *f = &s_trace[s_frames++];
+    memcpy(f->data, &n, sizeof(n));
+    f->rx_ms = rx_ms;
+    f->legit = legit;
+}
+
+static int cmp_rx(const void *a, const void *b)
+{
+    const Frame *x = a, *y = b;
+    return (x->rx_ms > y->rx_ms) - (x->rx_ms < y->rx_ms);
+}
+
+static void make_mac(uint8_t mac[6], uint32_t id, uint8_t kind)
+{
+    mac[0] = 0x02;
+    mac[1] = kind;
+    mac[2] = (uint8_t)(id >> 24);
+    mac[3] = (uint8_t)(id >> 16);
+    mac[4] = (uint8_t)(id >> 8);
+    mac[5] = (uint8_t)id;
+}
+
+static void build_trace(int scn)
+{
+    s_frames = 0;
+    s_rng = 0x2545F491u;
+    uint8_t mac[6];
+
+    for (int i = 0; i < SIM_LEGIT; ++i) {
+        make_mac(mac, (uint32_t)i, 0);
+        uint32_t t = rng_next() % SIM_LEGIT_PERIOD_MS;
+        for (uint16_t seq = 1; t < SIM_DURATION_S * 1000u; ++seq) {
+            add(mac, seq, t, t, TEAM_ID, true, true);
+            uint32_t jitter = SIM_LEGIT_PERIOD_MS / 10;
+            t += SIM_LEGIT_PERIOD_MS - jitter + rng_next() % (2 * jitter + 1);
+        }
+    }
+
+    uint32_t t = SIM_ATTACK_START_MS;
+    uint32_t gap = 1000 / SIM_FLOOD_PER_S;
+    switch (scn) {
+    case SCN_ATTACKER: {
+        make_mac(mac, 0xA77AC4u, 0xAA);
+        uint16_t seq = 0;
+        for (int i = 0; i < 1000; ++i, t += 20) add(mac, ++seq, t, t, TEAM_ID, true, false);
+        t += 15000;
+        for (int i = 0; i < 5; ++i, t += 1000) add(mac, 9999, t, t - 10000, TEAM_ID, true, false);
+        t += 10000;
+        static const uint8_t fake[6] = { 0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0x01 };
+        for (int i = 0; i < 5; ++i, t += 1000) add(fake, 1, t, t, TEAM_ID, false, false);
+        break;
+    }
+    case SCN_SPOOF:
+        make_mac(mac, 0xBAD, 0xEE);
+        for (uint16_t seq = 1; t < SIM_DURATION_S * 1000u; t += gap, ++seq) {
+            add(mac, seq, t, t, TEAM_ID, false, false);
+        }
+        break;
+    case SCN_FRESH:
+        for (uint32_t id = 0; t < SIM_DURATION_S * 1000u; t += gap, ++id) {
+            make_mac(mac, id, 0xEE);
+            add(mac, 1, t, t, TEAM_ID, false, false);
+        }
+        break;
+    default:
+        make_mac(mac, 0x7EA, 0xEE);
+        for (uint16_t seq = 1; t < SIM_DURATION_S * 1000u; t += gap, ++seq) {
+            add(mac, seq, t, t, TEAM_ID + 1, false, false);
+        }
+        break;
+    }
+    qsort(s_trace, (size_t)s_frames, sizeof(Frame), cmp_rx);
+}
+
+// -----------------------------------------------------------------------------
+// VERIFIER
+// -----------------------------------------------------------------------------
+static bool mac_ok(const uint8_t *frame)
+{
+    uint8_t tag[CMAC_BLOCK];
+    cmac_compute(&s_key, frame, offsetof(NeighbourState, mac_tag), tag);
+    return memcmp(tag + 12, frame + offsetof(NeighbourState, mac_tag), 4) == 0;
+}
+
+static TokenRate s_node_rate;
+
+// Table side of security_validate_packet()
+static bool validate(SecTable *t, const NeighbourState *n, uint32_t now_ms)
+{
+    if (n->version != VERSION) return false;
+    SecEntry *e = sec_table_find(t, n->node_id, now_ms);
+    if (!e) {
+        e = sec_table_insert(t, n->node_id, now_ms);
+        if (!e) return false;
+        token_fill(&e->bucket, &s_node_rate, now_ms);
+        token_take(&e->bucket, &s_node_rate, 0, now_ms);
+        e->last_ts_s  = n->ts_s;
+        e->last_ts_ms = n->ts_ms;
+        sec_table_on_accepted(t, e);
+        return true;
+    }
+    if (token_available(&e->bucket, &s_node_rate, now_ms) == 0) return false;
+    uint64_t old_ms = (uint64_t)e->last_ts_s * 1000 + e->last_ts_ms;
+    uint64_t new_ms = (uint64_t)n->ts_s * 1000 + n->ts_ms;
+    if (new_ms <= old_ms) return false;
+    token_take(&e->bucket, &s_node_rate, 0, now_ms);
+    e->last_ts_s  = n->ts_s;
+    e->last_ts_ms = n->ts_ms;
+    sec_table_on_accepted(t, e);
+    return true;
+}
+
+// TRUE if accepted; *pre if dropped by admission
+static bool verify(SecTable *t, Admit *a, const Frame *f, bool *pre)
+{
+    *pre = false;
+    const uint8_t *id = f->data + offsetof(NeighbourState, node_id);
+    if (a) {
+        const SecEntry *known = sec_table_peek(t, id);
+        if (admit_check(a, f->data, known, f->rx_ms) != ADMIT_PASS ||
+            !admit_take_budget(a, known, f->rx_ms)) {
+            *pre = true;
+            return false;
+        }
+    }
+    if (!mac_ok(f->data)) {
+        if (a) admit_on_bad_mac(a, id, sec_table_peek(t, id), f->rx_ms);
+        return false;
+    }
+    NeighbourState n;
+    memcpy(&n, f->data, sizeof(n));
+    return validate(t, &n, f->rx_ms);
+}
+
+typedef struct {
+    int    rejected;
+    int    pre_mac;
+    int    legit_ok;
+    double reject_ns;       // Summed over rejected frames
+} RunResult;
+
+static double s_best[SIM_MAX_FRAMES];
+
+static RunResult run(bool with_admit)
+{
+    static SecTable t;
+    static Admit a;
+    SecTableConfig tc;
+    AdmitConfig ac;
+    sec_table_default_config(&tc);
+    admit_default_config(&ac);
+
+    // Clock pair overhead
+    double overhead = 1e30;
+    for (int i = 0; i < 1000; ++i) {
+        double t0 = now_ns(), t1 = now_ns();
+        if (t1 - t0 < overhead) overhead = t1 - t0;
+    }
+
+    RunResult r = { 0 };
+    for (int i = 0; i < s_frames; ++i) s_best[i] = 1e30;
+    bool accepted[SIM_MAX_FRAMES], pre[SIM_MAX_FRAMES];
+
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        sec_table_init(&t, &tc, 0xC0FFEEu);
+        admit_init(&a, &ac, 0x5EED);
+        for (int i = 0; i < s_frames; ++i) {
+            double t0 = now_ns();
+            accepted[i] = verify(&t, with_admit ? &a : NULL, &s_trace[i], &pre[i]);
+            double dt = now_ns() - t0 - overhead;
+            if (dt < s_best[i]) s_best[i] = dt;
+        }
+    }
+
+    for (int i = 0; i < s_frames; ++i) {
+        if (accepted[i]) {
+            if (s_trace[i].legit) r.legit_ok++;
+            continue;
+        }
+        r.rejected++;
+        r.pre_mac += pre[i];
+        r.reject_ns += s_best[i] > 0 ? s_best[i] : 0;
+    }
+    return r;
+}
+
+int main(void)
+{
+    cmac_key_init(&s_key, KEY);
+    token_rate_init(&s_node_rate, SEC_NODE_RATE_PER_S, SEC_NODE_BURST);
+
+    printf("%d neighbours, one frame per %d ms each, attack from %d ms, %ds trace, "
+           "best of %d\n\n", SIM_LEGIT, SIM_LEGIT_PERIOD_MS, SIM_ATTACK_START_MS,
+           SIM_DURATION_S, BENCH_RUNS);
+    printf("%-12s | %6s | %8s | %7s | %17s | %7s | %11s\n", "scenario", "frames",
+           "rejected", "pre-MAC", "ns/reject", "speedup", "legit");
+
+    for (int s = 0; s < SCN_MAX; ++s) {
+        build_trace(s);
+        RunResult old = run(false), adm = run(true);
+        double old_ns = old.reject_ns / (old.rejected ? old.rejected : 1);
+        double new_ns = adm.reject_ns / (adm.rejected ? adm.rejected : 1);
+        printf("%-12s | %6d | %8d | %6.1f%% | %6.0f -> %6.0f | %6.1fx | %5d/%5d\n",
+               scn_names[s], s_frames, adm.rejected,
+               100.0 * adm.pre_mac / (adm.rejected ? adm.rejected : 1),
+               old_ns, new_ns, old_ns / new_ns, old.legit_ok, adm.legit_ok);
+    }
+
+    printf("\nrejected  = frames dropped, old and new pipeline\n");
+    printf("pre-MAC   = of those, dropped by admission without a CMAC\n");
+    printf("ns/reject = CPU per rejected frame, without -> with admission\n");
+    printf("legit     = neighbour frames accepted, without / with admission\n");
+
+    cmac_key_free(&s_key);
+    return 0;
+}
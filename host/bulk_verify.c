@@ -0,0 +1,313 @@
+// host/bulk_verify.c
+#include "bulk_verify.h"
+#include "drone_state.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BULK_X86 1
+#else
+#define BULK_X86 0
+#endif
+
+// The SIMD paths load the last block from offset 32 as 16 bytes and mask
+// the tag off: only valid for the layout they were written for
+_Static_assert(offsetof(NeighbourState, mac_tag) == 44, "CMAC input is 44 bytes");
+_Static_assert(sizeof(NeighbourState) == 48, "frame is 48 bytes");
+
+#define TAG_OFFSET   offsetof(NeighbourState, mac_tag)
+#define CHUNK        256     // Frames per tag buffer in bulk_verify()
+
+static const char *const s_impl_names[BULK_IMPLS] = { "portable", "AES-NI x8", "VAES x16" };
+
+const char *bulk_impl_name(BulkImpl impl)
+{
+    return impl < BULK_IMPLS ? s_impl_names[impl] : "?";
+}
+
+// -----------------------------------------------------------------------------
+// PORTABLE (cmac.c, as the firmware)
+// -----------------------------------------------------------------------------
+static void tags_portable(const BulkKey *k, const uint8_t *f, size_t stride, size_t n,
+                          uint8_t (*tags)[4])
+{
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t full[CMAC_BLOCK];
+        cmac_compute(&k->cmac, f + i * stride, TAG_OFFSET, full);
+        memcpy(tags[i], full + 12, 4);
+    }
+}
+
+#if BULK_X86
+// -----------------------------------------------------------------------------
+// AES-NI
+// -----------------------------------------------------------------------------
+#define NI __attribute__((target("aes,sse2")))
+#define NI_INLINE NI __attribute__((always_inline)) static inline
+
+NI_INLINE __m128i expand_step(__m128i key, __m128i gen)
+{
+    gen = _mm_shuffle_epi32(gen, 0xFF);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, gen);
+}
+
+NI static void expand_key(uint8_t rk[11][16], const uint8_t key[16])
+{
+    __m128i r[11];
+    r[0] = _mm_loadu_si128((const __m128i *)key);
+#define STEP(i, rcon) r[i] = expand_step(r[i - 1], _mm_aeskeygenassist_si128(r[i - 1], rcon))
+    STEP(1, 0x01); STEP(2, 0x02); STEP(3, 0x04); STEP(4, 0x08); STEP(5, 0x10);
+    STEP(6, 0x20); STEP(7, 0x40); STEP(8, 0x80); STEP(9, 0x1B); STEP(10, 0x36);
+#undef STEP
+    for (int i = 0; i < 11; ++i) _mm_storeu_si128((__m128i *)rk[i], r[i]);
+}
+
+// One CBC step on L lanes: x = AES(x ^ block)
+NI_INLINE void step_ni(__m128i *x, const __m128i *blk, const __m128i rk[11], int L)
+{
+    for (int l = 0; l < L; ++l) x[l] = _mm_xor_si128(_mm_xor_si128(x[l], blk[l]), rk[0]);
+    for (int r = 1; r < 10; ++r) {
+        for (int l = 0; l < L; ++l) x[l] = _mm_aesenc_si128(x[l], rk[r]);
+    }
+    for (int l = 0; l < L; ++l) x[l] = _mm_aesenclast_si128(x[l], rk[10]);
+}
+
+// CMAC of L frames at once, chains interleaved so the AES unit stays busy
+NI_INLINE void chain_ni(const __m128i rk[11], __m128i pad, const uint8_t *f, size_t stride,
+                        uint8_t (*tags)[4], int L)
+{
+    const __m128i keep = _mm_set_epi32(0, -1, -1, -1);     // Bytes 0..11
+    __m128i x[8], b[8];
+
+    for (int l = 0; l < L; ++l) {
+        x[l] = _mm_setzero_si128();
+        b[l] = _mm_loadu_si128((const __m128i *)(f + l * stride));
+    }
+    step_ni(x, b, rk, L);
+    for (int l = 0; l < L; ++l) b[l] = _mm_loadu_si128((const __m128i *)(f + l * stride + 16));
+    step_ni(x, b, rk, L);
+    for (int l = 0; l < L; ++l) {
+        __m128i last = _mm_loadu_si128((const __m128i *)(f + l * stride + 32));
+        b[l] = _mm_xor_si128(_mm_and_si128(last, keep), pad);
+    }
+    step_ni(x, b, rk, L);
+
+    for (int l = 0; l < L; ++l) {
+        uint32_t t = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(x[l], 12));
+        memcpy(tags[l], &t, 4);
+    }
+}
+
+NI static void tags_aesni(const BulkKey *k, const uint8_t *f, size_t stride, size_t n,
+                          uint8_t (*tags)[4])
+{
+    __m128i rk[11];
+    for (int r = 0; r < 11; ++r) rk[r] = _mm_loadu_si128((const __m128i *)k->rk[r]);
+    const __m128i pad = _mm_loadu_si128((const __m128i *)k->k2_pad);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) chain_ni(rk, pad, f + i * stride, stride, tags + i, 8);
+    for (; i < n; ++i) chain_ni(rk, pad, f + i * stride, stride, tags + i, 1);
+}
+
+// -----------------------------------------------------------------------------
+// VAES (AVX-512)
+// -----------------------------------------------------------------------------
+#define VA __attribute__((target("aes,vaes,avx512f")))
+#define VA_INLINE VA __attribute__((always_inline)) static inline
+
+// Block at off of four consecutive frames, one per 128-bit lane
+VA_INLINE __m512i load4(const uint8_t *f, size_t stride, size_t off)
+{
+    __m512i v = _mm512_castsi128_si512(_mm_loadu_si128((const __m128i *)(f + off)));
+    v = _mm512_inserti32x4(v, _mm_loadu_si128((const __m128i *)(f + stride + off)), 1);
+    v = _mm512_inserti32x4(v, _mm_loadu_si128((const __m128i *)(f + 2 * stride + off)), 2);
+    v = _mm512_inserti32x4(v, _mm_loadu_si128((const __m128i *)(f + 3 * stride + off)), 3);
+    return v;
+}
+
+VA_INLINE void step_va(__m512i x[4], const __m512i b[4], const __m512i rk[11])
+{
+    for (int g = 0; g < 4; ++g) x[g] = _mm512_xor_si512(_mm512_xor_si512(x[g], b[g]), rk[0]);
+    for (int r = 1; r < 10; ++r) {
+        for (int g = 0; g < 4; ++g) x[g] = _mm512_aesenc_epi128(x[g], rk[r]);
+    }
+    for (int g = 0; g < 4; ++g) x[g] = _mm512_aesenclast_epi128(x[g], rk[10]);
+}
+
+VA static void tags_vaes(const BulkKey *k, const uint8_t *f, size_t stride, size_t n,
+                         uint8_t (*tags)[4])
+{
+    __m512i rk[11];
+    for (int r = 0; r < 11; ++r) {
+        rk[r] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)k->rk[r]));
+    }
+    const __m512i pad  = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)k->k2_pad));
+    const __m512i keep = _mm512_broadcast_i32x4(_mm_set_epi32(0, -1, -1, -1));
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint8_t *p = f + i * stride;
+        __m512i x[4], b[4];
+        for (int g = 0; g < 4; ++g) {
+            x[g] = _mm512_setzero_si512();
+            b[g] = load4(p + 4 * g * stride, stride, 0);
+        }
+        step_va(x, b, rk);
+        for (int g = 0; g < 4; ++g) b[g] = load4(p + 4 * g * stride, stride, 16);
+        step_va(x, b, rk);
+        for (int g = 0; g < 4; ++g) {
+            b[g] = _mm512_xor_si512(_mm512_and_si512(load4(p + 4 * g * stride, stride, 32), keep), pad);
+        }
+        step_va(x, b, rk);
+
+        uint8_t out[4][64];
+        for (int g = 0; g < 4; ++g) _mm512_storeu_si512(out[g], x[g]);
+        for (int l = 0; l < 16; ++l) memcpy(tags[i + l], &out[l / 4][16 * (l % 4) + 12], 4);
+    }
+    if (i < n) tags_aesni(k, f + i * stride, stride, n - i, tags + i);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// KEY / DISPATCH
+// -----------------------------------------------------------------------------
+static bool cpu_has(BulkImpl impl)
+{
+#if BULK_X86
+    __builtin_cpu_init();
+    switch (impl) {
+    case BULK_PORTABLE: return true;
+    case BULK_AESNI:    return __builtin_cpu_supports("aes");
+    case BULK_VAES:     return __builtin_cpu_supports("aes") && __builtin_cpu_supports("vaes") &&
+                               __builtin_cpu_supports("avx512f");
+    default:            return false;
+    }
+#else
+    return impl == BULK_PORTABLE;
+#endif
+}
+
+BulkImpl bulk_best_impl(void)
+{
+    for (int i = BULK_IMPLS - 1; i > BULK_PORTABLE; --i) {
+        if (cpu_has((BulkImpl)i)) return (BulkImpl)i;
+    }
+    return BULK_PORTABLE;
+}
+
+bool bulk_key_init(BulkKey *k, const uint8_t key[16])
+{
+    memset(k, 0, sizeof(*k));
+    if (!cmac_key_init(&k->cmac, key)) return false;
+
+    // Last block: 12 message bytes, 0x80, zeros, XOR K2
+    memcpy(k->k2_pad, k->cmac.k2, CMAC_BLOCK);
+    k->k2_pad[TAG_OFFSET % CMAC_BLOCK] ^= 0x80;
+
+    k->impl = bulk_best_impl();
+#if BULK_X86
+    if (k->impl != BULK_PORTABLE) expand_key(k->rk, key);
+#endif
+    return true;
+}
+
+void bulk_key_free(BulkKey *k)
+{
+    cmac_key_free(&k->cmac);
+    memset(k, 0, sizeof(*k));
+}
+
+bool bulk_key_use(BulkKey *k, BulkImpl impl)
+{
+    if (impl >= BULK_IMPLS || !cpu_has(impl)) return false;
+    k->impl = impl;
+    return true;
+}
+
+void bulk_tags(const BulkKey *k, const uint8_t *frames, size_t stride, size_t n,
+               uint8_t (*tags)[4])
+{
+    switch (k->impl) {
+#if BULK_X86
+    case BULK_VAES:  tags_vaes(k, frames, stride, n, tags);  break;
+    case BULK_AESNI: tags_aesni(k, frames, stride, n, tags); break;
+#endif
+    default:         tags_portable(k, frames, stride, n, tags); break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// VERIFY
+// -----------------------------------------------------------------------------
+size_t bulk_verify(const BulkKey *k, const uint8_t *frames, size_t stride, size_t n,
+                   bool *ok)
+{
+    uint8_t tags[CHUNK][4];
+    size_t good = 0;
+    for (size_t i = 0; i < n; i += CHUNK) {
+        size_t m = n - i < CHUNK ? n - i : CHUNK;
+        bulk_tags(k, frames + i * stride, stride, m, tags);
+        for (size_t j = 0; j < m; ++j) {
+            ok[i + j] = memcmp(tags[j], frames + (i + j) * stride + TAG_OFFSET, 4) == 0;
+            good += ok[i + j];
+        }
+    }
+    return good;
+}
+
+typedef struct {
+    const BulkKey *k;
+    const uint8_t *frames;
+    size_t         stride, n, good;
+    bool          *ok;
+} Slice;
+
+static void *verify_slice(void *arg)
+{
+    Slice *s = arg;
+    s->good = bulk_verify(s->k, s->frames, s->stride, s->n, s->ok);
+    return NULL;
+}
+
+size_t bulk_verify_parallel(const BulkKey *k, const uint8_t *frames, size_t stride,
+                            size_t n, bool *ok, int threads)
+{
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 1 || n < 2 * CHUNK) return bulk_verify(k, frames, stride, n, ok);
+
+    // Whole chunks per thread so every slice but the last runs full batches
+    size_t chunks = (n + CHUNK - 1) / CHUNK;
+    if ((size_t)threads > chunks) threads = (int)chunks;
+    size_t per = (chunks + threads - 1) / threads * CHUNK;
+
+    Slice *s = calloc((size_t)threads, sizeof(Slice));
+    pthread_t *tid = calloc((size_t)threads, sizeof(pthread_t));
+    for (int t = 0; t < threads; ++t) {
+        size_t from = (size_t)t * per;
+        if (from >= n) break;
+        s[t] = (Slice){ k, frames + from * stride, stride, n - from < per ? n - from : per, 0,
+                        ok + from };
+        if (pthread_create(&tid[t], NULL, verify_slice, &s[t]) != 0) {
+            verify_slice(&s[t]);        // No thread: do it here
+            tid[t] = pthread_self();
+        }
+    }
+
+    size_t good = 0;
+    for (int t = 0; t < threads; ++t) {
+        if (s[t].k == NULL) break;
+        if (!pthread_equal(tid[t], pthread_self())) pthread_join(tid[t], NULL);
+        good += s[t].good;
+    }
+    free(s);
+    free(tid);
+    return good;
+}
@@ -0,0 +1,73 @@
+// host/bulk_verify.h
+#pragma once
+
+// Bulk mac_tag verification of recorded / MQTT-relayed NeighbourState frames
+// for ground-station ingest. The firmware path (cmac.c behind
+// verify_packet_bytes()) runs one frame at a time: the three AES blocks of a
+// 44-byte CMAC are a chain, so each waits on the one before and the AES
+// unit mostly idles. Here frames are processed in batches, each lane
+// running its own chain:
+//   - VAES + AVX-512: 16 frames per step, four per 512-bit register
+//   - AES-NI:         8 frames per step, one per 128-bit register
+//   - portable:       cmac.c, one frame at a time (the firmware path)
+// chosen at bulk_key_init() from what the CPU has, and split over threads
+// by bulk_verify_parallel(). Every path gives the tag of sign_packet() bit
+// for bit: the last 4 bytes of AES-128-CMAC over the first 44 bytes.
+//
+// Frames are NeighbourState images in wire order, stride bytes apart
+// (sizeof(NeighbourState) for a packed array, more for records carrying
+// their own metadata).
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cmac.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BULK_PORTABLE = 0,
+    BULK_AESNI,
+    BULK_VAES,
+    BULK_IMPLS
+} BulkImpl;
+
+typedef struct {
+    uint8_t  rk[11][16];        // AES-128 encryption schedule
+    uint8_t  k2_pad[16];        // K2 ^ 10* padding of the 12-byte last block
+    CmacKey  cmac;              // Portable path
+    BulkImpl impl;
+} BulkKey;
+
+// Expand the key, pick the fastest implementation this CPU supports.
+// FALSE if the key was refused.
+bool bulk_key_init(BulkKey *k, const uint8_t key[16]);
+
+void bulk_key_free(BulkKey *k);
+
+// Best implementation this CPU supports
+BulkImpl bulk_best_impl(void);
+
+// Force an implementation (benchmarks, tests). FALSE if the CPU lacks it.
+bool bulk_key_use(BulkKey *k, BulkImpl impl);
+
+const char *bulk_impl_name(BulkImpl impl);
+
+// 4-byte tags of n frames, as sign_packet() would write them
+void bulk_tags(const BulkKey *k, const uint8_t *frames, size_t stride, size_t n,
+               uint8_t (*tags)[4]);
+
+// ok[i] = frame i carries its tag. Returns the number that do.
+size_t bulk_verify(const BulkKey *k, const uint8_t *frames, size_t stride, size_t n,
+                   bool *ok);
+
+// bulk_verify() over threads threads (0: one per online CPU)
+size_t bulk_verify_parallel(const BulkKey *k, const uint8_t *frames, size_t stride,
+                            size_t n, bool *ok, int threads);
+
+#ifdef __cplusplus
+}
+#endif
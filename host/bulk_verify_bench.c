@@ -0,0 +1,191 @@
+// host/bulk_verify_bench.c
+// Bulk mac_tag verification (bulk_verify.c) for ground-station ingest.
+//
+// Part 1 checks every implementation this CPU has against the firmware
+// path: tags bit-exact with sign_packet() (cmac.c, last 4 bytes of the
+// CMAC over the first 44 bytes) and the same verdicts, on BENCH_CHECK
+// frames (a third tampered: one byte flipped anywhere, tag included),
+// packed and in records of RECORD_STRIDE bytes, batch tails included.
+//
+// Part 2 times verification of BENCH_FRAMES recorded frames per row:
+//   - portable:  cmac.c, one frame at a time, as verify_packet_bytes()
+//   - AES-NI x8: eight CMAC chains interleaved
+//   - VAES x16:  sixteen, four per AVX-512 register
+// on one thread (messages per second per core), then the best one over
+// 1, 2, 4, ... threads up to the online CPUs.
+
+#include "bulk_verify.h"
+#include "drone_state.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_CHECK     10007
+#define BENCH_FRAMES    (1u << 20)
+#define BENCH_RUNS      5
+#define RECORD_STRIDE   64      // Frame + e.g. receive time / RSSI
+
+// security.c s_aes_key
+static const uint8_t KEY[16] = {
+    0x2B, 0x7E, 0x15, 0x16, 0x22, 0xA0, 0xD2, 0xA6,
+    0xAC, 0xF7, 0x19, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+static uint32_t s_rng = 0x2545F491u;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// sign_packet() on the firmware: the cached-key CMAC, last 4 bytes
+static void sign(const CmacKey *k, uint8_t *frame)
+{
+    uint8_t full[CMAC_BLOCK];
+    cmac_compute(k, frame, offsetof(NeighbourState, mac_tag), full);
+    memcpy(frame + offsetof(NeighbourState, mac_tag), full + 12, 4);
+}
+
+// n signed random frames, stride apart; tampered[i] if one byte was flipped
+static uint8_t *make_frames(const CmacKey *k, size_t n, size_t stride, bool *tampered)
+{
+    uint8_t *buf = malloc(n * stride);
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t *f = buf + i * stride;
+        for (size_t b = 0; b < stride; ++b) f[b] = (uint8_t)rng_next();
+        sign(k, f);
+        bool bad = tampered && rng_next() % 3 == 0;
+        if (bad) f[rng_next() % sizeof(NeighbourState)] ^= (uint8_t)(1u << (rng_next() % 8));
+        if (tampered) tampered[i] = bad;
+    }
+    return buf;
+}
+
+// -----------------------------------------------------------------------------
+// Part 1: bit-exact with sign_packet()
+// -----------------------------------------------------------------------------
+static bool check(BulkKey *bk, const CmacKey *ck, size_t stride)
+{
+    bool *tampered = malloc(BENCH_CHECK * sizeof(bool));
+    bool *ok = malloc(BENCH_CHECK * sizeof(bool));
+    uint8_t (*tags)[4] = malloc(BENCH_CHECK * 4);
+    uint8_t *frames = make_frames(ck, BENCH_CHECK, stride, tampered);
+
+    bool pass = true;
+    // Every batch tail: n = 1..33, then all
+    for (size_t n = 1; n <= BENCH_CHECK; n = n < 33 ? n + 1 : BENCH_CHECK) {
+        bulk_tags(bk, frames, stride, n, tags);
+        size_t good = bulk_verify(bk, frames, stride, n, ok);
+        size_t want_good = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint8_t full[CMAC_BLOCK];
+            cmac_compute(ck, frames + i * stride, offsetof(NeighbourState, mac_tag), full);
+            pass &= memcmp(tags[i], full + 12, 4) == 0;
+            pass &= ok[i] == !tampered[i];
+            want_good += !tampered[i];
+        }
+        pass &= good == want_good;
+        if (n == BENCH_CHECK) break;
+    }
+    size_t good = bulk_verify_parallel(bk, frames, stride, BENCH_CHECK, ok, 3);
+    for (size_t i = 0; i < BENCH_CHECK; ++i) {
+        pass &= ok[i] == !tampered[i];
+        good -= ok[i];
+    }
+    pass &= good == 0;
+
+    free(frames);
+    free(tags);
+    free(ok);
+    free(tampered);
+    return pass;
+}
+
+// -----------------------------------------------------------------------------
+// Part 2: throughput
+// -----------------------------------------------------------------------------
+static double bench(const BulkKey *k, const uint8_t *frames, bool *ok, int threads)
+{
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        double t0 = now_s();
+        size_t good = bulk_verify_parallel(k, frames, sizeof(NeighbourState), BENCH_FRAMES,
+                                           ok, threads);
+        double t = now_s() - t0;
+        if (good != BENCH_FRAMES) return 0.0;
+        if (t < best) best = t;
+    }
+    return BENCH_FRAMES / best;
+}
+
+int main(void)
+{
+    CmacKey ck;
+    BulkKey bk;
+    cmac_key_init(&ck, KEY);
+    bulk_key_init(&bk, KEY);
+    BulkImpl best = bk.impl;
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    printf("Part 1: tags and verdicts vs sign_packet(), %d frames, a third tampered\n\n",
+           BENCH_CHECK);
+    printf("%-10s | %8s | %9s\n", "impl", "packed", "stride 64");
+    bool all = true;
+    for (int i = 0; i < BULK_IMPLS; ++i) {
+        if (!bulk_key_use(&bk, (BulkImpl)i)) {
+            printf("%-10s | %8s | %9s\n", bulk_impl_name((BulkImpl)i), "n/a", "n/a");
+            continue;
+        }
+        bool packed = check(&bk, &ck, sizeof(NeighbourState));
+        bool record = check(&bk, &ck, RECORD_STRIDE);
+        all &= packed && record;
+        printf("%-10s | %8s | %9s\n", bulk_impl_name((BulkImpl)i), packed ? "OK" : "FAIL",
+               record ? "OK" : "FAIL");
+    }
+
+    uint8_t *frames = make_frames(&ck, BENCH_FRAMES, sizeof(NeighbourState), NULL);
+    bool *ok = malloc(BENCH_FRAMES * sizeof(bool));
+
+    printf("\nPart 2: verify %u packed frames, best of %d, %d CPU(s)\n\n", BENCH_FRAMES,
+           BENCH_RUNS, cpus);
+    printf("%-10s | %7s | %13s | %8s | %8s\n", "impl", "threads", "msg/s", "per msg",
+           "speedup");
+    double base = 0.0;
+    for (int i = 0; i < BULK_IMPLS; ++i) {
+        if (!bulk_key_use(&bk, (BulkImpl)i)) continue;
+        double rate = bench(&bk, frames, ok, 1);
+        if (i == BULK_PORTABLE) base = rate;
+        printf("%-10s | %7d | %13.0f | %5.1f ns | %7.1fx\n", bulk_impl_name((BulkImpl)i), 1,
+               rate, 1e9 / rate, rate / base);
+    }
+    bulk_key_use(&bk, best);
+    for (int t = 2; t <= cpus; t *= 2) {
+        double rate = bench(&bk, frames, ok, t);
+        printf("%-10s | %7d | %13.0f | %5.1f ns | %7.1fx\n", bulk_impl_name(best), t, rate,
+               1e9 / rate, rate / base);
+    }
+
+    printf("\nmsg/s   = frames verified per second, in total (per core with 1 thread)\n");
+    printf("per msg = wall time per frame\n");
+    printf("speedup = against portable on one thread\n");
+
+    free(ok);
+    free(frames);
+    bulk_key_free(&bk);
+    cmac_key_free(&ck);
+    return all ? 0 : 1;
+}
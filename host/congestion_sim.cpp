@@ -0,0 +1,241 @@
+// host/congestion_sim.cpp
+// Swarm-wide congestion control (congestion.c) against fixed broadcast rates,
+// on the simulated SX1276 channel with hundreds of nodes.
+//
+// Nodes are spread over a 4 km x 4 km field (path loss exponent 3.5, so about
+// 1 km range at SF7 / 14 dBm) and every node broadcasts its state at its TX
+// interval, +-10% jitter, with listen-before-talk as radio_task does. The
+// field stays the same while the swarm grows, so density rises with the node
+// count. Rates:
+//   - fixed 2 Hz:  RADIO_TX_MIN_PERIOD_MS, a swarm that is always moving
+//   - fixed hb:    RADIO_TX_PERIOD_MS heartbeat only
+//   - AIMD:        congestion.c on every node
+// A link is an ordered pair of nodes whose mean received power clears the SF
+// floor. Reported:
+//   - goodput: states received per node per second
+//   - delivery: receptions / in-range listeners per frame sent
+//   - timeout: share of link-seconds with nothing heard for
+//     NEIGHBOUR_TIMEOUT_MS (the neighbour would have been pruned)
+//   - period: mean TX interval at the end (AIMD)
+
+#include "sim_radio.h"
+
+extern "C" {
+#include "config.h"
+#include "drone_state.h"
+#include "csma.h"
+#include "congestion.h"
+#include "link_adapt.h"
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define SIM_DURATION_S      300
+#define SIM_WARMUP_S        60
+#define SIM_FIELD_M         4000.0
+#define SIM_PATH_LOSS_EXP   3.5
+#define SIM_ISR_TO_TASK_US  200
+#define SIM_SF              7
+
+static uint64_t ms_to_us(uint64_t ms) { return ms * 1000; }
+
+enum Mode { MODE_FAST, MODE_HEARTBEAT, MODE_AIMD, MODE_MAX };
+static const char *const mode_names[MODE_MAX] = { "fixed 2Hz", "fixed hb", "AIMD" };
+
+struct Node : SimCsmaNode {
+    Congestion cc;
+};
+
+struct Sim : SimCsmaSwarm {
+    std::vector<Node> &nodes;
+    Mode mode;
+    uint32_t frame_us = 0;
+    std::mt19937 rng{7};
+
+    uint64_t sent = 0;
+    uint64_t sent_reach = 0;        // Sum of in-range listeners of frames sent
+    uint64_t delivered = 0;
+    std::vector<int>      reach{};    // In-range listeners per node
+    std::vector<uint8_t>  in_range{}; // [from * n + to]
+    std::vector<uint64_t> last_rx{};  // [from * n + to], us
+
+    Sim(SimChannel &ch, std::vector<Node> &nodes, Mode mode)
+        : SimCsmaSwarm(ch, sizeof(NeighbourState)), nodes(nodes), mode(mode) {}
+
+    bool measuring() const { return ch.now_us() >= ms_to_us(SIM_WARMUP_S * 1000ull); }
+
+    uint32_t period_ms(const Node &n) const
+    {
+        switch (mode) {
+        case MODE_FAST:      return RADIO_TX_MIN_PERIOD_MS;
+        case MODE_HEARTBEAT: return (uint32_t)RADIO_TX_PERIOD_MS;
+        default:             return congestion_period_ms(&n.cc);
+        }
+    }
+
+    void fill_frame(SimCsmaNode &n, uint8_t *f) override
+    {
+        f[2] = (uint8_t)n.id;
+        f[3] = (uint8_t)(n.id >> 8);
+    }
+
+    void on_sent(SimCsmaNode &n) override
+    {
+        congestion_on_tx(&static_cast<Node &>(n).cc, frame_us);
+        if (measuring()) {
+            sent++;
+            sent_reach += reach[n.id];
+        }
+    }
+
+    void on_rx(SimCsmaNode &sn, const uint8_t *buf, size_t len, int16_t status) override
+    {
+        Node &n = static_cast<Node &>(sn);
+        if (status == RADIOLIB_ERR_NONE && len == sizeof(NeighbourState)) {
+            congestion_on_rx(&n.cc, &buf[2], frame_us);
+            int from = buf[2] | buf[3] << 8;
+            last_rx[(size_t)from * nodes.size() + n.id] = ch.now_us();
+            if (measuring()) delivered++;
+        } else if (status == RADIOLIB_ERR_CRC_MISMATCH) {
+            congestion_on_rx_error(&n.cc, frame_us);
+        }
+    }
+
+    void on_due(Node &n)
+    {
+        uint64_t now = ch.now_us();
+        // Replaces a state still waiting
+        hold(n, (uint32_t)(now / 1000) + TX_SCHED_OWN_DEADLINE_MS);
+
+        std::uniform_real_distribution<double> jit(0.9, 1.1);
+        uint64_t next = now + (uint64_t)(ms_to_us(period_ms(n)) * jit(rng));
+        ch.at(next, [this, &n] { on_due(n); });
+    }
+
+    void on_window(Node &n)
+    {
+        congestion_update(&n.cc, (uint32_t)(ch.now_us() / 1000));
+        ch.at(ch.now_us() + ms_to_us(CONGESTION_WINDOW_MS), [this, &n] { on_window(n); });
+    }
+};
+
+struct Result {
+    double goodput;
+    double delivery;
+    double timeout;
+    double period_s;
+    double links;
+};
+
+static Result run(int n_nodes, Mode mode)
+{
+    SimChannelConfig cfg;
+    cfg.seed = 9;
+    cfg.path_loss_exp = SIM_PATH_LOSS_EXP;
+    SimChannel ch(cfg);
+
+    std::vector<Node> nodes(n_nodes);
+    Sim sim(ch, nodes, mode);
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    CongestionConfig cc_cfg;
+    congestion_default_config(&cc_cfg);
+
+    for (int i = 0; i < n_nodes; ++i) {
+        Node &n = nodes[i];
+        n.id = i;
+        n.radio = std::make_unique<SimRadio>(ch);
+        n.radio->set_position(uni(rng) * SIM_FIELD_M, uni(rng) * SIM_FIELD_M, 20.0);
+        n.radio->begin(868.2f, 250.0f, SIM_SF, 7, 0x12, 14, 10);
+        csma_init(&n.csma, 0x2000u + (uint32_t)i);
+        congestion_init(&n.cc, &cc_cfg, 0);
+
+        sim.connect(n, SIM_ISR_TO_TASK_US);
+        n.radio->startReceive();
+
+        Node *np = &n;
+
+        ch.at((uint64_t)(uni(rng) * ms_to_us((uint64_t)RADIO_TX_PERIOD_MS)),
+              [&sim, np] { sim.on_due(*np); });
+        ch.at((uint64_t)(uni(rng) * ms_to_us(CONGESTION_WINDOW_MS)),
+              [&sim, np] { sim.on_window(*np); });
+    }
+    sim.frame_us = nodes[0].radio->getTimeOnAir(sizeof(NeighbourState));
+
+    double floor_db = link_adapt_snr_floor_db(SIM_SF);
+    size_t nn = (size_t)n_nodes;
+    sim.reach.assign(nn, 0);
+    sim.in_range.assign(nn * nn, 0);
+    sim.last_rx.assign(nn * nn, 0);
+    uint64_t links = 0;
+    for (size_t i = 0; i < nn; ++i) {
+        for (size_t j = 0; j < nn; ++j) {
+            if (i == j) continue;
+            double snr = ch.mean_rx_power_dbm(*nodes[i].radio, *nodes[j].radio) -
+                         cfg.noise_floor_dbm;
+            if (snr >= floor_db) {
+                sim.in_range[i * nn + j] = 1;
+                sim.reach[i]++;
+                links++;
+            }
+        }
+    }
+
+    // Step the clock a second at a time to sample link staleness
+    uint64_t link_s = 0, stale = 0;
+    for (uint64_t s = 1; s <= SIM_DURATION_S; ++s) {
+        ch.run_until(ms_to_us(s * 1000));
+        if (s <= SIM_WARMUP_S) continue;
+        uint64_t now = ch.now_us();
+        for (size_t k = 0; k < nn * nn; ++k) {
+            if (!sim.in_range[k]) continue;
+            link_s++;
+            if (now - sim.last_rx[k] > ms_to_us(NEIGHBOUR_TIMEOUT_MS)) stale++;
+        }
+    }
+
+    double secs = SIM_DURATION_S - SIM_WARMUP_S;
+    double period = 0.0;
+    for (const Node &n : nodes) period += sim.period_ms(n);
+
+    Result r;
+    r.goodput  = sim.delivered / secs / n_nodes;
+    r.delivery = sim.sent_reach ? 100.0 * sim.delivered / sim.sent_reach : 0.0;
+    r.timeout  = link_s ? 100.0 * stale / link_s : 0.0;
+    r.period_s = period / n_nodes / 1000.0;
+    r.links    = (double)links / n_nodes;
+    return r;
+}
+
+int main(void)
+{
+    printf("Congestion control: %ds, %.0f x %.0f m field, path loss exp %.1f, SF%d, "
+           "CSMA on, AIMD target %.0f%% busy\n\n",
+           SIM_DURATION_S, SIM_FIELD_M, SIM_FIELD_M, SIM_PATH_LOSS_EXP, SIM_SF,
+           CONGESTION_TARGET_UTIL * 100.0);
+    printf("%5s | %9s | %-9s | %9s | %8s | %7s | %8s\n",
+           "nodes", "links/nd", "rate", "goodput", "delivery", "timeout", "period");
+
+    const int counts[] = { 25, 50, 100, 200, 400 };
+    for (int n : counts) {
+        for (int m = 0; m < MODE_MAX; ++m) {
+            Result r = run(n, (Mode)m);
+            printf("%5d | %9.1f | %-9s | %7.2f/s | %7.1f%% | %6.1f%% | %6.2f s\n",
+                   n, r.links, mode_names[m], r.goodput, r.delivery, r.timeout,
+                   r.period_s);
+        }
+    }
+
+    printf("\ngoodput  = states received per node per second\n");
+    printf("delivery = receptions / in-range listeners of every frame sent\n");
+    printf("timeout  = in-range links silent for more than %d ms (neighbour pruned)\n",
+           NEIGHBOUR_TIMEOUT_MS);
+    printf("period   = mean own TX interval at the end of the run\n");
+    return 0;
+}
@@ -0,0 +1,264 @@
+// host/interest_sim.c
+// Interest filter (interest.c) in front of the flocking neighbour table, for
+// swarms larger than the table. Nodes wander a 1 km x 1 km field at
+// MAX_SPEED_MM_S and broadcast once a second, reporting their position with
+// a few metres of error; the node under test (DUT) hears all of them (radio
+// loss is not the point here). Verified updates go
+// either straight to the table, as before, or through the filter. The table
+// is a copy of flocking.c: MAX_NEIGHBOURS slots, a new sender takes the first
+// free slot or overwrites slot 0, entries older than
+// NEIGHBOUR_STALE_TIMEOUT_S are pruned.
+//
+// Reported per second:
+//   - updates handed to flocking (neigh_ring copies + RX log lines)
+//   - coverage: share of nodes truly within FLOCKING_NEIGHBOUR_RADIUS_MM
+//     that sit in the table with a state at most 2 s old
+//   - table slots held by nodes outside that radius
+//   - near/far flips of the filter (hysteresis damps these)
+
+#include "interest.h"
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SIM_DURATION_S    600
+#define SIM_WARMUP_S      60
+#define SIM_FIELD_MM      1000000.0
+#define SIM_HEIGHT_MM     100000.0
+#define SIM_TX_PERIOD_MS  1000
+#define SIM_FRESH_MS      2000
+#define SIM_MAX_NODES     400
+#define SIM_POS_NOISE_MM  3000.0    // Reported position error (1 sigma)
+
+typedef struct {
+    double   pos[3];
+    double   heading;
+    uint16_t seq;
+    uint32_t next_tx_ms;
+} SimNode;
+
+typedef struct {
+    bool     is_valid;
+    uint32_t last_updated_ms;
+    int      node;
+    uint16_t seq;
+} TableEntry;
+
+static SimNode    s_nodes[SIM_MAX_NODES];
+static TableEntry s_table[MAX_NEIGHBOURS];
+static uint32_t   s_rng;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double rng_uniform(void)
+{
+    return (double)rng_next() / 4294967296.0;
+}
+
+static double rng_gauss(double sigma)
+{
+    double u1 = rng_uniform() + 1e-12, u2 = rng_uniform();
+    return sigma * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static uint32_t reported_mm(double v)
+{
+    v += rng_gauss(SIM_POS_NOISE_MM);
+    return v > 0.0 ? (uint32_t)v : 0;
+}
+
+static void move_node(SimNode *n, double dt_s)
+{
+    n->heading += (rng_uniform() - 0.5) * 0.6;
+    n->pos[0] += cos(n->heading) * MAX_SPEED_MM_S * dt_s;
+    n->pos[1] += sin(n->heading) * MAX_SPEED_MM_S * dt_s;
+
+    for (int a = 0; a < 2; ++a) {
+        if (n->pos[a] < 0.0)          { n->pos[a] = -n->pos[a];                   n->heading += M_PI; }
+        if (n->pos[a] > SIM_FIELD_MM) { n->pos[a] = 2.0 * SIM_FIELD_MM - n->pos[a]; n->heading += M_PI; }
+    }
+}
+
+static double dist_mm(const SimNode *a, const SimNode *b)
+{
+    double dx = a->pos[0] - b->pos[0];
+    double dy = a->pos[1] - b->pos[1];
+    double dz = a->pos[2] - b->pos[2];
+    return sqrt(dx*dx + dy*dy + dz*dz);
+}
+
+// flocking.c update_neighbour_table() / prune_stale_neighbours()
+static void table_update(int node, uint16_t seq, uint32_t now_ms)
+{
+    int first_empty = -1;
+    for (int i = 0; i < MAX_NEIGHBOURS; ++i) {
+        if (s_table[i].is_valid && s_table[i].node == node) {
+            if (seq > s_table[i].seq) {
+                s_table[i].seq = seq;
+                s_table[i].last_updated_ms = now_ms;
+            }
+            return;
+        }
+        if (!s_table[i].is_valid && first_empty < 0) first_empty = i;
+    }
+    int idx = (first_empty >= 0) ? first_empty : 0;
+    s_table[idx].is_valid = true;
+    s_table[idx].node = node;
+    s_table[idx].seq = seq;
+    s_table[idx].last_updated_ms = now_ms;
+}
+
+static void table_prune(uint32_t now_ms)
+{
+    for (int i = 0; i < MAX_NEIGHBOURS; ++i) {
+        if (s_table[i].is_valid &&
+            (now_ms - s_table[i].last_updated_ms) / 1000 > NEIGHBOUR_STALE_TIMEOUT_S) {
+            s_table[i].is_valid = false;
+        }
+    }
+}
+
+typedef struct {
+    const char *name;
+    bool        filter;
+    double      hysteresis_mm;
+    uint32_t    far_period_ms;
+} Variant;
+
+typedef struct {
+    double updates_s;
+    double coverage;
+    double far_slots;
+    double flips_s;
+} Result;
+
+static Result run(int n_nodes, const Variant *v)
+{
+    s_rng = 0x5EED1234u;
+    memset(s_table, 0, sizeof(s_table));
+
+    for (int i = 0; i < n_nodes; ++i) {
+        SimNode *n = &s_nodes[i];
+        n->pos[0] = rng_uniform() * SIM_FIELD_MM;
+        n->pos[1] = rng_uniform() * SIM_FIELD_MM;
+        n->pos[2] = rng_uniform() * SIM_HEIGHT_MM;
+        n->heading = rng_uniform() * 2.0 * M_PI;
+        n->seq = 0;
+        n->next_tx_ms = (uint32_t)(rng_uniform() * SIM_TX_PERIOD_MS);
+    }
+    // DUT (node 0) in the middle so it always has a full neighbourhood
+    s_nodes[0].pos[0] = s_nodes[0].pos[1] = SIM_FIELD_MM / 2.0;
+
+    InterestConfig cfg;
+    interest_default_config(&cfg);
+    cfg.radius_mm     = v->filter ? INTEREST_RADIUS_MM : 0.0;
+    cfg.hysteresis_mm = v->hysteresis_mm;
+    cfg.far_period_ms = v->far_period_ms;
+    static InterestFilter f;
+    interest_init(&f, &cfg);
+
+    uint64_t updates = 0, covered = 0, relevant = 0, far_slots = 0, samples = 0;
+    uint32_t flips_at_warmup = 0;
+
+    for (uint32_t now_ms = 0; now_ms < SIM_DURATION_S * 1000u; now_ms += 100) {
+        for (int i = 0; i < n_nodes; ++i) move_node(&s_nodes[i], 0.1);
+        interest_set_own(&f, s_nodes[0].pos[0], s_nodes[0].pos[1], s_nodes[0].pos[2]);
+
+        for (int i = 1; i < n_nodes; ++i) {
+            SimNode *n = &s_nodes[i];
+            if ((int32_t)(now_ms - n->next_tx_ms) < 0) continue;
+            n->next_tx_ms += SIM_TX_PERIOD_MS;
+            n->seq++;
+
+            NeighbourState st;
+            memset(&st, 0, sizeof(st));
+            memcpy(st.node_id, &i, sizeof(i));
+            st.seq_number = n->seq;
+            st.x_mm = reported_mm(n->pos[0]);
+            st.y_mm = reported_mm(n->pos[1]);
+            st.z_mm = reported_mm(n->pos[2]);
+
+            if (!interest_accept(&f, &st, now_ms)) continue;
+            table_update(i, n->seq, now_ms);
+            if (now_ms >= SIM_WARMUP_S * 1000u) updates++;
+        }
+        table_prune(now_ms);
+
+        if (now_ms == SIM_WARMUP_S * 1000u) {
+            flips_at_warmup = f.stats.entered + f.stats.left;
+        }
+        if (now_ms < SIM_WARMUP_S * 1000u || now_ms % 1000 != 0) continue;
+
+        // Score once a second
+        samples++;
+        for (int i = 1; i < n_nodes; ++i) {
+            if (dist_mm(&s_nodes[0], &s_nodes[i]) > FLOCKING_NEIGHBOUR_RADIUS_MM) continue;
+            relevant++;
+            for (int k = 0; k < MAX_NEIGHBOURS; ++k) {
+                if (s_table[k].is_valid && s_table[k].node == i &&
+                    now_ms - s_table[k].last_updated_ms <= SIM_FRESH_MS) {
+                    covered++;
+                    break;
+                }
+            }
+        }
+        for (int k = 0; k < MAX_NEIGHBOURS; ++k) {
+            if (s_table[k].is_valid &&
+                dist_mm(&s_nodes[0], &s_nodes[s_table[k].node]) > FLOCKING_NEIGHBOUR_RADIUS_MM) {
+                far_slots++;
+            }
+        }
+    }
+
+    double secs = SIM_DURATION_S - SIM_WARMUP_S;
+    Result r;
+    r.updates_s = updates / secs;
+    r.coverage  = relevant ? 100.0 * covered / relevant : 100.0;
+    r.far_slots = samples ? (double)far_slots / samples : 0.0;
+    r.flips_s   = (f.stats.entered + f.stats.left - flips_at_warmup) / secs;
+    return r;
+}
+
+int main(void)
+{
+    const Variant variants[] = {
+        { "off",        false, 0.0,                    0 },
+        { "no hyst",    true,  0.0,                    0 },
+        { "filter",     true,  INTEREST_HYSTERESIS_MM, 0 },
+        { "sample 10s", true,  INTEREST_HYSTERESIS_MM, 10000 },
+    };
+    const int counts[] = { 50, 100, 200, 400 };
+
+    printf("Interest filter: %ds, %.0f x %.0f m field, 1 TX/s per node, table %d slots, "
+           "flocking radius %.0f m, filter radius %.0f m (+%.0f m hysteresis)\n\n",
+           SIM_DURATION_S, SIM_FIELD_MM / 1000.0, SIM_FIELD_MM / 1000.0, MAX_NEIGHBOURS,
+           FLOCKING_NEIGHBOUR_RADIUS_MM / 1000.0, INTEREST_RADIUS_MM / 1000.0,
+           INTEREST_HYSTERESIS_MM / 1000.0);
+    printf("%5s | %-10s | %10s | %8s | %9s | %7s\n",
+           "nodes", "filter", "updates/s", "coverage", "far slots", "flips/s");
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); ++v) {
+            Result r = run(counts[c], &variants[v]);
+            printf("%5d | %-10s | %10.1f | %7.1f%% | %9.1f | %7.2f\n",
+                   counts[c], variants[v].name, r.updates_s, r.coverage,
+                   r.far_slots, r.flips_s);
+        }
+    }
+
+    printf("\nupdates/s = verified updates handed to flocking (ring copy + log line each)\n");
+    printf("coverage  = nodes within the flocking radius present in the table with a <= %d ms old state\n",
+           SIM_FRESH_MS);
+    printf("far slots = table entries (mean) held by nodes outside the flocking radius\n");
+    printf("flips/s   = near <-> far transitions of the filter\n");
+    return 0;
+}
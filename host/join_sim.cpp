@@ -0,0 +1,343 @@
+// host/join_sim.cpp
+// Fast join (join.c) against the plain heartbeat start, on the simulated
+// SX1276 channel with listen-before-talk.
+//
+// A stationary swarm in a 300 m square (everyone in range) broadcasts its
+// state on the RADIO_TX_PERIOD_MS heartbeat, +-10% jitter, as tx_policy
+// does when nobody moves. Two scenarios:
+//   - late:     one node powers up into an established swarm. Before, it
+//               sent its first state at once and then waited for the
+//               neighbours' heartbeats; with join it beacons and the
+//               neighbours answer early.
+//   - power-up: the whole swarm boots within one second.
+// Reported, from power-up, over many runs with different seeds:
+//   - heard all: the new node has heard every in-range neighbour once
+//     (power-up: every node has heard every other one)
+//   - known by all: every in-range neighbour has heard the new node
+//   - frames: states sent by the whole swarm in the 10 s after power-up
+//     (the price of the early answers)
+
+#include "sim_radio.h"
+
+extern "C" {
+#include "config.h"
+#include "drone_state.h"
+#include "csma.h"
+#include "congestion.h"
+#include "join.h"
+#include "link_adapt.h"
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define SIM_RUNS            100
+#define SIM_SETTLE_S        30      // Established swarm runs this long first
+#define SIM_HORIZON_S       30      // Measured after power-up
+#define SIM_FRAMES_S        10
+#define SIM_FIELD_M         300.0
+#define SIM_ISR_TO_TASK_US  200
+#define SIM_SF              7
+
+static uint64_t ms_to_us(uint64_t ms) { return ms * 1000; }
+static uint32_t us_to_ms(uint64_t us) { return (uint32_t)(us / 1000); }
+
+enum Mode { MODE_HEARTBEAT, MODE_JOIN, MODE_MAX };
+static const char *const mode_names[MODE_MAX] = { "heartbeat", "join" };
+
+struct Node : SimCsmaNode {
+    uint8_t  held_flag = 0;     // LINK_CFG_JOIN bit of the held state
+    uint64_t next_hb_us = 0;    // tx_policy heartbeat
+    uint64_t check_gen = 0;
+    Congestion cc;              // Load estimate only, heartbeat stays fixed
+    Join       join;
+};
+
+struct Sim : SimCsmaSwarm {
+    std::vector<Node> &nodes;
+    Mode mode;
+    uint32_t frame_us = 0;
+    std::mt19937 rng{};
+
+    std::vector<uint8_t>  in_range{};   // [from * n + to]
+    std::vector<uint64_t> first_rx{};   // [from * n + to], us, 0 = never
+    uint64_t frames_from = 0, frames_to = 0;
+    uint64_t frames = 0;
+
+    Sim(SimChannel &ch, std::vector<Node> &nodes, Mode mode)
+        : SimCsmaSwarm(ch, sizeof(NeighbourState)), nodes(nodes), mode(mode) {}
+
+    size_t idx(int from, int to) const { return (size_t)from * nodes.size() + to; }
+
+    uint64_t heartbeat_us()
+    {
+        std::uniform_real_distribution<double> jit(0.9, 1.1);
+        return (uint64_t)(ms_to_us((uint64_t)RADIO_TX_PERIOD_MS) * jit(rng));
+    }
+
+    void fill_frame(SimCsmaNode &n, uint8_t *f) override
+    {
+        f[2] = (uint8_t)n.id;
+        f[3] = (uint8_t)(n.id >> 8);
+        f[4] = static_cast<Node &>(n).held_flag;
+    }
+
+    void on_sent(SimCsmaNode &n) override
+    {
+        congestion_on_tx(&static_cast<Node &>(n).cc, frame_us);
+        uint64_t now = ch.now_us();
+        if (now >= frames_from && now < frames_to) frames++;
+    }
+
+    void on_rx(SimCsmaNode &sn, const uint8_t *buf, size_t len, int16_t status) override
+    {
+        Node &n = static_cast<Node &>(sn);
+        if (status == RADIOLIB_ERR_NONE && len == sizeof(NeighbourState)) {
+            congestion_on_rx(&n.cc, &buf[2], frame_us);
+            int from = buf[2] | buf[3] << 8;
+            uint64_t &first = first_rx[idx(from, n.id)];
+            if (first == 0) first = ch.now_us();
+            if (mode == MODE_JOIN && buf[4]) {
+                bool pending = n.join.answer_pending;
+                join_on_request(&n.join, 1, n.cc.stats.senders, n.cc.stats.util,
+                                frame_us / 1000, us_to_ms(ch.now_us()));
+                if (!pending && n.join.answer_pending) check(n);
+            }
+        } else if (status == RADIOLIB_ERR_CRC_MISMATCH) {
+            congestion_on_rx_error(&n.cc, frame_us);
+        }
+    }
+
+    // radio_queue_own_state(): beacons while joining, then answers and the
+    // heartbeat
+    void check(Node &n)
+    {
+        uint64_t now = ch.now_us();
+        uint32_t now_ms = us_to_ms(now);
+
+        bool due;
+        bool unscheduled = false;
+        if (mode == MODE_JOIN && join_active(&n.join)) {
+            due = join_beacon_due(&n.join, now_ms);
+        } else {
+            due = now >= n.next_hb_us;
+            if (!due && mode == MODE_JOIN && join_answer_due(&n.join, now_ms)) {
+                due = unscheduled = true;
+            }
+        }
+
+        uint64_t next;
+        if (n.held) {
+            next = now + ms_to_us(RADIO_TX_CHECK_PERIOD_MS);    // Own state still queued
+        } else {
+            if (due) {
+                n.held_flag = (mode == MODE_JOIN && join_active(&n.join)) ? 1 : 0;
+                if (!unscheduled) n.next_hb_us = now + heartbeat_us();
+                if (mode == MODE_JOIN) join_on_own_state(&n.join, now_ms);
+                hold(n, now_ms + TX_SCHED_OWN_DEADLINE_MS);
+            }
+            next = n.next_hb_us;
+            if (mode == MODE_JOIN) {
+                uint32_t w = join_wait_ms(&n.join, now_ms);
+                if (w != UINT32_MAX) next = std::min(next, now + ms_to_us(w));
+            }
+        }
+        schedule_check(n, std::max(next, now + 1));
+    }
+
+    void schedule_check(Node &n, uint64_t t_us)
+    {
+        uint64_t g = ++n.check_gen;
+        ch.at(t_us, [this, &n, g] {
+            if (n.check_gen == g) check(n);
+        });
+    }
+
+    void on_window(Node &n)
+    {
+        congestion_update(&n.cc, us_to_ms(ch.now_us()));
+        ch.at(ch.now_us() + ms_to_us(CONGESTION_WINDOW_MS), [this, &n] { on_window(n); });
+    }
+
+    void power_up(Node &n)
+    {
+        uint64_t now = ch.now_us();
+        n.radio->startReceive();
+        CongestionConfig cc_cfg;
+        congestion_default_config(&cc_cfg);
+        congestion_init(&n.cc, &cc_cfg, us_to_ms(now));
+        ch.at(now + ms_to_us(CONGESTION_WINDOW_MS), [this, &n] { on_window(n); });
+        join_init(&n.join, 0x3000u + (uint32_t)n.id * 7919u + (uint32_t)rng(), us_to_ms(now));
+        n.next_hb_us = now;     // tx_policy: first state right away
+        check(n);
+    }
+};
+
+struct Trial {
+    std::vector<double> heard;  // Per link into the new node(s), s (< 0: never)
+    std::vector<double> known;  // Per link out of the new node
+    uint64_t frames;
+};
+
+// late: nodes 0..n-2 settle for SIM_SETTLE_S, node n-1 powers up after.
+// Otherwise everyone powers up within the first second.
+static Trial run(int n_nodes, Mode mode, bool late, uint32_t seed)
+{
+    SimChannelConfig cfg;
+    cfg.seed = seed;
+    SimChannel ch(cfg);
+
+    std::vector<Node> nodes(n_nodes);
+    Sim sim(ch, nodes, mode);
+    sim.rng.seed(seed * 31 + 1);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    for (int i = 0; i < n_nodes; ++i) {
+        Node &n = nodes[i];
+        n.id = i;
+        n.radio = std::make_unique<SimRadio>(ch);
+        n.radio->set_position(uni(sim.rng) * SIM_FIELD_M, uni(sim.rng) * SIM_FIELD_M, 20.0);
+        n.radio->begin(868.2f, 250.0f, SIM_SF, 7, 0x12, 14, 10);
+        csma_init(&n.csma, 0x1000u + (uint32_t)i + seed * 977u);
+
+        sim.connect(n, SIM_ISR_TO_TASK_US);
+    }
+    sim.frame_us = nodes[0].radio->getTimeOnAir(sizeof(NeighbourState));
+
+    double floor_db = link_adapt_snr_floor_db(SIM_SF);
+    size_t nn = (size_t)n_nodes;
+    sim.in_range.assign(nn * nn, 0);
+    sim.first_rx.assign(nn * nn, 0);
+    for (size_t i = 0; i < nn; ++i) {
+        for (size_t j = 0; j < nn; ++j) {
+            if (i == j) continue;
+            double snr = ch.mean_rx_power_dbm(*nodes[i].radio, *nodes[j].radio) -
+                         cfg.noise_floor_dbm;
+            sim.in_range[i * nn + j] = snr >= floor_db;
+        }
+    }
+
+    // Established nodes boot spread over a heartbeat, the new one after
+    uint64_t t0 = late ? ms_to_us(SIM_SETTLE_S * 1000ull) : 0;
+    for (int i = 0; i < n_nodes; ++i) {
+        Node *np = &nodes[i];
+        uint64_t at;
+        if (!late) {
+            at = (uint64_t)(uni(sim.rng) * ms_to_us(1000));
+        } else if (i == n_nodes - 1) {
+            at = t0;
+        } else {
+            at = (uint64_t)(uni(sim.rng) * ms_to_us((uint64_t)RADIO_TX_PERIOD_MS));
+        }
+        ch.at(at, [&sim, np] { sim.power_up(*np); });
+    }
+    sim.frames_from = t0;
+    sim.frames_to   = t0 + ms_to_us(SIM_FRAMES_S * 1000ull);
+
+    ch.run_until(t0 + ms_to_us(SIM_HORIZON_S * 1000ull));
+
+    // First reception on each link of interest, from power-up (< 0: never)
+    auto link_times = [&](auto want) {
+        std::vector<double> v;
+        for (size_t from = 0; from < nn; ++from) {
+            for (size_t to = 0; to < nn; ++to) {
+                if (!sim.in_range[from * nn + to] || !want(from, to)) continue;
+                uint64_t t = sim.first_rx[from * nn + to];
+                v.push_back(t >= t0 && t != 0 ? (t - t0) / 1e6 : -1.0);
+            }
+        }
+        return v;
+    };
+
+    size_t joiner = nn - 1;
+    Trial r;
+    if (late) {
+        r.heard = link_times([&](size_t, size_t to) { return to == joiner; });
+        r.known = link_times([&](size_t from, size_t) { return from == joiner; });
+    } else {
+        r.heard = link_times([](size_t, size_t) { return true; });
+        r.known = r.heard;
+    }
+    r.frames = sim.frames;
+    return r;
+}
+
+// Last link heard (-1: not all within SIM_HORIZON_S, counted as the horizon)
+static double all_heard_s(const std::vector<double> &links)
+{
+    double last = 0.0;
+    for (double t : links) {
+        if (t < 0.0) return SIM_HORIZON_S;
+        last = std::max(last, t);
+    }
+    return last;
+}
+
+static double pct(std::vector<double> v, double p)
+{
+    std::sort(v.begin(), v.end());
+    size_t i = std::min(v.size() - 1, (size_t)(p * v.size()));
+    return v[i];
+}
+
+int main(void)
+{
+    SimRadio probe(*new SimChannel());
+    probe.begin(868.2f, 250.0f, SIM_SF, 7, 0x12, 14, 10);
+    printf("Fast join: %d runs each, %.0f m square, heartbeat %.0f ms +-10%%, SF%d "
+           "(airtime %.1f ms), CSMA on; join: %d beacons %d +- %d ms apart, answers "
+           "within >= %d ms, up to %.0f%% busy\n\n",
+           SIM_RUNS, SIM_FIELD_M, (double)RADIO_TX_PERIOD_MS, SIM_SF,
+           probe.getTimeOnAir(sizeof(NeighbourState)) / 1000.0,
+           JOIN_BEACONS, JOIN_BEACON_GAP_MS, JOIN_BEACON_JITTER_MS,
+           JOIN_ANSWER_WINDOW_MS, JOIN_ANSWER_MAX_UTIL * 100.0);
+    printf("%-8s | %5s | %-9s | %17s | %15s | %15s | %6s\n",
+           "scenario", "nodes", "start", "heard 1s/3s/5s", "heard all p50/90",
+           "known all p50/90", "frames");
+
+    const int counts[] = { 10, 20, 40 };
+    for (int late = 1; late >= 0; --late) {
+        for (int n : counts) {
+            for (int m = 0; m < MODE_MAX; ++m) {
+                std::vector<double> heard_all, known_all;
+                uint64_t links = 0, by[3] = {};
+                uint64_t frames = 0;
+                for (uint32_t s = 1; s <= SIM_RUNS; ++s) {
+                    Trial t = run(late ? n + 1 : n, (Mode)m, late, s);
+                    for (double l : t.heard) {
+                        links++;
+                        if (l < 0.0) continue;
+                        by[0] += l <= 1.0;
+                        by[1] += l <= 3.0;
+                        by[2] += l <= 5.0;
+                    }
+                    heard_all.push_back(all_heard_s(t.heard));
+                    known_all.push_back(all_heard_s(t.known));
+                    frames += t.frames;
+                }
+                char fill[32], ha[32], ka[32];
+                snprintf(fill, sizeof(fill), "%.0f/%.0f/%.0f%%", 100.0 * by[0] / links,
+                         100.0 * by[1] / links, 100.0 * by[2] / links);
+                snprintf(ha, sizeof(ha), "%.1f/%.1f s", pct(heard_all, 0.5), pct(heard_all, 0.9));
+                snprintf(ka, sizeof(ka), "%.1f/%.1f s", pct(known_all, 0.5), pct(known_all, 0.9));
+                printf("%-8s | %5d | %-9s | %17s | %15s | %15s | %6.1f\n",
+                       late ? "late" : "power-up", n, mode_names[m], fill, ha, ka,
+                       (double)frames / SIM_RUNS);
+            }
+        }
+    }
+
+    printf("\nlate      = one node powers up into a swarm of <nodes> that has run %d s\n",
+           SIM_SETTLE_S);
+    printf("power-up  = all <nodes> boot within 1 s; every link counts in both directions\n");
+    printf("heard     = in-range neighbours the new node has heard, by time since power-up\n");
+    printf("heard all = new node has heard every in-range neighbour (full table)\n");
+    printf("known all = every in-range neighbour has heard the new node\n");
+    printf("            (not complete within %d s counts as %d s)\n", SIM_HORIZON_S, SIM_HORIZON_S);
+    printf("frames    = states sent by the whole swarm in the first %d s\n", SIM_FRAMES_S);
+    return 0;
+}
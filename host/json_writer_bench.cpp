@@ -0,0 +1,182 @@
+// host/json_writer_bench.cpp
+// Telemetry JSON: the compile-time writer (telem_json.cpp, json_writer.h)
+// against the snprintf format string it replaces (telem_encode_json_printf).
+//
+// Part 1 checks the two give the same bytes and the same return value:
+// random states over the full field ranges, the extremes of every field,
+// and every buffer size around the object's length (too small must give 0
+// from both).
+// Part 2 times both on BENCH_SAMPLES states, best of BENCH_RUNS:
+//   - arena: positions / velocities as flown (5-6 digit values)
+//   - wide:  every field at random over its range (longest numbers)
+// and a TELEM_BATCH_SAMPLES batch (telem_encode_batch), which calls the
+// JSON writer once per sample.
+
+extern "C" {
+#include "config.h"
+#include "telemetry.h"
+}
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define BENCH_SAMPLES   4096
+#define BENCH_RUNS      20
+#define CHECK_SAMPLES   200000
+
+using EncodeFn = size_t (*)(const NeighbourState *, char *, size_t);
+
+static std::mt19937 s_rng(0x5EED);
+
+static uint32_t rnd() { return (uint32_t)s_rng(); }
+
+static NeighbourState random_state(bool wide)
+{
+    NeighbourState n;
+    memset(&n, 0, sizeof(n));
+    n.version    = wide ? (uint8_t)rnd() : VERSION;
+    n.team_id    = wide ? (uint8_t)rnd() : TEAM_ID;
+    for (int i = 0; i < 6; ++i) n.node_id[i] = (uint8_t)rnd();
+    n.seq_number = (uint16_t)rnd();
+    n.ts_s       = wide ? rnd() : 1750000000u + rnd() % 100000u;
+    n.ts_ms      = wide ? (uint16_t)rnd() : (uint16_t)(rnd() % 1000);
+    n.x_mm       = wide ? rnd() : rnd() % 100000u;
+    n.y_mm       = wide ? rnd() : rnd() % 100000u;
+    n.z_mm       = wide ? rnd() : rnd() % 20000u;
+    n.vx_mm_s    = wide ? (int32_t)rnd() : (int32_t)(rnd() % 1601) - 800;
+    n.vy_mm_s    = wide ? (int32_t)rnd() : (int32_t)(rnd() % 1601) - 800;
+    n.vz_mm_s    = wide ? (int32_t)rnd() : (int32_t)(rnd() % 401) - 200;
+    n.yaw_cd     = wide ? (uint16_t)rnd() : (uint16_t)(rnd() % 36000);
+    n.link_cfg   = (uint16_t)rnd();
+    for (int i = 0; i < 4; ++i) n.mac_tag[i] = (uint8_t)rnd();
+    return n;
+}
+
+// Every field 0, 1, 9, 10, ..., its max, and the int32 extremes
+static std::vector<NeighbourState> edge_states()
+{
+    static const uint32_t values[] = {
+        0u, 1u, 9u, 10u, 99u, 100u, 255u, 999u, 1000u, 9999u, 10000u, 65535u,
+        99999u, 100000u, 999999999u, 1000000000u, 2147483647u, 2147483648u,
+        4294967295u, (uint32_t)-1 - 9u, (uint32_t)-10
+    };
+    std::vector<NeighbourState> out;
+    for (uint32_t v : values) {
+        NeighbourState n;
+        memset(&n, (int)(v & 0xFF), sizeof(n));
+        n.version = (uint8_t)v;   n.team_id = (uint8_t)v;
+        n.seq_number = (uint16_t)v;
+        n.ts_s = v;               n.ts_ms = (uint16_t)v;
+        n.x_mm = v;  n.y_mm = v;  n.z_mm = v;
+        n.vx_mm_s = (int32_t)v;   n.vy_mm_s = (int32_t)v;   n.vz_mm_s = (int32_t)v;
+        n.yaw_cd = (uint16_t)v;
+        out.push_back(n);
+    }
+    return out;
+}
+
+static bool same(const NeighbourState &n, size_t size, size_t *len)
+{
+    char a[MAX_JSON_STRING_LENGTH], b[MAX_JSON_STRING_LENGTH];
+    size_t la = telem_encode_json(&n, a, size);
+    size_t lb = telem_encode_json_printf(&n, b, size);
+    if (len) *len = la;
+    return la == lb && (la == 0 || memcmp(a, b, la + 1) == 0);
+}
+
+// -----------------------------------------------------------------------------
+// Timing
+// -----------------------------------------------------------------------------
+static volatile size_t s_sink;
+
+static double time_single(EncodeFn fn, const std::vector<NeighbourState> &states)
+{
+    static char buf[MAX_JSON_STRING_LENGTH];
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        size_t acc = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (const NeighbourState &n : states) acc += fn(&n, buf, sizeof(buf));
+        std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - t0;
+        s_sink = acc;
+        best = std::min(best, dt.count() / states.size());
+    }
+    return best;
+}
+
+static double time_batch(const std::vector<NeighbourState> &states)
+{
+    static uint8_t buf[TELEM_BATCH_BUF_SIZE(TELEM_BATCH_SAMPLES)];
+    const size_t per = TELEM_BATCH_SAMPLES;
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        size_t acc = 0, done = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i + per <= states.size(); i += per, done += per) {
+            acc += telem_encode_batch(TELEM_JSON, &states[i], per, buf, sizeof(buf));
+        }
+        std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - t0;
+        s_sink = acc;
+        best = std::min(best, dt.count() / done);
+    }
+    return best;
+}
+
+int main()
+{
+    // --- Part 1: same bytes ---
+    size_t checked = 0, sized = 0, mismatched = 0, longest = 0;
+    for (const NeighbourState &n : edge_states()) {
+        size_t len;
+        mismatched += !same(n, MAX_JSON_STRING_LENGTH, &len);
+        longest = std::max(longest, len);
+        checked++;
+        for (size_t size = 0; size <= len + 2; ++size, ++sized) mismatched += !same(n, size, nullptr);
+    }
+    for (int i = 0; i < CHECK_SAMPLES; ++i) {
+        NeighbourState n = random_state(i % 2);
+        size_t len;
+        mismatched += !same(n, MAX_JSON_STRING_LENGTH, &len);
+        longest = std::max(longest, len);
+        checked++;
+        if (i % 1000 == 0) {
+            for (size_t size = len - 2; size <= len + 2; ++size, ++sized) {
+                mismatched += !same(n, size, nullptr);
+            }
+        }
+    }
+    printf("Same bytes: %zu states, %zu buffer sizes; %zu differ | longest %zu B (TELEM_JSON_MAX_LEN %d)\n\n",
+           checked, sized, mismatched, longest, TELEM_JSON_MAX_LEN);
+
+    // --- Part 2: speed ---
+    printf("%-6s | %-9s | %9s | %9s | %7s | %s\n", "states", "mode", "snprintf", "writer",
+           "speedup", "writer MB/s");
+    for (int wide = 0; wide < 2; ++wide) {
+        std::vector<NeighbourState> states;
+        size_t bytes = 0;
+        char tmp[MAX_JSON_STRING_LENGTH];
+        for (int i = 0; i < BENCH_SAMPLES; ++i) {
+            states.push_back(random_state(wide));
+            bytes += telem_encode_json(&states.back(), tmp, sizeof(tmp));
+        }
+        double avg = (double)bytes / BENCH_SAMPLES;
+
+        double ref = time_single(telem_encode_json_printf, states);
+        double fast = time_single(telem_encode_json, states);
+        printf("%-6s | %-9s | %6.0f ns | %6.0f ns | %6.1fx | %.0f\n", wide ? "wide" : "arena",
+               "single", ref, fast, ref / fast, avg / fast * 1e3);
+
+        double batch = time_batch(states);
+        printf("%-6s | %-9s | %9s | %6.0f ns | %7s | %.0f\n", wide ? "wide" : "arena",
+               "batch", "", batch, "", avg / batch * 1e3);
+    }
+
+    printf("\nsnprintf = telem_encode_json_printf() per object (the old format string)\n");
+    printf("writer   = telem_encode_json() per object (compile-time member list)\n");
+    printf("batch    = telem_encode_batch(TELEM_JSON) of %d samples, per sample\n", TELEM_BATCH_SAMPLES);
+    return mismatched == 0 && longest <= TELEM_JSON_MAX_LEN ? 0 : 1;
+}
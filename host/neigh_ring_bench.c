@@ -0,0 +1,274 @@
+// host/neigh_ring_bench.c
+// Neighbour update hand-off (neigh_ring.c) against the old 8-deep FIFO.
+//
+// Part 1 replays verified updates at 1 ms resolution: quiet nodes on Poisson
+// schedules, optionally one chatty node (e.g. manoeuvring under
+// send-on-delta at its minimum period, or a burst after an RX backlog). The
+// flocking task drains every FLOCKING_PERIOD_MS. We report how many updates
+// from *other* nodes the hand-off lost and how stale the flocking task's
+// view of each node gets (age of its newest state vs the newest one sent).
+//
+// Part 2 hammers the ring from two threads and checks every popped state is
+// untorn and per-node sequence numbers never go backwards.
+
+#define _GNU_SOURCE
+#include "neigh_ring.h"
+#include "config.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_DURATION_MS   600000
+#define SIM_MAX_NODES     64
+#define FIFO_LENGTH       8         // Old NEIGHBOUR_UPDATE_QUEUE_LENGTH
+
+static uint32_t s_rng = 0x2545F491u;
+
+static double rng_uniform(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return ((double)s_rng + 1.0) / 4294967297.0;
+}
+
+static NeighbourState make_state(int node, uint16_t seq)
+{
+    NeighbourState n;
+    memset(&n, 0, sizeof(n));
+    n.node_id[0] = 0x02;
+    n.node_id[5] = (uint8_t)node;
+    n.seq_number = seq;
+    n.x_mm = n.y_mm = n.z_mm = (uint32_t)node * 65536u + seq;
+    return n;
+}
+
+// -----------------------------------------------------------------------------
+// Part 1: replay
+// -----------------------------------------------------------------------------
+typedef struct {
+    const char *name;
+    int    quiet_nodes;
+    double quiet_hz;
+    double chatty_hz;       // 0 = none
+} Scenario;
+
+typedef struct {
+    uint64_t quiet_sent;
+    uint64_t quiet_lost;     // Updates from quiet nodes that never arrived
+    double   sum_stale_ms;
+    double   max_stale_ms;
+    uint64_t samples;
+} Result;
+
+// Old path: FreeRTOS queue semantics, xQueueSend(.., 0) drops when full
+static NeighbourState s_fifo[FIFO_LENGTH];
+static int s_fifo_head, s_fifo_count;
+
+static void fifo_push(const NeighbourState *n, uint64_t *lost)
+{
+    if (s_fifo_count == FIFO_LENGTH) {
+        (*lost)++;
+        return;
+    }
+    s_fifo[(s_fifo_head + s_fifo_count++) % FIFO_LENGTH] = *n;
+}
+
+static bool fifo_pop(NeighbourState *out)
+{
+    if (s_fifo_count == 0) return false;
+    *out = s_fifo[s_fifo_head];
+    s_fifo_head = (s_fifo_head + 1) % FIFO_LENGTH;
+    s_fifo_count--;
+    return true;
+}
+
+static void run(const Scenario *sc, bool use_ring, Result *r)
+{
+    int nodes = sc->quiet_nodes + (sc->chatty_hz > 0 ? 1 : 0);
+    double   next_ms[SIM_MAX_NODES];
+    uint16_t seq[SIM_MAX_NODES];
+    uint16_t seen_seq[SIM_MAX_NODES];
+    bool     seen[SIM_MAX_NODES];
+
+    memset(r, 0, sizeof(*r));
+    memset(seq, 0, sizeof(seq));
+    memset(seen, 0, sizeof(seen));
+    s_fifo_head = s_fifo_count = 0;
+    neigh_ring_init();
+
+    for (int i = 0; i < nodes; ++i) {
+        next_ms[i] = rng_uniform() * 1000.0;
+    }
+
+    uint32_t last_sent_ms[SIM_MAX_NODES] = {0};
+
+    for (uint32_t t = 0; t < SIM_DURATION_MS; ++t) {
+        for (int i = 0; i < nodes; ++i) {
+            bool chatty = (i == sc->quiet_nodes);
+            while (next_ms[i] <= t) {
+                double hz = chatty ? sc->chatty_hz : sc->quiet_hz;
+                next_ms[i] += chatty ? 1000.0 / hz : -log(rng_uniform()) * 1000.0 / hz;
+
+                NeighbourState n = make_state(i, ++seq[i]);
+                last_sent_ms[i] = t;
+                if (!chatty) r->quiet_sent++;
+
+                if (use_ring) {
+                    neigh_ring_push(&n);
+                } else {
+                    uint64_t lost = 0;
+                    fifo_push(&n, &lost);
+                    if (lost && !chatty) r->quiet_lost++;
+                }
+            }
+        }
+
+        if (t % FLOCKING_PERIOD_MS == 0) {
+            NeighbourState n;
+            while (use_ring ? neigh_ring_pop(&n) : fifo_pop(&n)) {
+                int i = n.node_id[5];
+                if (!seen[i] || (int16_t)(n.seq_number - seen_seq[i]) > 0) {
+                    seen[i] = true;
+                    seen_seq[i] = n.seq_number;
+                }
+            }
+
+            // Staleness: how long the newest sent state has been unknown
+            for (int i = 0; i < sc->quiet_nodes; ++i) {
+                if (!seen[i] || last_sent_ms[i] == 0) continue;
+                double stale = (seen_seq[i] == seq[i]) ? 0.0 : (double)(t - last_sent_ms[i]);
+                r->sum_stale_ms += stale;
+                if (stale > r->max_stale_ms) r->max_stale_ms = stale;
+                r->samples++;
+            }
+        }
+    }
+
+    if (use_ring) {
+        // Coalescing is not loss: only a quiet node's *newest* state matters,
+        // and it can only go missing if it was dropped outright
+        NeighRingStats st;
+        neigh_ring_get_stats(&st);
+        r->quiet_lost = st.dropped;
+    }
+}
+
+static void part1(void)
+{
+    static const Scenario scenarios[] = {
+        { "30 nodes @ 1Hz",              30, 1.0,  0.0 },
+        { "50 nodes @ 1Hz",              50, 1.0,  0.0 },
+        { "30 @ 1Hz + 1 chatty @ 20Hz",  30, 1.0, 20.0 },
+        { "30 @ 1Hz + 1 chatty @ 80Hz",  30, 1.0, 80.0 },
+        { "50 @ 2Hz + 1 chatty @ 80Hz",  50, 2.0, 80.0 },
+    };
+
+    printf("Part 1: %ds replay, flocking drains every %d ms\n\n",
+           SIM_DURATION_MS / 1000, FLOCKING_PERIOD_MS);
+    printf("%-28s | %-11s | %10s | %8s | %13s | %12s\n",
+           "scenario", "hand-off", "quiet sent", "lost %", "mean stale ms", "max stale ms");
+
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); ++i) {
+        for (int ring = 0; ring < 2; ++ring) {
+            Result r;
+            s_rng = 0x2545F491u + (uint32_t)i;      // Same traffic for both
+            run(&scenarios[i], ring, &r);
+            printf("%-28s | %-11s | %10llu | %7.2f%% | %13.1f | %12.0f\n",
+                   ring ? "" : scenarios[i].name, ring ? "neigh_ring" : "FIFO(8)",
+                   (unsigned long long)r.quiet_sent,
+                   100.0 * r.quiet_lost / (double)r.quiet_sent,
+                   r.sum_stale_ms / (double)r.samples, r.max_stale_ms);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Part 2: two-thread consistency
+// -----------------------------------------------------------------------------
+#define STRESS_NS       1000000000ull
+#define STRESS_NODES    48
+
+static atomic_bool s_stop;
+static atomic_bool s_producer_done;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void *producer(void *arg)
+{
+    uint64_t *pushes = arg;
+    uint16_t seq[STRESS_NODES] = {0};
+    uint32_t rng = 12345;
+
+    while (!atomic_load(&s_stop)) {
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        int node = rng % STRESS_NODES;
+        NeighbourState n = make_state(node, ++seq[node]);
+        neigh_ring_push(&n);
+        (*pushes)++;
+        if ((*pushes & 1023) == 0) sched_yield();
+    }
+    atomic_store(&s_producer_done, true);
+    return NULL;
+}
+
+static void part2(void)
+{
+    pthread_t th;
+    uint64_t pushes = 0, pops = 0, torn = 0, backwards = 0;
+    uint16_t last[STRESS_NODES] = {0};
+
+    neigh_ring_init();
+    atomic_store(&s_stop, false);
+    atomic_store(&s_producer_done, false);
+    pthread_create(&th, NULL, producer, &pushes);
+
+    uint64_t end = now_ns() + STRESS_NS;
+    NeighbourState n;
+    while (true) {
+        bool done = atomic_load(&s_producer_done);
+        if (now_ns() > end) atomic_store(&s_stop, true);
+
+        bool got = false;
+        while (neigh_ring_pop(&n)) {
+            got = true;
+            pops++;
+            int node = n.node_id[5];
+            uint32_t expect = (uint32_t)node * 65536u + n.seq_number;
+            if (n.x_mm != expect || n.y_mm != expect || n.z_mm != expect) torn++;
+            if ((int16_t)(n.seq_number - last[node]) <= 0) backwards++;
+            last[node] = n.seq_number;
+        }
+        if (done && !got) break;
+        if (!got) sched_yield();
+    }
+    pthread_join(th, NULL);
+
+    NeighRingStats st;
+    neigh_ring_get_stats(&st);
+    printf("\nPart 2: 2 threads, %d nodes, %.1fs\n", STRESS_NODES, STRESS_NS / 1e9);
+    printf("  pushed %llu, popped %llu, coalesced %lu, dropped %lu\n",
+           (unsigned long long)pushes, (unsigned long long)pops,
+           (unsigned long)st.coalesced, (unsigned long)st.dropped);
+    printf("  torn states: %llu, out-of-order: %llu, pushed - coalesced - popped: %ld\n",
+           (unsigned long long)torn, (unsigned long long)backwards,
+           (long)st.pushed - (long)st.coalesced - (long)st.popped);
+}
+
+int main(void)
+{
+    part1();
+    part2();
+    return 0;
+}
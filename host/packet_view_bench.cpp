@@ -0,0 +1,241 @@
+// host/packet_view_bench.cpp
+// RX verifier front end on packet views (packet_view.h) against the old
+// struct-copy path.
+//
+// Frames sit in RxFrame slots as rx_verify_task sees them. Both paths run
+// verify_frame()'s checks before the CMAC: length / hops, own MAC, relay
+// duplicate filter (relay.c). Frames that pass are "verified" and marked
+// seen; the CMAC itself is left out, it reads the same 44 bytes either way.
+//   - copy: memcpy the slot into a NeighbourState first, check the struct
+//   - view: check the slot in place, decode a NeighbourState only for
+//     frames that passed
+// The share of relayed duplicates varies; with multi-hop relay most copies a
+// node hears are duplicates, which the view path rejects without a copy.
+//
+// Part 2 checks the codec: view fields against the packed struct, and
+// encode(decode(frame)) == frame for random frames.
+
+#include "packet_view.h"
+
+extern "C" {
+#include "config.h"
+#include "relay.h"
+#include "rx_ring.h"
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define BENCH_FRAMES    4096        // Fits in cache, like the ring slots
+#define BENCH_PASSES    256
+#define BENCH_RUNS      7
+#define BENCH_NODES     64
+
+static const uint8_t OWN_MAC[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0xFF };
+
+static volatile uint32_t s_sink;
+
+static void make_frame(RxFrame *f, std::mt19937 &rng, int node, uint16_t seq, int hops)
+{
+    NeighbourState n;
+    uint8_t *raw = (uint8_t *)&n;
+    for (size_t i = 0; i < sizeof(n); ++i) raw[i] = (uint8_t)rng();
+    n.version = VERSION;
+    n.node_id[0] = 0x02;
+    memset(&n.node_id[1], 0, 4);
+    n.node_id[5] = (uint8_t)node;
+    n.seq_number = seq;
+
+    memset(f, 0, sizeof(*f));
+    wire::NeighbourWriter(f->data).encode(n);
+    if (hops > 0) {
+        f->data[RELAY_HOPS_OFFSET] = (uint8_t)hops;
+        f->len = RELAY_FRAME_LEN;
+    } else {
+        f->len = sizeof(NeighbourState);
+    }
+}
+
+// dup_share of the frames repeat one of the last few states (relayed copies),
+// 1% are our own state coming back
+static std::vector<RxFrame> make_traffic(double dup_share)
+{
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    std::vector<RxFrame> frames(BENCH_FRAMES);
+    uint16_t seq[BENCH_NODES] = {};
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        double u = uni(rng);
+        if (u < 0.01) {
+            make_frame(&frames[i], rng, 0xFF, (uint16_t)i, 1);
+        } else if (u < 0.01 + dup_share && i >= 8) {
+            frames[i] = frames[i - 1 - rng() % 8];
+            if (frames[i].len == sizeof(NeighbourState)) {
+                frames[i].data[RELAY_HOPS_OFFSET] = 1;
+                frames[i].len = RELAY_FRAME_LEN;
+            }
+        } else {
+            int node = (int)(rng() % BENCH_NODES);
+            make_frame(&frames[i], rng, node, seq[node]++, 0);
+        }
+    }
+    return frames;
+}
+
+static void relay_fresh(Relay *r)
+{
+    RelayConfig cfg;
+    relay_default_config(&cfg);
+    relay_init(r, &cfg, 1);
+}
+
+// Old verify_frame() front end
+static uint32_t run_copy(const std::vector<RxFrame> &frames, Relay *r)
+{
+    uint32_t kept = 0, acc = 0;
+    for (const RxFrame &f : frames) {
+        if (relay_frame_hops(f.data, f.len) < 0) continue;
+
+        NeighbourState rx;
+        memcpy(&rx, f.data, sizeof(rx));
+        if (memcmp(rx.node_id, OWN_MAC, 6) == 0) continue;
+        if (relay_is_duplicate(r, f.data, rx.node_id, rx.seq_number)) continue;
+        relay_mark_seen(r, rx.node_id, rx.seq_number);
+
+        acc += rx.x_mm ^ rx.seq_number ^ rx.link_cfg;
+        kept++;
+    }
+    s_sink = acc;
+    return kept;
+}
+
+// verify_frame() on a view of the slot
+static uint32_t run_view(const std::vector<RxFrame> &frames, Relay *r)
+{
+    uint32_t kept = 0, acc = 0;
+    for (const RxFrame &f : frames) {
+        if (relay_frame_hops(f.data, f.len) < 0) continue;
+
+        wire::NeighbourView v(f.data);
+        if (v.from(OWN_MAC)) continue;
+        if (relay_is_duplicate(r, f.data, v.node_id(), v.seq_number())) continue;
+        relay_mark_seen(r, v.node_id(), v.seq_number());
+
+        NeighbourState rx;
+        v.decode(&rx);
+        acc += rx.x_mm ^ rx.seq_number ^ rx.link_cfg;
+        kept++;
+    }
+    s_sink = acc;
+    return kept;
+}
+
+template <typename Fn>
+static double best_ns_per_frame(const std::vector<RxFrame> &frames, Fn fn, uint32_t *kept)
+{
+    double best = 1e30;
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        double ns = 0.0;
+        for (int pass = 0; pass < BENCH_PASSES; ++pass) {
+            Relay r;
+            relay_fresh(&r);
+            auto t0 = std::chrono::steady_clock::now();
+            *kept = fn(frames, &r);
+            auto t1 = std::chrono::steady_clock::now();
+            ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        }
+        best = std::min(best, ns / ((double)BENCH_PASSES * frames.size()));
+    }
+    return best;
+}
+
+// Field reads alone (sender, seq, link_cfg as the filters use them), to
+// separate the copy from the duplicate filter
+static uint32_t fields_copy(const std::vector<RxFrame> &frames, Relay *)
+{
+    uint32_t acc = 0;
+    for (const RxFrame &f : frames) {
+        NeighbourState rx;
+        memcpy(&rx, f.data, sizeof(rx));
+        acc += rx.node_id[5] ^ rx.seq_number ^ rx.link_cfg;
+    }
+    s_sink = acc;
+    return (uint32_t)frames.size();
+}
+
+static uint32_t fields_view(const std::vector<RxFrame> &frames, Relay *)
+{
+    uint32_t acc = 0;
+    for (const RxFrame &f : frames) {
+        wire::NeighbourView v(f.data);
+        acc += v.node_id()[5] ^ v.seq_number() ^ v.link_cfg();
+    }
+    s_sink = acc;
+    return (uint32_t)frames.size();
+}
+
+// -----------------------------------------------------------------------------
+// Part 2: codec
+// -----------------------------------------------------------------------------
+static bool check_codec(void)
+{
+    std::mt19937 rng(9);
+    for (int i = 0; i < 100000; ++i) {
+        uint8_t frame[sizeof(NeighbourState)];
+        for (uint8_t &b : frame) b = (uint8_t)rng();
+
+        NeighbourState packed, decoded;
+        memcpy(&packed, frame, sizeof(packed));     // Host is little-endian
+        wire::NeighbourView v(frame);
+        v.decode(&decoded);
+        if (memcmp(&packed, &decoded, sizeof(packed)) != 0) return false;
+        if (v.seq_number() != packed.seq_number || v.vz_mm_s() != packed.vz_mm_s ||
+            v.link_cfg() != packed.link_cfg || v.ts_s() != packed.ts_s) return false;
+
+        uint8_t again[sizeof(NeighbourState)];
+        wire::NeighbourWriter(again).encode(decoded);
+        if (memcmp(again, frame, sizeof(frame)) != 0) return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    printf("RX verifier front end: %u frames x %d passes from %d nodes, best of %d runs, "
+           "CMAC excluded (same bytes in both paths)\n\n",
+           BENCH_FRAMES, BENCH_PASSES, BENCH_NODES, BENCH_RUNS);
+    printf("%9s | %6s | %12s | %12s | %7s\n", "dup share", "kept", "copy", "view", "speedup");
+
+    const double shares[] = { 0.0, 0.5, 0.8 };
+    for (double d : shares) {
+        std::vector<RxFrame> frames = make_traffic(d);
+        uint32_t kept_copy, kept_view;
+        double copy = best_ns_per_frame(frames, run_copy, &kept_copy);
+        double view = best_ns_per_frame(frames, run_view, &kept_view);
+        if (kept_copy != kept_view) {
+            printf("MISMATCH: copy kept %u, view kept %u\n", kept_copy, kept_view);
+            return 1;
+        }
+        printf("%8.0f%% | %5.1f%% | %7.1f ns/fr | %7.1f ns/fr | %6.2fx\n",
+               d * 100.0, 100.0 * kept_view / frames.size(), copy, view, copy / view);
+    }
+
+    std::vector<RxFrame> frames = make_traffic(0.0);
+    uint32_t n;
+    double copy = best_ns_per_frame(frames, fields_copy, &n);
+    double view = best_ns_per_frame(frames, fields_view, &n);
+    printf("%9s | %6s | %7.1f ns/fr | %7.1f ns/fr | %6.2fx\n",
+           "fields", "-", copy, view, copy / view);
+
+    bool ok = check_codec();
+    printf("\ncodec: view == packed struct, encode(decode(f)) == f: %s\n", ok ? "OK" : "FAIL");
+    printf("\ndup share = relayed copies of a state already verified\n");
+    printf("kept      = frames that would go on to the CMAC\n");
+    printf("fields    = sender, seq and link_cfg read from the slot, no filter\n");
+    return ok ? 0 : 1;
+}
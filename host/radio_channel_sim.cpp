@@ -0,0 +1,253 @@
+// host/radio_channel_sim.cpp
+// Runs dozens of radio stacks on the simulated SX1276 channel (sim_radio.h)
+// and reports delivery, collisions and throughput.
+//
+// Each node runs the same loop as radio_task in comms_lora.cpp: DIO0 wakes
+// the task (after a small ISR -> task latency), TxDone re-arms RX, RxDone
+// drops echoes within 50 ms of our own TX, then readData() and re-arm. Nodes
+// broadcast one NeighbourState-sized frame per period with +-10% jitter, i.e.
+// unslotted ALOHA, which is what the firmware does today.
+//
+//   radio_channel_sim                          -> scenario table
+//   radio_channel_sim <nodes> <extent_m> <period_ms> <sf>
+
+#include "sim_radio.h"
+
+extern "C" {
+#include "config.h"
+#include "drone_state.h"
+#include "link_adapt.h"
+}
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define SIM_DURATION_S        600
+#define SIM_WARMUP_S          10
+#define SIM_ISR_TO_TASK_US    200
+#define SIM_ECHO_GUARD_US     50000
+#define SIM_PAYLOAD_B         sizeof(NeighbourState)
+#define SIM_FREQ_MHZ          868.2f
+#define SIM_BW_KHZ            250.0f
+#define SIM_CR                7
+#define SIM_PREAMBLE          10
+#define SIM_POWER_DBM         14
+
+struct Scenario {
+    const char *name;
+    int      nodes;
+    double   extent_m;      // Side of the square area
+    double   height_m;      // Altitude spread
+    uint32_t period_ms;
+    uint8_t  sf;
+};
+
+struct Node {
+    std::unique_ptr<SimRadio> radio;
+    int      id = 0;
+    bool     transmitting = false;
+    uint64_t last_tx_end_us = 0;
+    uint16_t seq = 0;
+};
+
+struct Result {
+    uint64_t sent;
+    uint64_t expected;      // Sum over sent packets of receivers in range
+    uint64_t delivered;     // ... of which actually received
+    uint64_t crc_errors;
+    uint64_t echo_drops;
+};
+
+static void run(const Scenario &sc, SimChannelStats &stats, Result &res)
+{
+    SimChannelConfig cfg;
+    cfg.seed = 7;
+    SimChannel ch(cfg);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    std::vector<Node> nodes(sc.nodes);
+    for (int i = 0; i < sc.nodes; ++i) {
+        Node &n = nodes[i];
+        n.id = i;
+        n.radio = std::make_unique<SimRadio>(ch);
+        n.radio->set_position(uni(rng) * sc.extent_m, uni(rng) * sc.extent_m,
+                              uni(rng) * sc.height_m);
+        n.radio->begin(SIM_FREQ_MHZ, SIM_BW_KHZ, sc.sf, SIM_CR, 0x12,
+                       SIM_POWER_DBM, SIM_PREAMBLE);
+        n.radio->setCRC(true);
+    }
+
+    // Which links clear sensitivity on average (the "should hear" set)
+    std::vector<std::vector<bool>> in_range(sc.nodes, std::vector<bool>(sc.nodes));
+    std::vector<int> fanout(sc.nodes, 0);
+    for (int i = 0; i < sc.nodes; ++i) {
+        for (int j = 0; j < sc.nodes; ++j) {
+            if (i == j) continue;
+            double snr = ch.mean_rx_power_dbm(*nodes[i].radio, *nodes[j].radio) -
+                         cfg.noise_floor_dbm;
+            in_range[i][j] = snr >= link_adapt_snr_floor_db(sc.sf);
+            if (in_range[i][j]) fanout[i]++;
+        }
+    }
+
+    const uint64_t warmup_us = (uint64_t)SIM_WARMUP_S * 1000000;
+    const uint64_t end_us    = (uint64_t)SIM_DURATION_S * 1000000;
+    res = Result{};
+
+    // --- radio_task equivalent ---
+    auto on_dio0 = [&](Node &n) {
+        SimRadio &r = *n.radio;
+        if (n.transmitting) {
+            n.transmitting = false;
+            n.last_tx_end_us = ch.now_us();
+            r.startReceive();
+            return;
+        }
+        if (ch.now_us() - n.last_tx_end_us < SIM_ECHO_GUARD_US) {
+            res.echo_drops += ch.now_us() > warmup_us;
+            r.startReceive();
+            return;
+        }
+        uint8_t buf[64];
+        size_t len = r.getPacketLength();
+        if (len > sizeof(buf)) len = sizeof(buf);
+        int16_t st = r.readData(buf, len);
+        if (st == RADIOLIB_ERR_NONE && len == SIM_PAYLOAD_B) {
+            uint16_t from;
+            memcpy(&from, buf, sizeof(from));
+            if (from < sc.nodes && in_range[from][n.id] && ch.now_us() > warmup_us) {
+                res.delivered++;
+            }
+        } else if (st == RADIOLIB_ERR_CRC_MISMATCH) {
+            res.crc_errors += ch.now_us() > warmup_us;
+        }
+        r.startReceive();
+    };
+
+    std::function<void(Node &)> on_tx_timer = [&](Node &n) {
+        if (!n.transmitting) {
+            uint8_t pkt[SIM_PAYLOAD_B] = {0};
+            uint16_t from = (uint16_t)n.id;
+            memcpy(pkt, &from, sizeof(from));
+            memcpy(pkt + 2, &n.seq, sizeof(n.seq));
+            n.seq++;
+
+            if (n.radio->startTransmit(pkt, sizeof(pkt)) == RADIOLIB_ERR_NONE) {
+                n.transmitting = true;
+                if (ch.now_us() > warmup_us) {
+                    res.sent++;
+                    res.expected += fanout[n.id];
+                }
+            }
+        }
+        double jitter = 0.9 + 0.2 * uni(rng);
+        uint64_t next = ch.now_us() + (uint64_t)(sc.period_ms * 1000.0 * jitter);
+        ch.at(next, [&n, &on_tx_timer] { on_tx_timer(n); });
+    };
+
+    for (Node &n : nodes) {
+        Node *np = &n;
+        n.radio->setDio0Action([&ch, np, &on_dio0] {
+            ch.at(ch.now_us() + SIM_ISR_TO_TASK_US, [np, &on_dio0] { on_dio0(*np); });
+        }, 0);
+        n.radio->startReceive();
+
+        uint64_t first = (uint64_t)(uni(rng) * sc.period_ms * 1000.0);
+        ch.at(first, [np, &on_tx_timer] { on_tx_timer(*np); });
+    }
+
+    ch.run_until(warmup_us);
+    SimChannelStats base = ch.stats();
+    ch.run_until(end_us);
+
+    // Channel counters for the measured part only
+    const SimChannelStats &s = ch.stats();
+    stats.tx_started        = s.tx_started - base.tx_started;
+    stats.tx_airtime_us     = s.tx_airtime_us - base.tx_airtime_us;
+    stats.rx_ok             = s.rx_ok - base.rx_ok;
+    stats.rx_collision      = s.rx_collision - base.rx_collision;
+    stats.rx_captured       = s.rx_captured - base.rx_captured;
+    stats.rx_lock_stolen    = s.rx_lock_stolen - base.rx_lock_stolen;
+    stats.rx_lost           = s.rx_lost - base.rx_lost;
+    stats.rx_aborted        = s.rx_aborted - base.rx_aborted;
+    stats.rx_half_duplex    = s.rx_half_duplex - base.rx_half_duplex;
+    stats.rx_busy           = s.rx_busy - base.rx_busy;
+    stats.below_sensitivity = s.below_sensitivity - base.below_sensitivity;
+}
+
+static void print_header(void)
+{
+    printf("%-16s | %5s | %4s | %6s | %6s | %8s | %7s | %7s | %7s | %7s | %9s\n",
+           "scenario", "nodes", "SF", "load G", "ALOHA", "delivery", "collis.",
+           "capture", "half-dx", "busy", "goodput/s");
+}
+
+static void print_row(const Scenario &sc, const SimChannelStats &s, const Result &r,
+                      double airtime_us)
+{
+    double measured_s = SIM_DURATION_S - SIM_WARMUP_S;
+    // Offered load seen by one receiver: other nodes' airtime per unit time
+    double g = (sc.nodes - 1) * airtime_us / (sc.period_ms * 1000.0);
+    double aloha = std::exp(-2.0 * g);
+    double delivery = r.expected ? (double)r.delivered / r.expected : 0.0;
+
+    printf("%-16s | %5d | SF%-2u | %6.2f | %5.1f%% | %7.1f%% | %7llu | %7llu | %7llu | %7llu | %9.1f\n",
+           sc.name, sc.nodes, (unsigned)sc.sf, g, 100.0 * aloha, 100.0 * delivery,
+           (unsigned long long)s.rx_collision, (unsigned long long)s.rx_captured,
+           (unsigned long long)s.rx_half_duplex, (unsigned long long)s.rx_busy,
+           r.delivered / measured_s);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<Scenario> scenarios;
+
+    if (argc == 5) {
+        scenarios.push_back({ "custom", atoi(argv[1]), atof(argv[2]), 50.0,
+                              (uint32_t)atoi(argv[3]), (uint8_t)atoi(argv[4]) });
+    } else {
+        const uint32_t p = (uint32_t)RADIO_TX_PERIOD_MS;
+        scenarios = {
+            { "cell 300m",  5,   300.0,  50.0, p, 9 },
+            { "cell 300m",  10,  300.0,  50.0, p, 9 },
+            { "cell 300m",  20,  300.0,  50.0, p, 9 },
+            { "cell 300m",  40,  300.0,  50.0, p, 9 },
+            { "cell 300m",  80,  300.0,  50.0, p, 9 },
+            { "cell 300m",  40,  300.0,  50.0, p, 7 },
+            { "cell 300m",  80,  300.0,  50.0, p, 7 },
+            { "field 8km",  40,  8000.0, 100.0, p, 9 },
+            { "field 8km",  80,  8000.0, 100.0, p, 9 },
+            { "field 8km",  80,  8000.0, 100.0, p, 7 },
+        };
+    }
+
+    printf("SX1276 channel simulation: %ds per scenario, %zu B frames, "
+           "BW %.0f kHz, CR 4/%d, %d dBm, period %u ms +-10%%\n\n",
+           SIM_DURATION_S, (size_t)SIM_PAYLOAD_B, SIM_BW_KHZ, SIM_CR,
+           SIM_POWER_DBM, scenarios[0].period_ms);
+    print_header();
+
+    for (const Scenario &sc : scenarios) {
+        SimChannel probe;
+        SimRadio r(probe);
+        r.begin(SIM_FREQ_MHZ, SIM_BW_KHZ, sc.sf, SIM_CR, 0x12, SIM_POWER_DBM, SIM_PREAMBLE);
+
+        SimChannelStats stats{};
+        Result res{};
+        run(sc, stats, res);
+        print_row(sc, stats, res, r.getTimeOnAir(SIM_PAYLOAD_B));
+    }
+
+    printf("\nload G: other nodes' airtime per second at one receiver. ALOHA: e^-2G.\n"
+           "delivery: frames received / (frames sent x receivers in range).\n"
+           "collis./capture: receptions lost to / surviving overlap (per receiver).\n"
+           "half-dx: decodable frames missed while transmitting.\n");
+    return 0;
+}
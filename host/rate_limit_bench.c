@@ -0,0 +1,342 @@
+// host/rate_limit_bench.c
+// Rate limiting in the RX verifier under attacker.c's FLOOD, sent from more
+// and more identities at once.
+//
+// Trace: SIM_LEGIT neighbours send a heartbeat every SIM_LEGIT_PERIOD_MS
+// (+-10%) and, every SIM_BURST_EVERY_MS, a manoeuvre burst of SIM_BURST
+// frames RADIO_TX_MIN_PERIOD_MS apart (send-on-delta at its rate cap).
+// From SIM_ATTACK_START_MS, each of N attacker identities runs the FLOOD
+// of attacker.c: 1000 correctly signed frames at 50 Hz. Frames go straight
+// into the verifier, whatever the channel could carry.
+// Policies:
+//   - gap:     before; a fixed DDOS_RATE_LIMIT_MS gap per sender, checked
+//              before the CMAC (as admit.c did) and after it
+//   - bucket:  admit.c + per-sender token buckets (SEC_NODE_RATE_PER_S,
+//              burst SEC_NODE_BURST) + the global SEC_VERIFY_PER_S budget
+// Each frame is timed on its own (clock pair overhead subtracted), best of
+// BENCH_RUNS per frame.
+// Reported:
+//   - CMAC/s:  verifications per second, mean / worst second of the flood
+//   - CPU:     verifier time in the worst second (host)
+//   - legit:   neighbour frames accepted; burst: of the frames sent inside
+//              a burst
+
+#include "admit.h"
+#include "cmac.h"
+#include "sec_table.h"
+#include "token_bucket.h"
+#include "config.h"
+#include "drone_state.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DDOS_RATE_LIMIT_MS  1000    // The old fixed gap
+#define BENCH_RUNS          5
+
+#define SIM_DURATION_S      40
+#define SIM_LEGIT           20
+#define SIM_LEGIT_PERIOD_MS 1200
+#define SIM_BURST_EVERY_MS  10000
+#define SIM_BURST           3
+#define SIM_ATTACK_START_MS 5000
+#define SIM_FLOOD_FRAMES    1000    // attacker.c
+#define SIM_FLOOD_GAP_MS    20
+
+// security.c s_aes_key
+static const uint8_t KEY[16] = {
+    0x2B, 0x7E, 0x15, 0x16, 0x22, 0xA0, 0xD2, 0xA6,
+    0xAC, 0xF7, 0x19, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+typedef struct {
+    uint8_t  data[sizeof(NeighbourState)];
+    uint32_t rx_ms;
+    bool     legit;
+    bool     burst;
+} Frame;
+
+static Frame    *s_trace;
+static int       s_frames, s_cap;
+static CmacKey   s_key;
+static TokenRate s_node_rate;
+static uint32_t  s_rng;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void make_mac(uint8_t mac[6], uint32_t id, uint8_t kind)
+{
+    mac[0] = 0x02;
+    mac[1] = kind;
+    mac[2] = (uint8_t)(id >> 24);
+    mac[3] = (uint8_t)(id >> 16);
+    mac[4] = (uint8_t)(id >> 8);
+    mac[5] = (uint8_t)id;
+}
+
+// -----------------------------------------------------------------------------
+// TRACE
+// -----------------------------------------------------------------------------
+static void add(const uint8_t mac[6], uint16_t seq, uint32_t t, bool legit, bool burst)
+{
+    if (s_frames == s_cap) {
+        s_cap = s_cap ? 2 * s_cap : 4096;
+        s_trace = realloc(s_trace, (size_t)s_cap * sizeof(Frame));
+    }
+    NeighbourState n;
+    memset(&n, 0, sizeof(n));
+    n.version    = VERSION;
+    n.team_id    = TEAM_ID;
+    memcpy(n.node_id, mac, 6);
+    n.seq_number = seq;
+    n.ts_s       = 1750000000u + t / 1000;
+    n.ts_ms      = (uint16_t)(t % 1000);
+    n.x_mm = 50000; n.y_mm = 50000; n.z_mm = 1000;
+
+    uint8_t tag[CMAC_BLOCK];
+    cmac_compute(&s_key, (const uint8_t *)&n, offsetof(NeighbourState, mac_tag), tag);
+    memcpy(n.mac_tag, tag + 12, 4);
+
+    Frame *f = &s_trace[s_frames++];
+    memcpy(f->data, &n, sizeof(n));
+    f->rx_ms = t;
+    f->legit = legit;
+    f->burst = burst;
+}
+
+static int cmp_rx(const void *a, const void *b)
+{
+    const Frame *x = a, *y = b;
+    return (x->rx_ms > y->rx_ms) - (x->rx_ms < y->rx_ms);
+}
+
+static void build_trace(int attackers)
+{
+    s_frames = 0;
+    s_rng = 0x2545F491u;
+    uint8_t mac[6];
+
+    for (int i = 0; i < SIM_LEGIT; ++i) {
+        make_mac(mac, (uint32_t)i, 0);
+        uint16_t seq = 0;
+        uint32_t t = rng_next() % SIM_LEGIT_PERIOD_MS;
+        uint32_t next_burst = rng_next() % SIM_BURST_EVERY_MS;
+        while (t < SIM_DURATION_S * 1000u) {
+            if (t >= next_burst) {
+                for (int k = 0; k < SIM_BURST; ++k) {
+                    add(mac, ++seq, t + k * RADIO_TX_MIN_PERIOD_MS, true, k > 0);
+                }
+                t += (SIM_BURST - 1) * RADIO_TX_MIN_PERIOD_MS;
+                next_burst += SIM_BURST_EVERY_MS;
+            } else {
+                add(mac, ++seq, t, true, false);
+            }
+            uint32_t jitter = SIM_LEGIT_PERIOD_MS / 10;
+            t += SIM_LEGIT_PERIOD_MS - jitter + rng_next() % (2 * jitter + 1);
+        }
+    }
+
+    for (int a = 0; a < attackers; ++a) {
+        make_mac(mac, (uint32_t)a, 0xAA);
+        uint32_t t = SIM_ATTACK_START_MS + rng_next() % SIM_FLOOD_GAP_MS;
+        for (int k = 0; k < SIM_FLOOD_FRAMES; ++k, t += SIM_FLOOD_GAP_MS) {
+            add(mac, (uint16_t)(k + 1), t, false, false);
+        }
+    }
+    qsort(s_trace, (size_t)s_frames, sizeof(Frame), cmp_rx);
+}
+
+// -----------------------------------------------------------------------------
+// VERIFIER
+// -----------------------------------------------------------------------------
+enum { POLICY_GAP, POLICY_BUCKET, POLICY_MAX };
+static const char *const policy_names[POLICY_MAX] = { "gap", "bucket" };
+
+static bool mac_ok(const uint8_t *frame)
+{
+    uint8_t tag[CMAC_BLOCK];
+    cmac_compute(&s_key, frame, offsetof(NeighbourState, mac_tag), tag);
+    return memcmp(tag + 12, frame + offsetof(NeighbourState, mac_tag), 4) == 0;
+}
+
+// Table side of security_validate_packet(): baseline, rate, timestamp
+static bool validate(SecTable *t, int policy, const NeighbourState *n, uint32_t now_ms)
+{
+    SecEntry *e = sec_table_find(t, n->node_id, now_ms);
+    if (!e) {
+        e = sec_table_insert(t, n->node_id, now_ms);
+        if (!e) return false;
+        token_fill(&e->bucket, &s_node_rate, now_ms);
+        token_take(&e->bucket, &s_node_rate, 0, now_ms);
+        e->last_rx_ms = now_ms;
+        e->last_ts_s  = n->ts_s;
+        e->last_ts_ms = n->ts_ms;
+        sec_table_on_accepted(t, e);
+        return true;
+    }
+    if (policy == POLICY_GAP) {
+        if (now_ms - e->last_rx_ms < DDOS_RATE_LIMIT_MS) return false;
+    } else {
+        if (token_available(&e->bucket, &s_node_rate, now_ms) == 0) return false;
+    }
+    uint64_t old_ms = (uint64_t)e->last_ts_s * 1000 + e->last_ts_ms;
+    uint64_t new_ms = (uint64_t)n->ts_s * 1000 + n->ts_ms;
+    if (new_ms <= old_ms) return false;
+
+    token_take(&e->bucket, &s_node_rate, 0, now_ms);
+    e->last_rx_ms = now_ms;
+    e->last_ts_s  = n->ts_s;
+    e->last_ts_ms = n->ts_ms;
+    sec_table_on_accepted(t, e);
+    return true;
+}
+
+// TRUE if accepted; *cmac if a CMAC ran
+static bool verify(SecTable *t, Admit *a, int policy, const Frame *f, bool *cmac)
+{
+    *cmac = false;
+    const uint8_t *id = f->data + offsetof(NeighbourState, node_id);
+    const SecEntry *known = sec_table_peek(t, id);
+
+    if (policy == POLICY_GAP) {
+        if (known && f->rx_ms - known->last_rx_ms < DDOS_RATE_LIMIT_MS) return false;
+    } else {
+        if (admit_check(a, f->data, known, f->rx_ms) != ADMIT_PASS) return false;
+        if (!admit_take_budget(a, known, f->rx_ms)) return false;
+    }
+
+    *cmac = true;
+    if (!mac_ok(f->data)) {
+        if (policy == POLICY_BUCKET) admit_on_bad_mac(a, id, known, f->rx_ms);
+        return false;
+    }
+    NeighbourState n;
+    memcpy(&n, f->data, sizeof(n));
+    return validate(t, policy, &n, f->rx_ms);
+}
+
+typedef struct {
+    double cmac_mean;       // Per second, during the flood
+    int    cmac_peak;
+    double cpu_peak_us;
+    int    legit, legit_ok;
+    int    burst, burst_ok;
+} RunResult;
+
+static RunResult run(int policy)
+{
+    static SecTable t;
+    static Admit a;
+    SecTableConfig tc;
+    AdmitConfig ac;
+    sec_table_default_config(&tc);
+    admit_default_config(&ac);
+
+    double overhead = 1e30;
+    for (int i = 0; i < 1000; ++i) {
+        double t0 = now_ns(), t1 = now_ns();
+        if (t1 - t0 < overhead) overhead = t1 - t0;
+    }
+
+    static int    cmacs[SIM_DURATION_S + 1];
+    static double cpu_ns[SIM_DURATION_S + 1];
+    memset(cmacs, 0, sizeof(cmacs));
+    memset(cpu_ns, 0, sizeof(cpu_ns));
+
+    double *best = malloc((size_t)s_frames * sizeof(double));
+    bool   *ok   = malloc((size_t)s_frames * sizeof(bool));
+    bool   *cmac = malloc((size_t)s_frames * sizeof(bool));
+    for (int i = 0; i < s_frames; ++i) best[i] = 1e30;
+
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        sec_table_init(&t, &tc, 0xC0FFEEu);
+        admit_init(&a, &ac, 0x5EED);
+        for (int i = 0; i < s_frames; ++i) {
+            double t0 = now_ns();
+            ok[i] = verify(&t, &a, policy, &s_trace[i], &cmac[i]);
+            double dt = now_ns() - t0 - overhead;
+            if (dt < best[i]) best[i] = dt;
+        }
+    }
+
+    RunResult r = { 0 };
+    for (int i = 0; i < s_frames; ++i) {
+        const Frame *f = &s_trace[i];
+        uint32_t sec = f->rx_ms / 1000;
+        if (sec > SIM_DURATION_S) sec = SIM_DURATION_S;
+        cmacs[sec] += cmac[i];
+        cpu_ns[sec] += best[i] > 0 ? best[i] : 0;
+        if (f->legit) {
+            r.legit++;
+            r.legit_ok += ok[i];
+            if (f->burst) {
+                r.burst++;
+                r.burst_ok += ok[i];
+            }
+        }
+    }
+    free(best);
+    free(ok);
+    free(cmac);
+
+    // Flood: attacker.c runs SIM_FLOOD_FRAMES x SIM_FLOOD_GAP_MS
+    int first = SIM_ATTACK_START_MS / 1000 + 1;
+    int last  = (SIM_ATTACK_START_MS + SIM_FLOOD_FRAMES * SIM_FLOOD_GAP_MS) / 1000 - 1;
+    for (int s = first; s <= last; ++s) {
+        r.cmac_mean += cmacs[s];
+        if (cmacs[s] > r.cmac_peak) r.cmac_peak = cmacs[s];
+        if (cpu_ns[s] / 1e3 > r.cpu_peak_us) r.cpu_peak_us = cpu_ns[s] / 1e3;
+    }
+    r.cmac_mean /= last - first + 1;
+    return r;
+}
+
+int main(void)
+{
+    cmac_key_init(&s_key, KEY);
+    token_rate_init(&s_node_rate, SEC_NODE_RATE_PER_S, SEC_NODE_BURST);
+
+    printf("%d neighbours (heartbeat %d ms, %d-frame bursts every %d ms), attacker.c FLOOD "
+           "from N identities, %d senders tracked\n", SIM_LEGIT, SIM_LEGIT_PERIOD_MS,
+           SIM_BURST, SIM_BURST_EVERY_MS, MAX_TRACKED_NODES);
+    printf("bucket: %.1f/s burst %d per sender, %d CMAC/s burst %d (reserve %d) in total\n\n",
+           (double)SEC_NODE_RATE_PER_S, SEC_NODE_BURST, SEC_VERIFY_PER_S, SEC_VERIFY_BURST,
+           SEC_VERIFY_RESERVE);
+    printf("%5s | %-6s | %15s | %9s | %7s | %7s\n", "N", "policy", "CMAC/s mean/max",
+           "CPU max", "legit", "burst");
+
+    const int counts[] = { 0, 1, 4, 16, 64, 256 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        build_trace(counts[c]);
+        for (int p = 0; p < POLICY_MAX; ++p) {
+            RunResult r = run(p);
+            printf("%5d | %-6s | %8.1f/%6d | %6.0f us | %6.1f%% | %6.1f%%\n", counts[c],
+                   policy_names[p], r.cmac_mean, r.cmac_peak, r.cpu_peak_us,
+                   100.0 * r.legit_ok / r.legit, 100.0 * r.burst_ok / r.burst);
+        }
+    }
+
+    printf("\nCMAC/s = verifications run per second while the flood lasts, mean / worst\n");
+    printf("CPU    = verifier time in the worst second of the flood (host)\n");
+    printf("legit  = neighbour frames accepted; burst = of those sent inside a burst\n");
+
+    free(s_trace);
+    cmac_key_free(&s_key);
+    return 0;
+}
@@ -0,0 +1,255 @@
+// host/rate_sketch_bench.c
+// Heavy-hitter detection among unknown senders (rate_sketch.c) as admit.c
+// uses it: every frame from a sender not in the security table is counted
+// by claimed node_id, and dropped if the estimate is above
+// RATE_SKETCH_HEAVY_PER_S.
+//
+// Trace, SIM_DURATION_S long:
+//   - SIM_NEWCOMERS honest nodes not in the table yet, sending at their
+//     cap: a frame every RADIO_TX_MIN_PERIOD_MS (+-10%)
+//   - a fresh-MAC flood: F frames/s, each from a node_id never used before
+//   - K heavy spoofed identities at SIM_HEAVY_PER_S each (attacker.c's
+//     FLOOD runs 50 Hz from one)
+// Frames go straight into the sketch, whatever the channel could carry.
+// Compared with an exact per-node_id table holding the same decayed rate.
+// Reported:
+//   - memory:   sketch, against the exact table at its peak (entries whose
+//               count has not decayed to nothing, SIM_EXACT_ENTRY_B each)
+//   - newcomer: newcomer frames throttled (false positives; an exact
+//               table throttles none)
+//   - fresh:    flood frames throttled (each is its node_id's first frame)
+//   - heavy:    frames of heavy identities throttled, and how long after
+//               an identity starts until its frames are
+//   - ns/frame: sketch cost per frame (host), best of SIM_SEEDS runs with
+//               different seeds; the rates are the mean over them
+
+#include "rate_sketch.h"
+#include "config.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_DURATION_S          30
+#define SIM_NEWCOMERS           20
+#define SIM_HEAVY_PER_S         20
+#define SIM_SEEDS               5
+#define SIM_EXACT_ENTRY_B       16      // node_id, count, last update, padding
+
+typedef enum { KIND_NEWCOMER, KIND_FRESH, KIND_HEAVY } Kind;
+
+typedef struct {
+    uint32_t rx_ms;
+    uint32_t id;
+    uint8_t  kind;
+} Frame;
+
+static Frame   *s_trace;
+static int      s_frames, s_cap;
+static uint32_t s_rng;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void make_mac(uint8_t mac[6], uint32_t id, uint8_t kind)
+{
+    mac[0] = 0x02;
+    mac[1] = kind;
+    mac[2] = (uint8_t)(id >> 24);
+    mac[3] = (uint8_t)(id >> 16);
+    mac[4] = (uint8_t)(id >> 8);
+    mac[5] = (uint8_t)id;
+}
+
+// -----------------------------------------------------------------------------
+// TRACE
+// -----------------------------------------------------------------------------
+static void add(uint32_t t, uint32_t id, Kind kind)
+{
+    if (s_frames == s_cap) {
+        s_cap = s_cap ? 2 * s_cap : 4096;
+        s_trace = realloc(s_trace, (size_t)s_cap * sizeof(Frame));
+    }
+    s_trace[s_frames++] = (Frame){ t, id, (uint8_t)kind };
+}
+
+static int cmp_rx(const void *a, const void *b)
+{
+    const Frame *x = a, *y = b;
+    return (x->rx_ms > y->rx_ms) - (x->rx_ms < y->rx_ms);
+}
+
+static void build_trace(int fresh_per_s, int heavy)
+{
+    s_frames = 0;
+    s_rng = 0x2545F491u;
+    const uint32_t end = SIM_DURATION_S * 1000u;
+
+    for (uint32_t i = 0; i < SIM_NEWCOMERS; ++i) {
+        for (uint32_t t = rng_next() % RADIO_TX_MIN_PERIOD_MS; t < end;
+             t += RADIO_TX_MIN_PERIOD_MS * 9 / 10 + rng_next() % (RADIO_TX_MIN_PERIOD_MS / 5 + 1)) {
+            add(t, i, KIND_NEWCOMER);
+        }
+    }
+
+    // Fresh MACs, evenly spread
+    uint32_t total = (uint32_t)fresh_per_s * SIM_DURATION_S;
+    for (uint32_t i = 0; i < total; ++i) add((uint32_t)((uint64_t)i * end / total), i, KIND_FRESH);
+
+    // Heavy identities, staggered starts over the first half
+    for (uint32_t k = 0; k < (uint32_t)heavy; ++k) {
+        uint32_t t = rng_next() % (end / 2);
+        for (; t < end; t += 1000 / SIM_HEAVY_PER_S) add(t, k, KIND_HEAVY);
+    }
+
+    qsort(s_trace, (size_t)s_frames, sizeof(Frame), cmp_rx);
+}
+
+// -----------------------------------------------------------------------------
+// EXACT REFERENCE
+// -----------------------------------------------------------------------------
+// Live node_ids of an exact table with the sketch's decay: a frame keeps an
+// entry until its count fades below one counter unit
+static int exact_peak_entries(void)
+{
+    uint32_t steps = 1;
+    for (double c = RATE_SKETCH_ONE; c >= 1.0; c *= 7.0 / 8.0) steps++;
+    const uint32_t keep_ms = steps * RATE_SKETCH_STEP_MS;
+
+    // Two pointers over the sorted trace: distinct ids in (t - keep_ms, t]
+    // for every t, by last-seen time per id
+    int peak = 0;
+    size_t n_ids = (size_t)s_frames;
+    uint32_t *last = malloc(3 * n_ids * sizeof(uint32_t));
+    for (size_t i = 0; i < 3 * n_ids; ++i) last[i] = UINT32_MAX;
+    int live = 0, tail = 0;
+    for (int i = 0; i < s_frames; ++i) {
+        const Frame *f = &s_trace[i];
+        while (s_trace[tail].rx_ms + keep_ms <= f->rx_ms) {
+            const Frame *o = &s_trace[tail++];
+            if (last[o->kind * n_ids + o->id] == o->rx_ms) {
+                last[o->kind * n_ids + o->id] = UINT32_MAX;
+                live--;
+            }
+        }
+        uint32_t *l = &last[f->kind * n_ids + f->id];
+        if (*l == UINT32_MAX) live++;
+        *l = f->rx_ms;
+        if (live > peak) peak = live;
+    }
+    free(last);
+    return peak;
+}
+
+// -----------------------------------------------------------------------------
+// RUN
+// -----------------------------------------------------------------------------
+typedef struct {
+    double newcomer, fresh, heavy;  // Throttled, fraction
+    double heavy_ms;                // Mean start to first throttled frame
+    double ns;
+    int    frames;
+} SimResult;
+
+static SimResult run(int heavy)
+{
+    static RateSketch s;
+    RateSketchConfig cfg;
+    rate_sketch_default_config(&cfg);
+    const uint32_t limit = RATE_SKETCH_HEAVY_PER_S * RATE_SKETCH_ONE;
+
+    uint8_t (*macs)[6] = malloc((size_t)s_frames * 6);
+    for (int i = 0; i < s_frames; ++i) make_mac(macs[i], s_trace[i].id, s_trace[i].kind);
+    bool *hit = malloc((size_t)s_frames);
+
+    SimResult r = { .ns = 1e30, .frames = s_frames };
+    for (uint32_t seed = 1; seed <= SIM_SEEDS; ++seed) {
+        rate_sketch_init(&s, &cfg, seed * 0x9E3779B9u, 0);
+        double t0 = now_ns();
+        for (int i = 0; i < s_frames; ++i) {
+            hit[i] = rate_sketch_add(&s, macs[i], s_trace[i].rx_ms) > limit;
+        }
+        double ns = (now_ns() - t0) / s_frames;
+        if (ns < r.ns) r.ns = ns;
+
+        int n[3] = { 0 }, h[3] = { 0 };
+        uint32_t *first = calloc((size_t)heavy + 1, sizeof(uint32_t));
+        uint32_t *caught = calloc((size_t)heavy + 1, sizeof(uint32_t));
+        for (int i = 0; i < s_frames; ++i) {
+            const Frame *f = &s_trace[i];
+            n[f->kind]++;
+            h[f->kind] += hit[i];
+            if (f->kind == KIND_HEAVY) {
+                if (!first[f->id]) first[f->id] = f->rx_ms + 1;
+                if (hit[i] && !caught[f->id]) caught[f->id] = f->rx_ms + 1;
+            }
+        }
+        r.newcomer += n[KIND_NEWCOMER] ? (double)h[KIND_NEWCOMER] / n[KIND_NEWCOMER] : 0;
+        r.fresh    += n[KIND_FRESH] ? (double)h[KIND_FRESH] / n[KIND_FRESH] : 0;
+        r.heavy    += n[KIND_HEAVY] ? (double)h[KIND_HEAVY] / n[KIND_HEAVY] : 0;
+        for (int k = 0; k < heavy; ++k) {
+            r.heavy_ms += caught[k] ? (double)(caught[k] - first[k]) / heavy : NAN;
+        }
+        free(first);
+        free(caught);
+    }
+    r.newcomer /= SIM_SEEDS;
+    r.fresh    /= SIM_SEEDS;
+    r.heavy    /= SIM_SEEDS;
+    r.heavy_ms /= SIM_SEEDS;
+    free(macs);
+    free(hit);
+    return r;
+}
+
+int main(void)
+{
+    printf("%d newcomers (a frame per %d ms), fresh-MAC flood F/s, K identities at %d/s, "
+           "throttled above %d/s, %ds\n", SIM_NEWCOMERS, RADIO_TX_MIN_PERIOD_MS, SIM_HEAVY_PER_S, RATE_SKETCH_HEAVY_PER_S, SIM_DURATION_S);
+    printf("sketch: %d x %d x 16-bit, decay 1/8 per %d ms, %zu B in all\n\n", RATE_SKETCH_DEPTH,
+           RATE_SKETCH_WIDTH, RATE_SKETCH_STEP_MS, sizeof(RateSketch));
+    printf("%6s | %4s | %8s | %8s | %9s | %8s | %13s | %8s\n", "F", "K", "frames/s", "exact",
+           "newcomer", "fresh", "heavy", "ns/frame");
+
+    const int floods[] = { 0, 100, 1000, 10000 };
+    const int heavies[] = { 0, 16, 256 };
+    for (size_t f = 0; f < sizeof(floods) / sizeof(floods[0]); ++f) {
+        for (size_t k = 0; k < sizeof(heavies) / sizeof(heavies[0]); ++k) {
+            build_trace(floods[f], heavies[k]);
+            int entries = exact_peak_entries();
+            SimResult r = run(heavies[k]);
+
+            char heavy[32] = "-";
+            if (heavies[k] > 0) {
+                snprintf(heavy, sizeof(heavy), "%5.1f%% %4.0fms", 100 * r.heavy, r.heavy_ms);
+            }
+            printf("%6d | %4d | %8d | %6.0fKB | %8.2f%% | %7.2f%% | %13s | %8.1f\n", floods[f],
+                   heavies[k], r.frames / SIM_DURATION_S,
+                   entries * (double)SIM_EXACT_ENTRY_B / 1024, 100 * r.newcomer,
+                   100 * r.fresh, heavy, r.ns);
+        }
+    }
+
+    printf("\nexact    = peak memory of an exact per-node_id table (%d B per live node_id)\n",
+           SIM_EXACT_ENTRY_B);
+    printf("newcomer = honest unknown senders' frames throttled (false positives)\n");
+    printf("fresh    = flood frames throttled, each its node_id's first\n");
+    printf("heavy    = heavy identities' frames throttled; mean ms from an identity's first\n");
+    printf("           frame to its first throttled one\n");
+    printf("ns/frame = sketch update per frame, decay steps included (host)\n");
+    return 0;
+}
@@ -0,0 +1,352 @@
+// host/relay_sim.cpp
+// Multi-hop relay (relay.c) on the simulated SX1276 channel: delivery ratio
+// and channel load amplification against the hop limit and suppression.
+//
+// Nodes are spread along a corridor several radio ranges long (a stretched
+// swarm) or packed into one cell, and broadcast their state once per period
+// with jitter. Each node runs relay.c exactly as rx_verify_task / radio_task do:
+// duplicate check before (simulated) CMAC, relay_mark_seen() / relay_consider()
+// after, and
+// due relays are taken when the radio is free, behind our own state and
+// spaced like the tx_sched.c bulk classes (TX_SCHED_BULK_GAP_MS /
+// TX_SCHED_BULK_SHARE_PCT).
+//
+// delivery: (origin, seq) states that reached a node / states x other nodes,
+// split into pairs within direct range (mean SNR above the SF floor) and
+// beyond it. amplification: frames on air per state originated.
+
+#include "sim_radio.h"
+
+extern "C" {
+#include "config.h"
+#include "drone_state.h"
+#include "link_adapt.h"
+#include "relay.h"
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#define SIM_DURATION_S      300
+#define SIM_WARMUP_S        10
+#define SIM_ISR_TO_TASK_US  200
+#define SIM_ECHO_GUARD_US   50000
+#define SIM_FREQ_MHZ        868.2f
+#define SIM_BW_KHZ          250.0f
+#define SIM_SF              7
+#define SIM_CR              7
+#define SIM_PREAMBLE        10
+#define SIM_POWER_DBM       14
+#define SIM_PATH_LOSS_EXP   3.3     // Low altitude, clutter: ~1.4 km range at SF7
+
+static uint64_t ms_to_us(uint64_t ms) { return ms * 1000; }
+
+struct Scenario {
+    const char *name;
+    int      nodes;
+    double   length_m;
+    double   width_m;
+    uint32_t period_ms;
+};
+
+struct Node {
+    std::unique_ptr<SimRadio> radio;
+    std::unique_ptr<Relay>    relay;
+    int      id = 0;
+    uint16_t seq = 0;
+    bool     transmitting = false;
+    bool     tx_is_relay = false;
+    uint64_t tx_start_us = 0;
+    uint64_t last_tx_end_us = 0;
+    uint64_t next_own_us = 0;
+    bool     own_pending = false;
+    uint64_t bulk_ready_us = 0;
+    uint64_t wake_gen = 0;
+};
+
+struct Result {
+    uint64_t originated = 0;
+    uint64_t frames = 0;            // On air, own + relayed
+    uint64_t airtime_us = 0;
+    uint64_t near_expected = 0, near_delivered = 0;
+    uint64_t far_expected = 0,  far_delivered = 0;
+    std::vector<uint32_t> far_latency_ms;
+    RelayStats relay{};
+};
+
+struct Sim {
+    SimChannel &ch;
+    const Scenario &sc;
+    std::vector<Node> nodes;
+    std::vector<std::vector<bool>> near;    // [from][to] within direct range
+    std::mt19937 rng{5};
+
+    // (origin, seq) -> origination time; delivered keys per receiver
+    std::unordered_map<uint32_t, uint64_t> born_us;
+    std::unordered_map<uint64_t, bool> delivered;
+    Result res;
+
+    Sim(SimChannel &c, const Scenario &s) : ch(c), sc(s) {}
+
+    bool measuring() const { return ch.now_us() >= ms_to_us(SIM_WARMUP_S * 1000); }
+
+    uint64_t jittered_period_us()
+    {
+        std::uniform_real_distribution<double> u(0.9, 1.1);
+        return (uint64_t)(u(rng) * ms_to_us(sc.period_ms));
+    }
+
+    void wake(Node &n, uint64_t at_us)
+    {
+        uint64_t g = ++n.wake_gen;
+        Node *np = &n;
+        ch.at(std::max(at_us, ch.now_us()), [this, np, g] {
+            if (np->wake_gen == g) service(*np);
+        });
+    }
+
+    void start_tx(Node &n, const uint8_t *data, size_t len, bool relayed)
+    {
+        if (n.radio->startTransmit(data, len) != RADIOLIB_ERR_NONE) return;
+        n.transmitting = true;
+        n.tx_is_relay  = relayed;
+        n.tx_start_us  = ch.now_us();
+        if (measuring()) {
+            res.frames++;
+            res.airtime_us += n.radio->getTimeOnAir(len);
+        }
+    }
+
+    // radio_task: queue own state / due relays, start the next TX, sleep
+    void service(Node &n)
+    {
+        uint64_t now = ch.now_us();
+        uint32_t now_ms = (uint32_t)(now / 1000);
+
+        if (now >= n.next_own_us) {
+            n.own_pending = true;
+            n.next_own_us = now + jittered_period_us();
+        }
+
+        if (!n.transmitting) {
+            if (n.own_pending) {
+                NeighbourState s{};
+                s.version = VERSION;
+                s.node_id[5] = (uint8_t)n.id;
+                s.seq_number = ++n.seq;
+                born_us[key(n.id, s.seq_number)] = now;
+                if (measuring()) res.originated++;
+                n.own_pending = false;
+                start_tx(n, (const uint8_t *)&s, sizeof(s), false);
+            } else if (now >= n.bulk_ready_us) {
+                uint8_t f[RELAY_FRAME_LEN];
+                if (relay_next(n.relay.get(), f, now_ms)) {
+                    start_tx(n, f, sizeof(f), true);
+                }
+            }
+        }
+
+        uint64_t next = n.next_own_us;
+        uint32_t rw = relay_wait_ms(n.relay.get(), now_ms);
+        if (rw != UINT32_MAX && !n.transmitting) {   // TxDone services us anyway
+            next = std::min(next, std::max(now + ms_to_us(rw), n.bulk_ready_us));
+        }
+        wake(n, next);
+    }
+
+    static uint32_t key(int origin, uint16_t seq) { return (uint32_t)origin << 16 | seq; }
+
+    void on_dio0(Node &n)
+    {
+        uint64_t now = ch.now_us();
+
+        if (n.transmitting) {
+            n.transmitting = false;
+            n.last_tx_end_us = now;
+            uint64_t gap = ms_to_us(TX_SCHED_BULK_GAP_MS);
+            if (n.tx_is_relay) {
+                uint64_t air = now - n.tx_start_us;
+                gap = std::max(gap, air * (100 - TX_SCHED_BULK_SHARE_PCT) / TX_SCHED_BULK_SHARE_PCT);
+            }
+            n.bulk_ready_us = now + gap;
+            n.radio->startReceive();
+            service(n);
+            return;
+        }
+
+        uint8_t buf[64];
+        size_t len = std::min(n.radio->getPacketLength(), sizeof(buf));
+        int16_t st = n.radio->readData(buf, len);
+        n.radio->startReceive();
+        if (st != RADIOLIB_ERR_NONE || now - n.last_tx_end_us < SIM_ECHO_GUARD_US) return;
+
+        // rx_verify_task: verify_frame()
+        int hops = relay_frame_hops(buf, len);
+        if (hops < 0) return;
+        NeighbourState s;
+        memcpy(&s, buf, sizeof(s));
+        int origin = s.node_id[5];
+        if (origin == n.id) return;
+        if (relay_is_duplicate(n.relay.get(), buf, s.node_id, s.seq_number)) return;
+
+        float margin = n.radio->getSNR() - link_adapt_snr_floor_db(SIM_SF);
+        relay_mark_seen(n.relay.get(), s.node_id, s.seq_number);
+        relay_consider(n.relay.get(), buf, (uint8_t)hops, margin, (uint32_t)(now / 1000));
+
+        uint32_t k = key(origin, s.seq_number);
+        auto born = born_us.find(k);
+        if (born != born_us.end() && born->second >= ms_to_us(SIM_WARMUP_S * 1000)) {
+            uint64_t dk = (uint64_t)n.id << 32 | k;
+            if (!delivered[dk]) {
+                delivered[dk] = true;
+                if (!near[origin][n.id]) {
+                    res.far_latency_ms.push_back((uint32_t)((now - born->second) / 1000));
+                }
+            }
+        }
+        service(n);
+    }
+
+    void run(const RelayConfig &rc)
+    {
+        std::uniform_real_distribution<double> uni(0.0, 1.0);
+        nodes.resize(sc.nodes);
+        for (int i = 0; i < sc.nodes; ++i) {
+            Node &n = nodes[i];
+            n.id = i;
+            n.radio = std::make_unique<SimRadio>(ch);
+            n.radio->set_position(uni(rng) * sc.length_m, uni(rng) * sc.width_m,
+                                  20.0 + uni(rng) * 30.0);
+            n.radio->begin(SIM_FREQ_MHZ, SIM_BW_KHZ, SIM_SF, SIM_CR, 0x12,
+                           SIM_POWER_DBM, SIM_PREAMBLE);
+            n.relay = std::make_unique<Relay>();
+            relay_init(n.relay.get(), &rc, 0x1234567u + (uint32_t)i);
+
+            Node *np = &n;
+            n.radio->setDio0Action([this, np] {
+                ch.at(ch.now_us() + SIM_ISR_TO_TASK_US, [this, np] { on_dio0(*np); });
+            }, 0);
+            n.radio->startReceive();
+            n.next_own_us = (uint64_t)(uni(rng) * ms_to_us(sc.period_ms));
+            wake(n, n.next_own_us);
+        }
+
+        float floor_db = link_adapt_snr_floor_db(SIM_SF);
+        near.assign(sc.nodes, std::vector<bool>(sc.nodes, false));
+        for (int a = 0; a < sc.nodes; ++a) {
+            for (int b = 0; b < sc.nodes; ++b) {
+                if (a == b) continue;
+                double snr = ch.mean_rx_power_dbm(*nodes[a].radio, *nodes[b].radio) -
+                             ch.config().noise_floor_dbm;
+                near[a][b] = snr >= floor_db;
+            }
+        }
+
+        uint64_t end_us = ms_to_us((uint64_t)SIM_DURATION_S * 1000);
+        ch.run_until(end_us);
+
+        // States from the last few seconds may still be in flight: skip them
+        uint64_t last_born_us = end_us - ms_to_us(5000);
+        for (const auto &b : born_us) {
+            if (b.second < ms_to_us(SIM_WARMUP_S * 1000) || b.second > last_born_us) continue;
+            int origin = (int)(b.first >> 16);
+            for (int r = 0; r < sc.nodes; ++r) {
+                if (r == origin) continue;
+                bool got = delivered.count((uint64_t)r << 32 | b.first) > 0;
+                if (near[origin][r]) { res.near_expected++; res.near_delivered += got; }
+                else                 { res.far_expected++;  res.far_delivered += got; }
+            }
+        }
+
+        for (const Node &n : nodes) {
+            const RelayStats &s = n.relay->stats;
+            res.relay.duplicates += s.duplicates;
+            res.relay.scheduled  += s.scheduled;
+            res.relay.relayed    += s.relayed;
+            res.relay.suppressed += s.suppressed;
+            res.relay.hop_limited += s.hop_limited;
+            res.relay.skipped    += s.skipped;
+        }
+    }
+};
+
+static uint32_t pct(std::vector<uint32_t> v, double p)
+{
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+int main(void)
+{
+    static const Scenario scenarios[] = {
+        { "corridor 60s", 30, 6000.0, 500.0, 60000 },
+        { "corridor 20s", 30, 6000.0, 500.0, 20000 },
+        { "corridor 5s",  30, 6000.0, 500.0, (uint32_t)RADIO_TX_PERIOD_MS },
+        { "cell 5s",      30, 300.0,  300.0, (uint32_t)RADIO_TX_PERIOD_MS },
+    };
+    // Blind flooding (relay everything once) vs the relay.c defaults
+    struct Variant { uint8_t hops; bool flood; };
+    static const Variant variants[] = {
+        { 1, false },
+        { 2, true }, { 3, true }, { 4, true }, { 6, true },
+        { 2, false }, { 3, false }, { 4, false }, { 6, false },
+    };
+
+    printf("Multi-hop relay: %ds, 30 nodes, SF%d, %d dBm, path loss exp %.1f (corridor "
+           "6 x 0.5 km), state every period +-10%%\n"
+           "relay.c: delay <= %d ms by SNR margin, skip above %.0f dB, suppress at %d copies\n\n",
+           SIM_DURATION_S, SIM_SF, SIM_POWER_DBM, SIM_PATH_LOSS_EXP, RELAY_DELAY_MAX_MS,
+           (double)RELAY_MARGIN_MAX_DB, RELAY_SUPPRESS_COPIES);
+    printf("%-12s | %4s | %-8s | %10s | %12s | %6s | %9s | %8s | %10s | %8s\n",
+           "scenario", "hops", "relay", "near deliv", "beyond deliv", "ampl.",
+           "airtime %", "dup drop", "suppressed", "far p90");
+
+    for (const Scenario &sc : scenarios) {
+        for (const Variant &v : variants) {
+            SimChannelConfig cfg;
+            cfg.path_loss_exp = SIM_PATH_LOSS_EXP;
+            cfg.seed = 9;
+            SimChannel ch(cfg);
+
+            RelayConfig rc;
+            relay_default_config(&rc);
+            rc.max_hops = v.hops;
+            if (v.flood) {
+                rc.suppress_copies = 0;
+                rc.margin_max_db   = 1e9f;
+            }
+
+            Sim sim(ch, sc);
+            sim.run(rc);
+            const Result &r = sim.res;
+
+            double measured_s = SIM_DURATION_S - SIM_WARMUP_S;
+            char beyond[16] = "-";
+            if (r.far_expected) {
+                snprintf(beyond, sizeof(beyond), "%.1f%%", 100.0 * r.far_delivered / r.far_expected);
+            }
+            printf("%-12s | %4u | %-8s | %9.1f%% | %12s | %6.2f | %8.1f%% | %8llu | %10llu | %5u ms\n",
+                   sc.name, v.hops, v.hops == 1 ? "off" : (v.flood ? "flood" : "relay.c"),
+                   100.0 * r.near_delivered / std::max<uint64_t>(1, r.near_expected),
+                   beyond,
+                   (double)r.frames / std::max<uint64_t>(1, r.originated),
+                   100.0 * r.airtime_us / (measured_s * 1e6),
+                   (unsigned long long)r.relay.duplicates,
+                   (unsigned long long)r.relay.suppressed,
+                   pct(r.far_latency_ms, 0.9));
+        }
+        printf("\n");
+    }
+
+    printf("near / beyond: receivers within / outside direct range of the origin.\n"
+           "ampl.: frames on air per state originated. airtime %%: summed over nodes.\n"
+           "dup drop: copies rejected by the duplicate filter before CMAC.\n");
+    return 0;
+}
@@ -0,0 +1,268 @@
+// host/replay_sim.c
+// Replay checks of security_validate_packet(): the old strictly increasing
+// timestamp against the seq_number window (replay_win.c) with freshness.
+//
+// One neighbour sends a signed state every SIM_PERIOD_MS for SIM_DURATION_S,
+// both clocks synced unless noted. Each state reaches us directly
+// (SIM_DIRECT_P, after 0..SIM_DIRECT_MAX_MS) and / or as a relayed copy
+// (SIM_RELAY_P, after SIM_RELAY_MIN_MS..SIM_RELAY_MAX_MS), so copies arrive
+// out of order.
+// Scenarios:
+//   - reorder:  just that
+//   - wrap:     seq_number starts at 65500 and wraps
+//   - reboot:   the sender restarts at SIM_REBOOT_S and counts from 0 again
+//   - unsynced: same, but the sender's clock is not SNTP-synced: its
+//               timestamps count from boot and start over too
+//   - replay:   an attacker re-sends a recorded frame every SIM_REPLAY_MS,
+//               picked at random from everything sent so far
+//   - silent:   clocks not synced; the sender goes quiet at SIM_REBOOT_S
+//               and the attacker replays recorded frames from then on
+// Only the replay logic is modelled (no rate limit, CMAC, physics).
+// Reported:
+//   - accepted: states accepted at least once / states that reached us
+//   - twice:    copies accepted for a state already accepted (replays)
+//   - after reboot: states reaching us after the reboot that were refused
+
+#include "replay_win.h"
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_DURATION_S      300
+#define SIM_PERIOD_MS       1000
+#define SIM_DIRECT_P        0.8
+#define SIM_DIRECT_MAX_MS   50
+#define SIM_RELAY_P         0.6
+#define SIM_RELAY_MIN_MS    200
+#define SIM_RELAY_MAX_MS    2500
+#define SIM_REBOOT_S        150
+#define SIM_REBOOT_GAP_MS   8000
+#define SIM_REPLAY_MS       250
+#define SIM_MAX_RX          8192
+
+static uint32_t s_rng;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double rng_unit(void)
+{
+    return (rng_next() >> 8) / 16777216.0;
+}
+
+// -----------------------------------------------------------------------------
+// TRACE
+// -----------------------------------------------------------------------------
+typedef struct {
+    uint32_t rx_ms;
+    uint64_t ts_ms;     // Sender's unix time, ms
+    uint16_t seq;
+    int      state;     // Index of the state sent
+    bool     replay;
+} Rx;
+
+static Rx  s_rx[SIM_MAX_RX];
+static int s_nrx;
+static int s_states;
+static int s_reboot_state;      // First state after the reboot (-1: none)
+
+enum { SCN_REORDER, SCN_WRAP, SCN_REBOOT, SCN_UNSYNCED, SCN_REPLAY, SCN_SILENT, SCN_MAX };
+static const char *const scn_names[SCN_MAX] = {
+    "reorder", "wrap", "reboot", "unsynced", "replay", "silent"
+};
+
+static const uint64_t EPOCH_MS = 1750000000000ull;
+
+static void push(uint32_t rx_ms, uint64_t ts_ms, uint16_t seq, int state, bool replay)
+{
+    if (s_nrx >= SIM_MAX_RX) return;
+    s_rx[s_nrx++] = (Rx){ rx_ms, ts_ms, seq, state, replay };
+}
+
+static int cmp_rx(const void *a, const void *b)
+{
+    const Rx *x = a, *y = b;
+    return (x->rx_ms > y->rx_ms) - (x->rx_ms < y->rx_ms);
+}
+
+static void build(int scn)
+{
+    s_rng = 0x9E3779B9u;
+    s_nrx = 0;
+    s_states = 0;
+    s_reboot_state = -1;
+
+    uint16_t seq = scn == SCN_WRAP ? 65500 : 0;
+    uint32_t t = 0, boot = 0;
+    static uint64_t sent_ts[SIM_DURATION_S * 1000 / SIM_PERIOD_MS + 16];
+    static uint16_t sent_seq[SIM_DURATION_S * 1000 / SIM_PERIOD_MS + 16];
+
+    uint32_t end = scn == SCN_SILENT ? SIM_REBOOT_S * 1000u : SIM_DURATION_S * 1000u;
+    while (t < end) {
+        if ((scn == SCN_REBOOT || scn == SCN_UNSYNCED) && s_reboot_state < 0 &&
+            t >= SIM_REBOOT_S * 1000u) {
+            t += SIM_REBOOT_GAP_MS;
+            boot = t;
+            seq = 0;
+            s_reboot_state = s_states;
+        }
+        int k = s_states++;
+        sent_ts[k]  = scn == SCN_UNSYNCED || scn == SCN_SILENT ? 1000000u + t - boot
+                                                               : EPOCH_MS + t;
+        sent_seq[k] = ++seq;
+        if (rng_unit() < SIM_DIRECT_P) {
+            push(t + rng_next() % (SIM_DIRECT_MAX_MS + 1), sent_ts[k], seq, k, false);
+        }
+        if (rng_unit() < SIM_RELAY_P) {
+            push(t + SIM_RELAY_MIN_MS + rng_next() % (SIM_RELAY_MAX_MS - SIM_RELAY_MIN_MS + 1),
+                 sent_ts[k], seq, k, false);
+        }
+        t += SIM_PERIOD_MS;
+    }
+
+    if (scn == SCN_REPLAY || scn == SCN_SILENT) {
+        uint32_t from = scn == SCN_SILENT ? end : 5000u;
+        for (uint32_t r = from; r < SIM_DURATION_S * 1000u; r += SIM_REPLAY_MS) {
+            int recorded = (int)(r / SIM_PERIOD_MS);
+            if (recorded > s_states) recorded = s_states;
+            if (recorded < 1) continue;
+            int k = (int)(rng_next() % (uint32_t)recorded);
+            push(r, sent_ts[k], sent_seq[k], k, true);
+        }
+    }
+    qsort(s_rx, (size_t)s_nrx, sizeof(Rx), cmp_rx);
+}
+
+// -----------------------------------------------------------------------------
+// POLICIES
+// -----------------------------------------------------------------------------
+typedef struct {
+    bool         valid;
+    uint64_t     last_ts_ms;
+    uint32_t     last_rx_ms;
+    ReplayWindow win;
+} Peer;
+
+// Before: first frame is the baseline, then time must go up
+static bool old_accept(Peer *p, const Rx *f, uint64_t wall_ms)
+{
+    (void)wall_ms;
+    if (p->valid && f->ts_ms <= p->last_ts_ms) return false;
+    p->valid = true;
+    p->last_ts_ms = f->ts_ms;
+    return true;
+}
+
+// security_validate_packet() steps 2 and 5
+static bool new_accept(Peer *p, const Rx *f, uint64_t wall_ms)
+{
+    bool synced = wall_ms / 1000 >= REPLAY_SYNCED_EPOCH_S &&
+                  f->ts_ms / 1000 >= REPLAY_SYNCED_EPOCH_S;
+    int64_t age = (int64_t)(wall_ms - f->ts_ms);
+    if (synced && llabs(age) > REPLAY_FRESH_MS) return false;
+
+    if (!p->valid) {
+        p->valid = true;
+        p->last_rx_ms = f->rx_ms;
+        p->last_ts_ms = f->ts_ms;
+        replay_reset(&p->win, f->seq);
+        return true;
+    }
+
+    bool resync = false;
+    switch (replay_check(&p->win, f->seq)) {
+    case REPLAY_NEW:
+        if (f->ts_ms + REPLAY_FRESH_MS <= p->last_ts_ms) return false;
+        break;
+    case REPLAY_LATE:
+        break;
+    case REPLAY_SEEN:
+        return false;
+    case REPLAY_OLD:
+        if (!synced || f->ts_ms <= p->last_ts_ms) return false;
+        resync = true;
+        break;
+    }
+
+    p->last_rx_ms = f->rx_ms;
+    if (resync) replay_reset(&p->win, f->seq);
+    else        replay_commit(&p->win, f->seq);
+    if (resync || f->ts_ms > p->last_ts_ms) p->last_ts_ms = f->ts_ms;
+    return true;
+}
+
+typedef struct {
+    int reached;
+    int accepted;
+    int twice;
+    int reboot_reached;
+    int reboot_refused;
+} SimResult;
+
+static SimResult run(bool (*accept)(Peer *, const Rx *, uint64_t))
+{
+    static bool reached[SIM_MAX_RX], got[SIM_MAX_RX];
+    memset(reached, 0, sizeof(reached));
+    memset(got, 0, sizeof(got));
+
+    Peer p;
+    memset(&p, 0, sizeof(p));
+    SimResult r = { 0 };
+
+    for (int i = 0; i < s_nrx; ++i) {
+        const Rx *f = &s_rx[i];
+        bool ok = accept(&p, f, EPOCH_MS + f->rx_ms);
+        if (!f->replay) reached[f->state] = true;
+        if (!ok) continue;
+        if (got[f->state]) r.twice++;
+        got[f->state] = true;
+    }
+
+    for (int k = 0; k < s_states; ++k) {
+        if (!reached[k]) continue;
+        r.reached++;
+        r.accepted += got[k];
+        if (s_reboot_state >= 0 && k >= s_reboot_state) {
+            r.reboot_reached++;
+            r.reboot_refused += !got[k];
+        }
+    }
+    return r;
+}
+
+int main(void)
+{
+    printf("One neighbour, a state every %d ms for %ds, direct %.0f%% (0..%d ms), "
+           "relayed %.0f%% (%d..%d ms), window %d, fresh %d ms\n\n",
+           SIM_PERIOD_MS, SIM_DURATION_S, 100 * SIM_DIRECT_P, SIM_DIRECT_MAX_MS,
+           100 * SIM_RELAY_P, SIM_RELAY_MIN_MS, SIM_RELAY_MAX_MS, REPLAY_WINDOW,
+           REPLAY_FRESH_MS);
+    printf("%-8s | %-6s | %15s | %5s | %12s\n", "scenario", "policy", "accepted",
+           "twice", "after reboot");
+
+    for (int s = 0; s < SCN_MAX; ++s) {
+        build(s);
+        for (int pol = 0; pol < 2; ++pol) {
+            SimResult r = run(pol ? new_accept : old_accept);
+            char reboot[32] = "-";
+            if (s_reboot_state >= 0) {
+                snprintf(reboot, sizeof(reboot), "%d/%d lost", r.reboot_refused, r.reboot_reached);
+            }
+            printf("%-8s | %-6s | %4d/%4d %5.1f%% | %5d | %12s\n", scn_names[s],
+                   pol ? "window" : "time", r.accepted, r.reached,
+                   100.0 * r.accepted / r.reached, r.twice, reboot);
+        }
+    }
+
+    printf("\naccepted     = states accepted / states that reached us (direct or relayed)\n");
+    printf("twice        = copies accepted for a state already accepted (replays)\n");
+    printf("after reboot = states sent after the reboot and refused\n");
+    return 0;
+}
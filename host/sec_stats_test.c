@@ -0,0 +1,391 @@
+// host/sec_stats_test.c
+// Checks of the security path's statistics (sec_stats.c), against exact
+// counts kept next to them:
+//   - rejects:    per-reason counters and accepted frames, NULL node_ids not
+//                 counted as offenders, out-of-range reasons / stages ignored
+//   - stages:     log2 histogram buckets, count / total / max, and
+//                 sec_stats_percentile_us() against the sorted samples
+//   - top:        sec_stats_top() sorted by count, count - error <= true
+//                 count <= count for every listed node_id, every node_id
+//                 with more than 1/SEC_STATS_TOP of the rejections listed,
+//                 and the counts summing to the rejections (space-saving)
+//   - seqlock:    a writer thread updates continuously while the reader
+//                 snapshots. Each snapshot must be whole: rejections ==
+//                 offender counts, hist sums == stage counts, nothing going
+//                 backwards. Plain memcpy copies are checked the same way,
+//                 to show the check sees torn copies at all.
+// Exits nonzero if any check fails.
+
+#include "sec_stats.h"
+#include "config.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TOP_NODES       200
+#define TOP_REJECTS     200000
+#define STAGE_SAMPLES   100000
+#define STRESS_NS       1000000000ull
+
+static uint32_t s_rng = 0x9E3779B9u;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static void make_id(uint8_t id[6], uint32_t k)
+{
+    id[0] = 0x02;
+    id[1] = 0x5E;
+    id[2] = (uint8_t)(k >> 24);
+    id[3] = (uint8_t)(k >> 16);
+    id[4] = (uint8_t)(k >> 8);
+    id[5] = (uint8_t)k;
+}
+
+static uint32_t id_key(const uint8_t id[6])
+{
+    return (uint32_t)id[2] << 24 | (uint32_t)id[3] << 16 | (uint32_t)id[4] << 8 | id[5];
+}
+
+static int s_failed_total;
+
+static void report(const char *check, unsigned long cases, unsigned long failed)
+{
+    printf("%-9s | %9lu | %6lu\n", check, cases, failed);
+    s_failed_total += failed != 0;
+}
+
+// -----------------------------------------------------------------------------
+// Rejects
+// -----------------------------------------------------------------------------
+static void check_rejects(void)
+{
+    SecStats s;
+    sec_stats_init(&s);
+    uint32_t want[SEC_REJ_REASONS] = {0};
+    uint32_t want_accepted = 0, with_id = 0;
+    unsigned long cases = 0, failed = 0;
+
+    for (int i = 0; i < 50000; ++i) {
+        uint32_t r = rng_next();
+        if (r % 5 == 0) {
+            sec_stats_accept(&s);
+            want_accepted++;
+            continue;
+        }
+        SecReject why = (SecReject)(r % SEC_REJ_REASONS);
+        uint8_t id[6];
+        make_id(id, r % 37);
+        bool named = (r >> 8) % 4 != 0;
+        sec_stats_reject(&s, why, named ? id : NULL);
+        want[why]++;
+        with_id += named;
+    }
+    sec_stats_reject(&s, SEC_REJ_REASONS, NULL);        // Ignored
+    sec_stats_time(&s, SEC_STAGES, 10);                 // Ignored
+
+    for (int r = 0; r < SEC_REJ_REASONS; ++r) {
+        cases++;
+        failed += s.rejected[r] != want[r];
+    }
+    cases++;
+    failed += s.accepted != want_accepted;
+
+    uint32_t listed = 0;
+    for (int i = 0; i < SEC_STATS_TOP; ++i) listed += s.top[i].count;
+    cases++;
+    failed += listed != with_id;
+
+    for (int st = 0; st < SEC_STAGES; ++st) {
+        cases++;
+        failed += s.stage[st].count != 0;
+    }
+    cases++;
+    failed += strcmp(sec_reject_name(SEC_REJ_BAD_MAC), "bad MAC") != 0 ||
+              strcmp(sec_reject_name(SEC_REJ_REASONS), "?") != 0;
+
+    report("rejects", cases, failed);
+}
+
+// -----------------------------------------------------------------------------
+// Stage times
+// -----------------------------------------------------------------------------
+static int bucket_of(uint32_t us)
+{
+    int b = 0;
+    while (b < SEC_STATS_BUCKETS - 1 && us >= (2u << b)) b++;
+    return b;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Bucket upper bound of the p quantile of sorted samples, as documented
+static uint32_t ref_percentile(const uint32_t *sorted, uint32_t n, float p)
+{
+    uint32_t target = (uint32_t)(p * (float)n);
+    if (target >= n) target = n - 1;
+    uint32_t v = sorted[target];
+    int b = bucket_of(v);
+    return b == SEC_STATS_BUCKETS - 1 ? sorted[n - 1] : 2u << b;
+}
+
+static void check_stages(void)
+{
+    static uint32_t samples[STAGE_SAMPLES];
+    static const float ps[] = { 0.0f, 0.1f, 0.5f, 0.9f, 0.99f, 0.999f, 1.0f };
+    unsigned long cases = 0, failed = 0;
+
+    SecStats s;
+    sec_stats_init(&s);
+
+    // Empty stage
+    cases++;
+    failed += sec_stats_percentile_us(&s.stage[SEC_STAGE_CMAC], 0.5f) != 0;
+
+    // Each stage its own spread: short, log-uniform, past the last bucket
+    for (int st = 0; st < SEC_STAGES; ++st) {
+        uint32_t want_hist[SEC_STATS_BUCKETS] = {0};
+        uint64_t want_total = 0;
+        uint32_t want_max = 0;
+        uint32_t n = STAGE_SAMPLES / (uint32_t)(st + 1);
+
+        for (uint32_t i = 0; i < n; ++i) {
+            uint32_t us;
+            switch (st) {
+            case 0:  us = rng_next() % 8; break;
+            case 1:  us = rng_next() >> (rng_next() % 32); break;
+            case 2:  us = (2u << (SEC_STATS_BUCKETS - 2)) + rng_next() % 1000000u; break;
+            default: us = 100 + rng_next() % 900; break;
+            }
+            samples[i] = us;
+            sec_stats_time(&s, (SecStage)st, us);
+            want_hist[bucket_of(us)]++;
+            want_total += us;
+            if (us > want_max) want_max = us;
+        }
+
+        const SecStageTime *t = &s.stage[st];
+        cases += 3;
+        failed += t->count != n;
+        failed += t->total_us != want_total;
+        failed += t->max_us != want_max;
+        for (int b = 0; b < SEC_STATS_BUCKETS; ++b) {
+            cases++;
+            failed += t->hist[b] != want_hist[b];
+        }
+
+        qsort(samples, n, sizeof(samples[0]), cmp_u32);
+        for (size_t k = 0; k < sizeof(ps) / sizeof(ps[0]); ++k) {
+            uint32_t got = sec_stats_percentile_us(t, ps[k]);
+            uint32_t want = ref_percentile(samples, n, ps[k]);
+            cases++;
+            if (got != want) {
+                failed++;
+                printf("  stage %d p%.1f: %u us, expected %u us\n", st, 100 * ps[k],
+                       (unsigned)got, (unsigned)want);
+            }
+            // An upper bound of the true quantile, within a factor of 2
+            // below the open-ended bucket
+            uint32_t idx = (uint32_t)(ps[k] * (float)n);
+            if (idx >= n) idx = n - 1;
+            cases++;
+            failed += got < samples[idx] ||
+                      (bucket_of(samples[idx]) < SEC_STATS_BUCKETS - 1 &&
+                       got > 2 * samples[idx] + 2);
+        }
+    }
+
+    report("stages", cases, failed);
+}
+
+// -----------------------------------------------------------------------------
+// Top offenders
+// -----------------------------------------------------------------------------
+static void check_top(void)
+{
+    static uint32_t truth[TOP_NODES];
+    memset(truth, 0, sizeof(truth));
+    unsigned long cases = 0, failed = 0;
+
+    SecStats s;
+    sec_stats_init(&s);
+
+    // Zipf-like: a few heavy node_ids in a crowd of one-offs
+    for (uint32_t i = 0; i < TOP_REJECTS; ++i) {
+        uint32_t r = rng_next();
+        uint32_t k = (r % 4 == 0) ? 0                           // 25%: one heavy
+                   : (r % 4 == 1) ? 1 + (r >> 2) % 6            // 25%: 6 medium
+                   : 7 + (r >> 2) % (TOP_NODES - 7);            // 50%: the rest
+        uint8_t id[6];
+        make_id(id, k);
+        sec_stats_reject(&s, (SecReject)(k % SEC_REJ_REASONS), id);
+        truth[k]++;
+    }
+
+    SecOffender top[SEC_STATS_TOP];
+    int n = sec_stats_top(&s, top);
+    cases++;
+    failed += n != SEC_STATS_TOP;
+
+    uint64_t sum = 0;
+    for (int i = 0; i < n; ++i) {
+        uint32_t k = id_key(top[i].node_id);
+        sum += top[i].count;
+
+        cases += 3;
+        failed += i > 0 && top[i].count > top[i - 1].count;         // Sorted
+        failed += k >= TOP_NODES ||                                 // Bounds
+                  top[i].count - top[i].error > truth[k] || truth[k] > top[i].count;
+        failed += top[i].last != k % SEC_REJ_REASONS;
+    }
+    cases++;
+    failed += sum != TOP_REJECTS;
+
+    // Guarantee: more than 1/SEC_STATS_TOP of the rejections -> listed
+    for (uint32_t k = 0; k < TOP_NODES; ++k) {
+        if ((uint64_t)truth[k] * SEC_STATS_TOP <= TOP_REJECTS) continue;
+        bool listed = false;
+        for (int i = 0; i < n; ++i) listed |= id_key(top[i].node_id) == k;
+        cases++;
+        failed += !listed;
+    }
+
+    // Fewer node_ids than slots: exact, free slots skipped
+    sec_stats_init(&s);
+    for (uint32_t k = 0; k < SEC_STATS_TOP - 1; ++k) {
+        uint8_t id[6];
+        make_id(id, k);
+        for (uint32_t j = 0; j <= k; ++j) sec_stats_reject(&s, SEC_REJ_RATE, id);
+    }
+    n = sec_stats_top(&s, top);
+    cases++;
+    failed += n != SEC_STATS_TOP - 1;
+    for (int i = 0; i < n; ++i) {
+        cases++;
+        failed += id_key(top[i].node_id) != (uint32_t)(n - 1 - i) ||
+                  top[i].count != (uint32_t)(n - i) || top[i].error != 0;
+    }
+
+    report("top", cases, failed);
+}
+
+// -----------------------------------------------------------------------------
+// Seqlock: snapshots under a concurrent writer
+// -----------------------------------------------------------------------------
+static SecStats   s_live;
+static atomic_bool s_stop;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void *writer(void *arg)
+{
+    uint64_t *updates = arg;
+    uint32_t rng = 12345;
+
+    while (!atomic_load_explicit(&s_stop, memory_order_relaxed)) {
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        uint8_t id[6];
+        make_id(id, rng % 64);
+        sec_stats_reject(&s_live, (SecReject)(rng % SEC_REJ_REASONS), id);
+        sec_stats_time(&s_live, (SecStage)((rng >> 8) % SEC_STAGES), rng >> 16);
+        if (rng % 3 == 0) sec_stats_accept(&s_live);
+        *updates += 1;
+        if ((*updates & 1023) == 0) sched_yield();
+    }
+    return NULL;
+}
+
+// A copy is whole if every update is in it completely or not at all
+static bool whole(const SecStats *c, const SecStats *prev)
+{
+    uint64_t rejected = 0, listed = 0;
+    for (int r = 0; r < SEC_REJ_REASONS; ++r) rejected += c->rejected[r];
+    for (int i = 0; i < SEC_STATS_TOP; ++i) listed += c->top[i].count;
+    if (rejected != listed) return false;
+
+    for (int st = 0; st < SEC_STAGES; ++st) {
+        uint64_t hist = 0;
+        for (int b = 0; b < SEC_STATS_BUCKETS; ++b) hist += c->stage[st].hist[b];
+        if (hist != c->stage[st].count) return false;
+        if (c->stage[st].count < prev->stage[st].count) return false;
+    }
+    return c->accepted >= prev->accepted;
+}
+
+static void check_seqlock(void)
+{
+    pthread_t th;
+    uint64_t updates = 0;
+    unsigned long snaps = 0, torn = 0, copies = 0, torn_plain = 0;
+
+    sec_stats_init(&s_live);
+    atomic_store(&s_stop, false);
+    pthread_create(&th, NULL, writer, &updates);
+
+    SecStats prev, prev_plain, c;
+    sec_stats_init(&prev);
+    sec_stats_init(&prev_plain);
+
+    uint64_t end = now_ns() + STRESS_NS;
+    while (now_ns() < end) {
+        sec_stats_snapshot(&s_live, &c);
+        snaps++;
+        if (!whole(&c, &prev) || (c.seq & 1u)) torn++;
+        prev = c;
+
+        // Same check, no sequence counter
+        memcpy(&c, &s_live, sizeof(c));
+        copies++;
+        if (!whole(&c, &prev_plain)) torn_plain++;
+        else prev_plain = c;
+    }
+    atomic_store(&s_stop, true);
+    pthread_join(th, NULL);
+
+    // Final state: the last snapshot is exact
+    sec_stats_snapshot(&s_live, &c);
+    bool final_ok = whole(&c, &prev) && memcmp(&c, &s_live, sizeof(c)) == 0;
+
+    report("seqlock", snaps + 1, torn + !final_ok);
+    printf("\nseqlock: %llu writer updates, %lu snapshots; plain memcpy: %lu of %lu copies torn\n",
+           (unsigned long long)updates, snaps, torn_plain, copies);
+}
+
+int main(void)
+{
+    printf("sec_stats: %d reasons, %d stages, %d buckets, top %d\n\n", SEC_REJ_REASONS,
+           SEC_STAGES, SEC_STATS_BUCKETS, SEC_STATS_TOP);
+    printf("%-9s | %9s | %6s\n", "check", "cases", "failed");
+
+    check_rejects();
+    check_stages();
+    check_top();
+    check_seqlock();
+
+    printf("\nrejects = per-reason counts, accepted, offenders only with a node_id\n");
+    printf("stages  = buckets, count / total / max, percentiles vs sorted samples\n");
+    printf("top     = order, count - error <= true <= count, > 1/%d of rejections listed\n",
+           SEC_STATS_TOP);
+    printf("seqlock = snapshots under a writer thread: reasons == offender counts,\n");
+    printf("          hist == count per stage, never backwards\n");
+    return s_failed_total ? 1 : 0;
+}
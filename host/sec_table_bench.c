@@ -0,0 +1,284 @@
+// host/sec_table_bench.c
+// Security table (sec_table.c) against the old linear SECURITY_TABLE.
+//
+// Part 1 times lookups in a full table (MAX_TRACKED_NODES senders): the old
+// memcmp scan over every slot against the hash index, for known senders and
+// for fresh MACs (a flood), which the scan has to walk to the end.
+//
+// Part 2 replays a swarm under a fresh-MAC flood at 100 ms resolution:
+// SIM_LEGIT neighbours send every SIM_LEGIT_PERIOD_MS (+-10%), and
+// SIM_NEWCOMERS more join at SIM_JOIN_S, in the middle of a flood of
+// correctly signed frames, each from a new MAC, from SIM_FLOOD_START_S to
+// SIM_FLOOD_END_S. The validation steps that touch the table are modelled:
+// find, else insert (first frame is the baseline), rate limit, accept.
+// Policies:
+//   - none:  old table, full means refused
+//   - LRU:   evict the sender seen longest ago
+//   - prot:  sec_table default, probation entries go first
+// Reported for the legitimate nodes:
+//   - refused: frames dropped with "Table full"
+//   - reset:   frames that found their entry evicted and started over from
+//     a baseline (rate / replay / physics history lost)
+//   - joined:  newcomers holding a protected entry at the end
+
+#include "sec_table.h"
+#include "token_bucket.h"
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_LOOKUPS       (1u << 22)
+#define BENCH_RUNS          5
+
+#define SIM_DURATION_S      300
+#define SIM_TICK_MS         100
+#define SIM_LEGIT           30
+#define SIM_NEWCOMERS       10
+#define SIM_LEGIT_PERIOD_MS 1200
+#define SIM_JOIN_S          60
+#define SIM_FLOOD_START_S   30
+#define SIM_FLOOD_END_S     240
+
+static uint32_t s_rng = 0x2545F491u;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static void make_mac(uint8_t mac[6], uint32_t id, uint8_t kind)
+{
+    mac[0] = 0x02;
+    mac[1] = kind;
+    mac[2] = (uint8_t)(id >> 24);
+    mac[3] = (uint8_t)(id >> 16);
+    mac[4] = (uint8_t)(id >> 8);
+    mac[5] = (uint8_t)id;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -----------------------------------------------------------------------------
+// Part 1: lookup
+// -----------------------------------------------------------------------------
+// Old security.c: first match or first empty slot, scanning all of them
+typedef struct {
+    uint8_t node_id[6];
+    bool    in_use;
+} OldEntry;
+
+static OldEntry s_old[MAX_TRACKED_NODES];
+
+static int old_find(const uint8_t node_id[6], int *first_empty)
+{
+    *first_empty = -1;
+    for (int i = 0; i < MAX_TRACKED_NODES; ++i) {
+        if (s_old[i].in_use) {
+            if (memcmp(s_old[i].node_id, node_id, 6) == 0) return i;
+        } else {
+            if (*first_empty < 0) *first_empty = i;
+        }
+    }
+    return -1;
+}
+
+static volatile int s_sink;
+
+static void bench_lookup(void)
+{
+    static SecTable t;
+    SecTableConfig cfg;
+    sec_table_default_config(&cfg);
+    sec_table_init(&t, &cfg, 0xC0FFEEu);
+
+    for (int i = 0; i < MAX_TRACKED_NODES; ++i) {
+        make_mac(s_old[i].node_id, (uint32_t)i * 7919u, 0);
+        s_old[i].in_use = true;
+        sec_table_insert(&t, s_old[i].node_id, 0);
+    }
+
+    // Query mix: known senders, or fresh MACs
+    static uint8_t known[1024][6], fresh[1024][6];
+    for (int i = 0; i < 1024; ++i) {
+        memcpy(known[i], s_old[rng_next() % MAX_TRACKED_NODES].node_id, 6);
+        make_mac(fresh[i], rng_next(), 1);
+    }
+
+    printf("Part 1: lookup, %d senders in the table, %d buckets, best of %d x %u lookups\n\n",
+           MAX_TRACKED_NODES, SEC_TABLE_BUCKETS, BENCH_RUNS, BENCH_LOOKUPS);
+    printf("%-12s | %10s | %10s | %7s\n", "query", "scan", "hash", "speedup");
+
+    const char *names[2] = { "known", "fresh MAC" };
+    for (int q = 0; q < 2; ++q) {
+        uint8_t (*ids)[6] = q ? fresh : known;
+        double best_old = 1e30, best_new = 1e30;
+        for (int run = 0; run < BENCH_RUNS; ++run) {
+            int acc = 0, fe;
+            double t0 = now_s();
+            for (uint32_t i = 0; i < BENCH_LOOKUPS; ++i) acc += old_find(ids[i & 1023], &fe);
+            double t1 = now_s();
+            for (uint32_t i = 0; i < BENCH_LOOKUPS; ++i) acc += sec_table_find(&t, ids[i & 1023], i) != NULL;
+            double t2 = now_s();
+            s_sink = acc;
+            if (t1 - t0 < best_old) best_old = t1 - t0;
+            if (t2 - t1 < best_new) best_new = t2 - t1;
+        }
+        printf("%-12s | %7.1f ns | %7.1f ns | %6.1fx\n", names[q],
+               best_old * 1e9 / BENCH_LOOKUPS, best_new * 1e9 / BENCH_LOOKUPS,
+               best_old / best_new);
+    }
+    printf("\nlongest probe chain: %u buckets\n\n", t.stats.max_probe);
+}
+
+// -----------------------------------------------------------------------------
+// Part 2: eviction stress
+// -----------------------------------------------------------------------------
+enum { POLICY_NONE, POLICY_LRU, POLICY_PROTECT, POLICY_MAX };
+static const char *const policy_names[POLICY_MAX] = { "none", "LRU", "prot" };
+
+typedef struct {
+    uint8_t  mac[6];
+    uint32_t next_ms;
+    bool     newcomer;
+} Legit;
+
+typedef struct {
+    uint64_t sent;
+    uint64_t refused;
+    uint64_t reset;
+    uint64_t reset_new;     // Of those, newcomers
+    int      joined;
+} StressResult;
+
+// Table side of security_validate_packet(); *reset if the sender's entry
+// had to be created again
+static TokenRate s_node_rate;
+
+static bool validate(SecTable *t, const uint8_t mac[6], uint32_t now_ms, bool known_before,
+                     bool *reset, bool *refused)
+{
+    *reset = *refused = false;
+    SecEntry *e = sec_table_find(t, mac, now_ms);
+    if (!e) {
+        e = sec_table_insert(t, mac, now_ms);
+        if (!e) {
+            *refused = true;
+            return false;
+        }
+        *reset = known_before;
+        token_fill(&e->bucket, &s_node_rate, now_ms);
+        token_take(&e->bucket, &s_node_rate, 0, now_ms);
+        sec_table_on_accepted(t, e);
+        return true;
+    }
+    if (!token_take(&e->bucket, &s_node_rate, 0, now_ms)) return false;
+    sec_table_on_accepted(t, e);
+    return true;
+}
+
+static StressResult run_stress(int policy, uint32_t flood_per_s)
+{
+    static SecTable t;
+    SecTableConfig cfg;
+    sec_table_default_config(&cfg);
+    cfg.evict = policy != POLICY_NONE;
+    if (policy == POLICY_LRU) cfg.protect_after = 0;
+    sec_table_init(&t, &cfg, 0x1234u);
+    s_rng = 0x2545F491u;
+
+    Legit legit[SIM_LEGIT + SIM_NEWCOMERS];
+    bool  known[SIM_LEGIT + SIM_NEWCOMERS];
+    for (int i = 0; i < SIM_LEGIT + SIM_NEWCOMERS; ++i) {
+        make_mac(legit[i].mac, (uint32_t)i, 0);
+        legit[i].newcomer = i >= SIM_LEGIT;
+        legit[i].next_ms  = (legit[i].newcomer ? SIM_JOIN_S * 1000u : 0u) +
+                            rng_next() % SIM_LEGIT_PERIOD_MS;
+        known[i] = false;
+    }
+
+    StressResult r = { 0 };
+    uint32_t fresh_id = 0;
+    double flood_acc = 0.0;
+
+    for (uint32_t now = 0; now < SIM_DURATION_S * 1000u; now += SIM_TICK_MS) {
+        // Flood frames of this tick, spread between the legit ones
+        uint32_t flood = 0;
+        if (now >= SIM_FLOOD_START_S * 1000u && now < SIM_FLOOD_END_S * 1000u) {
+            flood_acc += flood_per_s * (SIM_TICK_MS / 1000.0);
+            flood = (uint32_t)flood_acc;
+            flood_acc -= flood;
+        }
+
+        for (int i = 0; i < SIM_LEGIT + SIM_NEWCOMERS; ++i) {
+            for (uint32_t k = 0; k < flood / (SIM_LEGIT + SIM_NEWCOMERS) + 1 && flood; ++k, --flood) {
+                uint8_t mac[6];
+                make_mac(mac, fresh_id++, 0xEE);
+                bool reset, refused;
+                validate(&t, mac, now, false, &reset, &refused);
+            }
+
+            Legit *l = &legit[i];
+            if ((int32_t)(now - l->next_ms) < 0) continue;
+            uint32_t jitter = SIM_LEGIT_PERIOD_MS / 10;
+            l->next_ms = now + SIM_LEGIT_PERIOD_MS - jitter + rng_next() % (2 * jitter + 1);
+
+            bool reset, refused;
+            validate(&t, l->mac, now, known[i], &reset, &refused);
+            r.sent++;
+            if (refused) r.refused++;
+            if (reset)   r.reset++;
+            if (reset && l->newcomer) r.reset_new++;
+            if (!refused) known[i] = true;
+        }
+    }
+
+    for (int i = SIM_LEGIT; i < SIM_LEGIT + SIM_NEWCOMERS; ++i) {
+        SecEntry *e = sec_table_find(&t, legit[i].mac, SIM_DURATION_S * 1000u);
+        if (e && e->trust >= SEC_TABLE_PROTECT_AFTER) r.joined++;
+    }
+    return r;
+}
+
+static void bench_stress(void)
+{
+    printf("Part 2: %d neighbours + %d joining at %ds, one frame per %d ms each, "
+           "fresh-MAC flood %d..%ds, %ds total\n\n",
+           SIM_LEGIT, SIM_NEWCOMERS, SIM_JOIN_S, SIM_LEGIT_PERIOD_MS,
+           SIM_FLOOD_START_S, SIM_FLOOD_END_S, SIM_DURATION_S);
+    printf("%8s | %-6s | %8s | %15s | %6s\n", "flood/s", "policy", "refused", "reset (old/new)", "joined");
+
+    const uint32_t floods[] = { 0, 10, 100, 1000 };
+    for (size_t f = 0; f < sizeof(floods) / sizeof(floods[0]); ++f) {
+        for (int p = 0; p < POLICY_MAX; ++p) {
+            StressResult r = run_stress(p, floods[f]);
+            printf("%8u | %-6s | %7.2f%% | %6.2f/%6.2f%% | %3d/%d\n", floods[f], policy_names[p],
+                   100.0 * r.refused / r.sent, 100.0 * (r.reset - r.reset_new) / r.sent,
+                   100.0 * r.reset_new / r.sent, r.joined, SIM_NEWCOMERS);
+        }
+    }
+
+    printf("\nrefused = legitimate frames dropped as \"Table full\"\n");
+    printf("reset   = legitimate frames whose sender had been evicted (history lost),\n"
+           "          from neighbours there before the flood / newcomers\n");
+    printf("joined  = newcomers with %d+ accepted updates in the table at the end\n",
+           SEC_TABLE_PROTECT_AFTER);
+}
+
+int main(void)
+{
+    token_rate_init(&s_node_rate, SEC_NODE_RATE_PER_S, SEC_NODE_BURST);
+    bench_lookup();
+    bench_stress();
+    return 0;
+}
@@ -0,0 +1,39 @@
+// host/shim/mbedtls/aes.h
+// The mbedtls AES block API used by firmware modules (cmac.c), on OpenSSL
+// libcrypto for host builds. Encrypt direction only.
+#pragma once
+
+#define OPENSSL_SUPPRESS_DEPRECATED     // Low-level AES_* is all we need
+#include <openssl/aes.h>
+#include <string.h>
+
+#define MBEDTLS_AES_ENCRYPT 1
+#define MBEDTLS_AES_DECRYPT 0
+
+typedef struct {
+    AES_KEY key;
+} mbedtls_aes_context;
+
+static inline void mbedtls_aes_init(mbedtls_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static inline void mbedtls_aes_free(mbedtls_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static inline int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx,
+                                         const unsigned char *key, unsigned int bits)
+{
+    return AES_set_encrypt_key(key, (int)bits, &ctx->key) == 0 ? 0 : -0x0020;
+}
+
+static inline int mbedtls_aes_crypt_ecb(mbedtls_aes_context *ctx, int mode,
+                                        const unsigned char in[16], unsigned char out[16])
+{
+    if (mode != MBEDTLS_AES_ENCRYPT) return -0x0021;
+    AES_encrypt(in, out, &ctx->key);
+    return 0;
+}
@@ -0,0 +1,491 @@
+// host/sim_radio.cpp
+#include "sim_radio.h"
+
+extern "C" {
+#include "lora_airtime.h"
+#include "link_adapt.h"
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// -----------------------------------------------------------------------------
+// CHANNEL: scheduler
+// -----------------------------------------------------------------------------
+SimChannel::SimChannel(const SimChannelConfig &cfg)
+    : cfg_(cfg), rng_(cfg.seed)
+{
+}
+
+void SimChannel::at(uint64_t t_us, std::function<void()> fn)
+{
+    if (t_us < now_us_) t_us = now_us_;
+    events_.push(Event{t_us, next_seq_++, std::move(fn)});
+}
+
+void SimChannel::run_until(uint64_t t_us)
+{
+    while (!events_.empty() && events_.top().t_us <= t_us) {
+        Event ev = events_.top();
+        events_.pop();
+        now_us_ = ev.t_us;
+        ev.fn();
+    }
+    if (t_us > now_us_) now_us_ = t_us;
+}
+
+void SimChannel::attach(SimRadio *r)
+{
+    r->index_ = radios_.size();
+    radios_.push_back(r);
+}
+
+// -----------------------------------------------------------------------------
+// CHANNEL: propagation
+// -----------------------------------------------------------------------------
+static uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Deterministic, symmetric per-link shadowing
+double SimChannel::shadow_db(size_t a, size_t b) const
+{
+    if (cfg_.shadow_sigma_db <= 0.0) return 0.0;
+    if (a > b) std::swap(a, b);
+
+    uint64_t h1 = splitmix64(((uint64_t)a << 32 | b) ^ ((uint64_t)cfg_.seed << 48));
+    uint64_t h2 = splitmix64(h1);
+    double u1 = ((h1 >> 11) + 1.0) / 9007199254740993.0;
+    double u2 = (h2 >> 11) / 9007199254740992.0;
+    return cfg_.shadow_sigma_db * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+double SimChannel::mean_rx_power_dbm(const SimRadio &from, const SimRadio &to) const
+{
+    double d2 = 0.0;
+    for (int k = 0; k < 3; ++k) {
+        double v = from.pos_[k] - to.pos_[k];
+        d2 += v * v;
+    }
+    double d = std::max(1.0, std::sqrt(d2));
+    double pl = cfg_.ref_loss_db + 10.0 * cfg_.path_loss_exp * std::log10(d);
+    return from.power_dbm_ - pl - shadow_db(from.index_, to.index_);
+}
+
+bool SimChannel::same_channel(const Transmission &t, const SimRadio &r) const
+{
+    return t.sf == r.sf_ && t.sync_word == r.sync_word_ &&
+           std::fabs(t.freq_mhz - r.freq_mhz_) < 0.001f &&
+           std::fabs(t.bw_khz - r.bw_khz_) < 0.001f;
+}
+
+const SimChannel::Transmission *SimChannel::find(uint64_t id) const
+{
+    for (const Transmission &t : on_air_) {
+        if (t.id == id) return &t;
+    }
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// CHANNEL: TX start / end
+// -----------------------------------------------------------------------------
+void SimChannel::begin_tx(SimRadio *from, const uint8_t *data, size_t len)
+{
+    Transmission t;
+    t.id        = next_tx_id_++;
+    t.from      = from;
+    t.freq_mhz  = from->freq_mhz_;
+    t.bw_khz    = from->bw_khz_;
+    t.sf        = from->sf_;
+    t.sync_word = from->sync_word_;
+    t.start_us  = now_us_;
+    t.end_us    = now_us_ + from->getTimeOnAir(len);
+    t.data.assign(data, data + len);
+
+    // Receivers must catch the preamble + sync word to lock
+    double t_sym_us = (double)(1u << t.sf) * 1000.0 / t.bw_khz;
+    t.preamble_end_us = now_us_ + (uint64_t)((from->preamble_ + 4.25) * t_sym_us);
+
+    std::normal_distribution<double> fading(0.0, cfg_.fading_sigma_db);
+    t.rx_dbm.assign(radios_.size(), -std::numeric_limits<double>::infinity());
+
+    for (SimRadio *r : radios_) {
+        if (r == from) continue;
+        double rx = mean_rx_power_dbm(*from, *r);
+        if (cfg_.fading_sigma_db > 0.0) rx += fading(rng_);
+        t.rx_dbm[r->index_] = rx;
+    }
+
+    stats_.tx_started++;
+    stats_.tx_airtime_us += t.end_us - t.start_us;
+
+    for (SimRadio *r : radios_) {
+        if (r == from || !same_channel(t, *r)) continue;
+
+        double rx = t.rx_dbm[r->index_];
+        bool decodable = (rx - cfg_.noise_floor_dbm) >= link_adapt_snr_floor_db(t.sf);
+
+        if (r->mode_ == SimRadio::Mode::Tx) {
+            if (decodable) stats_.rx_half_duplex++;
+            continue;
+        }
+        if (r->mode_ != SimRadio::Mode::Rx) continue;
+
+        SimRadio::Lock &lk = r->lock_;
+
+        if (lk.tx_id == 0) {
+            if (!decodable) {
+                stats_.below_sensitivity++;
+                continue;
+            }
+            // Preamble detected: anything already on air is interference
+            double worst = -std::numeric_limits<double>::infinity();
+            for (const Transmission &o : on_air_) {
+                if (same_channel(o, *r)) worst = std::max(worst, o.rx_dbm[r->index_]);
+            }
+            lk.tx_id      = t.id;
+            lk.rx_dbm     = rx;
+            lk.overlapped = std::isfinite(worst);
+            lk.corrupted  = worst > rx - cfg_.capture_db;
+            continue;
+        }
+
+        const Transmission *cur = find(lk.tx_id);
+        if (decodable && cur && now_us_ < cur->preamble_end_us &&
+            rx >= lk.rx_dbm + cfg_.capture_db) {
+            // Still in the preamble of the weaker packet: re-sync on ours
+            stats_.rx_lock_stolen++;
+            lk.tx_id      = t.id;
+            lk.rx_dbm     = rx;
+            lk.overlapped = true;
+            lk.corrupted  = false;
+            continue;
+        }
+
+        if (decodable) stats_.rx_busy++;
+        lk.overlapped = true;
+        if (rx > lk.rx_dbm - cfg_.capture_db) {
+            lk.corrupted = true;
+        }
+    }
+
+    from->tx_id_ = t.id;
+    uint64_t id  = t.id;
+    uint64_t end = t.end_us;
+    on_air_.push_back(std::move(t));
+    at(end, [this, id] { end_tx(id); });
+}
+
+void SimChannel::end_tx(uint64_t id)
+{
+    auto it = std::find_if(on_air_.begin(), on_air_.end(),
+                           [id](const Transmission &t) { return t.id == id; });
+    if (it == on_air_.end()) return;
+
+    Transmission t = std::move(*it);
+    on_air_.erase(it);
+
+    // Callbacks may start new transmissions: collect first, fire after
+    std::vector<SimRadio *> irq;
+
+    SimRadio *from = t.from;
+    if (from->mode_ == SimRadio::Mode::Tx && from->tx_id_ == id) {
+        from->mode_  = SimRadio::Mode::Standby;
+        from->tx_id_ = 0;
+        irq.push_back(from);    // TxDone
+    }
+
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    for (SimRadio *r : radios_) {
+        SimRadio::Lock &lk = r->lock_;
+        if (lk.tx_id != id) continue;
+
+        double rx = lk.rx_dbm;
+        bool corrupted  = lk.corrupted;
+        bool overlapped = lk.overlapped;
+        lk = SimRadio::Lock();      // RX continuous: back to preamble search
+
+        if (!corrupted && cfg_.loss_prob > 0.0 && uni(rng_) < cfg_.loss_prob) {
+            stats_.rx_lost++;
+            continue;
+        }
+
+        r->rx_buf_       = t.data;
+        r->rx_crc_error_ = false;
+        r->last_rssi_    = (float)rx;
+        r->last_snr_     = (float)(rx - cfg_.noise_floor_dbm);
+
+        if (corrupted) {
+            stats_.rx_collision++;
+            if (r->crc_) {
+                r->rx_crc_error_ = true;
+            } else if (!r->rx_buf_.empty()) {
+                r->rx_buf_[r->rx_buf_.size() / 2] ^= 0x5A;
+            }
+        } else {
+            stats_.rx_ok++;
+            if (overlapped) stats_.rx_captured++;
+        }
+        irq.push_back(r);           // RxDone
+    }
+
+    for (SimRadio *r : irq) r->fire_dio0();
+}
+
+void SimChannel::end_cad(SimRadio *r, uint64_t start_us)
+{
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    bool busy = false;
+
+    stats_.cad_runs++;
+    for (const Transmission &t : on_air_) {
+        if (t.from == r || !same_channel(t, *r)) continue;
+        double snr = t.rx_dbm[r->index_] - cfg_.noise_floor_dbm;
+        if (snr < link_adapt_snr_floor_db(t.sf)) continue;
+
+        double p = (start_us < t.preamble_end_us) ? cfg_.cad_preamble_prob
+                                                  : cfg_.cad_payload_prob;
+        if (uni(rng_) < p) {
+            busy = true;
+            break;
+        }
+        stats_.cad_missed++;
+    }
+    if (busy) stats_.cad_detected++;
+
+    r->cad_busy_ = busy;
+    r->mode_ = SimRadio::Mode::Standby;
+    r->fire_dio0();
+}
+
+// -----------------------------------------------------------------------------
+// RADIO
+// -----------------------------------------------------------------------------
+SimRadio::SimRadio(SimChannel &ch) : ch_(ch)
+{
+    ch_.attach(this);
+}
+
+int16_t SimRadio::begin(float freq, float bw, uint8_t sf, uint8_t cr,
+                        uint8_t syncWord, int8_t power, uint16_t preambleLength)
+{
+    freq_mhz_  = freq;
+    bw_khz_    = bw;
+    sf_        = sf;
+    cr_        = cr;
+    sync_word_ = syncWord;
+    power_dbm_ = power;
+    preamble_  = preambleLength;
+    return standby();
+}
+
+int16_t SimRadio::setSpreadingFactor(uint8_t sf)
+{
+    sf_ = sf;
+    lock_ = Lock();
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SimRadio::setOutputPower(int8_t power)
+{
+    power_dbm_ = power;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SimRadio::setCRC(bool enable)
+{
+    crc_ = enable;
+    return RADIOLIB_ERR_NONE;
+}
+
+void SimRadio::setDio0Action(std::function<void()> fn, uint32_t dir)
+{
+    (void)dir;
+    dio0_ = std::move(fn);
+}
+
+void SimRadio::clearDio0Action()
+{
+    dio0_ = nullptr;
+}
+
+void SimRadio::fire_dio0()
+{
+    if (dio0_) dio0_();
+}
+
+int16_t SimRadio::startTransmit(const uint8_t *data, size_t len, uint8_t addr)
+{
+    (void)addr;
+    if (len > 255) return RADIOLIB_ERR_PACKET_TOO_LONG;
+
+    if (lock_.tx_id != 0) {
+        ch_.stats_.rx_aborted++;
+        lock_ = Lock();
+    }
+    mode_ = Mode::Tx;
+    ch_.begin_tx(this, data, len);
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SimRadio::startReceive()
+{
+    if (lock_.tx_id != 0) {
+        ch_.stats_.rx_aborted++;
+        lock_ = Lock();
+    }
+    // An SX1276 in TX would abort the packet; the channel still carries it
+    // to the end, so treat re-arming during TX as a no-op on the air side.
+    tx_id_ = 0;
+    mode_  = Mode::Rx;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SimRadio::standby()
+{
+    if (lock_.tx_id != 0) {
+        ch_.stats_.rx_aborted++;
+        lock_ = Lock();
+    }
+    tx_id_ = 0;
+    mode_  = Mode::Standby;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SimRadio::startChannelScan()
+{
+    if (lock_.tx_id != 0) {
+        ch_.stats_.rx_aborted++;
+        lock_ = Lock();
+    }
+    tx_id_ = 0;
+    mode_  = Mode::Cad;
+
+    uint64_t g = ++cad_gen_;
+    uint64_t start = ch_.now_us();
+    ch_.at(start + getCadTime(), [this, g, start] {
+        if (mode_ == Mode::Cad && cad_gen_ == g) ch_.end_cad(this, start);
+    });
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SimRadio::getChannelScanResult()
+{
+    return cad_busy_ ? RADIOLIB_PREAMBLE_DETECTED : RADIOLIB_CHANNEL_FREE;
+}
+
+uint32_t SimRadio::getCadTime() const
+{
+    LoraAirParams p = { sf_, bw_khz_, cr_, preamble_, crc_, false };
+    return lora_cad_time_us(&p);
+}
+
+size_t SimRadio::getPacketLength(bool update)
+{
+    (void)update;
+    return rx_buf_.size();
+}
+
+int16_t SimRadio::readData(uint8_t *data, size_t len)
+{
+    if (len == 0 || len > rx_buf_.size()) len = rx_buf_.size();
+    std::memcpy(data, rx_buf_.data(), len);
+    return rx_crc_error_ ? RADIOLIB_ERR_CRC_MISMATCH : RADIOLIB_ERR_NONE;
+}
+
+uint32_t SimRadio::getTimeOnAir(size_t len) const
+{
+    LoraAirParams p = { sf_, bw_khz_, cr_, preamble_, crc_, false };
+    return lora_time_on_air_us(&p, len);
+}
+
+// -----------------------------------------------------------------------------
+// CSMA SWARM
+// -----------------------------------------------------------------------------
+void SimCsmaSwarm::connect(SimCsmaNode &n, uint32_t isr_to_task_us)
+{
+    SimCsmaNode *np = &n;
+    n.radio->setDio0Action([this, np, isr_to_task_us] {
+        ch.at(ch.now_us() + isr_to_task_us, [this, np] { on_dio0(*np); });
+    }, 0);
+}
+
+void SimCsmaSwarm::hold(SimCsmaNode &n, uint32_t deadline_ms)
+{
+    n.held = true;
+    n.deadline_ms = deadline_ms;
+    try_send(n);
+}
+
+void SimCsmaSwarm::transmit(SimCsmaNode &n)
+{
+    std::vector<uint8_t> f(frame_len_, 0);
+    fill_frame(n, f.data());
+    n.held = false;
+    if (n.radio->startTransmit(f.data(), f.size()) != RADIOLIB_ERR_NONE) return;
+    n.transmitting = true;
+    on_sent(n);
+}
+
+void SimCsmaSwarm::try_send(SimCsmaNode &n)
+{
+    if (!n.held || n.transmitting || n.cad) return;
+    if (!use_cad_) {
+        transmit(n);
+        return;
+    }
+    n.cad = true;
+    n.radio->startChannelScan();
+}
+
+void SimCsmaSwarm::on_dio0(SimCsmaNode &n)
+{
+    if (n.transmitting) {
+        n.transmitting = false;
+        n.radio->startReceive();
+        try_send(n);
+        return;
+    }
+
+    if (n.cad) {
+        n.cad = false;
+        bool busy = n.radio->getChannelScanResult() != RADIOLIB_CHANNEL_FREE;
+        uint32_t frame_ms = n.radio->getTimeOnAir(frame_len_) / 1000;
+        uint32_t backoff_ms = 0;
+        switch (csma_on_cad(&n.csma, busy, frame_ms, (uint32_t)(ch.now_us() / 1000),
+                            n.deadline_ms, true, &backoff_ms)) {
+        case CSMA_SEND:
+            transmit(n);
+            break;
+        case CSMA_BACKOFF: {
+            n.radio->startReceive();
+            uint64_t g = ++n.wake_gen;
+            SimCsmaNode *np = &n;
+            ch.at(ch.now_us() + (uint64_t)backoff_ms * 1000, [this, np, g] {
+                if (np->wake_gen == g) try_send(*np);
+            });
+            break;
+        }
+        case CSMA_DROP:
+            n.held = false;
+            on_dropped(n);
+            n.radio->startReceive();
+            break;
+        }
+        return;
+    }
+
+    uint8_t buf[64];
+    size_t len = std::min(n.radio->getPacketLength(), sizeof(buf));
+    int16_t r = n.radio->readData(buf, len);
+    on_rx(n, buf, len, r);
+    n.radio->startReceive();
+}
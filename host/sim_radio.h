@@ -0,0 +1,282 @@
+// host/sim_radio.h
+#pragma once
+
+// Software SX1276 for host simulations. SimRadio exposes the subset of the
+// RadioLib SX1276 API that comms_lora.cpp uses (startTransmit / startReceive /
+// readData / getPacketLength / getRSSI / getSNR / DIO0 action), so a radio
+// stack written against RadioLib can run many times over in one process.
+//
+// All radios share a SimChannel: a discrete-event scheduler on a virtual
+// microsecond clock plus the propagation model:
+//   - time on air from lora_airtime.c (the firmware's own model)
+//   - log-distance path loss on 3D distance, per-link shadowing and
+//     per-packet fading
+//   - sensitivity: SNR must clear the SF demodulation floor
+//   - half duplex: a radio hears nothing while it transmits
+//   - collisions: an overlapping signal on the same SF within capture_db of
+//     the locked packet corrupts it (RxDone with CRC error)
+//   - capture: a locked packet survives weaker interferers, and a signal
+//     capture_db stronger arriving during the preamble steals the lock
+//   - configurable random packet loss on top
+//   - channel activity detection: startChannelScan() occupies the radio for
+//     lora_cad_time_us(), then CadDone on DIO0. A same-SF signal above
+//     sensitivity is detected with cad_preamble_prob while the CAD window
+//     overlaps its preamble and cad_payload_prob once only payload remains
+//     (the SX1276 correlates against preamble chirps).
+// Different SFs are treated as orthogonal.
+//
+// DIO0 callbacks run inline from SimChannel::run_until() at the virtual time
+// of the interrupt, like an ISR. Stacks model task latency by scheduling
+// their handler with SimChannel::at().
+//
+// SimCsmaSwarm is the own-state TX loop of radio_task on top of that, shared
+// by the swarm sims: a held frame goes to CAD and csma.c, backs off while the
+// channel looks busy and is forced out at its deadline (or goes straight out
+// with CAD off). Sims derive from it for the frame contents, the RX side and
+// their counters.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "csma.h"
+}
+
+// RadioLib status codes used by the firmware
+#ifndef RADIOLIB_ERR_NONE
+#define RADIOLIB_ERR_NONE              (0)
+#define RADIOLIB_ERR_PACKET_TOO_LONG   (-4)
+#define RADIOLIB_ERR_RX_TIMEOUT        (-6)
+#define RADIOLIB_ERR_CRC_MISMATCH      (-7)
+#define RADIOLIB_PREAMBLE_DETECTED     (-14)
+#define RADIOLIB_CHANNEL_FREE          (-15)
+#endif
+
+class SimRadio;
+
+struct SimChannelConfig {
+    double   path_loss_exp   = 2.7;     // Log-distance exponent
+    double   ref_loss_db     = 31.2;    // Loss at 1 m, 868 MHz
+    double   shadow_sigma_db = 4.0;     // Fixed per link
+    double   fading_sigma_db = 2.0;     // Per packet
+    double   noise_floor_dbm = -114.0;  // BW 250 kHz, 6 dB NF
+    double   capture_db      = 6.0;     // Co-SF rejection / capture margin
+    double   loss_prob       = 0.0;     // Extra random loss per reception
+    double   cad_preamble_prob = 0.99;  // CAD hit while a preamble is on air
+    double   cad_payload_prob  = 0.8;   // ... on payload symbols only
+    uint32_t seed            = 1;
+};
+
+struct SimChannelStats {
+    uint64_t tx_started;
+    uint64_t tx_airtime_us;
+    uint64_t rx_ok;             // Delivered to a listening radio
+    uint64_t rx_collision;      // Locked packet corrupted by overlap (CRC error)
+    uint64_t rx_captured;       // Overlap happened but the locked packet survived
+    uint64_t rx_lock_stolen;    // Stronger packet took over during the preamble
+    uint64_t rx_lost;           // Random loss (loss_prob)
+    uint64_t rx_aborted;        // Receiver left RX (e.g. started a TX) mid-packet
+    uint64_t rx_half_duplex;    // Decodable packet started while receiver was TXing
+    uint64_t rx_busy;           // Decodable packet started while locked on another
+    uint64_t below_sensitivity;
+    uint64_t cad_runs;
+    uint64_t cad_detected;
+    uint64_t cad_missed;        // Decodable signal on air, CAD said free
+};
+
+class SimChannel {
+public:
+    explicit SimChannel(const SimChannelConfig &cfg = SimChannelConfig());
+
+    uint64_t now_us() const { return now_us_; }
+
+    // Schedule fn at an absolute virtual time (FIFO among equal times)
+    void at(uint64_t t_us, std::function<void()> fn);
+
+    // Process events up to and including t_us, then park the clock there
+    void run_until(uint64_t t_us);
+
+    const SimChannelStats &stats() const { return stats_; }
+    const SimChannelConfig &config() const { return cfg_; }
+
+    // Received power (dBm) from one radio at another, without fading
+    double mean_rx_power_dbm(const SimRadio &from, const SimRadio &to) const;
+
+private:
+    friend class SimRadio;
+
+    struct Event {
+        uint64_t t_us;
+        uint64_t seq;
+        std::function<void()> fn;
+        bool operator>(const Event &o) const
+        {
+            return t_us != o.t_us ? t_us > o.t_us : seq > o.seq;
+        }
+    };
+
+    struct Transmission {
+        uint64_t id;
+        SimRadio *from;
+        float    freq_mhz;
+        float    bw_khz;
+        uint8_t  sf;
+        uint8_t  sync_word;
+        uint64_t start_us;
+        uint64_t preamble_end_us;
+        uint64_t end_us;
+        std::vector<uint8_t> data;
+        std::vector<double>  rx_dbm;    // Indexed by SimRadio::index_
+    };
+
+    void attach(SimRadio *r);
+    void begin_tx(SimRadio *from, const uint8_t *data, size_t len);
+    void end_tx(uint64_t id);
+    void end_cad(SimRadio *r, uint64_t start_us);
+    bool same_channel(const Transmission &t, const SimRadio &r) const;
+    const Transmission *find(uint64_t id) const;
+    double shadow_db(size_t a, size_t b) const;
+
+    SimChannelConfig cfg_;
+    SimChannelStats  stats_{};
+    uint64_t now_us_ = 0;
+    uint64_t next_seq_ = 0;
+    uint64_t next_tx_id_ = 1;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    std::vector<SimRadio *>   radios_;
+    std::vector<Transmission> on_air_;
+    std::mt19937 rng_;
+};
+
+class SimRadio {
+public:
+    explicit SimRadio(SimChannel &ch);
+
+    void set_position(double x, double y, double z) { pos_[0] = x; pos_[1] = y; pos_[2] = z; }
+    const double *position() const { return pos_; }
+
+    // --- RadioLib SX1276 subset ---
+    int16_t begin(float freq = 434.0f, float bw = 125.0f, uint8_t sf = 9,
+                  uint8_t cr = 7, uint8_t syncWord = 0x12, int8_t power = 10,
+                  uint16_t preambleLength = 8);
+    int16_t setSpreadingFactor(uint8_t sf);
+    int16_t setOutputPower(int8_t power);
+    int16_t setCRC(bool enable);
+    void    setDio0Action(std::function<void()> fn, uint32_t dir);
+    void    clearDio0Action();
+
+    int16_t startTransmit(const uint8_t *data, size_t len, uint8_t addr = 0);
+    int16_t startReceive();
+    int16_t standby();
+    int16_t startChannelScan();         // CadDone on DIO0
+    int16_t getChannelScanResult();     // RADIOLIB_PREAMBLE_DETECTED / _CHANNEL_FREE
+    uint32_t getCadTime() const;        // us
+
+    size_t  getPacketLength(bool update = true);
+    int16_t readData(uint8_t *data, size_t len);
+    float   getRSSI() const { return last_rssi_; }
+    float   getSNR() const  { return last_snr_; }
+    uint32_t getTimeOnAir(size_t len) const;   // us
+
+    // --- Introspection for harnesses ---
+    bool    is_transmitting() const { return mode_ == Mode::Tx; }
+    bool    is_receiving() const    { return mode_ == Mode::Rx; }
+    bool    is_scanning() const     { return mode_ == Mode::Cad; }
+    uint8_t sf() const              { return sf_; }
+    int8_t  power_dbm() const       { return power_dbm_; }
+
+private:
+    friend class SimChannel;
+
+    enum class Mode { Standby, Rx, Tx, Cad };
+
+    struct Lock {
+        uint64_t tx_id = 0;     // 0 = searching for a preamble
+        double   rx_dbm = 0.0;
+        bool     corrupted = false;
+        bool     overlapped = false;
+    };
+
+    void fire_dio0();
+
+    SimChannel &ch_;
+    size_t  index_ = 0;
+    double  pos_[3] = {0.0, 0.0, 0.0};
+
+    float    freq_mhz_ = 434.0f;
+    float    bw_khz_ = 125.0f;
+    uint8_t  sf_ = 9;
+    uint8_t  cr_ = 7;
+    uint8_t  sync_word_ = 0x12;
+    uint16_t preamble_ = 8;
+    bool     crc_ = true;
+    int8_t   power_dbm_ = 10;
+
+    Mode mode_ = Mode::Standby;
+    Lock lock_;
+    uint64_t tx_id_ = 0;
+    uint64_t cad_gen_ = 0;
+    bool     cad_busy_ = false;
+
+    std::function<void()> dio0_;
+
+    // Last RxDone
+    std::vector<uint8_t> rx_buf_;
+    bool  rx_crc_error_ = false;
+    float last_rssi_ = 0.0f;
+    float last_snr_ = 0.0f;
+};
+
+// One broadcasting node of a SimCsmaSwarm. Sims extend it with their state.
+struct SimCsmaNode {
+    std::unique_ptr<SimRadio> radio;
+    int      id = 0;
+    bool     transmitting = false;
+    bool     cad = false;
+    bool     held = false;      // Own state waiting for CAD / backoff
+    uint32_t deadline_ms = 0;
+    uint64_t wake_gen = 0;
+    Csma     csma;
+};
+
+class SimCsmaSwarm {
+public:
+    // frame_len: bytes per broadcast; use_cad false sends blind
+    SimCsmaSwarm(SimChannel &ch, size_t frame_len, bool use_cad = true)
+        : ch(ch), frame_len_(frame_len), use_cad_(use_cad) {}
+    virtual ~SimCsmaSwarm() = default;
+
+    // Route n's DIO0 to on_dio0() isr_to_task_us later (ISR -> task hand-off)
+    void connect(SimCsmaNode &n, uint32_t isr_to_task_us);
+
+    // Own state due: hold it (replacing one still waiting) and try to send
+    void hold(SimCsmaNode &n, uint32_t deadline_ms);
+
+    // radio_start_next_tx(): a held frame goes to CAD (or straight out)
+    void try_send(SimCsmaNode &n);
+
+    void on_dio0(SimCsmaNode &n);
+
+    SimChannel &ch;
+
+protected:
+    // Frame to send, frame_len bytes, zeroed
+    virtual void fill_frame(SimCsmaNode &n, uint8_t *f) = 0;
+    // On air
+    virtual void on_sent(SimCsmaNode &) {}
+    // csma.c gave up on the frame (own states are forced out instead)
+    virtual void on_dropped(SimCsmaNode &) {}
+    // RxDone, before RX is re-armed
+    virtual void on_rx(SimCsmaNode &n, const uint8_t *buf, size_t len, int16_t status) = 0;
+
+private:
+    void transmit(SimCsmaNode &n);
+
+    size_t frame_len_;
+    bool   use_cad_;
+};
@@ -0,0 +1,283 @@
+// host/telem_batch_bench.c
+// MQTT telemetry, one message per sample (TELEM_SAMPLE_HZ = 0) against
+// batches out of the telemetry ring (telem_ring.c) at several sample rates.
+//
+// One drone flies BENCH_SECONDS on the firmware's physics step (50 Hz,
+// same smoothing as physics.c) toward a new random velocity every
+// flocking period. Each mode samples that trajectory, pushes the samples
+// through the ring as physics_task and mqtt_task do, encodes and decodes
+// every message and checks the samples survive. Reported per topic:
+//   - msgs/s:   MQTT PUBLISHes per second per drone (each also costs a
+//               PUBACK round trip at QoS 1)
+//   - B/sample: wire bytes per sample (PUBLISH + PUBACK + TCP/IPv4 headers,
+//               one segment each), and the part of it that is overhead,
+//               i.e. anything but the sample's own JSON object / frame
+//   - encode:   CPU per sample on this host, batch encoding included
+//   - track:    RMS / max error (mm) of the trajectory rebuilt from the
+//               published samples by linear interpolation, against every
+//               physics step
+//   - delay:    oldest sample's age when its message goes out
+
+#include "telem_ring.h"
+#include "telemetry.h"
+#include "telem_decode.h"
+#include "config.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SECONDS   60
+#define BENCH_STEPS     (BENCH_SECONDS * PHYSICS_FREQ_HZ)
+#define TCPIP_HEADER    40
+#define MQTT_PUBACK     4
+#define MAX_BATCH       TELEM_BATCH_MAX_SAMPLES
+#define ENC_REPEAT      32      // Encodes per message timed, clock cost amortised
+#define BENCH_BIN_TOPIC MQTT_TOPIC "/bin"   // Off ("") in config.h by default
+
+typedef struct {
+    const char *name;
+    int sample_hz;          // Samples captured per second
+    int batch_ms;           // 0: one message per sample, as today
+} Mode;
+
+static const Mode s_modes[] = {
+    { "today",       TELEMETRY_FREQ_HZ, 0 },
+    { "batch",       TELEMETRY_FREQ_HZ, 1000 },
+    { "batch",       10,                1000 },
+    { "batch",       25,                1000 },
+    { "batch",       50,                1000 },
+    { "batch",       50,                200 },
+};
+#define N_MODES (sizeof(s_modes) / sizeof(s_modes[0]))
+
+static uint32_t s_rng = 0x9E3779B9u;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double rng_uniform(double lo, double hi)
+{
+    return lo + (hi - lo) * (rng_next() / 4294967296.0);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// -----------------------------------------------------------------------------
+// Trajectory (physics.c step, flocking-rate targets)
+// -----------------------------------------------------------------------------
+static DroneState s_truth[BENCH_STEPS];
+
+static void fly(void)
+{
+    DroneState s = {
+        .x_mm = (WORLD_MIN_X_MM + WORLD_MAX_X_MM) / 2.0,
+        .y_mm = (WORLD_MIN_Y_MM + WORLD_MAX_Y_MM) / 2.0,
+        .z_mm = (WORLD_MIN_Z_MM + WORLD_MAX_Z_MM) / 2.0,
+    };
+    ControlInput u = {0};
+    const double dt = PHYSICS_PERIOD_MS / 1000.0, alpha = 0.2;
+    const int per_target = PHYSICS_FREQ_HZ / FLOCKING_FREQ_HZ;
+
+    for (int k = 0; k < BENCH_STEPS; ++k) {
+        if (k % per_target == 0) {
+            u.target_vx_mm_s = rng_uniform(-MAX_SPEED_MM_S, MAX_SPEED_MM_S) * 0.7;
+            u.target_vy_mm_s = rng_uniform(-MAX_SPEED_MM_S, MAX_SPEED_MM_S) * 0.7;
+            u.target_vz_mm_s = rng_uniform(-MAX_SPEED_MM_S, MAX_SPEED_MM_S) * 0.2;
+        }
+        s.vx_mm_s += (u.target_vx_mm_s - s.vx_mm_s) * alpha;
+        s.vy_mm_s += (u.target_vy_mm_s - s.vy_mm_s) * alpha;
+        s.vz_mm_s += (u.target_vz_mm_s - s.vz_mm_s) * alpha;
+        s.x_mm += s.vx_mm_s * dt;
+        s.y_mm += s.vy_mm_s * dt;
+        s.z_mm += s.vz_mm_s * dt;
+        s_truth[k] = s;
+    }
+}
+
+// The sample physics_task would capture at step k (time = step)
+static NeighbourState capture(int k)
+{
+    const DroneState *s = &s_truth[k];
+    uint32_t t_ms = (uint32_t)k * PHYSICS_PERIOD_MS;
+    NeighbourState n;
+    memset(&n, 0, sizeof(n));
+    n.version = VERSION;
+    n.team_id = TEAM_ID;
+    for (int i = 0; i < 6; ++i) n.node_id[i] = (uint8_t)(0xA0 + i);
+    n.ts_s    = 1750000000u + t_ms / 1000;
+    n.ts_ms   = (uint16_t)(t_ms % 1000);
+    n.x_mm    = (uint32_t)s->x_mm;
+    n.y_mm    = (uint32_t)s->y_mm;
+    n.z_mm    = (uint32_t)s->z_mm;
+    n.vx_mm_s = (int32_t)s->vx_mm_s;
+    n.vy_mm_s = (int32_t)s->vy_mm_s;
+    n.vz_mm_s = (int32_t)s->vz_mm_s;
+    return n;
+}
+
+static int step_of(const NeighbourState *n)
+{
+    uint32_t t_ms = (n->ts_s - 1750000000u) * 1000 + n->ts_ms;
+    return (int)(t_ms / PHYSICS_PERIOD_MS);
+}
+
+// QoS 1 PUBLISH: fixed header, remaining length, topic, packet id, payload
+static size_t mqtt_publish_bytes(const char *topic, size_t payload)
+{
+    size_t remaining = 2 + strlen(topic) + 2 + payload;
+    size_t len_bytes = 1;
+    for (size_t r = remaining; r > 127; r >>= 7) len_bytes++;
+    return 1 + len_bytes + remaining;
+}
+
+// -----------------------------------------------------------------------------
+// One mode, one encoding
+// -----------------------------------------------------------------------------
+typedef struct {
+    double msgs_s, wire, overhead, enc_ns, rms_mm, max_mm, delay_ms;
+    uint32_t dropped;
+    bool ok;
+} Result;
+
+static NeighbourState s_got[BENCH_STEPS];
+
+static Result run(const Mode *m, TelemEncoding enc, const char *topic)
+{
+    static uint8_t buf[TELEM_BATCH_BUF_SIZE(MAX_BATCH)];
+    NeighbourState batch[MAX_BATCH], dec[MAX_BATCH];
+    Result r = { .ok = true };
+    size_t got = 0, msgs = 0;
+    double wire = 0, bare = 0, enc_ns = 0;
+    uint16_t seq = 0;
+
+    telem_ring_init();
+    const int every = PHYSICS_FREQ_HZ / m->sample_hz;
+    const int flush = m->batch_ms ? m->batch_ms / PHYSICS_PERIOD_MS : every;
+    const size_t cap = m->batch_ms ? (size_t)(m->sample_hz * m->batch_ms / 1000) : 1;
+
+    for (int k = 0; k < BENCH_STEPS; ++k) {
+        // physics_task
+        if ((k + 1) % every == 0) {
+            NeighbourState n = capture(k);
+            telem_ring_push(&n);
+        }
+        // mqtt_task
+        if ((k + 1) % flush != 0) continue;
+
+        size_t n;
+        while ((n = telem_ring_drain(batch, cap)) > 0) {
+            for (size_t i = 0; i < n; ++i) batch[i].seq_number = seq++;
+
+            size_t len = 0;
+            double t0 = now_ns();
+            for (int rep = 0; rep < ENC_REPEAT; ++rep) {
+                len = m->batch_ms ? telem_encode_batch(enc, batch, n, buf, sizeof(buf))
+                                  : telem_encode(enc, batch, buf, sizeof(buf));
+            }
+            enc_ns += (now_ns() - t0) / ENC_REPEAT;
+
+            size_t back = 0;
+            if (m->batch_ms) {
+                back = telem_decode_batch(buf, len, dec, MAX_BATCH, NULL);
+            } else {
+                back = telem_decode(buf, len, dec, NULL) ? 1 : 0;
+            }
+            r.ok &= len > 0 && back == n;
+            for (size_t i = 0; i < back; ++i) {
+                r.ok &= memcmp(&dec[i], &batch[i], sizeof(dec[i])) == 0;
+                s_got[got++] = dec[i];
+
+                uint8_t one[MAX_JSON_STRING_LENGTH];
+                bare += telem_encode(enc, &batch[i], one, sizeof(one));
+            }
+            double age = (k - step_of(&batch[0])) * PHYSICS_PERIOD_MS;
+            if (age > r.delay_ms) r.delay_ms = age;
+
+            wire += mqtt_publish_bytes(topic, len) + MQTT_PUBACK + 2 * TCPIP_HEADER;
+            msgs++;
+        }
+    }
+
+    TelemRingStats st;
+    telem_ring_get_stats(&st);
+    r.dropped  = st.dropped;
+    r.msgs_s   = (double)msgs / BENCH_SECONDS;
+    r.wire     = wire / got;
+    r.overhead = (wire - bare) / got;
+    r.enc_ns   = enc_ns / got;
+
+    // Trajectory between the first and last sample, from the samples
+    double sq = 0;
+    int n_sq = 0, j = 0;
+    int first = step_of(&s_got[0]), last = step_of(&s_got[got - 1]);
+    for (int k = first; k <= last; ++k) {
+        while (step_of(&s_got[j + 1]) < k) j++;
+        const NeighbourState *a = &s_got[j], *b = &s_got[j + 1 < (int)got ? j + 1 : j];
+        int ka = step_of(a), kb = step_of(b);
+        double f = kb > ka ? (double)(k - ka) / (kb - ka) : 0.0;
+        double ex = a->x_mm + f * ((double)b->x_mm - a->x_mm) - s_truth[k].x_mm;
+        double ey = a->y_mm + f * ((double)b->y_mm - a->y_mm) - s_truth[k].y_mm;
+        double ez = a->z_mm + f * ((double)b->z_mm - a->z_mm) - s_truth[k].z_mm;
+        double e2 = ex * ex + ey * ey + ez * ez;
+        sq += e2;
+        n_sq++;
+        if (sqrt(e2) > r.max_mm) r.max_mm = sqrt(e2);
+    }
+    r.rms_mm = sqrt(sq / n_sq);
+    r.ok &= r.dropped == 0;
+    return r;
+}
+
+int main(void)
+{
+    fly();
+
+    static const char *const names[TELEM_ENCODINGS] = { "JSON", "binary" };
+    static const char *const topics[TELEM_ENCODINGS] = {
+        MQTT_TELEM_JSON_TOPIC, BENCH_BIN_TOPIC
+    };
+
+    printf("1 drone, %d s at %d Hz physics, QoS 1; per topic\n\n", BENCH_SECONDS, PHYSICS_FREQ_HZ);
+    printf("%-6s | %-6s | %13s | %6s | %17s | %8s | %19s | %8s | %s\n", "enc", "mode",
+           "samples/batch", "msgs/s", "B/sample (ovh)", "encode", "track rms/max", "delay",
+           "round trip");
+
+    bool all = true;
+    for (int e = 0; e < TELEM_ENCODINGS; ++e) {
+        for (size_t i = 0; i < N_MODES; ++i) {
+            const Mode *m = &s_modes[i];
+            Result r = run(m, (TelemEncoding)e, topics[e]);
+            char shape[24];
+            if (m->batch_ms) {
+                snprintf(shape, sizeof(shape), "%2d Hz/%4d ms", m->sample_hz, m->batch_ms);
+            } else {
+                snprintf(shape, sizeof(shape), "%2d Hz/single", m->sample_hz);
+            }
+            all &= r.ok;
+            printf("%-6s | %-6s | %13s | %6.1f | %6.1f (%6.1f) | %5.0f ns | %6.0f / %6.0f mm | %5.0f ms | %s\n",
+                   names[e], m->name, shape, r.msgs_s, r.wire, r.overhead, r.enc_ns,
+                   r.rms_mm, r.max_mm, r.delay_ms, r.ok ? "OK" : "FAIL");
+        }
+    }
+
+    printf("\nmsgs/s     = PUBLISH per second per drone on the topic (and as many PUBACKs)\n");
+    printf("B/sample   = PUBLISH + PUBACK + TCP/IPv4 bytes per sample; (ovh) = all but the sample itself\n");
+    printf("encode     = telem_encode() / telem_encode_batch() per sample on this host\n");
+    printf("track      = position error of the trajectory interpolated from the samples, every physics step\n");
+    printf("delay      = oldest sample's age when its message is published\n");
+    printf("round trip = every sample decodes to what was captured, none dropped by the ring\n");
+    return all ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+// host/telem_decode.c
+#include "telem_decode.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+
+static uint32_t rd32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// -----------------------------------------------------------------------------
+// BINARY
+// -----------------------------------------------------------------------------
+// One frame image at f
+static void read_frame(const uint8_t *f, NeighbourState *out)
+{
+#define U16(field) out->field = rd16(f + offsetof(NeighbourState, field))
+#define U32(field) out->field = rd32(f + offsetof(NeighbourState, field))
+    out->version = f[offsetof(NeighbourState, version)];
+    out->team_id = f[offsetof(NeighbourState, team_id)];
+    memcpy(out->node_id, f + offsetof(NeighbourState, node_id), 6);
+    U16(seq_number);
+    U32(ts_s);
+    U16(ts_ms);
+    U32(x_mm);
+    U32(y_mm);
+    U32(z_mm);
+    out->vx_mm_s = (int32_t)rd32(f + offsetof(NeighbourState, vx_mm_s));
+    out->vy_mm_s = (int32_t)rd32(f + offsetof(NeighbourState, vy_mm_s));
+    out->vz_mm_s = (int32_t)rd32(f + offsetof(NeighbourState, vz_mm_s));
+    U16(yaw_cd);
+    U16(link_cfg);
+    memcpy(out->mac_tag, f + offsetof(NeighbourState, mac_tag), 4);
+#undef U16
+#undef U32
+}
+
+bool telem_decode_binary(const uint8_t *payload, size_t len, NeighbourState *out)
+{
+    if (len != TELEM_BIN_SIZE || payload[0] != TELEM_BIN_SCHEMA) return false;
+    read_frame(payload + 1, out);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// JSON
+// -----------------------------------------------------------------------------
+// The flat object of telem_encode_json(): "key":number or "key":"HEX"
+typedef enum { KIND_UINT, KIND_INT, KIND_HEX } Kind;
+
+typedef struct {
+    const char *key;
+    Kind        kind;
+    size_t      offset, size;
+} JsonField;
+
+#define FIELD(name, kind) { #name, kind, offsetof(NeighbourState, name), \
+                            sizeof(((NeighbourState *)0)->name) }
+static const JsonField s_fields[] = {
+    FIELD(version, KIND_UINT),  FIELD(team_id, KIND_UINT),  FIELD(node_id, KIND_HEX),
+    FIELD(seq_number, KIND_UINT), FIELD(ts_s, KIND_UINT),   FIELD(ts_ms, KIND_UINT),
+    FIELD(x_mm, KIND_INT),      FIELD(y_mm, KIND_INT),      FIELD(z_mm, KIND_INT),
+    FIELD(vx_mm_s, KIND_INT),   FIELD(vy_mm_s, KIND_INT),   FIELD(vz_mm_s, KIND_INT),
+    FIELD(yaw_cd, KIND_UINT),   FIELD(mac_tag, KIND_HEX),
+};
+#undef FIELD
+#define N_FIELDS (sizeof(s_fields) / sizeof(s_fields[0]))
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Value at *p into the field; advances *p
+static bool parse_value(const JsonField *fd, const char **p, const char *end, uint8_t *dst)
+{
+    const char *s = *p;
+    if (fd->kind == KIND_HEX) {
+        if (s >= end || *s++ != '"') return false;
+        for (size_t i = 0; i < fd->size; ++i) {
+            if (end - s < 2) return false;
+            int hi = hex_nibble(s[0]), lo = hex_nibble(s[1]);
+            if (hi < 0 || lo < 0) return false;
+            dst[i] = (uint8_t)(hi << 4 | lo);
+            s += 2;
+        }
+        if (s >= end || *s++ != '"') return false;
+        *p = s;
+        return true;
+    }
+
+    bool neg = s < end && *s == '-';
+    if (neg) {
+        if (fd->kind != KIND_INT) return false;
+        s++;
+    }
+    if (s >= end || *s < '0' || *s > '9') return false;
+    uint64_t v = 0;
+    while (s < end && *s >= '0' && *s <= '9') {
+        v = v * 10 + (uint64_t)(*s++ - '0');
+        if (v > UINT32_MAX + 1ull) return false;
+    }
+
+    uint32_t u;
+    if (fd->kind == KIND_INT) {
+        // (int) of the wire value: int32 range, stored as its bits
+        if (neg ? v > 0x80000000ull : v > INT32_MAX) return false;
+        u = neg ? (uint32_t)(-(int64_t)v) : (uint32_t)v;
+    } else {
+        if (fd->size < 4 && v >> (8 * fd->size)) return false;
+        if (v > UINT32_MAX) return false;
+        u = (uint32_t)v;
+    }
+    // Host order: the struct is read as values, not bytes
+    if (fd->size == 1) {
+        dst[0] = (uint8_t)u;
+    } else if (fd->size == 2) {
+        uint16_t h = (uint16_t)u;
+        memcpy(dst, &h, 2);
+    } else {
+        memcpy(dst, &u, 4);
+    }
+    *p = s;
+    return true;
+}
+
+// One object at p; the first byte after it, NULL if it isn't one
+static const char *parse_object(const char *p, const char *end, NeighbourState *out)
+{
+    uint32_t seen = 0;
+    NeighbourState n;
+    memset(&n, 0, sizeof(n));
+
+    if (p >= end || *p++ != '{') return NULL;
+    while (p < end && *p != '}') {
+        if (*p++ != '"') return NULL;
+        const char *key = p;
+        while (p < end && *p != '"') p++;
+        if (end - p < 2 || p[1] != ':') return NULL;
+        size_t key_len = (size_t)(p - key);
+        p += 2;
+
+        size_t i = 0;
+        while (i < N_FIELDS && !(strlen(s_fields[i].key) == key_len &&
+                                 memcmp(s_fields[i].key, key, key_len) == 0)) i++;
+        if (i == N_FIELDS) return NULL;
+        if (!parse_value(&s_fields[i], &p, end, (uint8_t *)&n + s_fields[i].offset)) return NULL;
+        seen |= 1u << i;
+
+        if (p < end && *p == ',') p++;
+    }
+    if (p >= end || seen != (1u << N_FIELDS) - 1) return NULL;
+
+    *out = n;
+    return p + 1;
+}
+
+bool telem_decode_json(const char *payload, size_t len, NeighbourState *out)
+{
+    return parse_object(payload, payload + len, out) != NULL;
+}
+
+bool telem_decode(const uint8_t *payload, size_t len, NeighbourState *out, TelemEncoding *enc)
+{
+    if (len == 0) return false;
+    TelemEncoding e = payload[0] == '{' ? TELEM_JSON : TELEM_BINARY;
+    if (enc) *enc = e;
+    return e == TELEM_JSON ? telem_decode_json((const char *)payload, len, out)
+                           : telem_decode_binary(payload, len, out);
+}
+
+// -----------------------------------------------------------------------------
+// BATCH
+// -----------------------------------------------------------------------------
+static size_t decode_batch_json(const char *p, const char *end, NeighbourState *out, size_t max)
+{
+    size_t n = 0;
+    if (p >= end || *p++ != '[') return 0;
+    while (n < max) {
+        p = parse_object(p, end, &out[n]);
+        if (!p || p >= end) return 0;
+        n++;
+        if (*p == ']') return n;
+        if (*p++ != ',') return 0;
+    }
+    return 0;
+}
+
+size_t telem_decode_batch(const uint8_t *payload, size_t len, NeighbourState *out,
+                          size_t max, TelemEncoding *enc)
+{
+    if (len == 0) return 0;
+    TelemEncoding e = payload[0] == '[' ? TELEM_JSON : TELEM_BINARY;
+    if (enc) *enc = e;
+    if (e == TELEM_JSON) {
+        return decode_batch_json((const char *)payload, (const char *)payload + len, out, max);
+    }
+
+    if (len < 2 || payload[0] != TELEM_BATCH_SCHEMA) return 0;
+    size_t n = payload[1];
+    if (n == 0 || n > max || len != 2 + n * sizeof(NeighbourState)) return 0;
+    for (size_t i = 0; i < n; ++i) {
+        read_frame(payload + 2 + i * sizeof(NeighbourState), &out[i]);
+    }
+    return n;
+}
@@ -0,0 +1,43 @@
+// host/telem_decode.h
+#pragma once
+
+// Decoders for the MQTT telemetry payloads of telemetry.h, for ground
+// stations and tools. Either encoding gives a NeighbourState:
+//   - binary: all fields read little-endian from the fixed schema, whatever
+//             the host; the frame image itself is kept too, so its mac_tag
+//             can be checked as sent (e.g. by bulk_verify.h)
+//   - JSON:   the fields make_json() writes; link_cfg is not among them
+//             and comes back 0, so the tag of a JSON sample can't be
+//             checked
+// telem_decode() tells the two apart by the first byte, telem_decode_batch()
+// likewise for batches.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "drone_state.h"
+#include "telemetry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// FALSE unless payload is one schema TELEM_BIN_SCHEMA record
+bool telem_decode_binary(const uint8_t *payload, size_t len, NeighbourState *out);
+
+// FALSE if a field is missing, unknown or out of range
+bool telem_decode_json(const char *payload, size_t len, NeighbourState *out);
+
+// Either; the encoding found in *enc (may be NULL)
+bool telem_decode(const uint8_t *payload, size_t len, NeighbourState *out,
+                  TelemEncoding *enc);
+
+// A batch of either encoding into out[0..max); how many samples, 0 if it
+// isn't one or holds more than max
+size_t telem_decode_batch(const uint8_t *payload, size_t len, NeighbourState *out,
+                          size_t max, TelemEncoding *enc);
+
+#ifdef __cplusplus
+}
+#endif
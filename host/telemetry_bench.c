@@ -0,0 +1,173 @@
+// host/telemetry_bench.c
+// MQTT telemetry: the JSON of make_json() against the fixed binary schema
+// (telemetry.c), both decoded with host/telem_decode.c.
+//
+// BENCH_SAMPLES random signed states (full field ranges, negative positions
+// and velocities included) are encoded both ways. Checked: binary decodes
+// to the exact frame, JSON to every field it carries (all but link_cfg).
+// Reported:
+//   - payload:   bytes per sample, min / mean / max
+//   - encode:    CPU per sample on this host (best of BENCH_RUNS); the
+//                firmware pays the same calls at TELEMETRY_FREQ_HZ
+//   - decode:    CPU per sample at the ground station
+//   - broker:    MQTT bytes per sample (QoS 1 PUBLISH on the topic + its
+//                PUBACK), and into the broker for BENCH_FLEET drones at
+//                TELEMETRY_FREQ_HZ, with TCP/IPv4 headers (one segment
+//                per PUBLISH) in brackets
+
+#include "telemetry.h"
+#include "telem_decode.h"
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SAMPLES   4096
+#define BENCH_RUNS      20
+#define BENCH_FLEET     MAX_NEIGHBOURS
+#define TCPIP_HEADER    40
+#define MQTT_PUBACK     4
+#define BENCH_BIN_TOPIC MQTT_TOPIC "/bin"  // Off ("") in config.h by default
+
+static uint32_t s_rng = 0x2545F491u;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void random_state(NeighbourState *n, uint16_t seq)
+{
+    memset(n, 0, sizeof(*n));
+    n->version    = VERSION;
+    n->team_id    = TEAM_ID;
+    for (int i = 0; i < 6; ++i) n->node_id[i] = (uint8_t)rng_next();
+    n->seq_number = seq;
+    n->ts_s       = 1750000000u + rng_next() % 100000u;
+    n->ts_ms      = (uint16_t)(rng_next() % 1000);
+    // Mostly arena-sized, sometimes anything (negative as (int))
+    bool wide = rng_next() % 8 == 0;
+    n->x_mm = wide ? rng_next() : rng_next() % 200000u;
+    n->y_mm = wide ? rng_next() : rng_next() % 200000u;
+    n->z_mm = wide ? rng_next() : rng_next() % 50000u;
+    n->vx_mm_s = wide ? (int32_t)rng_next() : (int32_t)(rng_next() % 20001) - 10000;
+    n->vy_mm_s = wide ? (int32_t)rng_next() : (int32_t)(rng_next() % 20001) - 10000;
+    n->vz_mm_s = wide ? (int32_t)rng_next() : (int32_t)(rng_next() % 4001) - 2000;
+    n->yaw_cd  = (uint16_t)(rng_next() % 36000);
+    n->link_cfg = (uint16_t)rng_next();
+    for (int i = 0; i < 4; ++i) n->mac_tag[i] = (uint8_t)rng_next();
+}
+
+// QoS 1 PUBLISH: fixed header, remaining length, topic, packet id, payload
+static size_t mqtt_publish_bytes(const char *topic, size_t payload)
+{
+    size_t remaining = 2 + strlen(topic) + 2 + payload;
+    size_t len_bytes = 1;
+    for (size_t r = remaining; r > 127; r >>= 7) len_bytes++;
+    return 1 + len_bytes + remaining;
+}
+
+typedef struct {
+    size_t min, max;
+    double mean, enc_ns, dec_ns, mqtt;
+    bool   ok;
+} EncResult;
+
+static EncResult run(TelemEncoding enc, const NeighbourState *states, const char *topic)
+{
+    static uint8_t buf[BENCH_SAMPLES][MAX_JSON_STRING_LENGTH];
+    static size_t  len[BENCH_SAMPLES];
+    EncResult r = { .min = SIZE_MAX, .enc_ns = 1e30, .dec_ns = 1e30, .ok = true };
+
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        double t0 = now_ns();
+        for (int i = 0; i < BENCH_SAMPLES; ++i) {
+            len[i] = telem_encode(enc, &states[i], buf[i], sizeof(buf[i]));
+        }
+        double ns = (now_ns() - t0) / BENCH_SAMPLES;
+        if (ns < r.enc_ns) r.enc_ns = ns;
+    }
+
+    for (int run = 0; run < BENCH_RUNS; ++run) {
+        NeighbourState out;
+        uint32_t acc = 0;
+        double t0 = now_ns();
+        for (int i = 0; i < BENCH_SAMPLES; ++i) {
+            r.ok &= telem_decode(buf[i], len[i], &out, NULL);
+            acc += out.seq_number;
+        }
+        double ns = (now_ns() - t0) / BENCH_SAMPLES;
+        if (ns < r.dec_ns) r.dec_ns = ns;
+        r.ok &= acc != 0xFFFFFFFFu;    // Keep the decode
+    }
+
+    for (int i = 0; i < BENCH_SAMPLES; ++i) {
+        NeighbourState out, want = states[i];
+        TelemEncoding got;
+        r.ok &= len[i] > 0 && telem_decode(buf[i], len[i], &out, &got) && got == enc;
+        if (enc == TELEM_JSON) want.link_cfg = 0;
+        r.ok &= memcmp(&out, &want, sizeof(want)) == 0;
+
+        if (len[i] < r.min) r.min = len[i];
+        if (len[i] > r.max) r.max = len[i];
+        r.mean += (double)len[i] / BENCH_SAMPLES;
+        r.mqtt += (double)(mqtt_publish_bytes(topic, len[i]) + MQTT_PUBACK) / BENCH_SAMPLES;
+    }
+    return r;
+}
+
+int main(void)
+{
+    static NeighbourState states[BENCH_SAMPLES];
+    for (int i = 0; i < BENCH_SAMPLES; ++i) random_state(&states[i], (uint16_t)i);
+
+    static const char *const names[TELEM_ENCODINGS] = { "JSON", "binary" };
+    static const char *const topics[TELEM_ENCODINGS] = {
+        MQTT_TELEM_JSON_TOPIC, BENCH_BIN_TOPIC
+    };
+
+    printf("%d random signed states; broker load for %d drones at %d Hz, QoS 1\n\n",
+           BENCH_SAMPLES, BENCH_FLEET, TELEMETRY_FREQ_HZ);
+    printf("%-6s | %-13s | %15s | %9s | %9s | %10s | %21s | %s\n", "enc", "topic",
+           "payload min/avg/max", "encode", "decode", "MQTT/msg", "broker in", "round trip");
+
+    double base_enc = 0.0, base_bw = 0.0;
+    bool all = true;
+    for (int e = 0; e < TELEM_ENCODINGS; ++e) {
+        EncResult r = run((TelemEncoding)e, states, topics[e]);
+        double bw    = r.mqtt * BENCH_FLEET * TELEMETRY_FREQ_HZ;
+        double bw_ip = (r.mqtt + 2 * TCPIP_HEADER) * BENCH_FLEET * TELEMETRY_FREQ_HZ;
+        if (e == TELEM_JSON) {
+            base_enc = r.enc_ns;
+            base_bw  = bw;
+        }
+        all &= r.ok;
+        printf("%-6s | %-13s | %4zu/%5.1f/%4zu | %6.1f ns | %6.1f ns | %7.1f B | %6.1f kB/s (%6.1f) | %s\n",
+               names[e], topics[e], r.min, r.mean, r.max, r.enc_ns, r.dec_ns, r.mqtt,
+               bw / 1000, bw_ip / 1000, r.ok ? "OK" : "FAIL");
+        if (e != TELEM_JSON) {
+            printf("%-6s   encode %.1fx faster, %.1fx less broker traffic\n", "",
+                   base_enc / r.enc_ns, base_bw / bw);
+        }
+    }
+
+    printf("\npayload    = bytes per sample\n");
+    printf("encode     = telem_encode() per sample on this host\n");
+    printf("decode     = telem_decode() per sample (ground station)\n");
+    printf("MQTT/msg   = PUBLISH (QoS 1) + PUBACK bytes per sample\n");
+    printf("broker in  = MQTT bytes/s for the fleet (with TCP/IPv4 headers, PUBLISH and PUBACK)\n");
+    printf("round trip = every sample decodes to what was encoded (JSON: all but link_cfg)\n");
+    return all ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+// host/tx_policy_sim.c
+// Compares fixed-rate broadcasting against send-on-delta (tx_policy.c).
+// One drone flies a scripted mix of hovering, cruising and manoeuvring using
+// the same first-order velocity smoothing as physics.c. A receiver
+// dead-reckons it from the last packet heard; we report airtime/energy
+// against the position error that receiver sees.
+
+#include "tx_policy.h"
+#include "lora_airtime.h"
+#include "drone_state.h"
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SIM_DURATION_S          1200
+#define SIM_STEP_MS             PHYSICS_PERIOD_MS
+
+typedef struct {
+    const char    *name;
+    TxPolicyConfig cfg;
+} SimPolicy;
+
+typedef struct {
+    uint32_t packets;
+    double   sum_err;
+    double   max_err;
+    uint32_t samples;
+    uint32_t hist[64];  // 250mm buckets for percentiles
+} SimResult;
+
+static uint32_t s_rng = 0x12345678u;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double rng_uniform(double lo, double hi)
+{
+    return lo + (hi - lo) * ((double)rng_next() / 4294967295.0);
+}
+
+// Scripted flight: 30% hover, 40% cruise, 30% manoeuvre (new target every 2s)
+static void pick_target(uint32_t t_ms, DroneState *s, double tgt[3])
+{
+    (void)s;
+    uint32_t phase = (t_ms / 20000) % 10;
+
+    if (phase < 3) {
+        tgt[0] = tgt[1] = tgt[2] = 0.0;
+    } else if (phase < 7) {
+        tgt[0] = 500.0; tgt[1] = 200.0; tgt[2] = 0.0;
+    } else if (t_ms % 2000 == 0) {
+        tgt[0] = rng_uniform(-MAX_SPEED_MM_S, MAX_SPEED_MM_S);
+        tgt[1] = rng_uniform(-MAX_SPEED_MM_S, MAX_SPEED_MM_S);
+        tgt[2] = rng_uniform(-200.0, 200.0);
+    }
+}
+
+static void quantise(const DroneState *s, NeighbourState *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->x_mm    = (uint32_t)s->x_mm;
+    out->y_mm    = (uint32_t)s->y_mm;
+    out->z_mm    = (uint32_t)s->z_mm;
+    out->vx_mm_s = (int32_t)s->vx_mm_s;
+    out->vy_mm_s = (int32_t)s->vy_mm_s;
+    out->vz_mm_s = (int32_t)s->vz_mm_s;
+}
+
+static double percentile(const SimResult *r, double pct)
+{
+    uint32_t target = (uint32_t)(r->samples * pct);
+    uint32_t acc = 0;
+    for (int i = 0; i < 64; ++i) {
+        acc += r->hist[i];
+        if (acc >= target) return (i + 1) * 250.0;
+    }
+    return 64 * 250.0;
+}
+
+static void run(const SimPolicy *pol, SimResult *res)
+{
+    memset(res, 0, sizeof(*res));
+    s_rng = 0x12345678u;   // same flight for every policy
+
+    DroneState s = {
+        .x_mm = 30000.0, .y_mm = 30000.0, .z_mm = 30000.0,
+    };
+    double tgt[3] = {0};
+
+    TxPolicy p;
+    tx_policy_init(&p, &pol->cfg);
+
+    const double dt    = SIM_STEP_MS / 1000.0;
+    const double alpha = 0.2;
+
+    for (uint32_t t = 0; t < SIM_DURATION_S * 1000u; t += SIM_STEP_MS) {
+        pick_target(t, &s, tgt);
+
+        s.vx_mm_s += (tgt[0] - s.vx_mm_s) * alpha;
+        s.vy_mm_s += (tgt[1] - s.vy_mm_s) * alpha;
+        s.vz_mm_s += (tgt[2] - s.vz_mm_s) * alpha;
+        s.x_mm    += s.vx_mm_s * dt;
+        s.y_mm    += s.vy_mm_s * dt;
+        s.z_mm    += s.vz_mm_s * dt;
+
+        // Radio task samples the policy on its own check grid
+        if (t % pol->cfg.check_period_ms == 0 &&
+            tx_policy_should_send(&p, &s, t)) {
+            NeighbourState pkt;
+            quantise(&s, &pkt);
+            tx_policy_on_sent(&p, &pkt, t);
+            res->packets++;
+        }
+
+        double err = tx_policy_error_mm(&p, &s, t);
+        res->sum_err += err;
+        if (err > res->max_err) res->max_err = err;
+        int bucket = (int)(err / 250.0);
+        if (bucket > 63) bucket = 63;
+        res->hist[bucket]++;
+        res->samples++;
+    }
+}
+
+int main(void)
+{
+    const SimPolicy policies[] = {
+        { "fixed 5000ms", { 5000, 5000, 5000, INFINITY } },
+        { "fixed 1000ms", { 1000, 1000, 1000, INFINITY } },
+        { "fixed  500ms", {  500,  500,  500, INFINITY } },
+        { "delta  500mm", {  500, 5000,  100,  500.0 } },
+        { "delta 1000mm", {  500, 5000,  100, 1000.0 } },
+        { "delta 2000mm", {  500, 5000,  100, 2000.0 } },
+    };
+
+    // One NeighbourState @ SF9 / BW250 / CR4:7 / 10-sym preamble
+    LoraAirParams air = { 9, 250.0f, 7, 10, true, false };
+    double packet_ms = lora_time_on_air_us(&air, sizeof(NeighbourState)) / 1000.0;
+
+    printf("Send-on-delta simulation: %ds flight, %.0fms airtime/packet\n\n",
+           SIM_DURATION_S, packet_ms);
+    printf("%-14s | %7s | %9s | %7s | %9s | %9s | %9s\n",
+           "policy", "packets", "airtime s", "duty %", "TX mAh",
+           "mean err", "p95 err");
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+        SimResult r;
+        run(&policies[i], &r);
+
+        double airtime_s = r.packets * packet_ms / 1000.0;
+        double tx_mah    = EST_CURRENT_LORA_TX_MA * airtime_s / 3600.0;
+
+        printf("%-14s | %7u | %9.1f | %7.2f | %9.4f | %7.0fmm | %7.0fmm\n",
+               policies[i].name, r.packets, airtime_s,
+               100.0 * airtime_s / SIM_DURATION_S, tx_mah,
+               r.sum_err / r.samples, percentile(&r, 0.95));
+    }
+
+    return 0;
+}
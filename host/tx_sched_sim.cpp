@@ -0,0 +1,373 @@
+// host/tx_sched_sim.cpp
+// Own-state latency and reception under test injection: the old radio_task
+// loop (inline injection TX + spin-wait, own TX only on semaphore timeout)
+// against the tx_sched.c loop, on the simulated SX1276 channel.
+//
+// One node under test (DUT) broadcasts its state every second and, in the
+// flood scenarios, gets attack packets pushed into its 10-deep attack queue
+// at 50 Hz like attacker.c. Eight neighbours broadcast every two seconds.
+// Periods carry some jitter (send-on-delta, clock drift) so no two nodes stay
+// phase-locked onto each other. We report DUT own-state latency (due -> on air), how many
+// neighbour frames the DUT still receives, how many of its own broadcasts
+// reach the neighbours, and the injected frames that went out.
+
+#include "sim_radio.h"
+
+extern "C" {
+#include "config.h"
+#include "drone_state.h"
+#include "tx_sched.h"
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define SIM_DURATION_S      300
+#define SIM_NEIGHBOURS      8
+#define SIM_OWN_PERIOD_MS   1000
+#define SIM_NB_PERIOD_MS    2000
+#define SIM_JITTER_MS       100
+#define SIM_ISR_TO_TASK_US  200
+#define SIM_ECHO_GUARD_US   50000
+#define SIM_ATTACK_Q_LEN    10
+#define SIM_ATTACK_HZ       50.0
+#define SIM_SF              7
+
+static uint64_t ms_to_us(uint64_t ms) { return ms * 1000; }
+
+static std::mt19937 s_rng;
+
+static uint64_t period_us(uint32_t period_ms)
+{
+    std::uniform_int_distribution<int> j(-SIM_JITTER_MS, SIM_JITTER_MS);
+    return ms_to_us(period_ms + j(s_rng));
+}
+
+// A task blocked in xSemaphoreTake(RX_SEM, timeout) on the simulated clock:
+// body(taken) runs on the DIO0 give or when the timeout expires.
+struct SemTask {
+    SimChannel &ch;
+    std::function<void(bool)> body;
+    bool     sem = false;
+    bool     waiting = false;
+    uint64_t gen = 0;
+
+    explicit SemTask(SimChannel &c) : ch(c) {}
+
+    void give()
+    {
+        if (!waiting) { sem = true; return; }
+        waiting = false;
+        gen++;
+        ch.at(ch.now_us() + SIM_ISR_TO_TASK_US, [this] { body(true); });
+    }
+
+    void wait(uint64_t timeout_us)
+    {
+        if (sem) {
+            sem = false;
+            ch.at(ch.now_us(), [this] { body(true); });
+            return;
+        }
+        waiting = true;
+        uint64_t g = ++gen;
+        ch.at(ch.now_us() + timeout_us, [this, g] {
+            if (waiting && gen == g) { waiting = false; body(false); }
+        });
+    }
+};
+
+enum Kind : uint8_t { KIND_OWN = 1, KIND_ATTACK = 2 };
+
+struct Counters {
+    std::vector<uint32_t> own_latency_ms;
+    uint64_t own_sent = 0;
+    uint64_t own_heard = 0;     // Neighbour receptions of DUT own state
+    uint64_t nb_sent = 0;
+    uint64_t nb_heard = 0;      // DUT receptions of neighbour frames
+    uint64_t attack_sent = 0;
+    uint64_t attack_dropped = 0;
+};
+
+struct Node {
+    std::unique_ptr<SimRadio> radio;
+    std::unique_ptr<SemTask>  task;
+    int  id = 0;
+    bool transmitting = false;
+    uint64_t last_tx_end_us = 0;
+    uint64_t next_own_us = 0;   // Own state due
+    uint64_t guard_us = 0;
+    bool     spinning = false;  // Legacy: inside the injection spin-wait
+    std::deque<std::vector<uint8_t>> attack_q;
+};
+
+static std::vector<uint8_t> frame(int from, Kind kind)
+{
+    std::vector<uint8_t> f(sizeof(NeighbourState), 0);
+    f[0] = (uint8_t)from;
+    f[1] = kind;
+    return f;
+}
+
+// --- Common RX handling (anti-echo, readData, re-arm) ---
+static void handle_rx(SimChannel &ch, Node &n, Counters &c)
+{
+    if (ch.now_us() - n.last_tx_end_us < SIM_ECHO_GUARD_US) {
+        n.radio->startReceive();
+        return;
+    }
+    uint8_t buf[64];
+    size_t len = std::min(n.radio->getPacketLength(), sizeof(buf));
+    if (n.radio->readData(buf, len) == RADIOLIB_ERR_NONE && len == sizeof(NeighbourState)) {
+        if (n.id == 0 && buf[0] != 0) c.nb_heard++;
+        if (n.id != 0 && buf[0] == 0 && buf[1] == KIND_OWN) c.own_heard++;
+    }
+    n.radio->startReceive();
+}
+
+static void tx_done(SimChannel &ch, Node &n)
+{
+    n.transmitting = false;
+    n.last_tx_end_us = ch.now_us();
+    n.radio->startReceive();
+}
+
+// -----------------------------------------------------------------------------
+// Legacy loop (pre tx_sched radio_task)
+// -----------------------------------------------------------------------------
+static void legacy_loop_top(SimChannel &ch, Node &n, Counters &c);
+
+static void legacy_body(SimChannel &ch, Node &n, Counters &c, bool taken)
+{
+    if (n.spinning) {
+        // while (s_transmitting) xSemaphoreTake(RX_SEM, 100ms)
+        if (taken && n.transmitting) {
+            tx_done(ch, n);
+            n.spinning = false;
+            legacy_loop_top(ch, n, c);
+        } else {
+            n.task->wait(ms_to_us(100));
+        }
+        return;
+    }
+
+    if (taken) {
+        if (n.transmitting) tx_done(ch, n);
+        else handle_rx(ch, n, c);
+    } else {
+        // Timeout branch: own state
+        std::vector<uint8_t> f = frame(n.id, KIND_OWN);
+        if (n.radio->startTransmit(f.data(), f.size()) == RADIOLIB_ERR_NONE) {
+            n.transmitting = true;
+            if (n.id == 0) {
+                c.own_sent++;
+                c.own_latency_ms.push_back((uint32_t)((ch.now_us() - n.next_own_us) / 1000));
+            } else {
+                c.nb_sent++;
+            }
+        }
+        n.next_own_us = ch.now_us() + period_us(SIM_OWN_PERIOD_MS);
+    }
+    legacy_loop_top(ch, n, c);
+}
+
+static void legacy_loop_top(SimChannel &ch, Node &n, Counters &c)
+{
+    if (!n.attack_q.empty()) {
+        std::vector<uint8_t> f = n.attack_q.front();
+        n.attack_q.pop_front();
+        if (n.radio->startTransmit(f.data(), f.size()) == RADIOLIB_ERR_NONE) {
+            n.transmitting = true;
+            c.attack_sent++;
+        }
+        n.spinning = true;
+        n.task->wait(ms_to_us(100));
+        return;
+    }
+    uint64_t now = ch.now_us();
+    n.task->wait(n.next_own_us > now ? n.next_own_us - now : 0);
+}
+
+// -----------------------------------------------------------------------------
+// Scheduler loop (tx_sched.c, as in radio_task now). The scheduler is a
+// singleton, so only the DUT uses it; neighbours only send their own state.
+// -----------------------------------------------------------------------------
+static void sched_body(SimChannel &ch, Node &n, Counters &c, bool taken)
+{
+    if (taken) {
+        if (n.transmitting) {
+            tx_done(ch, n);
+            if (n.id == 0) tx_sched_on_tx_done((uint32_t)(ch.now_us() / 1000));
+        } else {
+            handle_rx(ch, n, c);
+        }
+    } else if (n.transmitting && ch.now_us() >= n.guard_us) {
+        tx_done(ch, n);
+    }
+
+    uint64_t now = ch.now_us();
+    uint32_t now_ms = (uint32_t)(now / 1000);
+
+    if (n.id != 0) {
+        if (!n.transmitting && now >= n.next_own_us) {
+            std::vector<uint8_t> f = frame(n.id, KIND_OWN);
+            n.radio->startTransmit(f.data(), f.size());
+            n.transmitting = true;
+            n.guard_us = now + n.radio->getTimeOnAir(f.size()) + ms_to_us(TX_SCHED_TX_GUARD_MS);
+            n.next_own_us = now + period_us(SIM_NB_PERIOD_MS);
+            c.nb_sent++;
+        }
+        uint64_t wait = n.transmitting ? n.guard_us - now
+                                       : (n.next_own_us > now ? n.next_own_us - now : 0);
+        n.task->wait(wait);
+        return;
+    }
+
+    // 1. Injection
+    while (!n.attack_q.empty()) {
+        std::vector<uint8_t> &f = n.attack_q.front();
+        tx_sched_enqueue(TX_CLASS_INJECT, f.data(), f.size(), now_ms,
+                         now_ms + TX_SCHED_INJECT_DEADLINE_MS);
+        n.attack_q.pop_front();
+    }
+
+    // 2. Own state
+    static uint64_t own_due_us;
+    if (now >= n.next_own_us) {
+        if (!tx_sched_pending(TX_CLASS_OWN)) {
+            std::vector<uint8_t> f = frame(n.id, KIND_OWN);
+            tx_sched_enqueue(TX_CLASS_OWN, f.data(), f.size(), now_ms,
+                             now_ms + TX_SCHED_OWN_DEADLINE_MS);
+            own_due_us = n.next_own_us;
+        }
+        n.next_own_us += period_us(SIM_OWN_PERIOD_MS);
+    }
+
+    // 3. TX
+    TxItem it;
+    if (!n.transmitting && tx_sched_next(&it, now_ms)) {
+        if (n.radio->startTransmit(it.data, it.len) == RADIOLIB_ERR_NONE) {
+            n.transmitting = true;
+            n.guard_us = now + n.radio->getTimeOnAir(it.len) + ms_to_us(TX_SCHED_TX_GUARD_MS);
+            tx_sched_on_tx_start(&it, now_ms);
+            if (it.cls == TX_CLASS_OWN) {
+                c.own_sent++;
+                c.own_latency_ms.push_back((uint32_t)((now - own_due_us) / 1000));
+            } else {
+                c.attack_sent++;
+            }
+        }
+    }
+
+    // 4. Wait
+    uint64_t wait = n.next_own_us > now ? n.next_own_us - now : 0;
+    if (n.transmitting) {
+        wait = std::min(wait, n.guard_us > now ? n.guard_us - now : 0);
+    } else {
+        uint32_t q = tx_sched_wait_ms(now_ms);
+        if (q != UINT32_MAX) wait = std::min(wait, ms_to_us(q));
+    }
+    wait = std::min(wait, ms_to_us(RADIO_TX_CHECK_PERIOD_MS));
+    n.task->wait(wait);
+}
+
+// -----------------------------------------------------------------------------
+// Scenario
+// -----------------------------------------------------------------------------
+static void run(bool legacy, bool flood, Counters &c)
+{
+    SimChannelConfig cfg;
+    cfg.seed = 3;
+    SimChannel ch(cfg);
+    std::mt19937 rng(11);
+    s_rng.seed(7);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    tx_sched_init();
+
+    std::vector<Node> nodes(SIM_NEIGHBOURS + 1);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        Node &n = nodes[i];
+        n.id = (int)i;
+        n.radio = std::make_unique<SimRadio>(ch);
+        n.radio->set_position(uni(rng) * 300.0, uni(rng) * 300.0, 20.0);
+        n.radio->begin(868.2f, 250.0f, SIM_SF, 7, 0x12, 14, 10);
+        n.task = std::make_unique<SemTask>(ch);
+
+        Node *np = &n;
+        bool use_legacy = legacy && i == 0;
+        n.task->body = [&ch, np, &c, use_legacy](bool taken) {
+            if (use_legacy) legacy_body(ch, *np, c, taken);
+            else            sched_body(ch, *np, c, taken);
+        };
+        n.radio->setDio0Action([np] { np->task->give(); }, 0);
+        n.radio->startReceive();
+
+        n.next_own_us = (uint64_t)(uni(rng) * ms_to_us(SIM_OWN_PERIOD_MS));
+        ch.at(0, [np, use_legacy, &ch, &c] {
+            if (use_legacy) legacy_loop_top(ch, *np, c);
+            else            sched_body(ch, *np, c, false);
+        });
+    }
+
+    Node *dut = &nodes[0];
+    std::function<void()> attacker = [&]() {
+        if (dut->attack_q.size() < SIM_ATTACK_Q_LEN) {
+            dut->attack_q.push_back(frame(0, KIND_ATTACK));
+        } else {
+            c.attack_dropped++;
+        }
+        ch.at(ch.now_us() + (uint64_t)(1e6 / SIM_ATTACK_HZ), attacker);
+    };
+    if (flood) ch.at(0, attacker);
+
+    ch.run_until(ms_to_us((uint64_t)SIM_DURATION_S * 1000));
+}
+
+static uint32_t pct(std::vector<uint32_t> v, double p)
+{
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t i = std::min(v.size() - 1, (size_t)(p * v.size()));
+    return v[i];
+}
+
+int main(void)
+{
+    printf("TX scheduling: %ds, DUT (every %d ms) + %d neighbours (every %d ms), SF%d, "
+           "injection %.0f Hz\n\n", SIM_DURATION_S, SIM_OWN_PERIOD_MS, SIM_NEIGHBOURS,
+           SIM_NB_PERIOD_MS, SIM_SF, SIM_ATTACK_HZ);
+    printf("%-9s | %-8s | %8s | %20s | %10s | %10s | %9s\n",
+           "loop", "inject", "own sent", "own lat p50/p99/max", "own heard", "DUT hears",
+           "inj. sent");
+
+    for (int flood = 0; flood < 2; ++flood) {
+        for (int legacy = 1; legacy >= 0; --legacy) {
+            Counters c;
+            run(legacy, flood, c);
+            char lat[32];
+            snprintf(lat, sizeof(lat), "%u/%u/%u ms", pct(c.own_latency_ms, 0.5),
+                     pct(c.own_latency_ms, 0.99), pct(c.own_latency_ms, 1.0));
+            double own_heard = c.own_sent ? 100.0 * c.own_heard / (c.own_sent * SIM_NEIGHBOURS) : 0;
+            double dut_hears = c.nb_sent ? 100.0 * c.nb_heard / c.nb_sent : 0;
+            printf("%-9s | %-8s | %8llu | %20s | %9.1f%% | %9.1f%% | %9llu\n",
+                   legacy ? "inline" : "tx_sched", flood ? "50 Hz" : "none",
+                   (unsigned long long)c.own_sent, lat, own_heard, dut_hears,
+                   (unsigned long long)c.attack_sent);
+        }
+    }
+
+    TxSchedStats st;
+    tx_sched_get_stats(TX_CLASS_INJECT, &st);
+    printf("\ntx_sched inject class (last run): sent %lu, expired %lu, dropped %lu, "
+           "p50/p90/p99 %lu/%lu/%lu ms\n",
+           (unsigned long)st.sent, (unsigned long)st.expired, (unsigned long)st.dropped,
+           (unsigned long)st.p50_ms, (unsigned long)st.p90_ms, (unsigned long)st.p99_ms);
+    return 0;
+}
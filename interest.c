@@ -0,0 +1,127 @@
+// main/interest.c
+#include "interest.h"
+
+#include <string.h>
+
+void interest_default_config(InterestConfig *cfg)
+{
+#if INTEREST_FILTER_ENABLED
+    cfg->radius_mm     = INTEREST_RADIUS_MM;
+#else
+    cfg->radius_mm     = 0.0;           // <= 0: filter off
+#endif
+    cfg->hysteresis_mm = INTEREST_HYSTERESIS_MM;
+    cfg->far_period_ms = INTEREST_FAR_PERIOD_MS;
+}
+
+void interest_init(InterestFilter *f, const InterestConfig *cfg)
+{
+    memset(f, 0, sizeof(*f));
+    f->cfg = *cfg;
+}
+
+void interest_set_own(InterestFilter *f, double x_mm, double y_mm, double z_mm)
+{
+    f->own_mm[0] = x_mm;
+    f->own_mm[1] = y_mm;
+    f->own_mm[2] = z_mm;
+    f->have_own  = true;
+}
+
+static bool older(const InterestPeer *a, const InterestPeer *b)
+{
+    return !b || (int32_t)(a->last_seen_ms - b->last_seen_ms) < 0;
+}
+
+// Peer for this node: existing, free, or the one heard from longest ago
+// (far ones first, so near nodes keep their hysteresis state)
+static InterestPeer *find_peer(InterestFilter *f, const uint8_t node_id[6],
+                               double d2, bool *is_new)
+{
+    InterestPeer *free_slot = NULL, *oldest = NULL, *oldest_far = NULL;
+
+    for (int i = 0; i < INTEREST_PEERS; ++i) {
+        InterestPeer *p = &f->peers[i];
+        if (!p->in_use) {
+            if (!free_slot) free_slot = p;
+            continue;
+        }
+        if (memcmp(p->node_id, node_id, 6) == 0) {
+            *is_new = false;
+            return p;
+        }
+        if (older(p, oldest)) oldest = p;
+        if (!p->near && older(p, oldest_far)) oldest_far = p;
+    }
+
+    InterestPeer *p = free_slot ? free_slot : (oldest_far ? oldest_far : oldest);
+    if (p->in_use) {
+        if (p->near) f->stats.near_nodes--;
+        else         f->stats.far_nodes--;
+    }
+
+    double r = f->cfg.radius_mm;
+    memset(p, 0, sizeof(*p));
+    p->in_use = true;
+    p->near   = d2 <= r * r;
+    memcpy(p->node_id, node_id, 6);
+    if (p->near) f->stats.near_nodes++;
+    else         f->stats.far_nodes++;
+
+    *is_new = true;
+    return p;
+}
+
+bool interest_accept(InterestFilter *f, const NeighbourState *n, uint32_t now_ms)
+{
+    if (!f->have_own || f->cfg.radius_mm <= 0.0) {
+        f->stats.passed++;
+        return true;
+    }
+
+    double dx = (double)n->x_mm - f->own_mm[0];
+    double dy = (double)n->y_mm - f->own_mm[1];
+    double dz = (double)n->z_mm - f->own_mm[2];
+    double d2 = dx*dx + dy*dy + dz*dz;
+
+    bool is_new;
+    InterestPeer *p = find_peer(f, n->node_id, d2, &is_new);
+    p->last_seen_ms = now_ms;
+    if (is_new) {
+        // Far newcomers wait a full period: with more far nodes than peers
+        // they would otherwise all pass as "new" again and again
+        p->last_pass_ms = now_ms;
+    }
+
+    if (!is_new) {
+        double r_in  = f->cfg.radius_mm;
+        double r_out = f->cfg.radius_mm + f->cfg.hysteresis_mm;
+
+        if (!p->near && d2 <= r_in * r_in) {
+            p->near = true;
+            f->stats.entered++;
+            f->stats.near_nodes++;
+            f->stats.far_nodes--;
+        } else if (p->near && d2 > r_out * r_out) {
+            p->near = false;
+            f->stats.left++;
+            f->stats.near_nodes--;
+            f->stats.far_nodes++;
+        }
+    }
+
+    if (p->near) {
+        p->last_pass_ms = now_ms;
+        f->stats.passed++;
+        return true;
+    }
+
+    if (f->cfg.far_period_ms > 0 && now_ms - p->last_pass_ms >= f->cfg.far_period_ms) {
+        p->last_pass_ms = now_ms;
+        f->stats.sampled++;
+        return true;
+    }
+
+    f->stats.dropped++;
+    return false;
+}
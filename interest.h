@@ -0,0 +1,76 @@
+// main/interest.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+#include "drone_state.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Interest filter between the verifier and the flocking task. compute_control()
+// ignores neighbours beyond FLOCKING_NEIGHBOUR_RADIUS_MM, yet in a large swarm
+// their updates would still be copied through neigh_ring, take flocking table
+// slots (evicting close ones once the table is full) and get logged.
+//
+// A node counts as near once its reported position is within radius_mm of
+// our latest own state, and as far again only beyond radius_mm +
+// hysteresis_mm, so a node on the edge does not flap. Updates from near nodes
+// pass. Updates from far nodes are dropped, or one per far_period_ms is let
+// through when that is non-zero. Until our own position is known everything
+// passes.
+//
+// Pure logic, no FreeRTOS: times are plain milliseconds.
+
+typedef struct {
+    double   radius_mm;         // Far -> near
+    double   hysteresis_mm;     // Near -> far beyond radius + hysteresis
+    uint32_t far_period_ms;     // 0: drop every far update
+} InterestConfig;
+
+typedef struct {
+    bool     in_use;
+    bool     near;
+    uint8_t  node_id[6];
+    uint32_t last_seen_ms;
+    uint32_t last_pass_ms;
+} InterestPeer;
+
+typedef struct {
+    uint32_t passed;            // Near, or own position not known yet
+    uint32_t sampled;           // Far, let through by far_period_ms
+    uint32_t dropped;           // Far
+    uint32_t entered;           // Far -> near transitions
+    uint32_t left;              // Near -> far transitions
+    uint32_t near_nodes;        // Right now
+    uint32_t far_nodes;
+} InterestStats;
+
+typedef struct {
+    InterestConfig cfg;
+    bool           have_own;
+    double         own_mm[3];
+    InterestPeer   peers[INTEREST_PEERS];
+    InterestStats  stats;
+} InterestFilter;
+
+// Defaults from config.h
+void interest_default_config(InterestConfig *cfg);
+
+void interest_init(InterestFilter *f, const InterestConfig *cfg);
+
+// Latest own position (mm)
+void interest_set_own(InterestFilter *f, double x_mm, double y_mm, double z_mm);
+
+// TRUE if this verified update should go on to the flocking task
+bool interest_accept(InterestFilter *f, const NeighbourState *n, uint32_t now_ms);
+
+// Stats of the radio's filter instance (comms_lora.cpp), for monitoring
+void radio_get_interest_stats(InterestStats *out);
+
+#ifdef __cplusplus
+}
+#endif
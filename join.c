@@ -0,0 +1,110 @@
+// main/join.c
+#include "join.h"
+#include "config.h"
+
+#include <string.h>
+
+static uint32_t rng_next(Join *j)
+{
+    j->rng ^= j->rng << 13;
+    j->rng ^= j->rng >> 17;
+    j->rng ^= j->rng << 5;
+    return j->rng;
+}
+
+static bool due(uint32_t at_ms, uint32_t now_ms)
+{
+    return (int32_t)(now_ms - at_ms) >= 0;
+}
+
+void join_init(Join *j, uint32_t seed, uint32_t now_ms)
+{
+    memset(j, 0, sizeof(*j));
+    j->rng = seed ? seed : 0x9E3779B9u;
+#if JOIN_ENABLED
+    j->beacons_left   = JOIN_BEACONS;
+    j->next_beacon_ms = now_ms;
+#else
+    (void)now_ms;
+#endif
+}
+
+bool join_active(const Join *j)
+{
+    return j->beacons_left > 0;
+}
+
+bool join_beacon_due(const Join *j, uint32_t now_ms)
+{
+    return j->beacons_left > 0 && due(j->next_beacon_ms, now_ms);
+}
+
+void join_on_request(Join *j, uint32_t count, uint16_t senders, float util,
+                     uint32_t frame_ms, uint32_t now_ms)
+{
+    if (count == 0) return;
+    j->stats.requests += count;
+
+    if (j->beacons_left > 0) return;            // Our beacons announce us
+    if (j->answer_pending) {
+        j->stats.absorbed += count;
+        return;
+    }
+    if (j->answered &&
+        now_ms - j->last_answer_ms < (uint32_t)JOIN_ANSWER_MIN_INTERVAL_MS) {
+        j->stats.limited += count;
+        return;
+    }
+
+    // Spread the neighbourhood's answers over the spare channel time
+    float spare = JOIN_ANSWER_MAX_UTIL - util;
+    if (spare <= 0.0f) {
+        j->stats.busy += count;
+        return;
+    }
+    float window_ms = (float)senders * (float)frame_ms / spare;
+    if (window_ms < (float)JOIN_ANSWER_WINDOW_MS) {
+        window_ms = (float)JOIN_ANSWER_WINDOW_MS;
+    }
+    if (window_ms > (float)JOIN_ANSWER_MIN_INTERVAL_MS) {
+        window_ms = (float)JOIN_ANSWER_MIN_INTERVAL_MS;     // Heartbeat first
+    }
+
+    j->answer_pending = true;
+    j->answer_at_ms   = now_ms + rng_next(j) % (uint32_t)window_ms;
+}
+
+bool join_answer_due(const Join *j, uint32_t now_ms)
+{
+    return j->answer_pending && due(j->answer_at_ms, now_ms);
+}
+
+void join_on_own_state(Join *j, uint32_t now_ms)
+{
+    if (j->beacons_left > 0) {
+        j->beacons_left--;
+        j->stats.beacons++;
+        uint32_t jitter = rng_next(j) % (2 * JOIN_BEACON_JITTER_MS + 1);
+        j->next_beacon_ms = now_ms + JOIN_BEACON_GAP_MS - JOIN_BEACON_JITTER_MS + jitter;
+        return;
+    }
+    if (j->answer_pending) {
+        j->answer_pending = false;
+        j->answered       = true;
+        j->last_answer_ms = now_ms;
+        j->stats.answers++;
+    }
+}
+
+uint32_t join_wait_ms(const Join *j, uint32_t now_ms)
+{
+    uint32_t at;
+    if (j->beacons_left > 0) {
+        at = j->next_beacon_ms;
+    } else if (j->answer_pending) {
+        at = j->answer_at_ms;
+    } else {
+        return UINT32_MAX;
+    }
+    return due(at, now_ms) ? 0 : at - now_ms;
+}
@@ -0,0 +1,80 @@
+// main/join.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fast join. A node that just powered up knows nobody, and at the heartbeat
+// rate it takes up to a full RADIO_TX_PERIOD_MS (longer once congestion
+// control stretches it) before every neighbour has been heard once.
+//
+// Instead, a new node first sends a short burst of JOIN_BEACONS own states,
+// JOIN_BEACON_GAP_MS apart with +-JOIN_BEACON_JITTER_MS jitter (so nodes
+// that boot together do not stay in step), each with LINK_CFG_JOIN set:
+// "please announce". An established node that hears a beacon directly
+// answers with one own state out of schedule, at a random delay. Every
+// neighbour answers, so the window is sized to fit senders answers into
+// the channel time left below JOIN_ANSWER_MAX_UTIL (at least
+// JOIN_ANSWER_WINDOW_MS); with the channel already busier than that nobody
+// answers and the heartbeats have to do. Further beacons while an answer is
+// pending are absorbed by it, any own state sent meanwhile counts as the
+// answer, and a node answers at most once per JOIN_ANSWER_MIN_INTERVAL_MS.
+// Nodes still joining do not answer: their own beacons announce them.
+//
+// Pure logic, no FreeRTOS: times are plain milliseconds.
+
+typedef struct {
+    uint32_t beacons;           // Join beacons sent
+    uint32_t requests;          // Join beacons heard directly
+    uint32_t answers;           // Pending answers sent (or covered by a due state)
+    uint32_t absorbed;          // Requests covered by a pending answer
+    uint32_t limited;           // Requests ignored by the rate limit
+    uint32_t busy;              // Requests ignored, channel too busy
+} JoinStats;
+
+typedef struct {
+    uint8_t   beacons_left;
+    uint32_t  next_beacon_ms;
+    bool      answer_pending;
+    uint32_t  answer_at_ms;
+    bool      answered;         // last_answer_ms valid
+    uint32_t  last_answer_ms;
+    uint32_t  rng;
+    JoinStats stats;
+} Join;
+
+// Starts in the join phase, first beacon due now. JOIN_ENABLED == 0: never
+// beacons (but still answers other nodes' beacons).
+void join_init(Join *j, uint32_t seed, uint32_t now_ms);
+
+// Still sending beacons: every own state goes out with LINK_CFG_JOIN
+bool join_active(const Join *j);
+
+// A beacon is due now (bypasses the send-on-delta rate cap)
+bool join_beacon_due(const Join *j, uint32_t now_ms);
+
+// count join beacons heard directly. senders and util (busy fraction) are
+// the congestion.h estimates, frame_ms the airtime of one state.
+void join_on_request(Join *j, uint32_t count, uint16_t senders, float util,
+                     uint32_t frame_ms, uint32_t now_ms);
+
+// An answer is due now (bypasses the send-on-delta rate cap)
+bool join_answer_due(const Join *j, uint32_t now_ms);
+
+// Own state queued for TX: a beacon while join_active(), else it covers
+// a pending answer
+void join_on_own_state(Join *j, uint32_t now_ms);
+
+// Time until the next beacon or answer, UINT32_MAX if none
+uint32_t join_wait_ms(const Join *j, uint32_t now_ms);
+
+// Stats of the radio's instance (comms_lora.cpp), for monitoring
+void radio_get_join_stats(JoinStats *out);
+
+#ifdef __cplusplus
+}
+#endif
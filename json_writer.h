@@ -0,0 +1,186 @@
+// main/json_writer.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "packet_view.h"
+
+// Flat JSON objects written straight from a wire frame, for telemetry.
+//
+// The object is a compile-time list of members: a key, a field of the wire
+// schema (packet_view.h) and how to print it. Everything that doesn't depend
+// on the values (braces, quotes, keys, separators) is fixed text built at
+// compile time; at run time only the values are formatted, by dedicated
+// decimal and hex routines. No format string, no locale, no heap, and the
+// longest possible object (max_len) is a compile-time constant, so a buffer
+// of max_len + 1 never needs a check.
+//
+// C++20 (string literal template arguments); header-only.
+
+#if __cplusplus < 202002L
+#error json_writer.h needs C++20 (ESP-IDF 5 builds gnu++20 or later)
+#endif
+
+namespace json {
+
+// -----------------------------------------------------------------------------
+// VALUES
+// -----------------------------------------------------------------------------
+// "00".."99", two digits per step
+struct DigitPairs {
+    char s[200];
+    constexpr DigitPairs() : s()
+    {
+        for (int i = 0; i < 100; ++i) {
+            s[2 * i]     = (char)('0' + i / 10);
+            s[2 * i + 1] = (char)('0' + i % 10);
+        }
+    }
+};
+inline constexpr DigitPairs digit_pairs{};
+
+// Decimal, no leading zeros (%u); returns the end
+inline char *put_u32(char *p, uint32_t v)
+{
+    char tmp[10];
+    char *t = tmp + sizeof(tmp);
+    while (v >= 100) {
+        uint32_t q = v / 100;
+        t -= 2;
+        memcpy(t, &digit_pairs.s[2 * (v - 100 * q)], 2);
+        v = q;
+    }
+    if (v >= 10) {
+        t -= 2;
+        memcpy(t, &digit_pairs.s[2 * v], 2);
+    } else {
+        *--t = (char)('0' + v);
+    }
+    size_t n = (size_t)(tmp + sizeof(tmp) - t);
+    memcpy(p, t, n);
+    return p + n;
+}
+
+// Decimal with sign (%d)
+inline char *put_i32(char *p, int32_t v)
+{
+    uint32_t u = (uint32_t)v;
+    if (v < 0) {
+        *p++ = '-';
+        u = 0u - u;
+    }
+    return put_u32(p, u);
+}
+
+// Two upper-case hex digits per byte (%02X each)
+inline char *put_hex(char *p, const uint8_t *b, size_t n)
+{
+    static constexpr char digits[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < n; ++i) {
+        *p++ = digits[b[i] >> 4];
+        *p++ = digits[b[i] & 0x0F];
+    }
+    return p;
+}
+
+// -----------------------------------------------------------------------------
+// MEMBERS
+// -----------------------------------------------------------------------------
+template <size_t N>
+struct Key {
+    char s[N];
+    constexpr Key(const char (&k)[N]) : s() { for (size_t i = 0; i < N; ++i) s[i] = k[i]; }
+    static constexpr size_t len = N - 1;
+};
+
+enum class Fmt {
+    Uint,       // %u of the field
+    Int,        // %d of (int) the field, whatever its signedness
+    Hex,        // "%02X..." of the field's bytes, quoted
+};
+
+// ,"key":value, the value read from field F of a frame
+template <Key K, typename F, Fmt Kind>
+struct Member {
+    using field = F;
+    static constexpr Fmt kind = Kind;
+
+    // ,"key": and, for hex, the opening quote
+    static constexpr size_t head_len = 2 + K.len + 2 + (Kind == Fmt::Hex ? 1 : 0);
+    struct Head {
+        char s[head_len];
+        constexpr Head() : s()
+        {
+            size_t n = 0;
+            s[n++] = ',';
+            s[n++] = '"';
+            for (size_t i = 0; i < K.len; ++i) s[n++] = K.s[i];
+            s[n++] = '"';
+            s[n++] = ':';
+            if (Kind == Fmt::Hex) s[n++] = '"';
+        }
+    };
+    static constexpr Head head{};
+
+    static constexpr size_t max_value_len =
+        Kind == Fmt::Hex ? 2 * F::size + 1 :                        // With the quote
+        Kind == Fmt::Int ? 11 :                                     // -2147483648
+        F::size == 1 ? 3 : F::size == 2 ? 5 : 10;
+    static constexpr size_t max_len = head_len + max_value_len;
+
+    static char *write(char *p, const uint8_t *frame)
+    {
+        memcpy(p, head.s, head_len);
+        p += head_len;
+        const uint8_t *f = frame + F::offset;
+        if constexpr (Kind == Fmt::Hex) {
+            p = put_hex(p, f, F::size);
+            *p++ = '"';
+        } else if constexpr (Kind == Fmt::Int) {
+            static_assert(F::size == 4, "Fmt::Int is for 32-bit fields");
+            p = put_i32(p, (int32_t)wire::load_le<uint32_t>(f));
+        } else {
+            p = put_u32(p, (uint32_t)wire::load_le<typename F::type>(f));
+        }
+        return p;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// OBJECT
+// -----------------------------------------------------------------------------
+template <typename... Members>
+struct Object {
+    static_assert(sizeof...(Members) > 0, "empty object");
+
+    // Every member with its comma, the first one's turned into '{', and '}'
+    static constexpr size_t max_len = (Members::max_len + ...) + 1;
+
+    // The object of frame at out, NUL-terminated; its length. out holds
+    // at least max_len + 1 bytes.
+    static size_t write_unchecked(const uint8_t *frame, char *out)
+    {
+        char *p = out;
+        ((p = Members::write(p, frame)), ...);
+        out[0] = '{';
+        *p++ = '}';
+        *p = '\0';
+        return (size_t)(p - out);
+    }
+
+    // As snprintf: 0 if the object and its NUL don't fit in size
+    static size_t write(const uint8_t *frame, char *out, size_t size)
+    {
+        if (size > max_len) return write_unchecked(frame, out);
+
+        char tmp[max_len + 1];
+        size_t n = write_unchecked(frame, tmp);
+        if (n >= size) return 0;
+        memcpy(out, tmp, n + 1);
+        return n;
+    }
+};
+
+} // namespace json
@@ -0,0 +1,240 @@
+// main/link_adapt.c
+#include "link_adapt.h"
+#include "config.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// HELPERS
+// -----------------------------------------------------------------------------
+float link_adapt_snr_floor_db(uint8_t sf)
+{
+    // SX1276 datasheet, table 13: -7.5 dB @ SF7 ... -20 dB @ SF12
+    if (sf < 7)  sf = 7;
+    if (sf > 12) sf = 12;
+    return -7.5f - 2.5f * (float)(sf - 7);
+}
+
+static bool peer_fresh(const LinkPeer *p, uint32_t now_ms)
+{
+    return p->in_use && (now_ms - p->last_seen_ms) < LINK_PEER_TIMEOUT_MS;
+}
+
+void link_adapt_default_config(LinkAdaptConfig *cfg, uint8_t base_sf, int8_t base_power_dbm)
+{
+    cfg->base_sf         = base_sf;
+    cfg->base_power_dbm  = base_power_dbm;
+    cfg->sf_min          = LINK_SF_MIN;
+    cfg->sf_max          = LINK_SF_MAX;
+    cfg->power_min_dbm   = LINK_POWER_MIN_DBM;
+    cfg->power_max_dbm   = LINK_POWER_MAX_DBM;
+    cfg->target_fraction = LINK_TARGET_FRACTION;
+    cfg->margin_db       = LINK_MARGIN_DB;
+}
+
+void link_adapt_init(LinkAdapt *la, const LinkAdaptConfig *cfg, uint32_t now_ms)
+{
+    memset(la, 0, sizeof(*la));
+    la->cfg        = *cfg;
+    la->sf         = cfg->base_sf;
+    la->desired_sf = cfg->base_sf;
+    la->need_sf    = cfg->base_sf;
+    la->power_dbm  = cfg->base_power_dbm;
+    la->last_rx_ms = now_ms;
+}
+
+// -----------------------------------------------------------------------------
+// RX: track per-neighbour link quality
+// -----------------------------------------------------------------------------
+void link_adapt_on_rx(LinkAdapt *la, const uint8_t node_id[6],
+                      float rssi_dbm, float snr_db, uint16_t link_cfg,
+                      uint32_t now_ms)
+{
+    // SX1276 SNR saturates around +10 dB; above that RSSI over the
+    // thermal floor is the better estimate of how much margin we have.
+    float snr = snr_db;
+    if (snr_db > LINK_SNR_SATURATION_DB) {
+        float from_rssi = rssi_dbm - LINK_NOISE_FLOOR_DBM;
+        if (from_rssi > snr) snr = from_rssi;
+    }
+
+    // link_cfg == 0: sender is not adapting (fixed base settings)
+    link_cfg &= (uint16_t)~LINK_CFG_JOIN;
+    int8_t  sender_power = la->cfg.base_power_dbm;
+    uint8_t need_sf      = 0;
+    uint8_t need_hops    = 0;
+    if (link_cfg != 0) {
+        sender_power = LINK_CFG_POWER_DBM(link_cfg);
+        need_sf      = LINK_CFG_SF(link_cfg);
+        need_hops    = LINK_CFG_HOPS(link_cfg);
+    }
+    float snr_0dbm = snr - (float)sender_power;
+
+    // Find peer; otherwise take a free slot, or recycle the least recently seen
+    LinkPeer *peer   = NULL;
+    LinkPeer *victim = NULL;
+    for (int i = 0; i < MAX_NEIGHBOURS; ++i) {
+        LinkPeer *p = &la->peers[i];
+        if (p->in_use && memcmp(p->node_id, node_id, 6) == 0) {
+            peer = p;
+            break;
+        }
+        if (!p->in_use) {
+            if (!victim || victim->in_use) victim = p;
+        } else if (!victim || (victim->in_use &&
+                               p->last_seen_ms < victim->last_seen_ms)) {
+            victim = p;
+        }
+    }
+
+    if (!peer) {
+        peer = victim;
+        memset(peer, 0, sizeof(*peer));
+        peer->in_use = true;
+        memcpy(peer->node_id, node_id, 6);
+        peer->snr_0dbm = snr_0dbm;
+    } else {
+        peer->snr_0dbm += LINK_EMA_ALPHA * (snr_0dbm - peer->snr_0dbm);
+    }
+
+    peer->need_sf      = need_sf;
+    peer->need_hops    = need_hops;
+    peer->last_seen_ms = now_ms;
+    la->last_rx_ms     = now_ms;
+}
+
+// -----------------------------------------------------------------------------
+// SF / POWER SELECTION
+// -----------------------------------------------------------------------------
+static int cmp_desc(const void *a, const void *b)
+{
+    float fa = *(const float *)a, fb = *(const float *)b;
+    return (fa < fb) - (fa > fb);
+}
+
+// Power needed for the k-th best link to close at this SF
+static int8_t power_for(const LinkAdapt *la, uint8_t sf, float snr_k)
+{
+    float need = link_adapt_snr_floor_db(sf) + la->cfg.margin_db - snr_k;
+    int8_t p = (int8_t)ceilf(need);
+    if (p < la->cfg.power_min_dbm) p = la->cfg.power_min_dbm;
+    if (p > la->cfg.power_max_dbm) p = la->cfg.power_max_dbm;
+    return p;
+}
+
+bool link_adapt_update(LinkAdapt *la, uint32_t now_ms)
+{
+    int8_t old_power = la->power_dbm;
+
+    // Nobody heard for a while: we may be on the wrong SF. Hunt through the
+    // SFs (base SF first) at full power until a neighbour turns up.
+    // Nobody is listening to announcements here, so retune straight away.
+    uint32_t silent_ms = now_ms - la->last_rx_ms;
+    if (silent_ms >= LINK_ISOLATION_TIMEOUT_MS) {
+        uint32_t n_sf = (uint32_t)(la->cfg.sf_max - la->cfg.sf_min + 1);
+        uint32_t step = (silent_ms - LINK_ISOLATION_TIMEOUT_MS) / LINK_HUNT_DWELL_MS;
+
+        la->sf         = (uint8_t)(la->cfg.sf_min +
+                         (la->cfg.base_sf - la->cfg.sf_min + step) % n_sf);
+        la->pending_sf = 0;
+        la->desired_sf = la->sf;
+        la->need_sf    = la->sf;
+        la->need_hops  = 0;
+        la->power_dbm  = la->cfg.power_max_dbm;
+        la->lower_since_ms = now_ms;
+        return la->power_dbm != old_power;
+    }
+
+    float snr[MAX_NEIGHBOURS];
+    int   n = 0;
+
+    for (int i = 0; i < MAX_NEIGHBOURS; ++i) {
+        const LinkPeer *p = &la->peers[i];
+        if (!peer_fresh(p, now_ms)) continue;
+        snr[n++] = p->snr_0dbm;
+    }
+
+    if (n == 0) {
+        return false;   // keep current settings until isolation timeout
+    }
+
+    // k-th best link must close, k = ceil(fraction * n)
+    qsort(snr, n, sizeof(float), cmp_desc);
+    int k = (int)ceilf(la->cfg.target_fraction * (float)n);
+    if (k < 1) k = 1;
+    if (k > n) k = n;
+    float snr_k = snr[k - 1];
+
+    uint8_t desired = la->cfg.sf_max;
+    for (uint8_t sf = la->cfg.sf_min; sf <= la->cfg.sf_max; ++sf) {
+        float need = link_adapt_snr_floor_db(sf) + la->cfg.margin_db;
+        if (snr_k + (float)la->cfg.power_max_dbm >= need) {
+            desired = sf;
+            break;
+        }
+    }
+    la->desired_sf = desired;
+
+    // Highest need in reach: our own at hop 0, neighbours' at their hops + 1
+    uint8_t need_sf   = desired;
+    uint8_t need_hops = 0;
+    for (int i = 0; i < MAX_NEIGHBOURS; ++i) {
+        const LinkPeer *p = &la->peers[i];
+        if (!peer_fresh(p, now_ms) || p->need_sf == 0) continue;
+        if (p->need_hops + 1 > LINK_MAX_HOPS) continue;
+
+        if (p->need_sf > need_sf ||
+            (p->need_sf == need_sf && p->need_hops + 1 < need_hops)) {
+            need_sf   = p->need_sf;
+            need_hops = (uint8_t)(p->need_hops + 1);
+        }
+    }
+    la->need_sf   = need_sf;
+    la->need_hops = need_hops;
+
+    uint8_t swarm_sf = need_sf;
+    if (swarm_sf < la->cfg.sf_min) swarm_sf = la->cfg.sf_min;
+    if (swarm_sf > la->cfg.sf_max) swarm_sf = la->cfg.sf_max;
+
+    // Step up at once, step down only after LINK_SF_HOLD_MS of agreement.
+    // Either way the move is staged until our announcement has gone out.
+    la->pending_sf = 0;
+    if (swarm_sf >= la->sf) {
+        if (swarm_sf > la->sf) la->pending_sf = swarm_sf;
+        la->lower_since_ms = now_ms;
+    } else if ((now_ms - la->lower_since_ms) >= LINK_SF_HOLD_MS) {
+        la->pending_sf = swarm_sf;
+        la->lower_since_ms = now_ms;
+    }
+
+    // Power for the announcement on the current SF; the higher of the two
+    // SFs' needs so the old and new SF both close.
+    int8_t p = power_for(la, la->sf, snr_k);
+    if (la->pending_sf) {
+        int8_t p_new = power_for(la, la->pending_sf, snr_k);
+        if (p_new > p) p = p_new;
+    }
+    la->power_dbm = p;
+
+    return la->power_dbm != old_power;
+}
+
+bool link_adapt_on_tx(LinkAdapt *la)
+{
+    if (la->pending_sf == 0 || la->pending_sf == la->sf) {
+        la->pending_sf = 0;
+        return false;
+    }
+    la->sf         = la->pending_sf;
+    la->pending_sf = 0;
+    return true;
+}
+
+uint16_t link_adapt_encode(const LinkAdapt *la)
+{
+    return (uint16_t)(((la->need_sf & 0x0F) << 12) |
+                      ((la->need_hops & 0x0F) << 8) |
+                      ((uint8_t)la->power_dbm & 0x7F));
+}
@@ -0,0 +1,99 @@
+// main/link_adapt.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Link adaptation: pick the lowest spreading factor and TX power that still
+// reach LINK_TARGET_FRACTION of the neighbours we hear.
+//
+// LoRa SFs are (quasi) orthogonal, so the whole swarm has to share one SF.
+// Every packet carries a link_cfg field: the highest SF anyone in the swarm
+// needs, how many hops away that need originates, and the power the packet
+// was sent at. Needs propagate like a hop-limited distance vector: each node
+// advertises max(own need, neighbours' needs at hops + 1), so one weak link
+// pulls the whole connected swarm up immediately. When the need goes away
+// the stale copies count up to LINK_MAX_HOPS and die, after which the swarm
+// steps down (with LINK_SF_HOLD_MS hysteresis). SF changes are announced
+// first: the next packet still goes out on the old SF carrying the new need,
+// and we only retune after it, so neighbours on the old SF hear about it.
+// A node that hears nothing for LINK_ISOLATION_TIMEOUT_MS (fresh boot, or the
+// swarm moved SF without it) hunts: it dwells LINK_HUNT_DWELL_MS on each SF,
+// starting from the base SF, at full power until it hears someone.
+//
+// Pure logic, no FreeRTOS / RadioLib: times are plain milliseconds.
+
+// link_cfg: [15:12] needed SF (0 = not adapting), [11:8] hops to the node
+// that needs it, [7] join beacon (join.h), [6:0] TX power in dBm (7-bit
+// signed)
+#define LINK_CFG_SF(c)          ((uint8_t)(((c) >> 12) & 0x0F))
+#define LINK_CFG_HOPS(c)        ((uint8_t)(((c) >> 8) & 0x0F))
+#define LINK_CFG_POWER_DBM(c)   ((int8_t)((int8_t)(uint8_t)((c) << 1) >> 1))
+#define LINK_CFG_JOIN           0x0080u
+
+typedef struct {
+    uint8_t base_sf;        // boot / fallback SF (LORA_SF)
+    int8_t  base_power_dbm; // boot / fallback power (LORA_POWER_DBM)
+    uint8_t sf_min;
+    uint8_t sf_max;
+    int8_t  power_min_dbm;
+    int8_t  power_max_dbm;
+    float   target_fraction;
+    float   margin_db;
+} LinkAdaptConfig;
+
+typedef struct {
+    bool     in_use;
+    uint8_t  node_id[6];
+    float    snr_0dbm;      // EMA of link SNR normalised to 0 dBm sender power
+    uint8_t  need_sf;       // Swarm-wide need as advertised by this neighbour
+    uint8_t  need_hops;
+    uint32_t last_seen_ms;
+} LinkPeer;
+
+typedef struct {
+    LinkAdaptConfig cfg;
+    LinkPeer peers[MAX_NEIGHBOURS];
+
+    uint8_t  sf;            // Swarm SF we are on (listen + transmit)
+    uint8_t  pending_sf;    // SF to move to after the next TX (0 = none)
+    int8_t   power_dbm;     // Our TX power
+    uint8_t  desired_sf;    // What our own links need
+    uint8_t  need_sf;       // Highest need we know of (own or propagated)
+    uint8_t  need_hops;
+
+    uint32_t lower_since_ms;   // Down-switch hysteresis
+    uint32_t last_rx_ms;
+} LinkAdapt;
+
+void link_adapt_default_config(LinkAdaptConfig *cfg, uint8_t base_sf, int8_t base_power_dbm);
+
+void link_adapt_init(LinkAdapt *la, const LinkAdaptConfig *cfg, uint32_t now_ms);
+
+// Feed RSSI/SNR of a verified packet (RadioLib getRSSI()/getSNR() after readData)
+void link_adapt_on_rx(LinkAdapt *la, const uint8_t node_id[6],
+                      float rssi_dbm, float snr_db, uint16_t link_cfg,
+                      uint32_t now_ms);
+
+// Recompute SF/power before a TX. Returns TRUE if la->power_dbm changed.
+// A new SF is staged in la->pending_sf until link_adapt_on_tx().
+bool link_adapt_update(LinkAdapt *la, uint32_t now_ms);
+
+// Our announcement went out: apply any staged SF. Returns TRUE if la->sf changed.
+bool link_adapt_on_tx(LinkAdapt *la);
+
+// link_cfg field for our next outgoing packet
+uint16_t link_adapt_encode(const LinkAdapt *la);
+
+// Demodulation SNR floor for an SF (SX1276 datasheet)
+float link_adapt_snr_floor_db(uint8_t sf);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,117 @@
+// main/lora_airtime.c
+#include "lora_airtime.h"
+#include "config.h"
+
+#include <math.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// TIME ON AIR
+// -----------------------------------------------------------------------------
+uint32_t lora_time_on_air_us(const LoraAirParams *p, size_t payload_len)
+{
+    double t_sym_us = (double)(1u << p->sf) * 1000.0 / p->bw_khz;
+
+    // Low data rate optimisation: RadioLib enables it above 16ms symbols
+    int de = (t_sym_us > 16000.0) ? 1 : 0;
+    int ih = p->implicit_header ? 1 : 0;
+    int cr = p->cr - 4;                 // 4/5 -> 1 ... 4/8 -> 4
+
+    double t_preamble_us = ((double)p->preamble + 4.25) * t_sym_us;
+
+    int num = 8 * (int)payload_len - 4 * p->sf + 28 + (p->crc ? 16 : 0) - 20 * ih;
+    int den = 4 * (p->sf - 2 * de);
+    int n_payload = 8;
+    if (num > 0) {
+        n_payload += ((num + den - 1) / den) * (cr + 4);
+    }
+
+    return (uint32_t)lround(t_preamble_us + n_payload * t_sym_us);
+}
+
+uint32_t lora_cad_time_us(const LoraAirParams *p)
+{
+    // (2^SF + 32) / BW receive, then about one symbol of processing
+    double t_sym_us = (double)(1u << p->sf) * 1000.0 / p->bw_khz;
+    return (uint32_t)lround(2.0 * t_sym_us + 32.0 * 1000.0 / p->bw_khz);
+}
+
+float lora_tx_current_ma(int8_t power_dbm)
+{
+    // ~20mA fixed PA/LDO overhead plus ~1mA per mW radiated
+    float mw = powf(10.0f, (float)power_dbm / 10.0f);
+    return ((float)EST_CURRENT_LORA_TX_MA - 25.0f) + mw;
+}
+
+// -----------------------------------------------------------------------------
+// DUTY CYCLE
+// -----------------------------------------------------------------------------
+#define BUCKET_MS   (DUTY_CYCLE_WINDOW_MS / DUTY_CYCLE_BUCKETS)
+
+static uint32_t s_bucket_us[DUTY_CYCLE_BUCKETS];
+static uint32_t s_bucket_idx;       // Absolute index of the newest bucket
+
+static void advance(uint32_t now_ms)
+{
+    uint32_t idx = now_ms / BUCKET_MS;
+    uint32_t steps = idx - s_bucket_idx;
+
+    if (steps >= DUTY_CYCLE_BUCKETS) {
+        memset(s_bucket_us, 0, sizeof(s_bucket_us));
+    } else {
+        for (uint32_t i = 1; i <= steps; ++i) {
+            s_bucket_us[(s_bucket_idx + i) % DUTY_CYCLE_BUCKETS] = 0;
+        }
+    }
+    s_bucket_idx = idx;
+}
+
+void duty_cycle_init(uint32_t now_ms)
+{
+    memset(s_bucket_us, 0, sizeof(s_bucket_us));
+    s_bucket_idx = now_ms / BUCKET_MS;
+}
+
+uint32_t duty_cycle_budget_us(void)
+{
+    return (uint32_t)((double)DUTY_CYCLE_WINDOW_MS * 1000.0 * DUTY_CYCLE_PERCENT / 100.0);
+}
+
+uint32_t duty_cycle_used_us(uint32_t now_ms)
+{
+    advance(now_ms);
+
+    uint32_t used = 0;
+    for (int i = 0; i < DUTY_CYCLE_BUCKETS; ++i) used += s_bucket_us[i];
+    return used;
+}
+
+uint32_t duty_cycle_defer_ms(uint32_t airtime_us, uint32_t now_ms)
+{
+    uint32_t budget = duty_cycle_budget_us();
+    uint32_t used   = duty_cycle_used_us(now_ms);
+
+    if (used + airtime_us <= budget) return 0;
+    if (airtime_us > budget) return DUTY_CYCLE_WINDOW_MS;   // Never fits
+
+    // Walk from the oldest bucket until enough airtime has expired
+    uint32_t freed = 0;
+    for (uint32_t age = DUTY_CYCLE_BUCKETS - 1; age > 0; --age) {
+        uint32_t abs_idx = s_bucket_idx - age;
+        freed += s_bucket_us[abs_idx % DUTY_CYCLE_BUCKETS];
+
+        if (used - freed + airtime_us <= budget) {
+            // That bucket leaves the window when the newest index passes it
+            uint32_t expires_ms = (abs_idx + DUTY_CYCLE_BUCKETS) * BUCKET_MS;
+            return expires_ms - now_ms;
+        }
+    }
+    // Only the newest bucket is left to expire
+    return (s_bucket_idx + DUTY_CYCLE_BUCKETS) * BUCKET_MS - now_ms;
+}
+
+void duty_cycle_record(uint32_t airtime_us, uint32_t now_ms)
+{
+    advance(now_ms);
+    s_bucket_us[s_bucket_idx % DUTY_CYCLE_BUCKETS] += airtime_us;
+}
@@ -0,0 +1,57 @@
+// main/lora_airtime.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LoRa time-on-air (SX1276 datasheet, section 4.1.1.7) and an optional
+// regulatory duty-cycle accountant. Pure logic, no FreeRTOS: the duty-cycle
+// window runs on caller-supplied milliseconds.
+
+typedef struct {
+    uint8_t  sf;            // 6..12
+    float    bw_khz;        // 7.8 .. 500
+    uint8_t  cr;            // Coding rate denominator, 5..8 (RadioLib style: 7 = 4/7)
+    uint16_t preamble;      // Programmed preamble length (symbols)
+    bool     crc;
+    bool     implicit_header;
+} LoraAirParams;
+
+// Time on air of one packet in microseconds (LDRO applied as RadioLib does)
+uint32_t lora_time_on_air_us(const LoraAirParams *p, size_t payload_len);
+
+// Channel activity detection: ~1 symbol of receive plus ~1 symbol of
+// correlation (SX1276 datasheet, section 4.1.6). Radio sits in CAD mode for
+// this long before CadDone.
+uint32_t lora_cad_time_us(const LoraAirParams *p);
+
+// Rough SX1276 PA_BOOST supply current for an output power, anchored on
+// EST_CURRENT_LORA_TX_MA at 14 dBm
+float lora_tx_current_ma(int8_t power_dbm);
+
+// -----------------------------------------------------------------------------
+// Duty cycle (ETSI EN 300 220: 1% per hour in the 868.0-868.6 MHz sub-band)
+// -----------------------------------------------------------------------------
+// Sliding window of DUTY_CYCLE_BUCKETS buckets covering DUTY_CYCLE_WINDOW_MS.
+
+void duty_cycle_init(uint32_t now_ms);
+
+// 0 if a packet of airtime_us fits the budget now, otherwise how many ms to
+// defer until enough old airtime has left the window.
+uint32_t duty_cycle_defer_ms(uint32_t airtime_us, uint32_t now_ms);
+
+// Charge a transmission that actually went out
+void duty_cycle_record(uint32_t airtime_us, uint32_t now_ms);
+
+// Airtime used inside the current window (us) and the budget (us)
+uint32_t duty_cycle_used_us(uint32_t now_ms);
+uint32_t duty_cycle_budget_us(void);
+
+#ifdef __cplusplus
+}
+#endif
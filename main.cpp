@@ -18,6 +18,7 @@ extern "C" void app_main(void)
     fast_log("MAIN (I): starting up");
 
     init_globals();
+    init_security();
 
     if (wifi_connect() != ESP_OK) {
         fast_log("MAIN (F): Wi-Fi connect failed, continuing without network");
@@ -2,15 +2,44 @@
 #include "monitoring.h"
 #include "config.h"
 #include "tasks.h"
+#include "rx_ring.h"
+#include "neigh_ring.h"
+#include "telem_ring.h"
+#include "tx_sched.h"
+#include "relay.h"
+#include "csma.h"
+#include "interest.h"
+#include "congestion.h"
+#include "join.h"
+#include "radio_fsm.h"
+#include "sec_table.h"
+#include "admit.h"
+#include "replay_win.h"
+#include "sec_stats.h"
+#include "lora_airtime.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
 #include <string.h>
 #include <stdlib.h> // abs 
 
 // Thresholds
 #define CHANGE_ALERT_THRESHOLD   1.5f // 50% increase triggers alert
 #define EMA_ALPHA                0.2f // 0.2 = moderate adaptation speed
+#define SEC_TOP_SHOWN            3    // Offenders logged per report
+
+// fast_log() lines of a full report: the fixed ones plus one per task, TX
+// class, timed security stage and offender shown. fast_log() drops lines
+// when its queue is full and the logger runs at our priority, so the queue
+// must hold a whole report and still leave room for other tasks' lines.
+#define MON_REPORT_FIXED_LINES   21
+#define MON_REPORT_LINES         (MON_REPORT_FIXED_LINES + MON_TASK_MAX + TX_CLASS_MAX + \
+                                  SEC_STAGES + SEC_TOP_SHOWN)
+#define MON_LOG_HEADROOM         12   // Queue slots left for other tasks
+
+_Static_assert(MON_REPORT_LINES + MON_LOG_HEADROOM <= LOG_MESSAGE_QUEUE_LENGTH,
+               "LOG_MESSAGE_QUEUE_LENGTH can't hold a monitoring report");
 
 typedef struct {
     const char* name;
@@ -40,12 +69,20 @@ static uint32_t total_packets_lost = 0;
 static uint16_t last_seq_map[MAX_NEIGHBOURS];
 static bool     node_seen[MAX_NEIGHBOURS];
 
-// Energy Stats
-static uint32_t energy_tx_time_ms = 0;
+// Energy Stats (radio mode residency, charged on every mode change)
+static portMUX_TYPE  radio_mux = portMUX_INITIALIZER_UNLOCKED;
+static MonRadioState radio_state = MON_RADIO_IDLE;
+static int64_t       radio_since_us = 0;
+static uint32_t      radio_tx_airtime_us = 0;   // Computed ToA of the burst in flight
+static float         radio_tx_current_ma = 0.0f;
+static uint64_t      radio_time_us[MON_RADIO_MAX];
+static double        radio_tx_charge_ma_us = 0.0;  // TX charge, power dependent
 static uint64_t start_time_ms = 0;
 
 // Energy Change Detection State
-static uint32_t last_report_tx_time_ms = 0; // Snapshot of TX time at last report
+static uint64_t last_report_radio_us[MON_RADIO_MAX]; // Snapshot at last report
+static double   last_report_tx_charge = 0.0;
+static int64_t  last_report_us = 0;
 static float    moving_avg_mah = 0.0f;      // Average energy per window
 
 // -----------------------------------------------------------------------------
@@ -95,11 +132,49 @@ void monitor_report_packet(uint16_t seq_number, uint8_t *node_id)
     total_packets_rx++;
 }
 
-void monitor_radio_state(bool is_tx, uint32_t duration_ms)
+// Must hold radio_mux
+static void radio_charge(int64_t now_us)
 {
-    if (is_tx) {
-        energy_tx_time_ms += duration_ms;
+    int64_t dt = now_us - radio_since_us;
+    if (dt < 0) dt = 0;
+
+    if (radio_state == MON_RADIO_TX) {
+        // TX is charged its computed airtime; the tail until we re-arm is standby
+        uint64_t tx = radio_tx_airtime_us;
+        radio_time_us[MON_RADIO_TX] += tx;
+        radio_tx_charge_ma_us += (double)tx * radio_tx_current_ma;
+        if ((uint64_t)dt > tx) {
+            radio_time_us[MON_RADIO_IDLE] += (uint64_t)dt - tx;
+        }
+        radio_tx_airtime_us = 0;
+    } else {
+        radio_time_us[radio_state] += (uint64_t)dt;
     }
+    radio_since_us = now_us;
+}
+
+void monitor_radio_state(MonRadioState state)
+{
+    if (state >= MON_RADIO_MAX) return;
+    int64_t now_us = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&radio_mux);
+    radio_charge(now_us);
+    radio_state = state;
+    taskEXIT_CRITICAL(&radio_mux);
+}
+
+void monitor_radio_tx(uint32_t airtime_us, int8_t power_dbm)
+{
+    int64_t now_us = esp_timer_get_time();
+    float current  = lora_tx_current_ma(power_dbm);
+
+    taskENTER_CRITICAL(&radio_mux);
+    radio_charge(now_us);
+    radio_state         = MON_RADIO_TX;
+    radio_tx_airtime_us = airtime_us;
+    radio_tx_current_ma = current;
+    taskEXIT_CRITICAL(&radio_mux);
 }
 
 // -----------------------------------------------------------------------------
@@ -157,18 +232,163 @@ static void monitor_task_func(void *arg)
         fast_log("NET   | RX: %lu | Lost: %lu | Avail: %.1f%%", 
                  total_packets_rx, total_packets_lost, avail_pct);
 
+        // RX ring (radio task -> verifier)
+        RxRingStats rq;
+        rx_ring_get_stats(&rq);
+        fast_log("RXQ   | Occ: %lu/%lu (Peak %lu) | In: %lu | Drop: %lu",
+                 rq.occupancy, rq.capacity, rq.peak_occupancy,
+                 rq.pushed, rq.dropped);
+
+        // Neighbour updates (verifier -> flocking), coalesced per node
+        NeighRingStats nq;
+        neigh_ring_get_stats(&nq);
+        fast_log("NBQ   | Pend: %lu/%lu (Peak %lu) | Nodes: %lu | In: %lu | Coal: %lu | Evict: %lu | Drop: %lu",
+                 nq.pending, nq.capacity, nq.peak_pending, nq.slots_in_use,
+                 nq.pushed, nq.coalesced, nq.evicted, nq.dropped);
+
+        // Telemetry samples (physics -> MQTT), one message per topic per batch
+        TelemRingStats tq;
+        telem_ring_get_stats(&tq);
+        fast_log("TLMQ  | Occ: %lu/%lu (Peak %lu) | In: %lu | Batches: %lu (%.1f samples) | Drop: %lu",
+                 tq.occupancy, tq.capacity, tq.peak_occupancy, tq.pushed, tq.batches,
+                 tq.batches ? (float)tq.popped / tq.batches : 0.0f, tq.dropped);
+
+        // TX scheduler: queue -> air latency per class
+        static const char *const tx_class_names[TX_CLASS_MAX] = { "Own", "Relay", "Inject" };
+        for (int c = 0; c < TX_CLASS_MAX; ++c) {
+            TxSchedStats ts;
+            tx_sched_get_stats((TxClass)c, &ts);
+            if (ts.queued == 0) continue;
+            fast_log("TXQ   | %-6s | Sent: %lu | Lat p50/p90/p99: %lu/%lu/%lu ms (Max %lu) | Exp: %lu | Drop: %lu",
+                     tx_class_names[c], ts.sent, ts.p50_ms, ts.p90_ms, ts.p99_ms,
+                     ts.max_ms, ts.expired, ts.dropped);
+        }
+
+        // Multi-hop relay
+        RelayStats rs;
+        radio_get_relay_stats(&rs);
+        fast_log("RELAY | Sent: %lu | Sched: %lu | Supp: %lu | Exp: %lu | Close: %lu | HopLim: %lu | Dup: %lu",
+                 rs.relayed, rs.scheduled, rs.suppressed, rs.expired,
+                 rs.too_close, rs.hop_limited, rs.duplicates);
+
+        // Congestion control: last window and the own TX interval it chose
+        CongestionStats cg;
+        radio_get_congestion_stats(&cg);
+        fast_log("CONG  | Busy: %.1f%% | Fail: %.1f%% | Senders: %u | TX every %lu ms | Congested: %lu/%lu",
+                 cg.util * 100.0f, cg.fail_ratio * 100.0f, (unsigned)cg.senders,
+                 cg.period_ms, cg.congested, cg.windows);
+
+        // Fast join: our beacons, and answers to other nodes' beacons
+        JoinStats js;
+        radio_get_join_stats(&js);
+        fast_log("JOIN  | Beacons: %lu | Heard: %lu | Answered: %lu | Absorbed: %lu | Limited: %lu | Busy: %lu",
+                 js.beacons, js.requests, js.answers, js.absorbed, js.limited, js.busy);
+
+        // Interest filter (verifier -> flocking)
+        InterestStats is;
+        radio_get_interest_stats(&is);
+        fast_log("NEAR  | Nodes near/far: %lu/%lu | Pass: %lu | Sampled: %lu | Drop: %lu | In/Out: %lu/%lu",
+                 is.near_nodes, is.far_nodes, is.passed, is.sampled, is.dropped,
+                 is.entered, is.left);
+
+        // Security table: senders tracked, churn under fresh-MAC floods
+        SecTableStats st;
+        security_get_table_stats(&st);
+        fast_log("SEC   | Nodes: %lu/%d (Prot %lu) | New: %lu | Evict prob/idle: %lu/%lu | Refused: %lu | Probe max: %lu",
+                 st.used, MAX_TRACKED_NODES, st.protected_nodes, st.inserted,
+                 st.evicted_probation, st.evicted_idle, st.refused, st.max_probe);
+
+        // Admission: frames dropped before the CMAC, by reason. Two lines so
+        // ten-digit counters still fit MAX_LOG_MSG_LEN.
+        AdmitStats ad;
+        security_get_admit_stats(&ad);
+        fast_log("ADMIT | Checked: %lu | Header: %lu | Rate: %lu | Banned: %lu (%lu bans)",
+                 ad.checked, ad.dropped[ADMIT_HEADER], ad.dropped[ADMIT_RATE],
+                 ad.dropped[ADMIT_BANNED], ad.bans);
+        fast_log("ADMIT | Heavy: %lu | Unknown: %lu | Budget: %lu | Bad MAC: %lu",
+                 ad.dropped[ADMIT_HEAVY], ad.dropped[ADMIT_UNKNOWN],
+                 ad.dropped[ADMIT_BUDGET], ad.bad_macs);
+
+        // Replay window: reordered frames let in, replays / stale refused
+        ReplayStats rp;
+        security_get_replay_stats(&rp);
+        fast_log("RPLY  | Late: %lu | Seen: %lu | Old: %lu | Stale: %lu | Resync: %lu (Unsynced %lu)",
+                 rp.late, rp.seen, rp.old, rp.stale, rp.resync, rp.unsynced);
+
+        // Security path: rejections by reason, CPU per stage (share of this
+        // window), the node_ids rejected most. Two REJ lines, mostly before
+        // / after the CMAC, so ten-digit counters still fit MAX_LOG_MSG_LEN.
+        static SecStats ss, ss_last;
+        security_get_stats(&ss);
+        fast_log("REJ   | OK: %lu | Version: %lu | Rate: %lu | Admit: %lu | Budget: %lu",
+                 ss.accepted, ss.rejected[SEC_REJ_VERSION], ss.rejected[SEC_REJ_RATE],
+                 ss.rejected[SEC_REJ_ADMIT], ss.rejected[SEC_REJ_BUDGET]);
+        fast_log("REJ   | Bad MAC: %lu | Full: %lu | Replay: %lu | Teleport: %lu | Speed: %lu",
+                 ss.rejected[SEC_REJ_BAD_MAC], ss.rejected[SEC_REJ_TABLE_FULL],
+                 ss.rejected[SEC_REJ_REPLAY], ss.rejected[SEC_REJ_TELEPORT],
+                 ss.rejected[SEC_REJ_SPEED]);
+
+        static const char *const stage_names[SEC_STAGES] = { "Admit", "CMAC", "Validate", "Frame" };
+        for (int s = 0; s < SEC_STAGES; ++s) {
+            const SecStageTime *t = &ss.stage[s];
+            if (t->count == ss_last.stage[s].count) continue;   // Idle this window
+            uint64_t window_us = t->total_us - ss_last.stage[s].total_us;
+            fast_log("SCPU  | %-8s | N: %lu | p50/p99: %lu/%lu us (Max %lu) | Window: %.1f ms (%.2f%%)",
+                     stage_names[s], t->count, sec_stats_percentile_us(t, 0.50f),
+                     sec_stats_percentile_us(t, 0.99f), t->max_us, window_us / 1000.0,
+                     window_us / (MONITOR_REPORT_PERIOD_MS * 10.0));
+        }
+
+        SecOffender top[SEC_STATS_TOP];
+        int n_top = sec_stats_top(&ss, top);
+        for (int i = 0; i < n_top && i < SEC_TOP_SHOWN; ++i) {
+            fast_log("TOP   | %d | %s | Rejected: %lu (+-%lu) | Last: %s", i + 1,
+                     format_mac(top[i].node_id), top[i].count, top[i].error,
+                     sec_reject_name((SecReject)top[i].last));
+        }
+        ss_last = ss;
+
+        // Listen before talk
+        CsmaStats cs;
+        radio_get_csma_stats(&cs);
+        fast_log("CSMA  | CAD: %lu | Busy: %lu | Backoff: %lu (%lu ms) | Forced: %lu | Drop: %lu",
+                 cs.cad, cs.busy, cs.backoffs, cs.backoff_ms, cs.forced, cs.dropped);
+
+        // Radio state machine: DIO0 ISR -> radio_task latency, lost interrupts
+        RadioFsmStats fs;
+        radio_get_fsm_stats(&fs);
+        fast_log("RADIO | DIO0: %lu | ISR lat p50/p99: %lu/%lu us (Max %lu) | RX: %lu | Echo: %lu | Guard TX/CAD: %lu/%lu",
+                 fs.dio0, radio_fsm_latency_us(&fs, 0.50f), radio_fsm_latency_us(&fs, 0.99f),
+                 fs.lat_max_us, fs.rx, fs.echo, fs.guard_tx, fs.guard_cad);
+
         // 3. Energy Change Detection
-        // Calculate usage ONLY for this window (delta)
-        uint32_t current_tx_total = energy_tx_time_ms;
-        uint32_t delta_tx_ms = current_tx_total - last_report_tx_time_ms;
-        uint32_t delta_window_ms = MONITOR_REPORT_PERIOD_MS;
-        uint32_t delta_rx_ms = delta_window_ms - delta_tx_ms;
+        // Radio residency for this window only (delta), TX at computed airtime
+        uint64_t radio_now[MON_RADIO_MAX];
+        double   tx_charge_now;
+        int64_t  now_us = esp_timer_get_time();
+
+        taskENTER_CRITICAL(&radio_mux);
+        radio_charge(now_us);
+        memcpy(radio_now, radio_time_us, sizeof(radio_now));
+        tx_charge_now = radio_tx_charge_ma_us;
+        taskEXIT_CRITICAL(&radio_mux);
+
+        if (last_report_us == 0) last_report_us = now_us - (int64_t)MONITOR_REPORT_PERIOD_MS * 1000;
+
+        double window_s = (now_us - last_report_us) / 1e6;
+        double tx_s   = (radio_now[MON_RADIO_TX]   - last_report_radio_us[MON_RADIO_TX])   / 1e6;
+        double rx_s   = (radio_now[MON_RADIO_RX]   - last_report_radio_us[MON_RADIO_RX])   / 1e6;
+        double idle_s = (radio_now[MON_RADIO_IDLE] - last_report_radio_us[MON_RADIO_IDLE]) / 1e6;
+
+        fast_log("RADIO | TX: %.0f ms (%.2f%%) | RX: %.1f s | Idle: %.1f s",
+                 tx_s * 1000.0, 100.0 * tx_s / window_s, rx_s, idle_s);
 
-        // Calculate mAh for this specific 5-second window
+        // Calculate mAh for this specific window
         double window_mah = 0;
-        window_mah += (EST_CURRENT_BASE_MA * (delta_window_ms / 1000.0f));
-        window_mah += (EST_CURRENT_LORA_RX_MA * (delta_rx_ms / 1000.0f));
-        window_mah += (EST_CURRENT_LORA_TX_MA * (delta_tx_ms / 1000.0f));
+        window_mah += (EST_CURRENT_BASE_MA * window_s);
+        window_mah += (EST_CURRENT_LORA_RX_MA * rx_s);
+        window_mah += (EST_CURRENT_LORA_IDLE_MA * idle_s);
+        window_mah += (tx_charge_now - last_report_tx_charge) / 1e6;
         window_mah /= 3600.0; // Convert to mAh
 
         // Init baseline
@@ -193,7 +413,9 @@ static void monitor_task_func(void *arg)
 
         // Update State
         moving_avg_mah = (EMA_ALPHA * window_mah) + ((1.0f - EMA_ALPHA) * moving_avg_mah);
-        last_report_tx_time_ms = current_tx_total;
+        memcpy(last_report_radio_us, radio_now, sizeof(last_report_radio_us));
+        last_report_tx_charge = tx_charge_now;
+        last_report_us = now_us;
 
         fast_log("--------------------------------");
     }
@@ -29,8 +29,22 @@ void monitor_task_end(MonTaskId id);
 // Call this when a valid neighbour packet is received to track loss/availability
 void monitor_report_packet(uint16_t seq_number, uint8_t *node_id);
 
-// Call this to track radio energy states
-void monitor_radio_state(bool is_tx, uint32_t duration_ms);
+// Radio modes for energy accounting
+typedef enum {
+    MON_RADIO_IDLE = 0,
+    MON_RADIO_RX,
+    MON_RADIO_TX,
+    MON_RADIO_MAX
+} MonRadioState;
+
+// Call this on every radio mode change (RX armed, standby). Time since the
+// previous change is charged to the previous mode.
+void monitor_radio_state(MonRadioState state);
+
+// Call this when a transmission starts: charges its computed time-on-air at
+// the given output power. After the packet ends the radio counts as idle
+// until the next monitor_radio_state().
+void monitor_radio_tx(uint32_t airtime_us, int8_t power_dbm);
 
 #ifdef __cplusplus
 }
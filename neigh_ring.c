@@ -0,0 +1,189 @@
+// main/neigh_ring.c
+#include "neigh_ring.h"
+#include "config.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#if (NEIGH_RING_SLOTS & (NEIGH_RING_SLOTS - 1)) != 0
+#error NEIGH_RING_SLOTS must be a power of two
+#endif
+
+// Triple buffer: producer fills buf[back], then swaps it with "middle" and
+// marks it fresh; consumer swaps its buf[front] with a fresh middle.
+#define MIDDLE_FRESH   0x4u
+#define MIDDLE_INDEX   0x3u
+
+typedef struct {
+    NeighbourState buf[3];
+    atomic_uint    middle;
+    atomic_bool    queued;      // Index is in the ring (or being consumed)
+    uint8_t        back;        // Producer only
+    uint8_t        front;       // Consumer only
+
+    // Sender mapping, producer only
+    bool           in_use;
+    uint8_t        node_id[6];
+    uint32_t       stamp;       // Last push, for LRU eviction
+} NeighSlot;
+
+static NeighSlot SLOTS[NEIGH_RING_SLOTS];
+
+// Ring of slot indices with unread data
+static uint8_t     RING[NEIGH_RING_SLOTS];
+static atomic_uint s_head;
+static atomic_uint s_tail;
+
+// Producer owned counters (consumer owns popped)
+static uint32_t    s_clock;
+static uint32_t    s_in_use;
+static atomic_uint s_pushed;
+static atomic_uint s_coalesced;
+static atomic_uint s_dropped;
+static atomic_uint s_evicted;
+static atomic_uint s_popped;
+static atomic_uint s_peak;
+
+void neigh_ring_init(void)
+{
+    memset(SLOTS, 0, sizeof(SLOTS));
+    for (int i = 0; i < NEIGH_RING_SLOTS; ++i) {
+        SLOTS[i].back  = 0;
+        SLOTS[i].front = 1;
+        atomic_store(&SLOTS[i].middle, 2);
+        atomic_store(&SLOTS[i].queued, false);
+    }
+    atomic_store(&s_head, 0);
+    atomic_store(&s_tail, 0);
+
+    s_clock  = 0;
+    s_in_use = 0;
+    atomic_store(&s_pushed, 0);
+    atomic_store(&s_coalesced, 0);
+    atomic_store(&s_dropped, 0);
+    atomic_store(&s_evicted, 0);
+    atomic_store(&s_popped, 0);
+    atomic_store(&s_peak, 0);
+}
+
+// -----------------------------------------------------------------------------
+// PRODUCER
+// -----------------------------------------------------------------------------
+static int find_slot(const uint8_t node_id[6])
+{
+    int free_idx = -1, lru_idx = -1;
+    uint32_t lru_age = 0;
+
+    for (int i = 0; i < NEIGH_RING_SLOTS; ++i) {
+        NeighSlot *s = &SLOTS[i];
+        if (!s->in_use) {
+            if (free_idx < 0) free_idx = i;
+            continue;
+        }
+        if (memcmp(s->node_id, node_id, 6) == 0) return i;
+
+        // Only slots without unread data may be taken from another sender.
+        // queued alone isn't enough: the consumer clears it before it takes
+        // the middle buffer, and only that clears MIDDLE_FRESH.
+        uint32_t age = s_clock - s->stamp;
+        bool unread = atomic_load_explicit(&s->queued, memory_order_acquire) ||
+                      (atomic_load_explicit(&s->middle, memory_order_acquire) & MIDDLE_FRESH);
+        if (!unread && age >= lru_age) {
+            lru_age = age;
+            lru_idx = i;
+        }
+    }
+
+    int idx = (free_idx >= 0) ? free_idx : lru_idx;
+    if (idx < 0) return -1;
+
+    if (free_idx < 0) {
+        atomic_fetch_add_explicit(&s_evicted, 1, memory_order_relaxed);
+    } else {
+        s_in_use++;
+    }
+    SLOTS[idx].in_use = true;
+    memcpy(SLOTS[idx].node_id, node_id, 6);
+    return idx;
+}
+
+bool neigh_ring_push(const NeighbourState *n)
+{
+    int idx = find_slot(n->node_id);
+    if (idx < 0) {
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+        return false;
+    }
+
+    NeighSlot *s = &SLOTS[idx];
+    s->stamp = ++s_clock;
+
+    s->buf[s->back] = *n;
+    unsigned prev = atomic_exchange_explicit(&s->middle, s->back | MIDDLE_FRESH,
+                                             memory_order_acq_rel);
+    s->back = (uint8_t)(prev & MIDDLE_INDEX);
+
+    atomic_fetch_add_explicit(&s_pushed, 1, memory_order_relaxed);
+    if (prev & MIDDLE_FRESH) {
+        atomic_fetch_add_explicit(&s_coalesced, 1, memory_order_relaxed);
+    }
+
+    // Announce the slot unless it is already waiting
+    if (!atomic_exchange_explicit(&s->queued, true, memory_order_acq_rel)) {
+        unsigned head = atomic_load_explicit(&s_head, memory_order_relaxed);
+        RING[head & (NEIGH_RING_SLOTS - 1)] = (uint8_t)idx;
+        atomic_store_explicit(&s_head, head + 1, memory_order_release);
+
+        unsigned occ = head + 1 - atomic_load_explicit(&s_tail, memory_order_relaxed);
+        if (occ > atomic_load_explicit(&s_peak, memory_order_relaxed)) {
+            atomic_store_explicit(&s_peak, occ, memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// CONSUMER
+// -----------------------------------------------------------------------------
+bool neigh_ring_pop(NeighbourState *out)
+{
+    while (true) {
+        unsigned tail = atomic_load_explicit(&s_tail, memory_order_relaxed);
+        unsigned head = atomic_load_explicit(&s_head, memory_order_acquire);
+        if (head == tail) return false;
+
+        NeighSlot *s = &SLOTS[RING[tail & (NEIGH_RING_SLOTS - 1)]];
+        atomic_store_explicit(&s_tail, tail + 1, memory_order_release);
+
+        // Clear before taking: a push from here on re-queues the slot
+        atomic_store_explicit(&s->queued, false, memory_order_seq_cst);
+
+        if (!(atomic_load_explicit(&s->middle, memory_order_acquire) & MIDDLE_FRESH)) {
+            continue;   // Already taken via an earlier entry
+        }
+
+        unsigned prev = atomic_exchange_explicit(&s->middle, s->front,
+                                                 memory_order_acq_rel);
+        s->front = (uint8_t)(prev & MIDDLE_INDEX);
+        *out = s->buf[s->front];
+
+        atomic_fetch_add_explicit(&s_popped, 1, memory_order_relaxed);
+        return true;
+    }
+}
+
+void neigh_ring_get_stats(NeighRingStats *out)
+{
+    unsigned head = atomic_load(&s_head);
+    unsigned tail = atomic_load(&s_tail);
+
+    out->pushed       = atomic_load(&s_pushed);
+    out->coalesced    = atomic_load(&s_coalesced);
+    out->dropped      = atomic_load(&s_dropped);
+    out->evicted      = atomic_load(&s_evicted);
+    out->popped       = atomic_load(&s_popped);
+    out->pending      = head - tail;
+    out->peak_pending = atomic_load(&s_peak);
+    out->slots_in_use = s_in_use;
+    out->capacity     = NEIGH_RING_SLOTS;
+}
@@ -0,0 +1,52 @@
+// main/neigh_ring.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "drone_state.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Verified neighbour updates from rx_verify_task (producer) to the flocking
+// task (consumer). Replaces the 8-deep FreeRTOS queue, which kept stale
+// copies from one busy sender while dropping other nodes' updates.
+//
+// Every sender owns a slot holding only its newest NeighbourState (a triple
+// buffer, so neither side ever blocks or sees a torn state). A lock-free
+// SPSC ring carries the indices of slots with unread data; a slot is in the
+// ring at most once, so the ring can never overflow. A new update for a node
+// that is still unread replaces it (counted as coalesced). The only drop is
+// a brand-new sender when every slot holds unread data.
+//
+// Pure C11 (atomics only): also built on the host for the benchmark.
+
+typedef struct {
+    uint32_t pushed;
+    uint32_t coalesced;      // Overwrote an unread update from the same node
+    uint32_t dropped;        // New sender, no slot free or evictable
+    uint32_t evicted;        // Slot reassigned from the least recent sender
+    uint32_t popped;
+    uint32_t pending;        // Nodes with unread updates right now
+    uint32_t peak_pending;
+    uint32_t slots_in_use;
+    uint32_t capacity;
+} NeighRingStats;
+
+void neigh_ring_init(void);
+
+// --- Producer side (verifier task) ---
+// FALSE if the update was dropped (counted)
+bool neigh_ring_push(const NeighbourState *n);
+
+// --- Consumer side (flocking task) ---
+// Newest unread state of the next node with news, FALSE if none
+bool neigh_ring_pop(NeighbourState *out);
+
+void neigh_ring_get_stats(NeighRingStats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,191 @@
+// main/packet_view.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+
+#include "drone_state.h"
+
+// Typed views over a NeighbourState frame as it sits in a radio buffer.
+//
+// The wire layout is described once, by the field schema below: every field
+// follows the previous one, so offsets and the MAC-covered length are
+// compile-time constants, and static_asserts pin them to the packed C struct
+// the C modules use. A view is just a pointer: reading a field decodes those
+// bytes little-endian (the wire order, whatever the CPU), so the verifier
+// can check the sender, duplicates and the CMAC straight from the RX ring
+// slot and only decode a full NeighbourState for frames it keeps.
+//
+// C++ only (comms_lora.cpp and host tools); header-only, no allocation.
+
+namespace wire {
+
+// --- Little-endian codec ---
+template <typename T>
+constexpr T load_le(const uint8_t *p)
+{
+    using U = typename std::conditional<sizeof(T) == 1, uint8_t,
+              typename std::conditional<sizeof(T) == 2, uint16_t, uint32_t>::type>::type;
+    U v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) v |= (U)((U)p[i] << (8 * i));
+    return (T)v;
+}
+
+template <typename T>
+constexpr void store_le(uint8_t *p, T v)
+{
+    for (size_t i = 0; i < sizeof(T); ++i) p[i] = (uint8_t)((uint32_t)v >> (8 * i));
+}
+
+// --- Field schema ---
+// A scalar field (T) or a byte array (uint8_t, N) at a fixed offset
+template <typename T, size_t Off, size_t N = 1>
+struct Field {
+    using type = T;
+    static constexpr size_t offset = Off;
+    static constexpr size_t size   = sizeof(T) * N;
+    static constexpr size_t end    = Off + size;
+};
+
+// The field right after Prev
+template <typename Prev, typename T, size_t N = 1>
+using Next = Field<T, Prev::end, N>;
+
+struct Neighbour {
+    using version    = Field<uint8_t, 0>;
+    using team_id    = Next<version,    uint8_t>;
+    using node_id    = Next<team_id,    uint8_t, 6>;
+    using seq_number = Next<node_id,    uint16_t>;
+    using ts_s       = Next<seq_number, uint32_t>;
+    using ts_ms      = Next<ts_s,       uint16_t>;
+    using x_mm       = Next<ts_ms,      uint32_t>;
+    using y_mm       = Next<x_mm,       uint32_t>;
+    using z_mm       = Next<y_mm,       uint32_t>;
+    using vx_mm_s    = Next<z_mm,       int32_t>;
+    using vy_mm_s    = Next<vx_mm_s,    int32_t>;
+    using vz_mm_s    = Next<vy_mm_s,    int32_t>;
+    using yaw_cd     = Next<vz_mm_s,    uint16_t>;
+    using link_cfg   = Next<yaw_cd,     uint16_t>;
+    using mac_tag    = Next<link_cfg,   uint8_t, 4>;
+
+    static constexpr size_t size        = mac_tag::end;
+    static constexpr size_t mac_covered = mac_tag::offset;    // CMAC input
+};
+
+// Schema and C struct must never drift apart
+#define WIRE_PIN(f) \
+    static_assert(Neighbour::f::offset == offsetof(NeighbourState, f) && \
+                  Neighbour::f::size == sizeof(((NeighbourState *)0)->f), \
+                  "wire::Neighbour::" #f " does not match NeighbourState")
+WIRE_PIN(version);    WIRE_PIN(team_id);    WIRE_PIN(node_id);
+WIRE_PIN(seq_number); WIRE_PIN(ts_s);       WIRE_PIN(ts_ms);
+WIRE_PIN(x_mm);       WIRE_PIN(y_mm);       WIRE_PIN(z_mm);
+WIRE_PIN(vx_mm_s);    WIRE_PIN(vy_mm_s);    WIRE_PIN(vz_mm_s);
+WIRE_PIN(yaw_cd);     WIRE_PIN(link_cfg);   WIRE_PIN(mac_tag);
+#undef WIRE_PIN
+static_assert(Neighbour::size == sizeof(NeighbourState), "NeighbourState has padding");
+
+// -----------------------------------------------------------------------------
+// READ VIEW
+// -----------------------------------------------------------------------------
+class NeighbourView {
+public:
+    // buf must hold at least Neighbour::size bytes (see fits())
+    explicit constexpr NeighbourView(const uint8_t *buf) : p_(buf) {}
+
+    static constexpr bool fits(size_t len) { return len >= Neighbour::size; }
+
+    template <typename F>
+    typename F::type get() const { return load_le<typename F::type>(p_ + F::offset); }
+
+    template <typename F>
+    const uint8_t *bytes() const { return p_ + F::offset; }
+
+    uint8_t  version() const    { return get<Neighbour::version>(); }
+    uint8_t  team_id() const    { return get<Neighbour::team_id>(); }
+    const uint8_t *node_id() const { return bytes<Neighbour::node_id>(); }
+    uint16_t seq_number() const { return get<Neighbour::seq_number>(); }
+    uint32_t ts_s() const       { return get<Neighbour::ts_s>(); }
+    uint16_t ts_ms() const      { return get<Neighbour::ts_ms>(); }
+    uint32_t x_mm() const       { return get<Neighbour::x_mm>(); }
+    uint32_t y_mm() const       { return get<Neighbour::y_mm>(); }
+    uint32_t z_mm() const       { return get<Neighbour::z_mm>(); }
+    int32_t  vx_mm_s() const    { return get<Neighbour::vx_mm_s>(); }
+    int32_t  vy_mm_s() const    { return get<Neighbour::vy_mm_s>(); }
+    int32_t  vz_mm_s() const    { return get<Neighbour::vz_mm_s>(); }
+    uint16_t yaw_cd() const     { return get<Neighbour::yaw_cd>(); }
+    uint16_t link_cfg() const   { return get<Neighbour::link_cfg>(); }
+    const uint8_t *mac_tag() const { return bytes<Neighbour::mac_tag>(); }
+
+    // CMAC input: the frame up to the tag
+    const uint8_t *mac_region() const { return p_; }
+    static constexpr size_t mac_region_len() { return Neighbour::mac_covered; }
+
+    bool from(const uint8_t mac[6]) const { return memcmp(node_id(), mac, 6) == 0; }
+
+    // Full decode, for frames that are kept
+    void decode(NeighbourState *out) const
+    {
+        out->version    = version();
+        out->team_id    = team_id();
+        memcpy(out->node_id, node_id(), sizeof(out->node_id));
+        out->seq_number = seq_number();
+        out->ts_s       = ts_s();
+        out->ts_ms      = ts_ms();
+        out->x_mm       = x_mm();
+        out->y_mm       = y_mm();
+        out->z_mm       = z_mm();
+        out->vx_mm_s    = vx_mm_s();
+        out->vy_mm_s    = vy_mm_s();
+        out->vz_mm_s    = vz_mm_s();
+        out->yaw_cd     = yaw_cd();
+        out->link_cfg   = link_cfg();
+        memcpy(out->mac_tag, mac_tag(), sizeof(out->mac_tag));
+    }
+
+private:
+    const uint8_t *p_;
+};
+
+// -----------------------------------------------------------------------------
+// WRITE VIEW
+// -----------------------------------------------------------------------------
+class NeighbourWriter {
+public:
+    explicit constexpr NeighbourWriter(uint8_t *buf) : p_(buf) {}
+
+    template <typename F>
+    void set(typename F::type v) { store_le<typename F::type>(p_ + F::offset, v); }
+
+    template <typename F>
+    void set_bytes(const uint8_t *src) { memcpy(p_ + F::offset, src, F::size); }
+
+    NeighbourView view() const { return NeighbourView(p_); }
+
+    // Whole state into the buffer in wire order
+    void encode(const NeighbourState &n)
+    {
+        set<Neighbour::version>(n.version);
+        set<Neighbour::team_id>(n.team_id);
+        set_bytes<Neighbour::node_id>(n.node_id);
+        set<Neighbour::seq_number>(n.seq_number);
+        set<Neighbour::ts_s>(n.ts_s);
+        set<Neighbour::ts_ms>(n.ts_ms);
+        set<Neighbour::x_mm>(n.x_mm);
+        set<Neighbour::y_mm>(n.y_mm);
+        set<Neighbour::z_mm>(n.z_mm);
+        set<Neighbour::vx_mm_s>(n.vx_mm_s);
+        set<Neighbour::vy_mm_s>(n.vy_mm_s);
+        set<Neighbour::vz_mm_s>(n.vz_mm_s);
+        set<Neighbour::yaw_cd>(n.yaw_cd);
+        set<Neighbour::link_cfg>(n.link_cfg);
+        set_bytes<Neighbour::mac_tag>(n.mac_tag);
+    }
+
+private:
+    uint8_t *p_;
+};
+
+} // namespace wire
@@ -2,10 +2,15 @@
 #include "tasks.h"
 #include "config.h"
 #include "monitoring.h" // <--- Added
+#include "telem_ring.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#if TELEM_SAMPLE_HZ > 0 && PHYSICS_FREQ_HZ % TELEM_SAMPLE_HZ != 0
+#error TELEM_SAMPLE_HZ must divide PHYSICS_FREQ_HZ
+#endif
+
 static void physics_task(void *arg)
 {
     (void)arg;
@@ -13,7 +18,9 @@ static void physics_task(void *arg)
     QueueHandle_t control_q   = get_control_input_queue();
     QueueHandle_t flocking_q  = get_flocking_state_queue();
     QueueHandle_t radio_q     = get_radio_state_queue();
+#if TELEM_SAMPLE_HZ == 0
     QueueHandle_t telemetry_q = get_telemetry_state_queue();
+#endif
 
     TickType_t period_ticks   = pdMS_TO_TICKS(PHYSICS_PERIOD_MS);
     TickType_t next_wake      = xTaskGetTickCount();
@@ -31,6 +38,9 @@ static void physics_task(void *arg)
     };
 
     ControlInput u = {0};
+#if TELEM_SAMPLE_HZ > 0
+    uint32_t telem_steps = 0;
+#endif
 
     while (true) {
         vTaskDelayUntil(&next_wake, period_ticks);
@@ -71,7 +81,16 @@ static void physics_task(void *arg)
         // Publish state to other subsystems
         xQueueOverwrite(flocking_q,  &s);
         xQueueOverwrite(radio_q,     &s);
+#if TELEM_SAMPLE_HZ > 0
+        // Telemetry sample, stamped now (seq_number / mac_tag at publish);
+        // the telemetry queue has no reader in batched mode
+        if (++telem_steps % (PHYSICS_FREQ_HZ / TELEM_SAMPLE_HZ) == 0) {
+            NeighbourState sample = DroneState_to_NeighbourState(&s, 0);
+            telem_ring_push(&sample);
+        }
+#else
         xQueueOverwrite(telemetry_q, &s);
+#endif
 
         // --- MONITOR END ---
         monitor_task_end(MON_TASK_PHYSICS);
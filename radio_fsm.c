@@ -0,0 +1,204 @@
+// main/radio_fsm.c
+#include "radio_fsm.h"
+#include "config.h"
+
+#include <string.h>
+
+static bool due(uint32_t at_ms, uint32_t now_ms)
+{
+    return (int32_t)(now_ms - at_ms) >= 0;
+}
+
+void radio_fsm_default_config(RadioFsmConfig *cfg)
+{
+    cfg->csma          = CSMA_ENABLED;
+    cfg->echo_guard_ms = RADIO_ECHO_GUARD_MS;
+    cfg->guard_ms      = TX_SCHED_TX_GUARD_MS;
+    cfg->cad_guard_ms  = CSMA_CAD_GUARD_MS;
+}
+
+void radio_fsm_init(RadioFsm *m, const RadioFsmConfig *cfg,
+                    const RadioFsmOps *ops, void *ctx, uint32_t csma_seed)
+{
+    memset(m, 0, sizeof(*m));
+    m->cfg = *cfg;
+    m->ops = ops;
+    m->ctx = ctx;
+    m->state = RADIO_FSM_RX;
+    csma_init(&m->csma, csma_seed);
+}
+
+// -----------------------------------------------------------------------------
+// TRANSITIONS
+// -----------------------------------------------------------------------------
+static void enter_rx(RadioFsm *m)
+{
+    m->state = RADIO_FSM_RX;
+    m->ops->start_receive(m->ctx);
+}
+
+static bool enter_tx(RadioFsm *m, const TxItem *it, uint32_t now_ms)
+{
+    uint32_t airtime_us = 0;
+    if (!m->ops->transmit(m->ctx, it, now_ms, &airtime_us)) {
+        m->stats.tx_refused++;
+        enter_rx(m);
+        return false;
+    }
+    m->state = RADIO_FSM_TX;
+    m->guard_at_ms = now_ms + airtime_us / 1000 + m->cfg.guard_ms;
+    m->stats.tx++;
+    return true;
+}
+
+static void tx_done(RadioFsm *m, uint32_t now_ms)
+{
+    m->tx_ended  = true;
+    m->tx_end_ms = now_ms;
+    m->ops->tx_done(m->ctx, now_ms);
+    enter_rx(m);
+}
+
+static void cad_done(RadioFsm *m, uint32_t now_ms)
+{
+    bool busy = m->ops->cad_busy(m->ctx);
+    uint32_t backoff_ms = 0;
+
+    switch (csma_on_cad(&m->csma, busy, m->ops->airtime_us(m->ctx, m->held.len) / 1000,
+                        now_ms, m->held.deadline_ms,
+                        m->held.cls == TX_CLASS_OWN, &backoff_ms)) {
+    case CSMA_SEND:
+        m->held_valid = false;
+        enter_tx(m, &m->held, now_ms);
+        break;
+    case CSMA_BACKOFF:
+        m->backoff_until_ms = now_ms + backoff_ms;
+        enter_rx(m);
+        break;
+    case CSMA_DROP:
+        m->held_valid = false;
+        enter_rx(m);
+        break;
+    }
+}
+
+static void rx_done(RadioFsm *m, uint32_t now_ms)
+{
+    if (m->tx_ended && now_ms - m->tx_end_ms < m->cfg.echo_guard_ms) {
+        m->stats.echo++;
+    } else {
+        m->stats.rx++;
+        m->ops->receive(m->ctx, now_ms);
+    }
+    enter_rx(m);
+}
+
+// -----------------------------------------------------------------------------
+// EVENTS
+// -----------------------------------------------------------------------------
+void radio_fsm_start(RadioFsm *m, uint32_t now_ms)
+{
+    (void)now_ms;
+    enter_rx(m);
+}
+
+void radio_fsm_on_dio0(RadioFsm *m, uint32_t now_ms, uint32_t latency_us)
+{
+    m->stats.dio0++;
+    if (latency_us > m->stats.lat_max_us) m->stats.lat_max_us = latency_us;
+    int b = 0;
+    while (b < RADIO_FSM_LAT_BUCKETS - 1 && latency_us >= (16u << (b + 1))) b++;
+    m->stats.lat_hist[b]++;
+
+    switch (m->state) {
+    case RADIO_FSM_TX:  tx_done(m, now_ms);  break;
+    case RADIO_FSM_CAD: cad_done(m, now_ms); break;
+    default:            rx_done(m, now_ms);  break;
+    }
+}
+
+void radio_fsm_poll(RadioFsm *m, uint32_t now_ms)
+{
+    // Lost DIO0: a TX counts as done, a held frame gets a fresh CAD
+    if (m->state == RADIO_FSM_TX && due(m->guard_at_ms, now_ms)) {
+        m->stats.guard_tx++;
+        tx_done(m, now_ms);
+    } else if (m->state == RADIO_FSM_CAD && due(m->guard_at_ms, now_ms)) {
+        m->stats.guard_cad++;
+        enter_rx(m);
+    }
+    if (m->state != RADIO_FSM_RX) return;
+
+    if (!m->cfg.csma) {
+        TxItem it;
+        while (m->ops->next_tx(m->ctx, &it, now_ms)) {
+            if (enter_tx(m, &it, now_ms)) return;
+        }
+        return;
+    }
+
+    if (m->held_valid && !due(m->backoff_until_ms, now_ms)) return;
+    if (!m->held_valid) {
+        if (!m->ops->next_tx(m->ctx, &m->held, now_ms)) return;
+        m->held_valid = true;
+    }
+
+    // A frame that landed since the last wake-up would be lost to the CAD
+    uint32_t latency_us;
+    if (m->ops->dio0_pending(m->ctx, &latency_us)) {
+        radio_fsm_on_dio0(m, now_ms, latency_us);
+    }
+
+    if (!m->ops->start_cad(m->ctx)) {
+        // No CAD: send blind
+        m->stats.cad_refused++;
+        m->held_valid = false;
+        enter_tx(m, &m->held, now_ms);
+        return;
+    }
+    m->state = RADIO_FSM_CAD;
+    m->guard_at_ms = now_ms + m->cfg.cad_guard_ms;
+}
+
+// -----------------------------------------------------------------------------
+// QUERIES
+// -----------------------------------------------------------------------------
+uint32_t radio_fsm_wait_ms(const RadioFsm *m, uint32_t now_ms)
+{
+    uint32_t at;
+    if (m->state != RADIO_FSM_RX) {
+        at = m->guard_at_ms;
+    } else if (m->held_valid) {
+        at = m->backoff_until_ms;
+    } else {
+        return UINT32_MAX;
+    }
+    return due(at, now_ms) ? 0 : at - now_ms;
+}
+
+bool radio_fsm_idle(const RadioFsm *m)
+{
+    return m->state == RADIO_FSM_RX && !m->held_valid;
+}
+
+bool radio_fsm_holds(const RadioFsm *m, TxClass cls)
+{
+    return m->held_valid && m->held.cls == cls;
+}
+
+uint32_t radio_fsm_latency_us(const RadioFsmStats *st, float p)
+{
+    uint32_t n = 0;
+    for (int b = 0; b < RADIO_FSM_LAT_BUCKETS; ++b) n += st->lat_hist[b];
+    if (n == 0) return 0;
+
+    uint32_t target = (uint32_t)(p * (float)n);
+    if (target >= n) target = n - 1;
+
+    uint32_t acc = 0;
+    for (int b = 0; b < RADIO_FSM_LAT_BUCKETS - 1; ++b) {
+        acc += st->lat_hist[b];
+        if (acc > target) return 16u << (b + 1);
+    }
+    return st->lat_max_us;
+}
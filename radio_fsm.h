@@ -0,0 +1,131 @@
+// main/radio_fsm.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "tx_sched.h"
+#include "csma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Event-driven state machine of the SX1276 driver. The radio is always in
+// exactly one of three states, and every transition re-arms RX in one place:
+//
+//   RX  --poll, frame held, channel clear?-->  CAD  --clear-->  TX
+//    ^  <--DIO0 RxDone: read, re-arm RX         |                |
+//    +---------- busy: backoff in RX -----------+                |
+//    +---------- DIO0 TxDone (or guard expired) -----------------+
+//
+// radio_task feeds it two kinds of events: DIO0 (radio_fsm_on_dio0, woken
+// by a task notification from the ISR, with the ISR -> handler latency) and
+// time (radio_fsm_poll, after any wake-up). Nothing in here blocks: a lost
+// TxDone / CadDone is caught by a guard deadline, backoff is a deadline, and
+// radio_fsm_wait_ms() tells the task how long it may sleep.
+//
+// Hardware and the TX bookkeeping around it are behind RadioFsmOps, so the
+// same machine runs against RadioLib (comms_lora.cpp) and against SimRadio
+// on the host (host/radio_fsm_sim.cpp).
+//
+// Pure logic, no FreeRTOS / RadioLib: times are plain milliseconds.
+
+typedef enum {
+    RADIO_FSM_RX = 0,       // Listening (a held frame may be backing off)
+    RADIO_FSM_CAD,          // Channel activity detection for the held frame
+    RADIO_FSM_TX,
+    RADIO_FSM_STATE_MAX
+} RadioFsmState;
+
+typedef struct {
+    void (*start_receive)(void *ctx);
+    bool (*start_cad)(void *ctx);               // FALSE: no CAD, send blind
+    bool (*cad_busy)(void *ctx);
+    // Put a frame on air and do the per-TX bookkeeping. FALSE if refused.
+    bool (*transmit)(void *ctx, const TxItem *it, uint32_t now_ms,
+                     uint32_t *airtime_us);
+    void (*tx_done)(void *ctx, uint32_t now_ms);
+    void (*receive)(void *ctx, uint32_t now_ms);    // Read out an RxDone
+    bool (*next_tx)(void *ctx, TxItem *it, uint32_t now_ms);
+    uint32_t (*airtime_us)(void *ctx, size_t len);
+    // DIO0 already signalled but not handled yet (consumes it)
+    bool (*dio0_pending)(void *ctx, uint32_t *latency_us);
+} RadioFsmOps;
+
+typedef struct {
+    bool     csma;              // Listen before talk (CSMA_ENABLED)
+    uint32_t echo_guard_ms;     // RxDone this soon after TxDone is our own echo
+    uint32_t guard_ms;          // Re-arm if TxDone never comes (+ airtime)
+    uint32_t cad_guard_ms;      // Re-arm if CadDone never comes
+} RadioFsmConfig;
+
+#define RADIO_FSM_LAT_BUCKETS   16      // Bucket b: below 32 << b us
+
+typedef struct {
+    uint32_t dio0;              // DIO0 events handled
+    uint32_t rx;                // RxDone read out
+    uint32_t echo;              // RxDone dropped by the echo guard
+    uint32_t tx;
+    uint32_t tx_refused;        // transmit() failed, RX re-armed
+    uint32_t cad_refused;       // start_cad() failed, sent blind
+    uint32_t guard_tx;          // TxDone never came
+    uint32_t guard_cad;         // CadDone never came
+    uint32_t lat_max_us;        // ISR -> handler
+    uint32_t lat_hist[RADIO_FSM_LAT_BUCKETS];
+} RadioFsmStats;
+
+typedef struct {
+    RadioFsmConfig    cfg;
+    const RadioFsmOps *ops;
+    void             *ctx;
+
+    RadioFsmState state;
+    uint32_t      guard_at_ms;      // CAD / TX: give up waiting for DIO0
+    bool          tx_ended;         // tx_end_ms valid
+    uint32_t      tx_end_ms;
+
+    // Frame taken from the scheduler, waiting through CAD and backoff
+    TxItem        held;
+    bool          held_valid;
+    uint32_t      backoff_until_ms;
+
+    Csma          csma;
+    RadioFsmStats stats;
+} RadioFsm;
+
+// Defaults from config.h
+void radio_fsm_default_config(RadioFsmConfig *cfg);
+
+void radio_fsm_init(RadioFsm *m, const RadioFsmConfig *cfg,
+                    const RadioFsmOps *ops, void *ctx, uint32_t csma_seed);
+
+// Arm RX for the first time
+void radio_fsm_start(RadioFsm *m, uint32_t now_ms);
+
+// DIO0: TxDone, CadDone or RxDone depending on the state
+void radio_fsm_on_dio0(RadioFsm *m, uint32_t now_ms, uint32_t latency_us);
+
+// Time events: lost DIO0, end of a backoff, and the next frame when idle
+void radio_fsm_poll(RadioFsm *m, uint32_t now_ms);
+
+// How long the task may sleep without missing a time event (UINT32_MAX: until
+// DIO0 or new work)
+uint32_t radio_fsm_wait_ms(const RadioFsm *m, uint32_t now_ms);
+
+// Listening with nothing held: a new frame would go to CAD / TX at once
+bool radio_fsm_idle(const RadioFsm *m);
+
+// A frame of this class is held (taken from tx_sched, not yet on air)
+bool radio_fsm_holds(const RadioFsm *m, TxClass cls);
+
+// ISR -> handler latency percentile (upper bucket edge, us)
+uint32_t radio_fsm_latency_us(const RadioFsmStats *st, float p);
+
+// Stats of the radio's instance (comms_lora.cpp), for monitoring
+void radio_get_fsm_stats(RadioFsmStats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,114 @@
+// main/rate_sketch.c
+#include "rate_sketch.h"
+
+#include <string.h>
+
+#if RATE_SKETCH_DEPTH != 4
+#error RATE_SKETCH_DEPTH must be 4 (one 16-bit index per row from a 64-bit hash)
+#endif
+#if (RATE_SKETCH_WIDTH & (RATE_SKETCH_WIDTH - 1)) != 0 || RATE_SKETCH_WIDTH < 4 || \
+    RATE_SKETCH_WIDTH > 65536
+#error RATE_SKETCH_WIDTH must be a power of two, 4..65536
+#endif
+
+#define WIDTH_MASK   (RATE_SKETCH_WIDTH - 1)
+#define WORDS        (int)(sizeof(((RateSketch *)0)->word) / sizeof(uint64_t))
+#define FADE_STEPS   84     // (7/8)^84 x 65535 < 1: everything gone
+
+void rate_sketch_default_config(RateSketchConfig *cfg)
+{
+    cfg->step_ms = RATE_SKETCH_STEP_MS;
+}
+
+void rate_sketch_init(RateSketch *s, const RateSketchConfig *cfg, uint32_t seed,
+                      uint32_t now_ms)
+{
+    memset(s, 0, sizeof(*s));
+    s->cfg  = *cfg;
+    s->seed = (uint64_t)seed * 0x9E3779B97F4A7C15ull;
+    s->last_step_ms = now_ms;
+}
+
+// -----------------------------------------------------------------------------
+// DECAY
+// -----------------------------------------------------------------------------
+// x -= x / 8 on four packed counters at once
+static uint64_t fade(uint64_t w)
+{
+    return w - ((w >> 3) & 0x1FFF1FFF1FFF1FFFull);
+}
+
+static void catch_up(RateSketch *s, uint32_t now_ms)
+{
+    uint32_t steps = (now_ms - s->last_step_ms) / s->cfg.step_ms;
+    if (steps == 0) return;
+    s->last_step_ms += steps * s->cfg.step_ms;
+
+    if (steps >= FADE_STEPS) {
+        memset(s->count, 0, sizeof(s->count));
+        return;
+    }
+
+    // In place: the verifier task's stack has no room for a copy
+    for (int i = 0; i < WORDS; ++i) {
+        uint64_t w = s->word[i];
+        for (uint32_t k = 0; k < steps && w; ++k) w = fade(w);
+        s->word[i] = w;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// API
+// -----------------------------------------------------------------------------
+static void columns(const RateSketch *s, const uint8_t node_id[6], uint32_t col[RATE_SKETCH_DEPTH])
+{
+    uint64_t k = 0;
+    memcpy(&k, node_id, 6);
+    k ^= s->seed;
+
+    // splitmix64 finaliser, one 16-bit slice per row
+    k ^= k >> 30; k *= 0xBF58476D1CE4E5B9ull;
+    k ^= k >> 27; k *= 0x94D049BB133111EBull;
+    k ^= k >> 31;
+    for (int r = 0; r < RATE_SKETCH_DEPTH; ++r) col[r] = (uint32_t)(k >> (16 * r)) & WIDTH_MASK;
+}
+
+static uint32_t min_count(const RateSketch *s, const uint32_t col[RATE_SKETCH_DEPTH])
+{
+    uint32_t m = UINT16_MAX;
+    for (int r = 0; r < RATE_SKETCH_DEPTH; ++r) {
+        if (s->count[r][col[r]] < m) m = s->count[r][col[r]];
+    }
+    return m;
+}
+
+// Counter units -> frames per second x RATE_SKETCH_ONE
+static uint32_t to_rate(const RateSketch *s, uint32_t count)
+{
+    return count * 125u / s->cfg.step_ms;
+}
+
+uint32_t rate_sketch_add(RateSketch *s, const uint8_t node_id[6], uint32_t now_ms)
+{
+    catch_up(s, now_ms);
+
+    uint32_t col[RATE_SKETCH_DEPTH];
+    columns(s, node_id, col);
+
+    // Conservative update: only counters below the new minimum move
+    uint32_t m = min_count(s, col) + RATE_SKETCH_ONE;
+    if (m > UINT16_MAX) m = UINT16_MAX;
+    for (int r = 0; r < RATE_SKETCH_DEPTH; ++r) {
+        if (s->count[r][col[r]] < m) s->count[r][col[r]] = (uint16_t)m;
+    }
+    return to_rate(s, m);
+}
+
+uint32_t rate_sketch_estimate(RateSketch *s, const uint8_t node_id[6], uint32_t now_ms)
+{
+    catch_up(s, now_ms);
+
+    uint32_t col[RATE_SKETCH_DEPTH];
+    columns(s, node_id, col);
+    return to_rate(s, min_count(s, col));
+}
@@ -0,0 +1,66 @@
+// main/rate_sketch.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Frame rate per claimed node_id over any number of senders, in fixed
+// memory: a count-min sketch of RATE_SKETCH_DEPTH rows x RATE_SKETCH_WIDTH
+// 16-bit counters (2 KB by default). A sender hashes to one counter per row
+// (seeded, so an attacker can't aim at a neighbour's counters); its
+// estimate is the smallest of them, which can only be too high, never too
+// low. Conservative update raises only the counters at that minimum, which
+// keeps the overestimate from collisions small.
+//
+// Counts decay: every step_ms all counters lose 1/8 (a shift and subtract
+// per four counters, caught up lazily on the next call), a time constant
+// of 8 x step_ms. A frame adds RATE_SKETCH_ONE, so a steady r frames/s
+// settles at 8 r RATE_SKETCH_ONE step_ms / 1000 (+-1/8); the estimates
+// scale that back to frames per second x RATE_SKETCH_ONE.
+//
+// The admission stage (admit.c) feeds it every frame of senders not in the
+// security table and throttles those above RATE_SKETCH_HEAVY_PER_S before
+// any crypto, so a spoofed flood from one or many identities neither costs
+// CMACs nor takes table entries, however many MACs it cycles through.
+//
+// Pure logic, no FreeRTOS: times are plain milliseconds.
+
+#define RATE_SKETCH_ONE  16     // Counter units per frame
+
+typedef struct {
+    uint32_t step_ms;           // Decay step, 1/8 per step
+} RateSketchConfig;
+
+typedef struct {
+    RateSketchConfig cfg;
+    uint64_t         seed;
+    uint32_t         last_step_ms;
+    union {
+        uint16_t     count[RATE_SKETCH_DEPTH][RATE_SKETCH_WIDTH];
+        uint64_t     word[RATE_SKETCH_DEPTH * RATE_SKETCH_WIDTH / 4];  // Decay, in place
+    };
+} RateSketch;
+
+// Defaults from config.h
+void rate_sketch_default_config(RateSketchConfig *cfg);
+
+// seed: random per boot, so the counters a node_id lands on can't be known
+void rate_sketch_init(RateSketch *s, const RateSketchConfig *cfg, uint32_t seed,
+                      uint32_t now_ms);
+
+// Count one frame from node_id; its rate estimate afterwards, in frames per
+// second x RATE_SKETCH_ONE
+uint32_t rate_sketch_add(RateSketch *s, const uint8_t node_id[6], uint32_t now_ms);
+
+// Rate estimate without counting (same unit)
+uint32_t rate_sketch_estimate(RateSketch *s, const uint8_t node_id[6], uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,208 @@
+// main/relay.c
+#include "relay.h"
+#include "config.h"
+
+#include <string.h>
+
+#define BLOOM_WORDS   (RELAY_DUP_FILTER_BITS / 32)
+#define BLOOM_MASK    (RELAY_DUP_FILTER_BITS - 1)
+
+static uint32_t rng_next(Relay *r)
+{
+    r->rng ^= r->rng << 13;
+    r->rng ^= r->rng >> 17;
+    r->rng ^= r->rng << 5;
+    return r->rng;
+}
+
+static bool time_after(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+void relay_default_config(RelayConfig *cfg)
+{
+#if RELAY_ENABLED
+    cfg->max_hops        = RELAY_MAX_HOPS;
+#else
+    cfg->max_hops        = 1;
+#endif
+    cfg->delay_max_ms    = RELAY_DELAY_MAX_MS;
+    cfg->suppress_copies = RELAY_SUPPRESS_COPIES;
+    cfg->probability     = RELAY_PROBABILITY;
+    cfg->deadline_ms     = TX_SCHED_RELAY_DEADLINE_MS;
+    cfg->margin_max_db   = RELAY_MARGIN_MAX_DB;
+}
+
+void relay_init(Relay *r, const RelayConfig *cfg, uint32_t seed)
+{
+    memset(r, 0, sizeof(*r));
+    r->cfg = *cfg;
+    r->rng = seed ? seed : 0x9E3779B9u;
+}
+
+int relay_frame_hops(const uint8_t *frame, size_t len)
+{
+    if (len == sizeof(NeighbourState)) return 0;
+    if (len == RELAY_FRAME_LEN) return frame[RELAY_HOPS_OFFSET];
+    return -1;
+}
+
+// -----------------------------------------------------------------------------
+// DUPLICATE FILTER
+// Two bloom generations: look up in both, insert into the current one. When
+// it holds RELAY_DUP_GEN_ENTRIES keys the older one is cleared and takes
+// over, so a key is remembered for one to two generations.
+// -----------------------------------------------------------------------------
+static uint64_t key_hash(const uint8_t node_id[6], uint16_t seq_number)
+{
+    uint64_t k = 0;
+    memcpy(&k, node_id, 6);
+    k ^= (uint64_t)seq_number << 48;
+
+    // splitmix64 finaliser
+    k ^= k >> 30; k *= 0xBF58476D1CE4E5B9ull;
+    k ^= k >> 27; k *= 0x94D049BB133111EBull;
+    k ^= k >> 31;
+    return k;
+}
+
+// Double hashing: bit i = h1 + i * h2
+static bool bloom_test(const uint32_t *bloom, uint64_t h)
+{
+    uint32_t h1 = (uint32_t)h, h2 = (uint32_t)(h >> 32) | 1u;
+    for (int i = 0; i < RELAY_DUP_FILTER_HASHES; ++i) {
+        uint32_t bit = (h1 + (uint32_t)i * h2) & BLOOM_MASK;
+        if (!(bloom[bit / 32] & (1u << (bit % 32)))) return false;
+    }
+    return true;
+}
+
+static void bloom_set(uint32_t *bloom, uint64_t h)
+{
+    uint32_t h1 = (uint32_t)h, h2 = (uint32_t)(h >> 32) | 1u;
+    for (int i = 0; i < RELAY_DUP_FILTER_HASHES; ++i) {
+        uint32_t bit = (h1 + (uint32_t)i * h2) & BLOOM_MASK;
+        bloom[bit / 32] |= 1u << (bit % 32);
+    }
+}
+
+bool relay_is_duplicate(Relay *r, const uint8_t *frame,
+                        const uint8_t node_id[6], uint16_t seq_number)
+{
+    uint64_t h = key_hash(node_id, seq_number);
+    if (!bloom_test(r->bloom[0], h) && !bloom_test(r->bloom[1], h)) {
+        return false;
+    }
+
+    // Still unverified: only a byte-exact copy of the signed state (mac_tag
+    // included) counts towards suppression, else a forged frame reusing the
+    // key could cancel the genuine relay. The hop byte is outside the MAC.
+    r->stats.duplicates++;
+    for (int i = 0; i < RELAY_PENDING_MAX; ++i) {
+        RelayPending *p = &r->pending[i];
+        if (p->in_use && memcmp(p->frame, frame, sizeof(NeighbourState)) == 0) {
+            if (p->copies < UINT8_MAX) p->copies++;
+            break;
+        }
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// RELAY DECISION
+// -----------------------------------------------------------------------------
+void relay_mark_seen(Relay *r, const uint8_t node_id[6], uint16_t seq_number)
+{
+    if (r->cur_entries >= RELAY_DUP_GEN_ENTRIES) {
+        r->cur ^= 1;
+        memset(r->bloom[r->cur], 0, sizeof(r->bloom[r->cur]));
+        r->cur_entries = 0;
+        r->stats.generations++;
+    }
+    bloom_set(r->bloom[r->cur], key_hash(node_id, seq_number));
+    r->cur_entries++;
+}
+
+void relay_consider(Relay *r, const uint8_t *frame, uint8_t hops,
+                    float margin_db, uint32_t now_ms)
+{
+    if (hops + 1 >= r->cfg.max_hops) {
+        r->stats.hop_limited++;
+        return;
+    }
+
+    if (margin_db > r->cfg.margin_max_db) {
+        r->stats.too_close++;
+        return;
+    }
+
+    if (r->cfg.probability < 1.0f &&
+        (float)(rng_next(r) >> 8) >= r->cfg.probability * (float)(1u << 24)) {
+        r->stats.skipped++;
+        return;
+    }
+
+    RelayPending *slot = NULL;
+    for (int i = 0; i < RELAY_PENDING_MAX; ++i) {
+        if (!r->pending[i].in_use) { slot = &r->pending[i]; break; }
+    }
+    if (!slot) {
+        r->stats.skipped++;
+        return;
+    }
+
+    slot->in_use = true;
+    slot->copies = 1;
+    // Weak copy -> we are far from the sender -> our relay covers the most
+    // new ground: go first. Strong copies wait and are likely suppressed.
+    float frac = margin_db / r->cfg.margin_max_db;
+    if (frac < 0.0f) frac = 0.0f;
+    if (frac > 1.0f) frac = 1.0f;
+    uint32_t slot_ms = r->cfg.delay_max_ms / 4u;
+    uint32_t base_ms = (uint32_t)(frac * (float)(r->cfg.delay_max_ms - slot_ms));
+    slot->due_ms = now_ms + base_ms + rng_next(r) % (slot_ms + 1);
+    memcpy(slot->frame, frame, sizeof(NeighbourState));
+    slot->frame[RELAY_HOPS_OFFSET] = hops;
+    r->stats.scheduled++;
+}
+
+bool relay_next(Relay *r, uint8_t out[RELAY_FRAME_LEN], uint32_t now_ms)
+{
+    while (true) {
+        RelayPending *due = NULL;
+        for (int i = 0; i < RELAY_PENDING_MAX; ++i) {
+            RelayPending *p = &r->pending[i];
+            if (!p->in_use || time_after(p->due_ms, now_ms)) continue;
+            if (!due || time_after(due->due_ms, p->due_ms)) due = p;
+        }
+        if (!due) return false;
+
+        due->in_use = false;
+        if (now_ms - due->due_ms > r->cfg.deadline_ms) {
+            r->stats.expired++;
+            continue;
+        }
+        if (r->cfg.suppress_copies > 0 && due->copies >= r->cfg.suppress_copies) {
+            r->stats.suppressed++;
+            continue;
+        }
+
+        memcpy(out, due->frame, RELAY_FRAME_LEN);
+        out[RELAY_HOPS_OFFSET]++;
+        r->stats.relayed++;
+        return true;
+    }
+}
+
+uint32_t relay_wait_ms(const Relay *r, uint32_t now_ms)
+{
+    uint32_t wait = UINT32_MAX;
+    for (int i = 0; i < RELAY_PENDING_MAX; ++i) {
+        const RelayPending *p = &r->pending[i];
+        if (!p->in_use) continue;
+        uint32_t w = time_after(p->due_ms, now_ms) ? p->due_ms - now_ms : 0;
+        if (w < wait) wait = w;
+    }
+    return wait;
+}
@@ -0,0 +1,115 @@
+// main/relay.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "config.h"
+#include "drone_state.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Multi-hop relay: controlled flooding of verified neighbour states so a
+// long or split swarm keeps hearing nodes beyond direct LoRa range.
+//
+// A relayed frame is the original signed NeighbourState followed by one hop
+// byte (hops travelled so far); direct broadcasts are the bare 48 bytes, i.e.
+// hop 0. The hop byte sits outside the MAC so relays can bump it; forging it
+// can only shorten or lengthen a flood by RELAY_MAX_HOPS, never inject state.
+//
+// Duplicates are caught before CMAC by a two-generation bloom filter keyed
+// on (node_id, seq_number). Keys are only inserted once the CMAC passed, so
+// a forged frame can't shadow the genuine one. A fresh frame is relayed after
+// an assessment delay, unless RELAY_SUPPRESS_COPIES copies of it were heard
+// meanwhile (counter-based suppression: neighbours already covered the area)
+// or the gossip coin says no. The delay grows with the SNR margin we heard
+// it at, so the nodes furthest from the sender relay first and the closer
+// ones, which would add little coverage, mostly end up suppressed.
+//
+// Pure logic, no FreeRTOS: times are plain milliseconds. Not thread-safe,
+// the caller serialises access.
+
+#define RELAY_FRAME_LEN     (sizeof(NeighbourState) + 1)
+#define RELAY_HOPS_OFFSET   sizeof(NeighbourState)
+
+typedef struct {
+    uint8_t  max_hops;          // Hops a state may travel (1 = relay off)
+    uint16_t delay_max_ms;      // Random assessment delay before relaying
+    uint8_t  suppress_copies;   // Cancel after this many copies (0 = never)
+    float    probability;       // Gossip: relay with this probability
+    uint16_t deadline_ms;       // Give up if still not sent this long after due
+    float    margin_max_db;     // Heard stronger than this: too close to add coverage
+} RelayConfig;
+
+typedef struct {
+    bool     in_use;
+    uint8_t  copies;            // Including the one that scheduled it
+    uint32_t due_ms;
+    uint8_t  frame[RELAY_FRAME_LEN];
+} RelayPending;
+
+typedef struct {
+    uint32_t duplicates;        // Dropped before CMAC
+    uint32_t scheduled;
+    uint32_t relayed;
+    uint32_t suppressed;        // Enough copies heard while waiting
+    uint32_t expired;           // Radio busy past the deadline
+    uint32_t hop_limited;
+    uint32_t too_close;         // Heard above margin_max_db
+    uint32_t skipped;           // Gossip coin or no free pending slot
+    uint32_t generations;       // Duplicate filter rotations
+} RelayStats;
+
+typedef struct {
+    RelayConfig  cfg;
+
+    uint32_t     bloom[2][RELAY_DUP_FILTER_BITS / 32];
+    uint8_t      cur;           // Generation being filled
+    uint16_t     cur_entries;
+
+    RelayPending pending[RELAY_PENDING_MAX];
+    uint32_t     rng;
+    RelayStats   stats;
+} Relay;
+
+void relay_default_config(RelayConfig *cfg);
+
+void relay_init(Relay *r, const RelayConfig *cfg, uint32_t seed);
+
+// Frame length -> hops travelled, or -1 if it is no state frame
+int relay_frame_hops(const uint8_t *frame, size_t len);
+
+// Pre-CMAC: TRUE if (node_id, seq_number) was already verified recently.
+// A frame (wire order) identical to a pending relay up to the hop byte also
+// counts as a copy of it; one that only shares the key is dropped but doesn't
+// count. Takes the key rather than a NeighbourState so it runs on the raw RX
+// frame.
+bool relay_is_duplicate(Relay *r, const uint8_t *frame,
+                        const uint8_t node_id[6], uint16_t seq_number);
+
+// CMAC passed: later copies of this state are duplicates
+void relay_mark_seen(Relay *r, const uint8_t node_id[6], uint16_t seq_number);
+
+// State accepted: maybe schedule a relay of the signed frame as received
+// (wire order). margin_db is the SNR this copy was heard at above the
+// demodulation floor.
+void relay_consider(Relay *r, const uint8_t *frame, uint8_t hops,
+                    float margin_db, uint32_t now_ms);
+
+// Next relay that is due now (RELAY_FRAME_LEN bytes, hop byte already bumped).
+// Call only when the frame can go on air right away: copies keep counting
+// against a relay until it is taken, so late is better than redundant.
+bool relay_next(Relay *r, uint8_t out[RELAY_FRAME_LEN], uint32_t now_ms);
+
+// How long until relay_next() may return something (UINT32_MAX if nothing)
+uint32_t relay_wait_ms(const Relay *r, uint32_t now_ms);
+
+// Stats of the radio's relay instance (comms_lora.cpp), for monitoring
+void radio_get_relay_stats(RelayStats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,43 @@
+// main/replay_win.c
+#include "replay_win.h"
+
+#if REPLAY_WINDOW < 1 || REPLAY_WINDOW > 64
+#error REPLAY_WINDOW must be 1..64 (one uint64_t bitmap)
+#endif
+
+ReplayVerdict replay_check(const ReplayWindow *w, uint16_t seq)
+{
+    if (!w->valid) return REPLAY_NEW;
+
+    int16_t ahead = (int16_t)(uint16_t)(seq - w->top);
+    if (ahead > 0) return REPLAY_NEW;
+
+    uint32_t behind = (uint32_t)(-(int32_t)ahead);
+    if (behind >= REPLAY_WINDOW) return REPLAY_OLD;
+    return (w->seen >> behind) & 1u ? REPLAY_SEEN : REPLAY_LATE;
+}
+
+void replay_commit(ReplayWindow *w, uint16_t seq)
+{
+    if (!w->valid) {
+        replay_reset(w, seq);
+        return;
+    }
+
+    int16_t ahead = (int16_t)(uint16_t)(seq - w->top);
+    if (ahead > 0) {
+        w->seen = (uint32_t)ahead < 64 ? (w->seen << ahead) | 1u : 1u;
+        w->top  = seq;
+        return;
+    }
+
+    uint32_t behind = (uint32_t)(-(int32_t)ahead);
+    if (behind < REPLAY_WINDOW) w->seen |= 1ull << behind;
+}
+
+void replay_reset(ReplayWindow *w, uint16_t seq)
+{
+    w->seen  = 1u;
+    w->top   = seq;
+    w->valid = true;
+}
@@ -0,0 +1,94 @@
+// main/rx_ring.c
+#include "rx_ring.h"
+#include "config.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+// Power of two so indices can free-run and wrap with a mask
+#if (RX_RING_LENGTH & (RX_RING_LENGTH - 1)) != 0
+#error RX_RING_LENGTH must be a power of two
+#endif
+
+static RxFrame RX_RING[RX_RING_LENGTH];
+
+// head: next slot the producer fills, tail: next slot the consumer reads.
+// Each index is written by one side only.
+static atomic_uint s_head;
+static atomic_uint s_tail;
+
+// Counters (producer owns pushed/dropped/peak, consumer owns popped)
+static atomic_uint s_pushed;
+static atomic_uint s_dropped;
+static atomic_uint s_popped;
+static atomic_uint s_peak;
+
+void rx_ring_init(void)
+{
+    memset(RX_RING, 0, sizeof(RX_RING));
+    atomic_store(&s_head, 0);
+    atomic_store(&s_tail, 0);
+    atomic_store(&s_pushed, 0);
+    atomic_store(&s_dropped, 0);
+    atomic_store(&s_popped, 0);
+    atomic_store(&s_peak, 0);
+}
+
+// -----------------------------------------------------------------------------
+// PRODUCER
+// -----------------------------------------------------------------------------
+RxFrame *rx_ring_reserve(void)
+{
+    unsigned head = atomic_load_explicit(&s_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&s_tail, memory_order_acquire);
+
+    if (head - tail >= RX_RING_LENGTH) {
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+        return NULL;
+    }
+    return &RX_RING[head & (RX_RING_LENGTH - 1)];
+}
+
+void rx_ring_commit(void)
+{
+    unsigned head = atomic_load_explicit(&s_head, memory_order_relaxed) + 1;
+    atomic_store_explicit(&s_head, head, memory_order_release);
+    atomic_fetch_add_explicit(&s_pushed, 1, memory_order_relaxed);
+
+    unsigned occ  = head - atomic_load_explicit(&s_tail, memory_order_relaxed);
+    if (occ > atomic_load_explicit(&s_peak, memory_order_relaxed)) {
+        atomic_store_explicit(&s_peak, occ, memory_order_relaxed);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// CONSUMER
+// -----------------------------------------------------------------------------
+RxFrame *rx_ring_peek(void)
+{
+    unsigned tail = atomic_load_explicit(&s_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&s_head, memory_order_acquire);
+
+    if (head == tail) return NULL;
+    return &RX_RING[tail & (RX_RING_LENGTH - 1)];
+}
+
+void rx_ring_release(void)
+{
+    unsigned tail = atomic_load_explicit(&s_tail, memory_order_relaxed) + 1;
+    atomic_store_explicit(&s_tail, tail, memory_order_release);
+    atomic_fetch_add_explicit(&s_popped, 1, memory_order_relaxed);
+}
+
+void rx_ring_get_stats(RxRingStats *out)
+{
+    unsigned head = atomic_load(&s_head);
+    unsigned tail = atomic_load(&s_tail);
+
+    out->pushed         = atomic_load(&s_pushed);
+    out->dropped        = atomic_load(&s_dropped);
+    out->popped         = atomic_load(&s_popped);
+    out->occupancy      = head - tail;
+    out->peak_occupancy = atomic_load(&s_peak);
+    out->capacity       = RX_RING_LENGTH;
+}
@@ -0,0 +1,56 @@
+// main/rx_ring.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Raw RX frame ring between the radio task (producer) and the verifier task
+// (consumer). Single producer / single consumer, lock-free, storage is a
+// static array so nothing is allocated at runtime. The radio task reads the
+// SX1276 FIFO straight into a reserved slot and re-arms RX immediately;
+// CMAC, security checks and queueing happen later in rx_verify_task.
+//
+// Pure C11 (atomics only): also built on the host for the ring benchmark.
+
+#define RX_FRAME_MAX_LEN  64
+
+typedef struct {
+    uint8_t  len;
+    uint8_t  sf;             // Spreading factor it was received at
+    float    rssi_dbm;
+    float    snr_db;
+    uint32_t rx_ms;
+    uint8_t  data[RX_FRAME_MAX_LEN];
+} RxFrame;
+
+typedef struct {
+    uint32_t pushed;
+    uint32_t dropped;        // Ring full when a frame arrived
+    uint32_t popped;
+    uint32_t occupancy;      // Frames waiting right now
+    uint32_t peak_occupancy;
+    uint32_t capacity;
+} RxRingStats;
+
+void rx_ring_init(void);
+
+// --- Producer side (radio task) ---
+// Slot to fill, or NULL if the ring is full (the drop is counted)
+RxFrame *rx_ring_reserve(void);
+void     rx_ring_commit(void);
+
+// --- Consumer side (verifier task) ---
+// Oldest frame, or NULL if empty
+RxFrame *rx_ring_peek(void);
+void     rx_ring_release(void);
+
+void rx_ring_get_stats(RxRingStats *out);
+
+#ifdef __cplusplus
+}
+#endif
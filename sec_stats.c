@@ -0,0 +1,140 @@
+// main/sec_stats.c
+#include "sec_stats.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#if SEC_STATS_BUCKETS < 2 || SEC_STATS_BUCKETS > 31
+#error SEC_STATS_BUCKETS must be 2..31
+#endif
+#if SEC_STATS_TOP < 1
+#error SEC_STATS_TOP must be at least 1
+#endif
+
+static const char *const s_reject_names[SEC_REJ_REASONS] = {
+    "version", "bad MAC", "table full", "rate", "replay", "teleport", "speed",
+    "admit", "budget"
+};
+
+const char *sec_reject_name(SecReject why)
+{
+    return why < SEC_REJ_REASONS ? s_reject_names[why] : "?";
+}
+
+void sec_stats_init(SecStats *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+// -----------------------------------------------------------------------------
+// WRITER (one task)
+// -----------------------------------------------------------------------------
+// seq odd while fields change; the fences keep the stores inside
+static void begin(SecStats *s)
+{
+    __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void end(SecStats *s)
+{
+    __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELEASE);
+}
+
+void sec_stats_accept(SecStats *s)
+{
+    begin(s);
+    s->accepted++;
+    end(s);
+}
+
+static void count_offender(SecStats *s, SecReject why, const uint8_t node_id[6])
+{
+    SecOffender *min = &s->top[0];
+    for (int i = 0; i < SEC_STATS_TOP; ++i) {
+        SecOffender *o = &s->top[i];
+        if (o->count && memcmp(o->node_id, node_id, 6) == 0) {
+            o->count++;
+            o->last = (uint8_t)why;
+            return;
+        }
+        if (o->count < min->count) min = o;
+    }
+
+    // Not listed: replace the smallest, which may be a free slot (0)
+    min->error = min->count;
+    min->count++;
+    min->last  = (uint8_t)why;
+    memcpy(min->node_id, node_id, 6);
+}
+
+void sec_stats_reject(SecStats *s, SecReject why, const uint8_t node_id[6])
+{
+    if (why >= SEC_REJ_REASONS) return;
+    begin(s);
+    s->rejected[why]++;
+    if (node_id) count_offender(s, why, node_id);
+    end(s);
+}
+
+void sec_stats_time(SecStats *s, SecStage stage, uint32_t us)
+{
+    if (stage >= SEC_STAGES) return;
+    SecStageTime *t = &s->stage[stage];
+
+    int b = 0;
+    while (b < SEC_STATS_BUCKETS - 1 && us >= (2u << b)) b++;
+
+    begin(s);
+    t->count++;
+    t->total_us += us;
+    if (us > t->max_us) t->max_us = us;
+    t->hist[b]++;
+    end(s);
+}
+
+// -----------------------------------------------------------------------------
+// READERS
+// -----------------------------------------------------------------------------
+void sec_stats_snapshot(const SecStats *live, SecStats *out)
+{
+    for (;;) {
+        uint32_t before = __atomic_load_n(&live->seq, __ATOMIC_ACQUIRE);
+        if (before & 1u) continue;
+        memcpy(out, live, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&live->seq, __ATOMIC_RELAXED) == before) return;
+    }
+}
+
+uint32_t sec_stats_percentile_us(const SecStageTime *t, float p)
+{
+    if (t->count == 0) return 0;
+
+    uint32_t target = (uint32_t)(p * (float)t->count);
+    if (target >= t->count) target = t->count - 1;
+
+    uint32_t acc = 0;
+    for (int b = 0; b < SEC_STATS_BUCKETS - 1; ++b) {
+        acc += t->hist[b];
+        if (acc > target) return 2u << b;
+    }
+    return t->max_us;
+}
+
+int sec_stats_top(const SecStats *s, SecOffender out[SEC_STATS_TOP])
+{
+    int n = 0;
+    for (int i = 0; i < SEC_STATS_TOP; ++i) {
+        if (s->top[i].count == 0) continue;
+
+        // Insertion sort, count descending
+        int j = n++;
+        while (j > 0 && out[j - 1].count < s->top[i].count) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = s->top[i];
+    }
+    return n;
+}
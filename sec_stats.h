@@ -0,0 +1,102 @@
+// main/sec_stats.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// What the RX security path decides and what it costs:
+//   - rejected frames per reason, wherever the check runs (admission before
+//     the CMAC, the CMAC, security_validate_packet()), and accepted ones
+//   - per-stage CPU time: count, total, max and a log2 histogram
+//     (bucket b: below 2 << b us; the last one open-ended)
+//   - the SEC_STATS_TOP node_ids with the most rejected frames, by the
+//     space-saving algorithm: fixed slots, a newcomer takes the smallest
+//     slot and inherits its count as error, so any node_id with more than
+//     1/SEC_STATS_TOP of all rejections is in the list. Claimed node_ids:
+//     before the CMAC they may be forged.
+//
+// One writer (rx_verify_task). Readers take a copy with sec_stats_snapshot(),
+// which retries until it got one not torn by an update (sequence counter),
+// so tests and monitoring can diff two snapshots.
+//
+// Pure logic, no FreeRTOS: times are plain microseconds.
+
+typedef enum {
+    SEC_REJ_VERSION = 0,        // Foreign version / team_id
+    SEC_REJ_BAD_MAC,
+    SEC_REJ_TABLE_FULL,
+    SEC_REJ_RATE,               // Sender's token bucket empty
+    SEC_REJ_REPLAY,             // Seen / below the window / stale time
+    SEC_REJ_TELEPORT,           // Jump at ~zero elapsed time
+    SEC_REJ_SPEED,
+    SEC_REJ_ADMIT,              // Banned / heavy / unknown-sender limit (admit.h)
+    SEC_REJ_BUDGET,             // Global verify budget empty
+    SEC_REJ_REASONS
+} SecReject;
+
+typedef enum {
+    SEC_STAGE_ADMIT = 0,        // security_admit_frame()
+    SEC_STAGE_CMAC,             // verify_packet_bytes()
+    SEC_STAGE_VALIDATE,         // security_validate_packet()
+    SEC_STAGE_FRAME,            // All of it, per frame out of the RX ring
+    SEC_STAGES
+} SecStage;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t hist[SEC_STATS_BUCKETS];
+} SecStageTime;
+
+typedef struct {
+    uint8_t  node_id[6];
+    uint8_t  last;              // SecReject of the latest rejection
+    uint32_t count;             // Upper bound
+    uint32_t error;             // count - error: lower bound
+} SecOffender;
+
+typedef struct {
+    uint32_t     seq;           // Odd while an update runs
+    uint32_t     accepted;
+    uint32_t     rejected[SEC_REJ_REASONS];
+    SecStageTime stage[SEC_STAGES];
+    SecOffender  top[SEC_STATS_TOP];    // count 0: free
+} SecStats;
+
+void sec_stats_init(SecStats *s);
+
+void sec_stats_accept(SecStats *s);
+
+// node_id may be NULL (not counted as an offender)
+void sec_stats_reject(SecStats *s, SecReject why, const uint8_t node_id[6]);
+
+void sec_stats_time(SecStats *s, SecStage stage, uint32_t us);
+
+// Consistent copy of a SecStats another task is updating
+void sec_stats_snapshot(const SecStats *live, SecStats *out);
+
+// Upper bound of the bucket holding the p quantile (0..1); max_us for the
+// open-ended one, 0 if nothing was timed
+uint32_t sec_stats_percentile_us(const SecStageTime *t, float p);
+
+// Offenders by count, most first; returns how many are in use
+int sec_stats_top(const SecStats *s, SecOffender out[SEC_STATS_TOP]);
+
+const char *sec_reject_name(SecReject why);
+
+// Snapshot of the security path's stats (security.c), for monitoring
+void security_get_stats(SecStats *out);
+
+// Time of a stage run outside security.c (CMAC, whole frame); rx_verify_task
+void security_record_stage(SecStage stage, uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,185 @@
+// main/sec_table.c
+#include "sec_table.h"
+
+#include <string.h>
+
+#define BUCKET_MASK   (SEC_TABLE_BUCKETS - 1)
+
+#if (SEC_TABLE_BUCKETS & (SEC_TABLE_BUCKETS - 1)) != 0
+#error SEC_TABLE_BUCKETS must be a power of two
+#endif
+#if SEC_TABLE_BUCKETS < 2 * MAX_TRACKED_NODES
+#error SEC_TABLE_BUCKETS must be at least 2 x MAX_TRACKED_NODES
+#endif
+#if MAX_TRACKED_NODES >= 255
+#error MAX_TRACKED_NODES too large for the 8-bit index
+#endif
+
+void sec_table_default_config(SecTableConfig *cfg)
+{
+    cfg->evict         = true;
+    cfg->protect_after = SEC_TABLE_PROTECT_AFTER;
+    cfg->idle_ms       = SEC_TABLE_IDLE_MS;
+}
+
+void sec_table_init(SecTable *t, const SecTableConfig *cfg, uint32_t seed)
+{
+    memset(t, 0, sizeof(*t));
+    t->cfg  = *cfg;
+    t->seed = seed;
+}
+
+// -----------------------------------------------------------------------------
+// INDEX
+// -----------------------------------------------------------------------------
+static uint32_t bucket_of(const SecTable *t, const uint8_t node_id[6])
+{
+    uint64_t k = 0;
+    memcpy(&k, node_id, 6);
+    k ^= (uint64_t)t->seed * 0x9E3779B97F4A7C15ull;
+
+    // splitmix64 finaliser
+    k ^= k >> 30; k *= 0xBF58476D1CE4E5B9ull;
+    k ^= k >> 27; k *= 0x94D049BB133111EBull;
+    k ^= k >> 31;
+    return (uint32_t)k & BUCKET_MASK;
+}
+
+// Bucket holding this sender, or the empty bucket ending its chain
+static uint32_t probe(SecTable *t, const uint8_t node_id[6], bool *found)
+{
+    uint32_t b = bucket_of(t, node_id);
+    uint32_t n = 1;
+    while (t->index[b]) {
+        if (memcmp(t->entries[t->index[b] - 1].node_id, node_id, 6) == 0) {
+            *found = true;
+            break;
+        }
+        b = (b + 1) & BUCKET_MASK;
+        n++;
+    }
+    if (n > t->stats.max_probe) t->stats.max_probe = n;
+    return b;
+}
+
+// Linear-probing delete: pull later chain members back over the hole
+static void index_remove(SecTable *t, uint32_t hole)
+{
+    t->index[hole] = 0;
+    uint32_t b = (hole + 1) & BUCKET_MASK;
+    while (t->index[b]) {
+        uint32_t home = bucket_of(t, t->entries[t->index[b] - 1].node_id);
+        // Move if its home is not in (hole, b]
+        if (((b - home) & BUCKET_MASK) >= ((b - hole) & BUCKET_MASK)) {
+            t->index[hole] = t->index[b];
+            t->index[b] = 0;
+            hole = b;
+        }
+        b = (b + 1) & BUCKET_MASK;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// EVICTION
+// -----------------------------------------------------------------------------
+static bool is_protected(const SecTable *t, const SecEntry *e)
+{
+    return t->cfg.protect_after > 0 && e->trust >= t->cfg.protect_after;
+}
+
+static bool older(const SecEntry *a, const SecEntry *b)
+{
+    return !b || (int32_t)(a->last_seen_ms - b->last_seen_ms) < 0;
+}
+
+// Free entry, or the one to give up for a newcomer (NULL: refuse)
+static SecEntry *pick_slot(SecTable *t, uint32_t now_ms)
+{
+    SecEntry *oldest_probation = NULL, *oldest_protected = NULL;
+
+    for (int i = 0; i < MAX_TRACKED_NODES; ++i) {
+        SecEntry *e = &t->entries[i];
+        if (!e->in_use) return e;
+        if (is_protected(t, e)) {
+            if (older(e, oldest_protected)) oldest_protected = e;
+        } else {
+            if (older(e, oldest_probation)) oldest_probation = e;
+        }
+    }
+    if (!t->cfg.evict) return NULL;
+
+    if (oldest_probation) {
+        t->stats.evicted_probation++;
+        return oldest_probation;
+    }
+    if (now_ms - oldest_protected->last_seen_ms >= t->cfg.idle_ms) {
+        t->stats.evicted_idle++;
+        t->stats.protected_nodes--;
+        return oldest_protected;
+    }
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// API
+// -----------------------------------------------------------------------------
+SecEntry *sec_table_find(SecTable *t, const uint8_t node_id[6], uint32_t now_ms)
+{
+    t->stats.lookups++;
+    bool found = false;
+    uint32_t b = probe(t, node_id, &found);
+    if (!found) return NULL;
+
+    t->stats.hits++;
+    SecEntry *e = &t->entries[t->index[b] - 1];
+    e->last_seen_ms = now_ms;
+    return e;
+}
+
+const SecEntry *sec_table_peek(const SecTable *t, const uint8_t node_id[6])
+{
+    uint32_t b = bucket_of(t, node_id);
+    while (t->index[b]) {
+        const SecEntry *e = &t->entries[t->index[b] - 1];
+        if (memcmp(e->node_id, node_id, 6) == 0) return e;
+        b = (b + 1) & BUCKET_MASK;
+    }
+    return NULL;
+}
+
+SecEntry *sec_table_insert(SecTable *t, const uint8_t node_id[6], uint32_t now_ms)
+{
+    SecEntry *e = pick_slot(t, now_ms);
+    if (!e) {
+        t->stats.refused++;
+        return NULL;
+    }
+
+    if (e->in_use) {
+        bool found = false;
+        uint32_t b = probe(t, e->node_id, &found);
+        if (found) index_remove(t, b);
+    } else {
+        t->stats.used++;
+    }
+
+    memset(e, 0, sizeof(*e));
+    e->in_use = true;
+    memcpy(e->node_id, node_id, 6);
+    e->last_seen_ms = now_ms;
+
+    bool found = false;
+    uint32_t b = probe(t, node_id, &found);
+    t->index[b] = (uint8_t)(e - t->entries + 1);
+    t->stats.inserted++;
+    return e;
+}
+
+void sec_table_on_accepted(SecTable *t, SecEntry *e)
+{
+    if (e->trust == UINT8_MAX) return;
+    e->trust++;
+    if (t->cfg.protect_after > 0 && e->trust == t->cfg.protect_after) {
+        t->stats.protected_nodes++;
+    }
+}
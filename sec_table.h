@@ -0,0 +1,105 @@
+// main/sec_table.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+#include "replay_win.h"
+#include "token_bucket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-sender state of security_validate_packet(): the entries, an O(1) hash
+// index over node_id, and eviction so the table never locks up.
+//
+// Index: open addressing with linear probing over SEC_TABLE_BUCKETS buckets
+// (at least twice the entries), keyed by a seeded hash of the 6-byte MAC so
+// an attacker can't pick MACs that pile into one probe chain. Removal
+// shifts the chain back, no tombstones.
+//
+// Eviction, when a new sender arrives and all entries are taken: entries
+// with fewer than protect_after accepted updates are on probation, the rest
+// are protected. The victim is the probation entry seen longest ago; a
+// protected entry only goes once it has been silent for idle_ms. If every
+// entry is protected and active, the newcomer is refused. A flood of fresh
+// MACs therefore only churns the probation entries and can't push out
+// neighbours with verified history.
+//
+// Pure logic, no FreeRTOS: times are plain milliseconds.
+
+typedef struct {
+    bool     evict;             // FALSE: full table refuses newcomers (old behaviour)
+    uint8_t  protect_after;     // Accepted updates to leave probation (0: plain LRU)
+    uint32_t idle_ms;           // A protected entry silent this long can go
+} SecTableConfig;
+
+// Payload fields belong to security.c; the table only keys, ages and evicts
+typedef struct {
+    uint8_t  node_id[6];
+    bool     in_use;
+    uint8_t  trust;             // Accepted updates, saturating
+    uint32_t last_seen_ms;      // Any frame that reached the table (LRU)
+
+    // Rate limiting
+    TokenBucket bucket;         // SEC_NODE_RATE_PER_S, SEC_NODE_BURST
+    uint32_t last_rx_ms;        // Last accepted update
+
+    // Physics & replay state
+    ReplayWindow replay;        // seq_number window
+    uint32_t last_ts_s;         // Newest accepted update
+    uint16_t last_ts_ms;
+
+    int32_t  last_x_mm;
+    int32_t  last_y_mm;
+    int32_t  last_z_mm;
+} SecEntry;
+
+typedef struct {
+    uint32_t lookups;
+    uint32_t hits;
+    uint32_t inserted;
+    uint32_t evicted_probation;
+    uint32_t evicted_idle;      // Protected, silent for idle_ms
+    uint32_t refused;           // Full of protected, active senders
+    uint32_t max_probe;         // Longest probe chain walked
+    uint32_t used;              // Right now
+    uint32_t protected_nodes;
+} SecTableStats;
+
+typedef struct {
+    SecTableConfig cfg;
+    uint32_t       seed;
+    SecEntry       entries[MAX_TRACKED_NODES];
+    uint8_t        index[SEC_TABLE_BUCKETS];    // Entry + 1, 0 = empty bucket
+    SecTableStats  stats;
+} SecTable;
+
+// Defaults from config.h
+void sec_table_default_config(SecTableConfig *cfg);
+
+// seed: per boot random, keys the index hash
+void sec_table_init(SecTable *t, const SecTableConfig *cfg, uint32_t seed);
+
+// Entry of this sender, or NULL. Refreshes its LRU age.
+SecEntry *sec_table_find(SecTable *t, const uint8_t node_id[6], uint32_t now_ms);
+
+// Entry of this sender, or NULL, without touching its age or the stats
+// (the admission check ahead of the CMAC)
+const SecEntry *sec_table_peek(const SecTable *t, const uint8_t node_id[6]);
+
+// New, zeroed entry for a sender not in the table (evicting if needed), or
+// NULL if refused
+SecEntry *sec_table_insert(SecTable *t, const uint8_t node_id[6], uint32_t now_ms);
+
+// An update from this entry passed every check
+void sec_table_on_accepted(SecTable *t, SecEntry *e);
+
+// Stats of the security table (security.c), for monitoring
+void security_get_table_stats(SecTableStats *out);
+
+#ifdef __cplusplus
+}
+#endif
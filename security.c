@@ -1,8 +1,16 @@
 // main/security.c
 #include "tasks.h"
 #include "config.h"
+#include "sec_table.h"
+#include "admit.h"
+#include "replay_win.h"
+#include "sec_stats.h"
+#include "token_bucket.h"
+#include "cmac.h"
 
 #include "esp_err.h"
+#include "esp_random.h"
+#include "esp_timer.h"
 #include "mbedtls/cmac.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -11,24 +19,22 @@
 #include <math.h>   // For sqrt
 #include <stdlib.h> // For abs
 
-typedef struct {
-    uint8_t    node_id[6];
-    bool       in_use;
-    
-    // Rate Limiting
-    TickType_t last_rx_tick;
+// Per-sender rate / replay / physics state, hash-indexed (sec_table.c).
+// rx_verify_task only.
+static SecTable s_table;
 
-    // Physics & Replay State
-    uint32_t   last_ts_s;
-    uint16_t   last_ts_ms;
-    uint16_t   last_seq;
-    
-    int32_t    last_x_mm;
-    int32_t    last_y_mm;
-    int32_t    last_z_mm;
-} SecurityEntry;
+// Header / rate / bad-sender checks ahead of the CMAC (admit.c). Same task.
+static Admit s_admit;
+
+// Replay window outcomes (replay_win.c). Same task.
+static ReplayStats s_replay_stats;
 
-static SecurityEntry SECURITY_TABLE[MAX_TRACKED_NODES];
+// Rejections / stage times / offenders (sec_stats.c). Written by the same
+// task, snapshotted by monitoring.
+static SecStats s_stats;
+
+// Per-sender token bucket refill (SecEntry.bucket)
+static TokenRate s_node_rate;
 
 // 16-byte pre-shared key
 static const uint8_t s_aes_key[16] = {
@@ -38,6 +44,10 @@ static const uint8_t s_aes_key[16] = {
     0x09, 0xCF, 0x4F, 0x3C
 };
 
+// Expanded key + CMAC subkeys, set up once in init_security(). Read-only
+// afterwards: sign / verify may run in any task.
+static CmacKey s_cmac;
+
 // -----------------------------------------------------------------------------
 // HELPER: Get total milliseconds from seconds + ms parts
 // -----------------------------------------------------------------------------
@@ -45,96 +55,148 @@ static uint64_t to_ms(uint32_t s, uint16_t ms) {
     return ((uint64_t)s * 1000ULL) + ms;
 }
 
+static uint32_t elapsed_us(int64_t since_us)
+{
+    return (uint32_t)(esp_timer_get_time() - since_us);
+}
+
 // -----------------------------------------------------------------------------
 // CORE VALIDATION FUNCTION
 // Returns TRUE if packet is valid, FALSE if attack detected.
 // -----------------------------------------------------------------------------
-bool security_validate_packet(const NeighbourState *n)
+static bool validate_packet(const NeighbourState *n, bool *newest);
+
+bool security_validate_packet(const NeighbourState *n, bool *newest)
+{
+    int64_t t0 = esp_timer_get_time();
+    *newest = false;
+    bool ok = validate_packet(n, newest);
+    sec_stats_time(&s_stats, SEC_STAGE_VALIDATE, elapsed_us(t0));
+    if (ok) sec_stats_accept(&s_stats);
+    return ok;
+}
+
+static bool validate_packet(const NeighbourState *n, bool *newest)
 {
     // -------------------------------------------------------------------------
     // 1. PROTOCOL CHECK
     // -------------------------------------------------------------------------
     if (n->version != VERSION) {
+        sec_stats_reject(&s_stats, SEC_REJ_VERSION, n->node_id);
         fast_log("SEC (W): Invalid version %u (Expected %u)", n->version, VERSION);
         return false;
     }
 
     // -------------------------------------------------------------------------
-    // 2. TABLE LOOKUP & STATEFUL CHECKS
+    // 2. FRESHNESS (both clocks synced)
     // -------------------------------------------------------------------------
-    TickType_t now_tick = xTaskGetTickCount();
-    SecurityEntry *entry = NULL;
-    int first_empty = -1;
-
-    // Find entry
-    for (int i = 0; i < MAX_TRACKED_NODES; ++i) {
-        if (SECURITY_TABLE[i].in_use) {
-            if (memcmp(SECURITY_TABLE[i].node_id, n->node_id, 6) == 0) {
-                entry = &SECURITY_TABLE[i];
-                break;
-            }
-        } else {
-            if (first_empty < 0) first_empty = i;
+    uint64_t time_new = to_ms(n->ts_s, n->ts_ms);
+
+    uint32_t wall_s;
+    uint16_t wall_ms;
+    get_current_unix_time(&wall_s, &wall_ms);
+    bool synced = wall_s >= REPLAY_SYNCED_EPOCH_S && n->ts_s >= REPLAY_SYNCED_EPOCH_S;
+
+    if (synced) {
+        int64_t age_ms = (int64_t)(to_ms(wall_s, wall_ms) - time_new);
+        if (llabs(age_ms) > REPLAY_FRESH_MS) {
+            s_replay_stats.stale++;
+            sec_stats_reject(&s_stats, SEC_REJ_REPLAY, n->node_id);
+            fast_log("SEC (W): Stale time (%lld ms) from %s", (long long)age_ms,
+                     format_mac(n->node_id));
+            return false;
         }
     }
 
+    // -------------------------------------------------------------------------
+    // 3. TABLE LOOKUP & STATEFUL CHECKS
+    // -------------------------------------------------------------------------
+    uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+    SecEntry *entry = sec_table_find(&s_table, n->node_id, now_ms);
+
     // If new node
     if (!entry) {
-        if (first_empty < 0) {
+        entry = sec_table_insert(&s_table, n->node_id, now_ms);
+        if (!entry) {
+            sec_stats_reject(&s_stats, SEC_REJ_TABLE_FULL, n->node_id);
             fast_log("SEC (E): Table full, dropping %s", format_mac(n->node_id));
             return false;
         }
-        entry = &SECURITY_TABLE[first_empty];
-        
-        // Init entry
-        entry->in_use = true;
-        memcpy(entry->node_id, n->node_id, 6);
-        entry->last_rx_tick = now_tick;
-        entry->last_seq     = n->seq_number;
+
+        // Init entry, the baseline takes its first token
+        token_fill(&entry->bucket, &s_node_rate, now_ms);
+        token_take(&entry->bucket, &s_node_rate, 0, now_ms);
+        entry->last_rx_ms   = now_ms;
         entry->last_ts_s    = n->ts_s;
         entry->last_ts_ms   = n->ts_ms;
         entry->last_x_mm    = n->x_mm;
         entry->last_y_mm    = n->y_mm;
         entry->last_z_mm    = n->z_mm;
+        replay_reset(&entry->replay, n->seq_number);
+        sec_table_on_accepted(&s_table, entry);
 
+        *newest = true;
         return true; // First packet is trusted (baseline)
     }
 
     // -------------------------------------------------------------------------
-    // 3. RATE LIMITING (DDoS)
+    // 4. RATE LIMITING (DDoS)
     // -------------------------------------------------------------------------
-    TickType_t tick_diff = now_tick - entry->last_rx_tick;
-    if (tick_diff < pdMS_TO_TICKS(DDOS_RATE_LIMIT_MS)) {
-        // fast_log("SEC (W): Rate limit exceeded for %s", format_mac(n->node_id));
+    // The token is only spent once the update is accepted: replayed copies
+    // of a sender's frames can't use up its budget
+    if (token_available(&entry->bucket, &s_node_rate, now_ms) == 0) {
+        sec_stats_reject(&s_stats, SEC_REJ_RATE, n->node_id);
         return false;
     }
 
     // -------------------------------------------------------------------------
-    // 4. SEQUENCE / REPLAY CHECK
+    // 5. SEQUENCE / REPLAY CHECK
     // -------------------------------------------------------------------------
-    // We allow wrap-around logic or strict > check. Simple > is safest for lab.
-    // Also check timestamps to ensure time moves forward.
-    
-    // Note: If sender rebooted, seq resets. This logic drops packets until 
-    // seq catches up or we timeout the entry. Simple fix: If seq drops drastically
-    // but time is valid, maybe reset? For now, strict check:
-    // if (n->seq_number <= entry->last_seq && 
-    //    (entry->last_seq - n->seq_number) < 1000) { // Not a wrap-around
-    //     fast_log("SEC (W): Replay/Old Seq %u <= %u from %s", 
-    //              n->seq_number, entry->last_seq, format_mac(n->node_id));
-    //     return false;
-    // }
-
+    // Window over seq_number: reordered frames pass once each. Timestamps
+    // only bound how far back a frame may be, so relayed / late copies are
+    // not mistaken for replays.
     uint64_t time_old = to_ms(entry->last_ts_s, entry->last_ts_ms);
-    uint64_t time_new = to_ms(n->ts_s, n->ts_ms);
+    bool resync = false;
 
-    if (time_new <= time_old) {
-        fast_log("SEC (W): Replay/Old Time from %s", format_mac(n->node_id));
+    switch (replay_check(&entry->replay, n->seq_number)) {
+    case REPLAY_NEW:
+        if (time_new + REPLAY_FRESH_MS <= time_old) {
+            s_replay_stats.stale++;
+            sec_stats_reject(&s_stats, SEC_REJ_REPLAY, n->node_id);
+            fast_log("SEC (W): Replay/Old Time from %s", format_mac(n->node_id));
+            return false;
+        }
+        break;
+    case REPLAY_LATE:
+        break;
+    case REPLAY_SEEN:
+        s_replay_stats.seen++;
+        sec_stats_reject(&s_stats, SEC_REJ_REPLAY, n->node_id);
+        fast_log("SEC (W): Replay seq %u from %s", n->seq_number, format_mac(n->node_id));
+        return false;
+    case REPLAY_OLD:
+        // Below the window: an old frame replayed, or the sender rebooted
+        // and counts from 0 again. Only with both clocks synced does the
+        // reboot tell itself apart, by a newer timestamp (freshness bounds
+        // it). Without SNTP any recorded frames would pass for a reboot, so
+        // the frame is refused and only counted as a resync candidate.
+        if (synced && time_new > time_old) {
+            resync = true;
+            break;
+        }
+        if (synced) {
+            s_replay_stats.old++;
+        } else {
+            s_replay_stats.unsynced++;
+        }
+        sec_stats_reject(&s_stats, SEC_REJ_REPLAY, n->node_id);
+        fast_log("SEC (W): Replay/Old Seq %u from %s", n->seq_number,
+                 format_mac(n->node_id));
         return false;
     }
 
     // -------------------------------------------------------------------------
-    // 5. PHYSICS CHECK (Prevent "Random Pos" / Teleportation)
+    // 6. PHYSICS CHECK (Prevent "Random Pos" / Teleportation)
     // -------------------------------------------------------------------------
     
     // Calculate distance moved (mm)
@@ -143,8 +205,8 @@ bool security_validate_packet(const NeighbourState *n)
     double dz = (double)n->z_mm - entry->last_z_mm;
     double dist_mm = sqrt(dx*dx + dy*dy + dz*dz);
 
-    // Calculate time elapsed (seconds)
-    double dt_sec = (double)(time_new - time_old) / 1000.0;
+    // Calculate time elapsed (seconds), either way round for late frames
+    double dt_sec = fabs((double)(int64_t)(time_new - time_old)) / 1000.0;
 
     // Calculate implied velocity (mm/s)
     double velocity = 0.0;
@@ -153,6 +215,7 @@ bool security_validate_packet(const NeighbourState *n)
     } else {
         // Zero time elapsed?
         if (dist_mm > PHYSICS_JUMP_TOLERANCE_MM) {
+             sec_stats_reject(&s_stats, SEC_REJ_TELEPORT, n->node_id);
              fast_log("SEC (W): Teleport (Instant Jump %.0fmm) %s", 
                       dist_mm, format_mac(n->node_id));
              return false;
@@ -163,6 +226,7 @@ bool security_validate_packet(const NeighbourState *n)
     
     // Check limit
     if (velocity > max_speed) {
+        sec_stats_reject(&s_stats, SEC_REJ_SPEED, n->node_id);
         fast_log("SEC (W): Physics Violation! Speed %.0f > %.0f mm/s by %s", 
                  velocity, max_speed, format_mac(n->node_id));
         return false;
@@ -171,17 +235,86 @@ bool security_validate_packet(const NeighbourState *n)
     // -------------------------------------------------------------------------
     // UPDATE STATE
     // -------------------------------------------------------------------------
-    entry->last_rx_tick = now_tick;
-    entry->last_seq     = n->seq_number;
-    entry->last_ts_s    = n->ts_s;
-    entry->last_ts_ms   = n->ts_ms;
-    entry->last_x_mm    = n->x_mm;
-    entry->last_y_mm    = n->y_mm;
-    entry->last_z_mm    = n->z_mm;
+    token_take(&entry->bucket, &s_node_rate, 0, now_ms);
+    entry->last_rx_ms = now_ms;
+    if (resync) {
+        s_replay_stats.resync++;
+        fast_log("SEC (I): %s restarted at seq %u", format_mac(n->node_id), n->seq_number);
+        replay_reset(&entry->replay, n->seq_number);
+    } else {
+        replay_commit(&entry->replay, n->seq_number);
+    }
+
+    // Late frames count once, but the newest state stays the reference. A
+    // resync replaces it whatever its time: the sender restarted.
+    *newest = resync || time_new > time_old;
+    if (*newest) {
+        entry->last_ts_s  = n->ts_s;
+        entry->last_ts_ms = n->ts_ms;
+        entry->last_x_mm  = n->x_mm;
+        entry->last_y_mm  = n->y_mm;
+        entry->last_z_mm  = n->z_mm;
+    } else {
+        s_replay_stats.late++;
+    }
+    sec_table_on_accepted(&s_table, entry);
 
     return true;
 }
 
+// -----------------------------------------------------------------------------
+// ADMISSION (before the CMAC)
+// Rejects from the header and the sender's table entry what the checks above
+// would reject after paying for the crypto.
+// -----------------------------------------------------------------------------
+bool security_admit_frame(const uint8_t *frame)
+{
+#if ADMIT_ENABLED
+    static const SecReject reasons[ADMIT_VERDICTS] = {
+        [ADMIT_HEADER] = SEC_REJ_VERSION, [ADMIT_RATE] = SEC_REJ_RATE,
+        [ADMIT_BANNED] = SEC_REJ_ADMIT,   [ADMIT_HEAVY] = SEC_REJ_ADMIT,
+        [ADMIT_UNKNOWN] = SEC_REJ_ADMIT,  [ADMIT_BUDGET] = SEC_REJ_BUDGET,
+    };
+
+    int64_t t0 = esp_timer_get_time();
+    uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+    const uint8_t *node_id = frame + offsetof(NeighbourState, node_id);
+    AdmitVerdict v = admit_check(&s_admit, frame, sec_table_peek(&s_table, node_id), now_ms);
+    sec_stats_time(&s_stats, SEC_STAGE_ADMIT, elapsed_us(t0));
+
+    if (v == ADMIT_PASS) return true;
+    sec_stats_reject(&s_stats, reasons[v], node_id);
+    return false;
+#else
+    (void)frame;
+    return true;
+#endif
+}
+
+bool security_verify_budget(const uint8_t node_id[6])
+{
+#if ADMIT_ENABLED
+    uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+    if (admit_take_budget(&s_admit, sec_table_peek(&s_table, node_id), now_ms)) return true;
+    sec_stats_reject(&s_stats, SEC_REJ_BUDGET, node_id);
+    return false;
+#else
+    (void)node_id;
+    return true;
+#endif
+}
+
+void security_on_bad_mac(const uint8_t node_id[6])
+{
+    sec_stats_reject(&s_stats, SEC_REJ_BAD_MAC, node_id);
+#if ADMIT_ENABLED
+    uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+    admit_on_bad_mac(&s_admit, node_id, sec_table_peek(&s_table, node_id), now_ms);
+#else
+    (void)node_id;
+#endif
+}
+
 // -----------------------------------------------------------------------------
 // AES-CMAC Crypto
 // -----------------------------------------------------------------------------
@@ -189,22 +322,42 @@ bool security_validate_packet(const NeighbourState *n)
 static void compute_mac(const uint8_t *buf, size_t len, uint8_t out[4])
 {
     uint8_t full_mac[16];
+    cmac_compute(&s_cmac, buf, len, full_mac);
+    memcpy(out, full_mac + 12, 4);
+}
 
+#if SECURITY_CMAC_BOOT_ITERS > 0
+// Per-frame CMAC before (mbedtls_cipher_cmac: cipher setup, key expansion,
+// subkeys every call) and after (cached key), measured on this chip at boot.
+// Also checks both give the same tag.
+static void cmac_boot_check(void)
+{
+    uint8_t frame[sizeof(NeighbourState)];
+    for (size_t i = 0; i < sizeof(frame); ++i) frame[i] = (uint8_t)(i * 37u);
+    const size_t len = offsetof(NeighbourState, mac_tag);
     const mbedtls_cipher_info_t *info =
         mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB);
 
-    int ret = mbedtls_cipher_cmac(info,
-                                  s_aes_key, 128,
-                                  buf, len,
-                                  full_mac);
-    if (ret != 0) {
-        fast_log("SECURITY (E): CMAC failed (%d)", ret);
-        memset(out, 0, 4);
-        return;
+    uint8_t ref[16], tag[16];
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < SECURITY_CMAC_BOOT_ITERS; ++i) {
+        mbedtls_cipher_cmac(info, s_aes_key, 128, frame, len, ref);
     }
+    int64_t t1 = esp_timer_get_time();
+    for (int i = 0; i < SECURITY_CMAC_BOOT_ITERS; ++i) {
+        cmac_compute(&s_cmac, frame, len, tag);
+    }
+    int64_t t2 = esp_timer_get_time();
 
-    memcpy(out, full_mac + 12, 4);
+    if (memcmp(ref, tag, sizeof(tag)) != 0) {
+        fast_log("SECURITY (F): cached CMAC disagrees with mbedtls");
+        vTaskDelay(portMAX_DELAY);
+    }
+    fast_log("SECURITY (I): CMAC per frame: %.1f us -> %.1f us (cached key)",
+             (double)(t1 - t0) / SECURITY_CMAC_BOOT_ITERS,
+             (double)(t2 - t1) / SECURITY_CMAC_BOOT_ITERS);
 }
+#endif
 
 void sign_packet(NeighbourState *state)
 {
@@ -216,15 +369,70 @@ void sign_packet(NeighbourState *state)
 }
 
 bool verify_packet(NeighbourState *state)
+{
+    return verify_packet_bytes((const uint8_t*)state);
+}
+
+bool verify_packet_bytes(const uint8_t *frame)
 {
     uint8_t expected[4];
-    compute_mac((const uint8_t*)state,
+    compute_mac(frame,
                 offsetof(NeighbourState, mac_tag),
                 expected);
 
+    const uint8_t *tag = frame + offsetof(NeighbourState, mac_tag);
     uint8_t diff = 0;
     for (int i = 0; i < 4; ++i) {
-        diff |= (uint8_t)(expected[i] ^ state->mac_tag[i]);
+        diff |= (uint8_t)(expected[i] ^ tag[i]);
     }
     return diff == 0;
+}
+
+// -----------------------------------------------------------------------------
+// INIT
+// -----------------------------------------------------------------------------
+void init_security(void)
+{
+    if (!cmac_key_init(&s_cmac, s_aes_key)) {
+        fast_log("SECURITY (F): AES key setup failed");
+        vTaskDelay(portMAX_DELAY);
+    }
+#if SECURITY_CMAC_BOOT_ITERS > 0
+    cmac_boot_check();
+#endif
+
+    SecTableConfig cfg;
+    sec_table_default_config(&cfg);
+    sec_table_init(&s_table, &cfg, esp_random());
+    token_rate_init(&s_node_rate, SEC_NODE_RATE_PER_S, SEC_NODE_BURST);
+
+    AdmitConfig admit_cfg;
+    admit_default_config(&admit_cfg);
+    admit_init(&s_admit, &admit_cfg, esp_random());
+    sec_stats_init(&s_stats);
+}
+
+void security_get_table_stats(SecTableStats *out)
+{
+    *out = s_table.stats;
+}
+
+void security_get_admit_stats(AdmitStats *out)
+{
+    *out = s_admit.stats;
+}
+
+void security_get_replay_stats(ReplayStats *out)
+{
+    *out = s_replay_stats;
+}
+
+void security_get_stats(SecStats *out)
+{
+    sec_stats_snapshot(&s_stats, out);
+}
+
+void security_record_stage(SecStage stage, uint32_t us)
+{
+    sec_stats_time(&s_stats, stage, us);
 }
\ No newline at end of file
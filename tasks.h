@@ -27,7 +27,6 @@ void get_current_unix_time(uint32_t *ts_s, uint16_t *ts_ms);
 void init_globals(void);
 
 QueueHandle_t get_control_input_queue(void);
-QueueHandle_t get_neighbour_update_queue(void);
 QueueHandle_t get_flocking_state_queue(void);
 QueueHandle_t get_radio_state_queue(void);
 QueueHandle_t get_telemetry_state_queue(void);
@@ -36,9 +35,14 @@ uint8_t *get_mac_address(void);
 const char *get_mac_address_string(void);
 
 // ---------- Security (AES-CMAC + Logic) ----------
+void init_security(void);
 void sign_packet(NeighbourState *state);
 bool verify_packet(NeighbourState *state);
-bool security_validate_packet(const NeighbourState *n);
+bool verify_packet_bytes(const uint8_t *frame);   // Frame in wire order (RX buffer)
+bool security_validate_packet(const NeighbourState *n, bool *newest);  // *newest: sender's reference now
+bool security_admit_frame(const uint8_t *frame);  // Before the CMAC, see admit.h
+bool security_verify_budget(const uint8_t node_id[6]);  // Right before the CMAC
+void security_on_bad_mac(const uint8_t node_id[6]);
 
 // ---------- Tasks (subsystems) ----------
 void init_physics(void);
@@ -0,0 +1,43 @@
+// main/telem_json.cpp
+// TELEM_JSON payload (telemetry.h) from the compile-time member list below,
+// see json_writer.h. Byte for byte what telem_encode_json_printf() writes.
+
+#include "json_writer.h"
+
+extern "C" {
+#include "telemetry.h"
+}
+
+namespace {
+
+using N = wire::Neighbour;
+using json::Fmt;
+using json::Member;
+
+// Keys, order and formats of the original format string; link_cfg isn't sent
+using TelemObject = json::Object<
+    Member<"version",    N::version,    Fmt::Uint>,
+    Member<"team_id",    N::team_id,    Fmt::Uint>,
+    Member<"node_id",    N::node_id,    Fmt::Hex>,
+    Member<"seq_number", N::seq_number, Fmt::Uint>,
+    Member<"ts_s",       N::ts_s,       Fmt::Uint>,
+    Member<"ts_ms",      N::ts_ms,      Fmt::Uint>,
+    Member<"x_mm",       N::x_mm,       Fmt::Int>,      // Signed
+    Member<"y_mm",       N::y_mm,       Fmt::Int>,      // Signed
+    Member<"z_mm",       N::z_mm,       Fmt::Int>,      // Signed
+    Member<"vx_mm_s",    N::vx_mm_s,    Fmt::Int>,
+    Member<"vy_mm_s",    N::vy_mm_s,    Fmt::Int>,
+    Member<"vz_mm_s",    N::vz_mm_s,    Fmt::Int>,
+    Member<"yaw_cd",     N::yaw_cd,     Fmt::Uint>,
+    Member<"mac_tag",    N::mac_tag,    Fmt::Hex>>;
+
+static_assert(TelemObject::max_len == TELEM_JSON_MAX_LEN,
+              "TELEM_JSON_MAX_LEN no longer matches the telemetry object");
+
+} // namespace
+
+extern "C" size_t telem_encode_json(const NeighbourState *p, char *buf, size_t size)
+{
+    // The packed struct is the wire image (telemetry.c checks the byte order)
+    return TelemObject::write(reinterpret_cast<const uint8_t *>(p), buf, size);
+}
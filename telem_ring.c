@@ -0,0 +1,95 @@
+// main/telem_ring.c
+#include "telem_ring.h"
+#include "config.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+// Power of two so indices can free-run and wrap with a mask
+#if (TELEM_RING_LENGTH & (TELEM_RING_LENGTH - 1)) != 0
+#error TELEM_RING_LENGTH must be a power of two
+#endif
+
+static NeighbourState TELEM_RING[TELEM_RING_LENGTH];
+
+// head: next slot the producer fills, tail: next slot the consumer reads.
+// Each index is written by one side only.
+static atomic_uint s_head;
+static atomic_uint s_tail;
+
+// Counters (producer owns pushed/dropped/peak, consumer popped/batches)
+static atomic_uint s_pushed;
+static atomic_uint s_dropped;
+static atomic_uint s_popped;
+static atomic_uint s_batches;
+static atomic_uint s_peak;
+
+void telem_ring_init(void)
+{
+    memset(TELEM_RING, 0, sizeof(TELEM_RING));
+    atomic_store(&s_head, 0);
+    atomic_store(&s_tail, 0);
+    atomic_store(&s_pushed, 0);
+    atomic_store(&s_dropped, 0);
+    atomic_store(&s_popped, 0);
+    atomic_store(&s_batches, 0);
+    atomic_store(&s_peak, 0);
+}
+
+// -----------------------------------------------------------------------------
+// PRODUCER
+// -----------------------------------------------------------------------------
+bool telem_ring_push(const NeighbourState *sample)
+{
+    unsigned head = atomic_load_explicit(&s_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&s_tail, memory_order_acquire);
+
+    if (head - tail >= TELEM_RING_LENGTH) {
+        atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    TELEM_RING[head & (TELEM_RING_LENGTH - 1)] = *sample;
+    atomic_store_explicit(&s_head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&s_pushed, 1, memory_order_relaxed);
+
+    unsigned occ = head + 1 - tail;
+    if (occ > atomic_load_explicit(&s_peak, memory_order_relaxed)) {
+        atomic_store_explicit(&s_peak, occ, memory_order_relaxed);
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// CONSUMER
+// -----------------------------------------------------------------------------
+size_t telem_ring_drain(NeighbourState *out, size_t max)
+{
+    unsigned tail = atomic_load_explicit(&s_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&s_head, memory_order_acquire);
+
+    size_t n = head - tail;
+    if (n > max) n = max;
+    if (n == 0) return 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = TELEM_RING[(tail + i) & (TELEM_RING_LENGTH - 1)];
+    }
+    atomic_store_explicit(&s_tail, tail + (unsigned)n, memory_order_release);
+    atomic_fetch_add_explicit(&s_popped, (unsigned)n, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s_batches, 1, memory_order_relaxed);
+    return n;
+}
+
+void telem_ring_get_stats(TelemRingStats *out)
+{
+    unsigned head = atomic_load(&s_head);
+    unsigned tail = atomic_load(&s_tail);
+
+    out->pushed         = atomic_load(&s_pushed);
+    out->dropped        = atomic_load(&s_dropped);
+    out->popped         = atomic_load(&s_popped);
+    out->batches        = atomic_load(&s_batches);
+    out->occupancy      = head - tail;
+    out->peak_occupancy = atomic_load(&s_peak);
+    out->capacity       = TELEM_RING_LENGTH;
+}
@@ -0,0 +1,49 @@
+// main/telem_ring.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "drone_state.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Telemetry sample ring between the physics task (producer, one sample
+// every 1/TELEM_SAMPLE_HZ) and mqtt_task (consumer, drains it once per
+// TELEM_BATCH_PERIOD_MS into one message per topic). Unlike the 1-deep
+// telemetry queue, nothing physics captured in between publishes is lost.
+// Samples are stamped when captured; seq_number and mac_tag are filled in
+// at publish time.
+//
+// Single producer / single consumer, lock-free, static storage. A full ring
+// (broker stalled for several batches) drops the newest sample and counts it.
+//
+// Pure C11 (atomics only): also built on the host for the batching bench.
+
+typedef struct {
+    uint32_t pushed;
+    uint32_t dropped;        // Ring full when a sample was captured
+    uint32_t popped;
+    uint32_t batches;        // Non-empty drains
+    uint32_t occupancy;      // Samples waiting right now
+    uint32_t peak_occupancy;
+    uint32_t capacity;
+} TelemRingStats;
+
+void telem_ring_init(void);
+
+// --- Producer side (physics task) ---
+bool telem_ring_push(const NeighbourState *sample);
+
+// --- Consumer side (MQTT task) ---
+// Up to max oldest samples into out, in capture order; how many
+size_t telem_ring_drain(NeighbourState *out, size_t max);
+
+void telem_ring_get_stats(TelemRingStats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,121 @@
+// main/telemetry.c
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+_Static_assert(sizeof(NeighbourState) == 48, "binary telemetry schema 0xB1 is 48 bytes");
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error telem_encode_binary() copies the struct as the little-endian wire image
+#endif
+
+// -----------------------------------------------------------------------------
+// JSON
+// -----------------------------------------------------------------------------
+// The original format string. telem_encode_json() (telem_json.cpp) writes
+// the same bytes without parsing it; kept as the reference to compare with.
+size_t telem_encode_json_printf(const NeighbourState *p, char *buf, size_t size)
+{
+    // Note: Coordinates and velocities are cast to (int) and use %d
+    // to correctly display negative values.
+    int n = snprintf(buf, size,
+             "{"
+             "\"version\":%u,"
+             "\"team_id\":%u,"
+             "\"node_id\":\"%02X%02X%02X%02X%02X%02X\","
+             "\"seq_number\":%u,"
+             "\"ts_s\":%lu,"
+             "\"ts_ms\":%u,"
+             "\"x_mm\":%d,"
+             "\"y_mm\":%d,"
+             "\"z_mm\":%d,"
+             "\"vx_mm_s\":%d,"
+             "\"vy_mm_s\":%d,"
+             "\"vz_mm_s\":%d,"
+             "\"yaw_cd\":%u,"
+             "\"mac_tag\":\"%02X%02X%02X%02X\""
+             "}",
+             p->version,
+             p->team_id,
+             p->node_id[0], p->node_id[1], p->node_id[2],
+             p->node_id[3], p->node_id[4], p->node_id[5],
+             p->seq_number,
+             (unsigned long)p->ts_s,
+             p->ts_ms,
+             (int)p->x_mm,      // Signed
+             (int)p->y_mm,      // Signed
+             (int)p->z_mm,      // Signed
+             (int)p->vx_mm_s,   // Signed
+             (int)p->vy_mm_s,   // Signed
+             (int)p->vz_mm_s,   // Signed
+             (unsigned)p->yaw_cd,
+             p->mac_tag[0], p->mac_tag[1], p->mac_tag[2], p->mac_tag[3]);
+
+    return (n > 0 && (size_t)n < size) ? (size_t)n : 0;
+}
+
+// -----------------------------------------------------------------------------
+// BINARY
+// -----------------------------------------------------------------------------
+size_t telem_encode_binary(const NeighbourState *p, uint8_t *buf, size_t size)
+{
+    if (size < TELEM_BIN_SIZE) return 0;
+
+    // The packed struct is the wire image on the (little-endian) ESP32
+    buf[0] = TELEM_BIN_SCHEMA;
+    memcpy(buf + 1, p, sizeof(*p));
+    return TELEM_BIN_SIZE;
+}
+
+size_t telem_encode(TelemEncoding enc, const NeighbourState *p, uint8_t *buf, size_t size)
+{
+    switch (enc) {
+    case TELEM_JSON:   return telem_encode_json(p, (char *)buf, size);
+    case TELEM_BINARY: return telem_encode_binary(p, buf, size);
+    default:           return 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// BATCH
+// -----------------------------------------------------------------------------
+static size_t encode_batch_json(const NeighbourState *p, size_t n, char *buf, size_t size)
+{
+    if (size < 2) return 0;
+    size_t off = 0;
+    buf[off++] = '[';
+
+    for (size_t i = 0; i < n; ++i) {
+        size_t len = telem_encode_json(&p[i], buf + off, size - off);
+        if (len == 0) return 0;
+        off += len;
+        // Separator or ']', then the NUL
+        if (size - off < 2) return 0;
+        buf[off++] = (i + 1 < n) ? ',' : ']';
+    }
+    buf[off] = '\0';
+    return off;
+}
+
+static size_t encode_batch_binary(const NeighbourState *p, size_t n, uint8_t *buf, size_t size)
+{
+    size_t len = 2 + n * sizeof(*p);
+    if (size < len) return 0;
+
+    buf[0] = TELEM_BATCH_SCHEMA;
+    buf[1] = (uint8_t)n;
+    memcpy(buf + 2, p, n * sizeof(*p));
+    return len;
+}
+
+size_t telem_encode_batch(TelemEncoding enc, const NeighbourState *p, size_t n,
+                          uint8_t *buf, size_t size)
+{
+    if (n == 0 || n > TELEM_BATCH_MAX_SAMPLES) return 0;
+
+    switch (enc) {
+    case TELEM_JSON:   return encode_batch_json(p, n, (char *)buf, size);
+    case TELEM_BINARY: return encode_batch_binary(p, n, buf, size);
+    default:           return 0;
+    }
+}
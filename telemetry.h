@@ -0,0 +1,63 @@
+// main/telemetry.h
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "drone_state.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// MQTT telemetry payloads of one signed NeighbourState (comms_mqtt.c), one
+// encoding per topic:
+//   - TELEM_JSON:   the original object, ~220 bytes, written by the
+//                   compile-time writer of telem_json.cpp. Carries mac_tag
+//                   but not link_cfg, so the tag can't be checked from it.
+//   - TELEM_BINARY: fixed schema, TELEM_BIN_SIZE bytes: the schema byte
+//                   TELEM_BIN_SCHEMA, then the frame exactly as sent on
+//                   the radio (little-endian, packed, mac_tag last), so a
+//                   ground station verifies it like a received frame.
+// Batches (TELEM_SAMPLE_HZ > 0, see telem_ring.h) put several samples in
+// one message: JSON as an array of the objects, binary as the schema byte
+// TELEM_BATCH_SCHEMA, a count byte, then the frames back to back.
+// Decoders for the host: host/telem_decode.h.
+//
+// Pure logic, no FreeRTOS; the JSON writer is C++ (telem_json.cpp).
+
+typedef enum {
+    TELEM_JSON = 0,
+    TELEM_BINARY,
+    TELEM_ENCODINGS
+} TelemEncoding;
+
+#define TELEM_BIN_SCHEMA  0xB1      // Never '{': tells the two apart
+#define TELEM_BIN_SIZE    (1 + sizeof(NeighbourState))
+#define TELEM_JSON_MAX_LEN 264      // Longest object, every field at its widest
+
+#define TELEM_BATCH_SCHEMA 0xB2
+#define TELEM_BATCH_MAX_SAMPLES 255 // Binary count byte
+
+// Buffer that holds a batch of n samples in either encoding
+#define TELEM_BATCH_BUF_SIZE(n) (2 + (n) * (TELEM_JSON_MAX_LEN + 1))
+
+// Payload of p in buf; its length, 0 if it didn't fit (JSON: without the
+// terminating NUL, which is written too)
+size_t telem_encode(TelemEncoding enc, const NeighbourState *p, uint8_t *buf, size_t size);
+
+size_t telem_encode_json(const NeighbourState *p, char *buf, size_t size);
+
+// Same bytes as telem_encode_json(), with snprintf (reference)
+size_t telem_encode_json_printf(const NeighbourState *p, char *buf, size_t size);
+
+size_t telem_encode_binary(const NeighbourState *p, uint8_t *buf, size_t size);
+
+// Payload of the n samples p[0..n) as one message; 0 if n is 0 or above
+// TELEM_BATCH_MAX_SAMPLES, or it didn't fit
+size_t telem_encode_batch(TelemEncoding enc, const NeighbourState *p, size_t n,
+                          uint8_t *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+// main/token_bucket.c
+#include "token_bucket.h"
+
+void token_rate_init(TokenRate *r, float per_s, uint32_t burst)
+{
+    r->per_ms = (uint32_t)(per_s * 1000.0f + 0.5f);
+    if (r->per_ms == 0) r->per_ms = 1;
+    r->cap = burst * TOKEN_UNIT;
+}
+
+void token_fill(TokenBucket *b, const TokenRate *r, uint32_t now_ms)
+{
+    b->level   = r->cap;
+    b->last_ms = now_ms;
+}
+
+static uint32_t level_at(const TokenBucket *b, const TokenRate *r, uint32_t now_ms)
+{
+    uint64_t level = b->level + (uint64_t)(now_ms - b->last_ms) * r->per_ms;
+    return level > r->cap ? r->cap : (uint32_t)level;
+}
+
+uint32_t token_available(const TokenBucket *b, const TokenRate *r, uint32_t now_ms)
+{
+    return level_at(b, r, now_ms) / TOKEN_UNIT;
+}
+
+bool token_take(TokenBucket *b, const TokenRate *r, uint32_t keep, uint32_t now_ms)
+{
+    b->level   = level_at(b, r, now_ms);
+    b->last_ms = now_ms;
+    if (b->level < (keep + 1) * TOKEN_UNIT) return false;
+    b->level -= TOKEN_UNIT;
+    return true;
+}
@@ -0,0 +1,47 @@
+// main/token_bucket.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Token bucket in integer micro-tokens: refills at per_s tokens per second
+// up to burst tokens, one token per event. The rate is shared (TokenRate) so
+// a bucket is 8 bytes and can sit in every security table entry.
+//
+// Refill is lazy, from the time since the last call, so a bucket costs
+// nothing while idle. token_available() only looks; token_take() refills and
+// takes one token if more than keep are there.
+//
+// Pure logic, no FreeRTOS: times are plain milliseconds.
+
+typedef struct {
+    uint32_t per_ms;        // Micro-tokens per millisecond (= tokens/s x 1000)
+    uint32_t cap;           // Micro-tokens, burst x 1e6
+} TokenRate;
+
+typedef struct {
+    uint32_t level;         // Micro-tokens
+    uint32_t last_ms;
+} TokenBucket;
+
+#define TOKEN_UNIT  1000000u
+
+// per_s > 0, 1 <= burst <= 4000
+void token_rate_init(TokenRate *r, float per_s, uint32_t burst);
+
+// Full bucket
+void token_fill(TokenBucket *b, const TokenRate *r, uint32_t now_ms);
+
+// Whole tokens there at now_ms, bucket unchanged
+uint32_t token_available(const TokenBucket *b, const TokenRate *r, uint32_t now_ms);
+
+// Take one token if more than keep are there
+bool token_take(TokenBucket *b, const TokenRate *r, uint32_t keep, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
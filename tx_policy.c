@@ -0,0 +1,101 @@
+// main/tx_policy.c
+#include "tx_policy.h"
+#include "config.h"
+
+#include <math.h>
+#include <string.h>
+
+void tx_policy_default_config(TxPolicyConfig *cfg)
+{
+#if RADIO_TX_ADAPTIVE
+    cfg->min_period_ms   = RADIO_TX_MIN_PERIOD_MS;
+    cfg->max_period_ms   = (uint32_t)RADIO_TX_MAX_PERIOD_MS;
+    cfg->check_period_ms = RADIO_TX_CHECK_PERIOD_MS;
+    cfg->threshold_mm    = RADIO_TX_DELTA_MM;
+#else
+    // Fixed rate: min == max, threshold never reached
+    cfg->min_period_ms   = (uint32_t)RADIO_TX_PERIOD_MS;
+    cfg->max_period_ms   = (uint32_t)RADIO_TX_PERIOD_MS;
+    cfg->check_period_ms = (uint32_t)RADIO_TX_PERIOD_MS;
+    cfg->threshold_mm    = INFINITY;
+#endif
+}
+
+void tx_policy_init(TxPolicy *p, const TxPolicyConfig *cfg)
+{
+    memset(p, 0, sizeof(*p));
+    p->cfg = *cfg;
+    if (p->cfg.check_period_ms == 0) p->cfg.check_period_ms = 1;
+    if (p->cfg.max_period_ms < p->cfg.min_period_ms) {
+        p->cfg.max_period_ms = p->cfg.min_period_ms;
+    }
+}
+
+void tx_policy_set_periods(TxPolicy *p, uint32_t min_period_ms, uint32_t max_period_ms)
+{
+    p->cfg.min_period_ms = min_period_ms;
+    p->cfg.max_period_ms = (max_period_ms < min_period_ms) ? min_period_ms : max_period_ms;
+}
+
+double tx_policy_error_mm(const TxPolicy *p, const DroneState *s, uint32_t now_ms)
+{
+    if (!p->has_sent) return INFINITY;
+
+    double dt = (double)(uint32_t)(now_ms - p->ref_ms) / 1000.0;
+
+    double dx = (p->x_mm + p->vx_mm_s * dt) - s->x_mm;
+    double dy = (p->y_mm + p->vy_mm_s * dt) - s->y_mm;
+    double dz = (p->z_mm + p->vz_mm_s * dt) - s->z_mm;
+
+    return sqrt(dx*dx + dy*dy + dz*dz);
+}
+
+bool tx_policy_should_send(const TxPolicy *p, const DroneState *s, uint32_t now_ms)
+{
+    if (!p->has_sent) return true;
+
+    uint32_t elapsed = now_ms - p->last_tx_ms;
+
+    if (elapsed < p->cfg.min_period_ms) return false;   // rate cap
+    if (elapsed >= p->cfg.max_period_ms) return true;   // heartbeat
+
+    return tx_policy_error_mm(p, s, now_ms) > p->cfg.threshold_mm;
+}
+
+void tx_policy_on_sent_unscheduled(TxPolicy *p, const NeighbourState *sent,
+                                   uint32_t now_ms)
+{
+    if (!p->has_sent) {
+        p->has_sent   = true;
+        p->last_tx_ms = now_ms;
+    }
+    p->ref_ms  = now_ms;
+
+    p->x_mm    = sent->x_mm;
+    p->y_mm    = sent->y_mm;
+    p->z_mm    = sent->z_mm;
+    p->vx_mm_s = sent->vx_mm_s;
+    p->vy_mm_s = sent->vy_mm_s;
+    p->vz_mm_s = sent->vz_mm_s;
+}
+
+void tx_policy_on_sent(TxPolicy *p, const NeighbourState *sent, uint32_t now_ms)
+{
+    p->has_sent   = true;
+    p->last_tx_ms = now_ms;
+    tx_policy_on_sent_unscheduled(p, sent, now_ms);
+}
+
+uint32_t tx_policy_next_check_ms(const TxPolicy *p, uint32_t now_ms)
+{
+    if (!p->has_sent) return 0;
+
+    uint32_t elapsed = now_ms - p->last_tx_ms;
+
+    if (elapsed < p->cfg.min_period_ms) return p->cfg.min_period_ms - elapsed;
+    if (elapsed >= p->cfg.max_period_ms) return 0;
+
+    uint32_t to_heartbeat = p->cfg.max_period_ms - elapsed;
+    return (to_heartbeat < p->cfg.check_period_ms) ? to_heartbeat
+                                                   : p->cfg.check_period_ms;
+}
@@ -0,0 +1,70 @@
+// main/tx_policy.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "drone_state.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Send-on-delta TX policy.
+// Neighbours dead-reckon our position from the last packet they received
+// (pos + vel * age). We only transmit when that extrapolation drifts more
+// than threshold_mm from our real state, bounded by a min interval (rate cap)
+// and a max interval (heartbeat so neighbours never time us out).
+//
+// Pure logic, no FreeRTOS: times are plain milliseconds supplied by the caller
+// so the same code runs in radio_task and in the host simulator.
+
+typedef struct {
+    uint32_t min_period_ms;   // never send faster than this
+    uint32_t max_period_ms;   // always send at least this often
+    uint32_t check_period_ms; // how often the radio task re-evaluates
+    double   threshold_mm;    // allowed dead-reckoning error
+} TxPolicyConfig;
+
+typedef struct {
+    TxPolicyConfig cfg;
+
+    bool     has_sent;
+    uint32_t last_tx_ms;      // Last scheduled send: rate cap / heartbeat phase
+
+    // State as the neighbours last saw it (quantised like the wire format),
+    // sent at ref_ms
+    uint32_t ref_ms;
+    double   x_mm, y_mm, z_mm;
+    double   vx_mm_s, vy_mm_s, vz_mm_s;
+} TxPolicy;
+
+// Defaults from config.h (RADIO_TX_ADAPTIVE == 0 degrades to fixed period)
+void tx_policy_default_config(TxPolicyConfig *cfg);
+
+void tx_policy_init(TxPolicy *p, const TxPolicyConfig *cfg);
+
+// Error between where neighbours think we are and where we actually are (mm)
+double tx_policy_error_mm(const TxPolicy *p, const DroneState *s, uint32_t now_ms);
+
+// Change rate cap / heartbeat at run time (congestion control)
+void tx_policy_set_periods(TxPolicy *p, uint32_t min_period_ms, uint32_t max_period_ms);
+
+// TRUE if a state broadcast is due now
+bool tx_policy_should_send(const TxPolicy *p, const DroneState *s, uint32_t now_ms);
+
+// Record the state that actually went out
+void tx_policy_on_sent(TxPolicy *p, const NeighbourState *sent, uint32_t now_ms);
+
+// Same for a state sent out of schedule (join answer): neighbours now
+// extrapolate from it, but the rate cap and heartbeat keep their phase, so
+// answers from a whole neighbourhood do not bunch its heartbeats together
+void tx_policy_on_sent_unscheduled(TxPolicy *p, const NeighbourState *sent,
+                                   uint32_t now_ms);
+
+// Milliseconds until the policy wants to be asked again
+uint32_t tx_policy_next_check_ms(const TxPolicy *p, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
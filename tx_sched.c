@@ -0,0 +1,207 @@
+// main/tx_sched.c
+#include "tx_sched.h"
+#include "config.h"
+
+#include <string.h>
+
+#define LAT_BUCKET_MS   10
+#define LAT_BUCKETS     100     // 0..990 ms, last bucket collects the rest
+
+typedef struct {
+    TxItem  *items;
+    uint8_t  capacity;
+    uint8_t  head;
+    uint8_t  count;
+} ClassQueue;
+
+typedef struct {
+    uint32_t queued;
+    uint32_t sent;
+    uint32_t expired;
+    uint32_t dropped;
+    uint32_t max_ms;
+    uint32_t lat_hist[LAT_BUCKETS];
+} ClassStats;
+
+static TxItem OWN_ITEMS[1];
+static TxItem RELAY_ITEMS[TX_SCHED_RELAY_DEPTH];
+static TxItem INJECT_ITEMS[TX_SCHED_INJECT_DEPTH];
+
+static ClassQueue QUEUES[TX_CLASS_MAX] = {
+    [TX_CLASS_OWN]    = { OWN_ITEMS,    1,                     0, 0 },
+    [TX_CLASS_RELAY]  = { RELAY_ITEMS,  TX_SCHED_RELAY_DEPTH,  0, 0 },
+    [TX_CLASS_INJECT] = { INJECT_ITEMS, TX_SCHED_INJECT_DEPTH, 0, 0 },
+};
+
+static ClassStats STATS[TX_CLASS_MAX];
+
+static uint32_t s_bulk_ready_ms;    // Relay / inject may start from here
+static uint32_t s_tx_start_ms;
+static TxClass  s_tx_class;
+
+static bool time_after(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+void tx_sched_init(void)
+{
+    for (int c = 0; c < TX_CLASS_MAX; ++c) {
+        QUEUES[c].head  = 0;
+        QUEUES[c].count = 0;
+    }
+    memset(STATS, 0, sizeof(STATS));
+    s_bulk_ready_ms = 0;
+    s_tx_start_ms   = 0;
+    s_tx_class      = TX_CLASS_OWN;
+}
+
+// -----------------------------------------------------------------------------
+// QUEUEING
+// -----------------------------------------------------------------------------
+bool tx_sched_enqueue(TxClass cls, const void *data, size_t len,
+                      uint32_t now_ms, uint32_t deadline_ms)
+{
+    if (cls >= TX_CLASS_MAX || len > TX_SCHED_FRAME_MAX) return false;
+
+    ClassQueue *q = &QUEUES[cls];
+    ClassStats *st = &STATS[cls];
+
+    if (q->count == q->capacity) {
+        st->dropped++;
+        if (cls != TX_CLASS_OWN) return false;
+        // Own state: the newer one supersedes what is waiting
+        q->count = 0;
+    }
+
+    TxItem *it = &q->items[(q->head + q->count) % q->capacity];
+    it->cls         = cls;
+    it->len         = (uint8_t)len;
+    it->enqueued_ms = now_ms;
+    it->deadline_ms = deadline_ms;
+    memcpy(it->data, data, len);
+
+    q->count++;
+    st->queued++;
+    return true;
+}
+
+bool tx_sched_pending(TxClass cls)
+{
+    return cls < TX_CLASS_MAX && QUEUES[cls].count > 0;
+}
+
+// Drop expired items at the head of a class queue
+static void expire(TxClass cls, uint32_t now_ms)
+{
+    ClassQueue *q = &QUEUES[cls];
+    while (q->count > 0 && time_after(now_ms, q->items[q->head].deadline_ms)) {
+        q->head = (q->head + 1) % q->capacity;
+        q->count--;
+        STATS[cls].expired++;
+    }
+}
+
+bool tx_sched_next(TxItem *out, uint32_t now_ms)
+{
+    for (int c = 0; c < TX_CLASS_MAX; ++c) {
+        expire((TxClass)c, now_ms);
+
+        ClassQueue *q = &QUEUES[c];
+        if (q->count == 0) continue;
+
+        // Bulk classes leave the receiver armed between frames
+        if (c != TX_CLASS_OWN && time_after(s_bulk_ready_ms, now_ms)) {
+            return false;
+        }
+
+        *out = q->items[q->head];
+        q->head = (q->head + 1) % q->capacity;
+        q->count--;
+        return true;
+    }
+    return false;
+}
+
+uint32_t tx_sched_wait_ms(uint32_t now_ms)
+{
+    if (QUEUES[TX_CLASS_OWN].count > 0) return 0;
+
+    for (int c = TX_CLASS_RELAY; c < TX_CLASS_MAX; ++c) {
+        if (QUEUES[c].count > 0) {
+            return time_after(s_bulk_ready_ms, now_ms) ? s_bulk_ready_ms - now_ms : 0;
+        }
+    }
+    return UINT32_MAX;
+}
+
+bool tx_sched_idle_for(TxClass cls, uint32_t now_ms)
+{
+    for (int c = 0; c < TX_CLASS_MAX; ++c) {
+        if (QUEUES[c].count > 0) return false;
+    }
+    return cls == TX_CLASS_OWN || !time_after(s_bulk_ready_ms, now_ms);
+}
+
+// -----------------------------------------------------------------------------
+// ACCOUNTING
+// -----------------------------------------------------------------------------
+void tx_sched_on_tx_start(const TxItem *it, uint32_t now_ms)
+{
+    ClassStats *st = &STATS[it->cls];
+    uint32_t lat = now_ms - it->enqueued_ms;
+
+    uint32_t b = lat / LAT_BUCKET_MS;
+    if (b >= LAT_BUCKETS) b = LAT_BUCKETS - 1;
+    st->lat_hist[b]++;
+    if (lat > st->max_ms) st->max_ms = lat;
+    st->sent++;
+
+    s_tx_start_ms = now_ms;
+    s_tx_class    = it->cls;
+}
+
+void tx_sched_on_tx_done(uint32_t now_ms)
+{
+    uint32_t gap = TX_SCHED_BULK_GAP_MS;
+
+    if (s_tx_class != TX_CLASS_OWN) {
+        // Listen long enough to keep bulk traffic within its airtime share
+        uint32_t airtime = now_ms - s_tx_start_ms;
+        uint32_t share_gap = airtime * (100u - TX_SCHED_BULK_SHARE_PCT) / TX_SCHED_BULK_SHARE_PCT;
+        if (share_gap > gap) gap = share_gap;
+    }
+    s_bulk_ready_ms = now_ms + gap;
+}
+
+static uint32_t percentile(const ClassStats *st, float p)
+{
+    if (st->sent == 0) return 0;
+
+    uint32_t target = (uint32_t)(p * (float)st->sent);
+    if (target >= st->sent) target = st->sent - 1;
+
+    uint32_t acc = 0;
+    for (int b = 0; b < LAT_BUCKETS - 1; ++b) {
+        acc += st->lat_hist[b];
+        if (acc > target) return (uint32_t)(b + 1) * LAT_BUCKET_MS;
+    }
+    return st->max_ms;
+}
+
+void tx_sched_get_stats(TxClass cls, TxSchedStats *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (cls >= TX_CLASS_MAX) return;
+
+    const ClassStats *st = &STATS[cls];
+    out->queued  = st->queued;
+    out->sent    = st->sent;
+    out->expired = st->expired;
+    out->dropped = st->dropped;
+    out->pending = QUEUES[cls].count;
+    out->p50_ms  = percentile(st, 0.50f);
+    out->p90_ms  = percentile(st, 0.90f);
+    out->p99_ms  = percentile(st, 0.99f);
+    out->max_ms  = st->max_ms;
+}
@@ -0,0 +1,79 @@
+// main/tx_sched.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Priority TX scheduler for radio_task. Three classes, strict priority:
+// our own state first, then relayed traffic, then test injection. Every
+// item carries a deadline and is discarded once it passes, so a backlog of
+// relayed / injected frames never delays a fresh own-state broadcast by more
+// than the packet already on air. Relayed / injected frames are spaced so
+// they take at most TX_SCHED_BULK_SHARE_PCT of airtime and the receiver is
+// re-armed between them.
+//
+// Called from radio_task only (stats may be read from anywhere). Pure
+// logic, no FreeRTOS: times are plain milliseconds.
+
+typedef enum {
+    TX_CLASS_OWN = 0,
+    TX_CLASS_RELAY,
+    TX_CLASS_INJECT,
+    TX_CLASS_MAX
+} TxClass;
+
+#define TX_SCHED_FRAME_MAX   64
+
+typedef struct {
+    TxClass  cls;
+    uint8_t  len;
+    uint32_t enqueued_ms;
+    uint32_t deadline_ms;
+    uint8_t  data[TX_SCHED_FRAME_MAX];
+} TxItem;
+
+typedef struct {
+    uint32_t queued;
+    uint32_t sent;
+    uint32_t expired;       // Deadline passed before it could go out
+    uint32_t dropped;       // Queue full (own state: superseded by a newer one)
+    uint32_t pending;
+    uint32_t p50_ms;        // Enqueue -> TX start latency
+    uint32_t p90_ms;
+    uint32_t p99_ms;
+    uint32_t max_ms;
+} TxSchedStats;
+
+void tx_sched_init(void);
+
+// Own state holds one item: a newer one replaces it. FALSE if dropped.
+bool tx_sched_enqueue(TxClass cls, const void *data, size_t len,
+                      uint32_t now_ms, uint32_t deadline_ms);
+
+bool tx_sched_pending(TxClass cls);
+
+// Next item allowed on air now, highest class first. Expired items are
+// discarded (counted) on the way.
+bool tx_sched_next(TxItem *out, uint32_t now_ms);
+
+// How long until tx_sched_next() may return something (UINT32_MAX if empty)
+uint32_t tx_sched_wait_ms(uint32_t now_ms);
+
+// TRUE if an item of this class enqueued now would be next out, without
+// waiting behind anything queued or the bulk spacing
+bool tx_sched_idle_for(TxClass cls, uint32_t now_ms);
+
+// radio_task reports what actually happened to the item from tx_sched_next()
+void tx_sched_on_tx_start(const TxItem *it, uint32_t now_ms);
+void tx_sched_on_tx_done(uint32_t now_ms);
+
+void tx_sched_get_stats(TxClass cls, TxSchedStats *out);
+
+#ifdef __cplusplus
+}
+#endif